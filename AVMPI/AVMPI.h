@@ -108,6 +108,30 @@ extern bool         AVMPI_commitMemory(void* address, size_t size);
 */
 extern bool         AVMPI_decommitMemory(char *address, size_t size);
 
+/**
+* Method to find the size of the transparent huge pages that AVMPI_commitHugePageMemory can request
+* @return size, in bytes, of a huge page, or 0 if the platform does not provide them
+*/
+extern size_t       AVMPI_getHugePageSize();
+
+/**
+* This method commits memory like AVMPI_commitMemory, additionally asking the system to back
+* the parts of the range that cover whole, aligned huge pages with huge pages
+* @param address base address of the memory region to commit
+* @param size size, in bytes, of the memory to commit
+* @return true if the function succeeds, false otherwise
+* @see AVMPI_getHugePageSize()
+*/
+extern bool         AVMPI_commitHugePageMemory(void* address, size_t size);
+
+/**
+* Method to find how much of a range of committed memory is currently backed by huge pages
+* @param address base address of the memory region
+* @param size size, in bytes, of the memory region
+* @return number of bytes backed by huge pages, 0 if that can't be determined
+*/
+extern size_t       AVMPI_getHugePageBackedSize(void* address, size_t size);
+
 /**
  * Allocate memory for jitted code.
  *
@@ -17,7 +17,7 @@
 #include <mach/mach.h>
 #endif // PEPPER_PLUGIN
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 #include <dlfcn.h>
 #include <cxxabi.h>
 #include <mach-o/dyld.h>
@@ -129,6 +129,22 @@ bool AVMPI_decommitMemory(char *address, size_t size)
     return (result == KERN_SUCCESS);
 }
 
+size_t AVMPI_getHugePageSize()
+{
+    // Superpages are not transparent here: they must be requested when the memory is mapped.
+    return 0;
+}
+
+bool AVMPI_commitHugePageMemory(void* address, size_t size)
+{
+    return AVMPI_commitMemory(address, size);
+}
+
+size_t AVMPI_getHugePageBackedSize(void* /*address*/, size_t /*size*/)
+{
+    return 0;
+}
+
 void* AVMPI_allocateAlignedMemory(size_t size)
 {
     void *addr = valloc(size);
@@ -185,7 +201,7 @@ uintptr_t AVMPI_getThreadStackBase()
     return (uintptr_t)pthread_get_stackaddr_np(pthread_self());
 }
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 
 #ifdef MMGC_PPC
 
@@ -332,4 +348,4 @@ bool AVMPI_getFileAndLineInfoFromPC(uintptr_t pc, char *buffer, size_t bufferSiz
     return false;
 }
 
-#endif //MMGC_MEMORY_PROFILER
+#endif // MMGC_MEMORY_PROFILER || MMGC_ALLOCATION_SAMPLER
@@ -126,6 +126,22 @@ bool AVMPI_decommitMemory(char *address, size_t size)
     return result;
 }
 
+size_t AVMPI_getHugePageSize()
+{
+    // No huge page support.
+    return 0;
+}
+
+bool AVMPI_commitHugePageMemory(void* address, size_t size)
+{
+    return AVMPI_commitMemory(address, size);
+}
+
+size_t AVMPI_getHugePageBackedSize(void* /*address*/, size_t /*size*/)
+{
+    return 0;
+}
+
 #if 0
 void* AVMPI_allocateAlignedMemory(size_t size)
 {
@@ -202,7 +218,7 @@ uintptr_t AVMPI_getThreadStackBase()
     return uintptr_t(info.iBase);
 }
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 
     bool AVMPI_captureStackTrace(uintptr_t* buffer, size_t bufferSize, uint32_t framesToSkip)
     {
@@ -225,4 +241,4 @@ uintptr_t AVMPI_getThreadStackBase()
         return false;
     }
 
-#endif //MEMORY_PROFILER
+#endif // MMGC_MEMORY_PROFILER || MMGC_ALLOCATION_SAMPLER
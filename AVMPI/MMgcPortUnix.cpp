@@ -89,6 +89,27 @@ void* AVMPI_reserveMemoryRegion(void* address, size_t size)
         AVMPI_releaseMemoryRegion(addr, size);
         return NULL;
     }
+    if(!address && (uintptr_t(addr) & (MMgc::GCHeap::kBlockSize-1)) != 0) {
+        // GCHeap requires its regions to be aligned on its block size, which may be
+        // larger than the OS page.  Fresh mappings are usually adjacent to earlier
+        // ones and hence aligned, but mappings made by others, such as thread stacks
+        // with their guard pages, can break that; reserve some slop and trim it off.
+        AVMPI_releaseMemoryRegion(addr, size);
+        const size_t slop = MMgc::GCHeap::kBlockSize;
+        char *base = (char*)mmap(NULL,
+                                 size + slop,
+                                 PROT_NONE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS,
+                                 -1, 0);
+        if (base == MAP_FAILED) {
+            return NULL;
+        }
+        addr = (char*)((uintptr_t(base) + slop - 1) & ~uintptr_t(slop - 1));
+        if (addr > base)
+            AVMPI_releaseMemoryRegion(base, addr - base);
+        if (base + slop > addr)
+            AVMPI_releaseMemoryRegion(addr + size, (base + slop) - addr);
+    }
     return addr;
 }
 
@@ -133,6 +154,108 @@ bool AVMPI_decommitMemory(char *address, size_t size)
     return addr == address;
 }
 
+// Transparent huge pages are Linux-only.  They are requested per mapping with
+// madvise(MADV_HUGEPAGE), which works when the system setting is "madvise" or
+// "always".  The advice must be given before the pages are first touched,
+// otherwise the range is faulted in with small pages and only khugepaged may
+// collapse it later.
+
+#if defined(linux) && defined(MADV_HUGEPAGE)
+static size_t readSysfsHugePageSize()
+{
+    char buf[64];
+    int fd = open("/sys/kernel/mm/transparent_hugepage/enabled", O_RDONLY);
+    if (fd == -1)
+        return 0;
+    ssize_t n = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (n <= 0)
+        return 0;
+    buf[n] = 0;
+    if (strstr(buf, "[never]") != NULL)
+        return 0;
+
+    size_t size = 2*1024*1024;
+    fd = open("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", O_RDONLY);
+    if (fd != -1) {
+        n = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+        if (n > 0) {
+            buf[n] = 0;
+            size = (size_t)strtoul(buf, NULL, 10);
+        }
+    }
+    // Must be a power of two multiple of the VM page size to be of any use
+    if (size <= VMPI_getVMPageSize() || (size & (size - 1)) != 0)
+        return 0;
+    return size;
+}
+#endif
+
+size_t AVMPI_getHugePageSize()
+{
+#if defined(linux) && defined(MADV_HUGEPAGE)
+    static size_t hugePageSize = readSysfsHugePageSize();
+    return hugePageSize;
+#else
+    return 0;
+#endif
+}
+
+bool AVMPI_commitHugePageMemory(void* address, size_t size)
+{
+#if defined(linux) && defined(MADV_HUGEPAGE)
+    char *addr = (char*)mmap((maddr_ptr)address,
+                             size,
+                             PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_FIXED | MAP_ANONYMOUS,
+                             -1, 0);
+    if (addr != address)
+        return false;
+
+    // Failure to advise is not an error, the memory just stays in small pages.
+    madvise(addr, size, MADV_HUGEPAGE);
+
+    size_t pageSize = VMPI_getVMPageSize();
+    for ( char* temp_addr = addr ; temp_addr < addr + size ; temp_addr += pageSize )
+        *temp_addr = 0;
+    return true;
+#else
+    return AVMPI_commitMemory(address, size);
+#endif
+}
+
+size_t AVMPI_getHugePageBackedSize(void* address, size_t size)
+{
+#if defined(linux) && defined(MADV_HUGEPAGE)
+    // Sum AnonHugePages over the mappings that overlap the range.  Mappings
+    // are merged when their attributes agree, so a mapping can extend past the
+    // range, but only into other huge-page-advised anonymous memory.
+    FILE* f = fopen("/proc/self/smaps", "r");
+    if (f == NULL)
+        return 0;
+
+    uintptr_t lo = uintptr_t(address);
+    uintptr_t hi = lo + size;
+    bool overlaps = false;
+    size_t total = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned long start, end, kbytes;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+            overlaps = start < hi && end > lo;
+        else if (overlaps && sscanf(line, "AnonHugePages: %lu kB", &kbytes) == 1)
+            total += size_t(kbytes) * 1024;
+    }
+    fclose(f);
+    return total;
+#else
+    (void)address;
+    (void)size;
+    return 0;
+#endif
+}
+
 void* AVMPI_allocateAlignedMemory(size_t size)
 {
     return valloc(size);
@@ -376,7 +499,7 @@ uintptr_t AVMPI_getThreadStackBase()
 #endif
 
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 
 
     #ifdef MMGC_SPARC
@@ -518,6 +641,30 @@ uintptr_t AVMPI_getThreadStackBase()
         }
     #endif
 
+    #if !defined MMGC_SPARC && !defined MMGC_PPC && !defined MMGC_IA32 && !defined MMGC_ARM
+        bool AVMPI_captureStackTrace(uintptr_t* buffer, size_t bufferSize, uint32_t framesToSkip)
+        {
+    #ifdef HAVE_BACKTRACE
+            // The unwinder does not depend on frame pointers, which x86-64 builds omit.
+            void* frames[64];
+            size_t want = bufferSize + framesToSkip;
+            int n = backtrace(frames, int(want < 64 ? want : 64));
+            size_t i = 0;
+            // save space for 0 terminator
+            bufferSize--;
+            for (int j=int(framesToSkip)+1; j < n && i < bufferSize; j++)
+                buffer[i++] = uintptr_t(frames[j]);
+            buffer[i] = 0;
+            return true;
+    #else
+            (void) buffer;
+            (void) bufferSize;
+            (void) framesToSkip;
+            return false;
+    #endif
+        }
+    #endif
+
     bool AVMPI_getFunctionNameFromPC(uintptr_t pc, char *buffer, size_t bufferSize)
     {
 #ifdef HAVE_BACKTRACE
@@ -553,14 +700,16 @@ uintptr_t AVMPI_getThreadStackBase()
 
     void AVMPI_desetupPCResolution() { }
 
+#ifdef MMGC_MEMORY_PROFILER
     bool AVMPI_isMemoryProfilingEnabled()
     {
         //read the mmgc profiling option switch
         const char *env = getenv("MMGC_PROFILE");
         return (env && (VMPI_strncmp(env, "1", 1) == 0));
     }
+#endif
 
-#endif //MEMORY_PROFILER
+#endif // MMGC_MEMORY_PROFILER || MMGC_ALLOCATION_SAMPLER
 
 
 void AVMPI_cleanStack(size_t amt)
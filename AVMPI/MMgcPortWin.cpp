@@ -9,7 +9,7 @@
 
 #include "MMgc.h"
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
     #include <malloc.h>
     #include <strsafe.h>
 #ifndef UNDER_CE  // Not available on WinMo builds
@@ -98,6 +98,22 @@ bool AVMPI_decommitMemory(char *address, size_t size)
     return success;
 }
 
+size_t AVMPI_getHugePageSize()
+{
+    // Large pages are not transparent on Windows: they need a privilege and must be committed when reserved.
+    return 0;
+}
+
+bool AVMPI_commitHugePageMemory(void* address, size_t size)
+{
+    return AVMPI_commitMemory(address, size);
+}
+
+size_t AVMPI_getHugePageBackedSize(void* /*address*/, size_t /*size*/)
+{
+    return 0;
+}
+
 void* AVMPI_allocateAlignedMemory(size_t size)
 {
     return VirtualAlloc(NULL, size, MEM_COMMIT
@@ -238,7 +254,7 @@ uintptr_t AVMPI_getThreadStackBase()
     return (uintptr_t)__mib.BaseAddress + __mib.RegionSize;
 }
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 
 #ifndef UNDER_CE
 namespace MMgc
@@ -605,7 +621,7 @@ extern "C" unsigned long* get_frame_pointer();
     #endif
     }
 
-#endif // MMGC_MEMORY_PROFILER
+#endif // MMGC_MEMORY_PROFILER || MMGC_ALLOCATION_SAMPLER
 
 // Constraint: nbytes must be a multiple of the VM page size.
 //
@@ -637,7 +653,9 @@ void *AVMPI_allocateCodeMemory(size_t nbytes)
     
     size_t nblocks = nbytes / MMgc::GCHeap::kBlockSize;
     heap->SignalCodeMemoryAllocation(nblocks, true);
-    return heap->Alloc(nblocks, MMgc::GCHeap::flags_Alloc, pagesize/MMgc::GCHeap::kBlockSize);
+    // Blocks may be larger than VM pages, in which case every block is page aligned.
+    size_t alignment = pagesize > MMgc::GCHeap::kBlockSize ? pagesize/MMgc::GCHeap::kBlockSize : 1;
+    return heap->Alloc(nblocks, MMgc::GCHeap::flags_Alloc, alignment);
 }
 
 // Constraint: address must have been returned from AVMPI_allocateCodeMemory
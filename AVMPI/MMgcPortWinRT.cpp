@@ -49,6 +49,22 @@ bool AVMPI_decommitMemory(char* /*address*/, size_t /*size*/)
 	return false;
 }
 
+size_t AVMPI_getHugePageSize()
+{
+	// No huge page support.
+	return 0;
+}
+
+bool AVMPI_commitHugePageMemory(void* address, size_t size)
+{
+	return AVMPI_commitMemory(address, size);
+}
+
+size_t AVMPI_getHugePageBackedSize(void* /*address*/, size_t /*size*/)
+{
+	return 0;
+}
+
 void* AVMPI_allocateAlignedMemory(size_t size)
 {
 	void* mem = _aligned_malloc(size, VMPI_getVMPageSize());
@@ -110,7 +126,7 @@ void AVMPI_makeCodeMemoryExecutable(void* /*address*/, size_t /*nbytes*/, bool /
 {
 }
 
-#ifdef MMGC_MEMORY_PROFILER
+#if defined MMGC_MEMORY_PROFILER || defined MMGC_ALLOCATION_SAMPLER
 /*
 It may not be possible to implement this feature in Windows Store apps, at least by using the same APIs as before.
 
@@ -145,4 +161,4 @@ bool AVMPI_isMemoryProfilingEnabled()
 	return false;
 }
 
-#endif // MMGC_MEMORY_PROFILER
+#endif // MMGC_MEMORY_PROFILER || MMGC_ALLOCATION_SAMPLER
@@ -49,7 +49,9 @@ void *AVMPI_allocateCodeMemory(size_t nbytes)
     size_t nblocks = nbytes / MMgc::GCHeap::kBlockSize;
 
     heap->SignalCodeMemoryAllocation(nblocks, true);
-    return heap->Alloc(nblocks, MMgc::GCHeap::flags_Alloc, pagesize/MMgc::GCHeap::kBlockSize);
+    // Blocks may be larger than VM pages, in which case every block is page aligned.
+    size_t alignment = pagesize > MMgc::GCHeap::kBlockSize ? pagesize/MMgc::GCHeap::kBlockSize : 1;
+    return heap->Alloc(nblocks, MMgc::GCHeap::flags_Alloc, alignment);
 }
 
 // Constraint: address must have been returned from VMPI_allocateCodeMemory
@@ -25,8 +25,16 @@ namespace MMgc
         m_heap->CheckForOOMAbortAllocation();
 #endif
 
-        if (size <= (size_t)kLargestAlloc)
+        if (size <= (size_t)kLargestAlloc) {
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+            ThreadCache* tc = m_threadCache;
+            if (tc == NULL && m_heap->config.fixedMagazines)
+                tc = AcquireThreadCache();
+            if (tc != NULL)
+                return MagazineAlloc(tc, size, flags);
+#endif
             return FindAllocatorForSize(size)->Alloc(size, flags);
+        }
         else
             return LargeAlloc(size, flags);
     }
@@ -47,8 +55,16 @@ namespace MMgc
 
         if(IsLargeAlloc(item))
             LargeFree(item);
-        else
+        else {
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+            ThreadCache* tc = m_threadCache;
+            if (tc != NULL) {
+                MagazineFree(tc, item);
+                return;
+            }
+#endif
             FixedAllocSafe::GetFixedAllocSafe(item)->Free(item);
+        }
     }
 
     REALLY_INLINE size_t FixedMalloc::Size(const void *item)
@@ -114,6 +130,64 @@ namespace MMgc
         return &m_allocs[index];
     }
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+    REALLY_INLINE void* FixedMalloc::MagazineAlloc(ThreadCache* tc, size_t size, FixedMallocOpts flags)
+    {
+        FixedAllocSafe* alloc = FindAllocatorForSize(size);
+        Magazine& m = tc->magazines[alloc - m_allocs];
+        tc->ops++;
+        if (m.count == 0 && !RefillMagazine(tc, alloc, m, size, flags))
+            return NULL;
+
+        void* item = FLPop(m.head);
+        m.count--;
+
+        // The rest of FixedAlloc::Alloc, which RefillMagazine did not do for this
+        // object: its first word held the magazine link.
+        size_t itemSize = alloc->GetItemSize();
+        if ((flags & kZero) != 0)
+            VMPI_memset(item, 0, itemSize);
+#ifdef DEBUG
+        else if (!RUNNING_ON_VALGRIND)
+            VMPI_memset(item, uint8_t(GCHeap::FXFreshPoison), itemSize);
+#endif
+#ifdef MMGC_HOOKS
+        alloc->InlineAllocHook(size, item);
+#endif
+        return item;
+    }
+
+    REALLY_INLINE void FixedMalloc::MagazineFree(ThreadCache* tc, void* item)
+    {
+        FixedAllocSafe* alloc = FixedAllocSafe::GetFixedAllocSafe(item);
+        unsigned index = unsigned(alloc - m_allocs);
+        GCAssert(index < unsigned(kNumSizeClasses));
+        Magazine& m = tc->magazines[index];
+        tc->ops++;
+
+#ifdef MMGC_HOOKS
+        // No memory profiler while there are magazines, see AcquireThreadCache.
+#ifdef MMGC_MEMORY_PROFILER
+        size_t askSize = 0;
+#endif
+        FixedAlloc::InlineFreeHook(item MMGC_MEMORY_PROFILER_ARG(askSize));
+#endif
+
+        uint32_t capacity = MagazineCapacity(index);
+        if (m.count == capacity)
+            FlushMagazine(tc, alloc, m, capacity / 2);
+        FLPush(m.head, item);
+        m.count++;
+    }
+
+    /*static*/
+    REALLY_INLINE uint32_t FixedMalloc::MagazineCapacity(unsigned index)
+    {
+        uint32_t n = kMagazineBytes / uint32_t(kSizeClasses[index]);
+        return n < 2 ? 2 : (n > kMaxMagazineItems ? kMaxMagazineItems : n);
+    }
+#endif
+
     REALLY_INLINE size_t FixedMalloc::GetNumLargeBlocks()
     {
         MMGC_LOCK(m_largeAllocInfoLock);
@@ -132,6 +132,13 @@ namespace MMgc
 
         m_rootFindCache.Init();
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        VMPI_lockInit(&m_threadCacheLock);
+        m_threadCaches = NULL;
+        m_retiredMagazineOps = 0;
+        m_retiredMagazineLocks = 0;
+#endif
+
         FixedMalloc::instance = this;
     }
 
@@ -145,6 +152,10 @@ namespace MMgc
         VMPI_lockDestroy(&m_largeObjectLock);
     #endif
         m_rootFindCache.Destroy();
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        GCAssert(m_threadCaches == NULL);
+        VMPI_lockDestroy(&m_threadCacheLock);
+#endif
 
         FixedMalloc::instance = NULL;
     }
@@ -290,6 +301,149 @@ namespace MMgc
     }
 #endif
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+    // Magazines.
+    //
+    // A thread inside MMGC_ENTER gets a ThreadCache with one magazine per size class.
+    // Small-object Alloc and Free work on the magazine without locking; an empty
+    // magazine is refilled with half its capacity, and half of a full magazine is
+    // flushed, each under a single acquisition of the allocator's lock.  Objects can
+    // be freed into any thread's magazine since flushing returns each to its own block.
+    //
+    // The objects in a magazine count as allocated for GetUsageInfo and friends.  The
+    // thread's cache is flushed and recycled when it leaves its outermost MMGC_ENTER,
+    // so exiting threads don't strand objects.  Magazines are not used while the memory
+    // profiler is installed, as it needs every Free to account the requested size.
+
+    FixedMalloc::ThreadCache* FixedMalloc::AcquireThreadCache()
+    {
+        GCAssert(m_threadCache == NULL);
+
+        if (m_heap->GetEnterFrame() == NULL)
+            return NULL;
+#ifdef MMGC_MEMORY_PROFILER
+        if (m_heap->GetProfiler() != NULL)
+            return NULL;
+#endif
+
+        ThreadCache* tc = NULL;
+        {
+            MMGC_LOCK(m_threadCacheLock);
+            for (tc = m_threadCaches; tc != NULL && tc->inUse; tc = tc->next)
+                ;
+            if (tc != NULL)
+                tc->inUse = true;
+        }
+
+        if (tc == NULL) {
+            // Allocate outside m_threadCacheLock, as the allocator may call into GCHeap.
+            tc = (ThreadCache*)FindAllocatorForSize(sizeof(ThreadCache))->Alloc(sizeof(ThreadCache), FixedMallocOpts(kZero|kCanFail));
+            if (tc == NULL)
+                return NULL;
+            tc->inUse = true;
+            MMGC_LOCK(m_threadCacheLock);
+            tc->next = m_threadCaches;
+            m_threadCaches = tc;
+        }
+
+        m_threadCache = tc;
+        return tc;
+    }
+
+    void FixedMalloc::ReleaseThreadCache()
+    {
+        ThreadCache* tc = m_threadCache;
+        if (tc == NULL)
+            return;
+        m_threadCache = NULL;
+
+        for (int i=0; i < kNumSizeClasses; i++) {
+            Magazine& m = tc->magazines[i];
+            if (m.count > 0)
+                FlushMagazine(tc, &m_allocs[i], m, m.count);
+        }
+
+        MMGC_LOCK(m_threadCacheLock);
+        m_retiredMagazineOps += tc->ops;
+        m_retiredMagazineLocks += tc->locks;
+        tc->ops = 0;
+        tc->locks = 0;
+        tc->inUse = false;
+    }
+
+    void FixedMalloc::DestroyThreadCaches()
+    {
+        ReleaseThreadCache();
+
+        ThreadCache* tc = m_threadCaches;
+        m_threadCaches = NULL;
+        while (tc != NULL) {
+            ThreadCache* next = tc->next;
+            for (int i=0; i < kNumSizeClasses; i++) {
+                Magazine& m = tc->magazines[i];
+                if (m.count > 0)
+                    FlushMagazine(tc, &m_allocs[i], m, m.count);
+            }
+            FixedAllocSafe::GetFixedAllocSafe(tc)->Free(tc);
+            tc = next;
+        }
+    }
+
+    bool FixedMalloc::RefillMagazine(ThreadCache* tc, FixedAllocSafe* alloc, Magazine& m, size_t size, FixedMallocOpts flags)
+    {
+        GCAssert(m.count == 0);
+
+        uint32_t n = MagazineCapacity(uint32_t(alloc - m_allocs)) / 2;
+        MMGC_LOCK(alloc->m_spinlock);
+        tc->locks++;
+
+        // Only the first object must honor kCanFail being absent; the others are a bonus.
+        // The caller zeroes or poisons each object as it hands it out.
+        void* item = alloc->InlineAllocSansHook(size, FixedMallocOpts(flags & kCanFail));
+        while (item != NULL) {
+#ifdef MMGC_MEMORY_INFO
+            // Poison as if freed, like the objects MagazineFree adds, so that FlushMagazine
+            // can treat all objects alike.
+            VMPI_memset(item, uint8_t(GCHeap::FXFreedPoison), alloc->GetItemSize());
+#endif
+            FLPush(m.head, item);
+            m.count++;
+            if (m.count >= n)
+                break;
+            item = alloc->InlineAllocSansHook(size, kCanFail);
+        }
+        return m.count > 0;
+    }
+
+    void FixedMalloc::FlushMagazine(ThreadCache* tc, FixedAllocSafe* alloc, Magazine& m, uint32_t n)
+    {
+        GCAssert(n <= m.count);
+
+        MMGC_LOCK(alloc->m_spinlock);
+        tc->locks++;
+        while (n-- > 0) {
+            void* item = FLPop(m.head);
+            m.count--;
+#ifdef MMGC_MEMORY_INFO
+            // Restore the poison the free hook wrote before the magazine link.
+            VMPI_memset(item, uint8_t(GCHeap::FXFreedPoison), sizeof(void*));
+#endif
+            FixedAlloc::InlineFreeSansHook(item MMGC_MEMORY_PROFILER_ARG(0));
+        }
+    }
+
+    void FixedMalloc::GetMagazineStats(uint64_t& ops, uint64_t& locks)
+    {
+        MMGC_LOCK(m_threadCacheLock);
+        ops = m_retiredMagazineOps;
+        locks = m_retiredMagazineLocks;
+        for (ThreadCache* tc = m_threadCaches; tc != NULL; tc = tc->next) {
+            ops += tc->ops;
+            locks += tc->locks;
+        }
+    }
+#endif
+
     const void* FixedMalloc::FindBeginning(const void *addr)
     {
         const void* begin_recv = NULL;
@@ -158,6 +158,21 @@ namespace MMgc
         void DumpMemoryInfo();
 #endif
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        /**
+         * Obtain the magazine counters (GCHeapConfig::fixedMagazines).
+         *
+         * @param ops    (out) The number of small-object Alloc and Free calls served
+         *               through magazines
+         * @param locks  (out) The number of allocator lock acquisitions made to refill
+         *               and flush magazines; without magazines every operation takes one
+         *
+         * @note  The counters of threads still inside MMGC_ENTER are read without
+         *        synchronization and may be slightly stale.
+         */
+        void GetMagazineStats(uint64_t& ops, uint64_t& locks);
+#endif
+
     private:
 #ifdef DEBUG
         // Data type used for tracking live large objects, used by EnsureFixedMallocMemory.
@@ -240,6 +255,44 @@ namespace MMgc
         // Free the item returned from LargeAlloc.
         void LargeFree(void *item);
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        struct ThreadCache;
+        struct Magazine;
+
+        // Return the calling thread's magazines, creating them if the thread is inside
+        // MMGC_ENTER.  Returns NULL if the thread can't have magazines, in which case
+        // the caller takes the allocator lock as usual.
+        ThreadCache* AcquireThreadCache();
+
+        // Return every object in the calling thread's magazines to its allocator and
+        // make the magazines available to another thread.  Called by GCHeap::Leave when
+        // the thread leaves its outermost MMGC_ENTER.
+        void ReleaseThreadCache();
+
+        // Flush and free the magazines of all threads.  Called from GCHeap::DestroyInstance
+        // before the leak check; no thread may be using FixedMalloc.
+        void DestroyThreadCaches();
+
+        // Allocate a small object from the magazine for its size class, refilling the
+        // magazine if it is empty.
+        void* MagazineAlloc(ThreadCache* tc, size_t size, FixedMallocOpts flags);
+
+        // Free a small object into the magazine for its size class, flushing half the
+        // magazine if it is full.
+        void MagazineFree(ThreadCache* tc, void* item);
+
+        // Move up to half a magazine of objects from 'alloc' into 'm' under one lock
+        // acquisition.  Returns false if no object could be allocated, which can only
+        // happen if 'flags' contains kCanFail.
+        bool RefillMagazine(ThreadCache* tc, FixedAllocSafe* alloc, Magazine& m, size_t size, FixedMallocOpts flags);
+
+        // Return 'n' objects from 'm' to 'alloc' under one lock acquisition.
+        void FlushMagazine(ThreadCache* tc, FixedAllocSafe* alloc, Magazine& m, uint32_t n);
+
+        // The number of objects a magazine for the allocator m_allocs[index] can hold.
+        static uint32_t MagazineCapacity(unsigned index);
+#endif
+
         // Return the allocated size (in bytes) of 'item', which must have been returned
         // from LargeAlloc.
         size_t LargeSize(const void *item);
@@ -267,6 +320,31 @@ namespace MMgc
         // in FixedMalloc.cpp, also see the implementation of FindAllocatorForSize.
         const static uint8_t kSizeClassIndex[kMaxSizeClassIndex];
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        // A magazine holds up to about kMagazineBytes of objects, but never more than
+        // kMaxMagazineItems or fewer than two.
+        const static uint32_t kMagazineBytes = 2048;
+        const static uint32_t kMaxMagazineItems = 32;
+
+        // Free objects of one size class, linked through their first word.  The objects
+        // are allocated as far as their FixedAlloc is concerned.
+        struct Magazine
+        {
+            void* head;
+            uint32_t count;
+        };
+
+        // The magazines of one thread.  The counters are written only by the owner.
+        struct ThreadCache
+        {
+            Magazine magazines[kNumSizeClasses];
+            uint64_t ops;           // Small-object Alloc and Free calls served through the magazines
+            uint64_t locks;         // Allocator lock acquisitions made to refill or flush magazines
+            ThreadCache* next;      // Next cache on m_threadCaches
+            bool inUse;             // true while owned by a thread
+        };
+#endif
+
     private:
         GCHeap *m_heap;                             // The heap from which we allocate, set in InitInstance
         FixedAllocSafe m_allocs[kNumSizeClasses];   // The array of size-segregated allocators, set in InitInstance
@@ -318,6 +396,14 @@ namespace MMgc
 
         FindBeginningRootsCache m_rootFindCache;
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        GCThreadLocal<ThreadCache*> m_threadCache;  // The calling thread's magazines, NULL if it has none
+        vmpi_spin_lock_t m_threadCacheLock;         // Protects m_threadCaches, ThreadCache::inUse and the retired counters
+        ThreadCache* m_threadCaches;                // All thread caches, owned or not
+        uint64_t m_retiredMagazineOps;              // Counters of released thread caches
+        uint64_t m_retiredMagazineLocks;
+#endif
+
         vmpi_spin_lock_t m_largeAllocInfoLock;  // Protects numLargeBlocks and totalAskSizeLargeAllocs
 
         size_t numLargeBlocks;              // Number of large-object blocks owned by this FixedMalloc
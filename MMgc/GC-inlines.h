@@ -470,9 +470,13 @@ namespace MMgc
 
     REALLY_INLINE bool GC::BarrierActive()
     {
-        // Note, this will not always have the same value as IncrementalMarking
-        // in the future.
+        // In generational mode the barrier maintains the remembered set between
+        // collections, see GC::NurseryCollect.
+#ifdef MMGC_GENERATIONAL
+        return marking || generational;
+#else
         return marking;
+#endif
     }
     
     REALLY_INLINE bool GC::Collecting()
@@ -606,6 +610,38 @@ namespace MMgc
         return false;
     }
 
+    // Trace the next item from 'stack', going through 'prefetched' if it is a gc object,
+    // or, when the stack is empty, the oldest item waiting in 'prefetched'.  Returns
+    // false when there was nothing to trace.
+
+    REALLY_INLINE bool GC::MarkNextItem(GCMarkStack& stack, GCMarkPrefetchQueue& prefetched)
+    {
+        const void* ptr;
+        if (!stack.IsEmpty()) {
+            if ((ptr = stack.Pop_GCObject()) == NULL) {
+                MarkTopItem_NonGCObject();
+                return true;
+            }
+            if ((ptr = prefetched.Rotate(ptr)) != NULL)
+                MarkItem_GCObject(ptr);
+            return true;
+        }
+        if ((ptr = prefetched.Take()) == NULL)
+            return false;
+        MarkItem_GCObject(ptr);
+        return true;
+    }
+
+    // Trace the items waiting in 'prefetched', leaving any work they generate on the
+    // mark stack.
+
+    REALLY_INLINE void GC::MarkPrefetchedItems(GCMarkPrefetchQueue& prefetched)
+    {
+        const void* ptr;
+        while ((ptr = prefetched.Take()) != NULL)
+            MarkItem_GCObject(ptr);
+    }
+
     REALLY_INLINE bool GC::IsQueued(const void* userptr)
     {
         const void* realptr = GetRealPointer(userptr);
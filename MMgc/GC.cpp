@@ -101,6 +101,21 @@ namespace MMgc
         greedy(config.mode == GCConfig::kGreedyGC),
         nogc(config.mode == GCConfig::kDisableGC),
         incremental(config.mode == GCConfig::kIncrementalGC),
+#ifdef MMGC_GENERATIONAL
+        generational(gcheap->Config().generational && config.mode != GCConfig::kGreedyGC && config.mode != GCConfig::kDisableGC),
+#else
+        generational(false),
+#endif
+#ifdef MMGC_CARD_MARKING
+        cardMarking(gcheap->Config().cardMarking && config.mode == GCConfig::kIncrementalGC),
+#else
+        cardMarking(false),
+#endif
+#ifdef MMGC_COMPACTION
+        compaction(gcheap->Config().compaction),
+#else
+        compaction(false),
+#endif
         drcEnabled(config.mode != GCConfig::kDisableGC && config.drc),
         findUnmarkedPointers(false),
 #ifdef DEBUG
@@ -124,6 +139,11 @@ namespace MMgc
         m_telemetry(NULL),
 #endif
         m_gcThread(0),
+#ifdef MMGC_INLINE_WEAKREFS
+        inlineWeakRefs(gcheap->Config().inlineWeakRefs),
+        weakRefSlots(NULL),
+        weakRefSlotsPopulation(0),
+#endif
         destroying(false),
         marking(false),
         collecting(false),
@@ -134,12 +154,36 @@ namespace MMgc
         rememberedStackTop(0),
         stackEnter(0),
         enterCount(0),
+#ifdef MMGC_STACK_MAPS
+        stackMaps(NULL),
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+        snapshot(NULL),
+        snapshotNamer(NULL),
+        snapshotWriter(NULL),
+        snapshotRequested(0),
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        allocationSampler(NULL),
+        allocationSamplerHost(NULL),
+        allocationSampleCountdown(kNoAllocationSample),
+#endif
 #ifdef VMCFG_SELECTABLE_EXACT_TRACING
         runtimeSelectableExactnessFlag(config.exactTracing ? kVirtualGCTrace : 0),
 #endif
 #ifdef MMGC_MARKSTACK_ALLOWANCE
         m_incrementalWork(config.markstackAllowance),
         m_barrierWork(config.markstackAllowance),
+#endif
+#ifdef MMGC_CARD_MARKING
+        m_cards(NULL),
+        m_cardBase(0),
+        m_cardLimit(0),
+#endif
+#ifdef MMGC_COMPACTION
+        compactionPhase(kNotCompacting),
+        compactOnSweep(false),
+        m_forwarding(NULL),
 #endif
         m_markStackOverflow(false),
         mark_item_recursion_control(20),    // About 3KB as measured with GCC 4.1 on MacOS X (144 bytes / frame), May 2009
@@ -164,6 +208,12 @@ namespace MMgc
 #ifdef MMGC_DELETION_PROFILER
         , deletos(0)
 #endif
+#ifdef MMGC_PARALLEL_MARKING
+        , parallelMarker(NULL)
+#endif
+#ifdef MMGC_BACKGROUND_SWEEPING
+        , backgroundSweeper(NULL)
+#endif
 #ifdef DEBUGGER
         , m_sampler(NULL)
 #endif
@@ -314,6 +364,27 @@ namespace MMgc
 
         m_incrementalWork.SetDeadItem(emptyWeakRef);    // The empty weak ref is as good an object as any for this
 
+#ifdef MMGC_PARALLEL_MARKING
+        // Work is moved between the marker threads' stacks, so parallel marking can't
+        // honor a limit on the size of the mark stack.  The pointer is already NULL
+        // (see the initializer list) since a greedy GC collects while allocating
+        // emptyWeakRef above.
+        if (heap->Config().markThreads > 1 && config.markstackAllowance == 0)
+            parallelMarker = mmfx_new(GCParallelMarker(this, heap->Config().markThreads));
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (heap->Config().backgroundSweeping)
+            backgroundSweeper = mmfx_new(GCBackgroundSweeper(this));
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if (heap->Config().allocationSampleInterval > 0) {
+            allocationSampler = new GCAllocationSampler(heap->Config().allocationSampleInterval);
+            allocationSampleCountdown = allocationSampler->NextInterval();
+        }
+#endif
+
 #ifdef MMGC_CONSERVATIVE_PROFILER
         if (demos == NULL && heap->profiler != NULL)
             demos = new AllocationSiteProfiler(this, "Conservative scanning volume incurred by allocation site");
@@ -365,10 +436,27 @@ namespace MMgc
 #endif
 #ifdef MMGC_HEAP_GRAPH
         printBlacklist();
+#endif
+#ifdef MMGC_CARD_MARKING
+        FreeCards();
+#endif
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // Stop the sweeper before the policy manager reports and the allocators go away.
+        if (backgroundSweeper != NULL) {
+            mmfx_delete(backgroundSweeper);
+            backgroundSweeper = NULL;
+        }
 #endif
         policy.shutdown();
         allocaShutdown();
 
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL) {
+            mmfx_delete(parallelMarker);
+            parallelMarker = NULL;
+        }
+#endif
+
         // Do this before calling GCHeap::RemoveGC as GCAutoEnter::Destroy
         // expect this GC to still be the active GC and GCHeap::RemoveGC clears
         // the active GC.
@@ -426,6 +514,11 @@ namespace MMgc
 
         pageMap.DestroyPageMapVia(heap);
 
+#ifdef MMGC_ALLOCATION_SAMPLER
+        delete allocationSampler;
+        allocationSampler = NULL;
+#endif
+
         GCAssert(!m_roots);
         GCAssert(!m_callbacks);
 
@@ -491,6 +584,74 @@ namespace MMgc
         policy.fullCollectionComplete();
     }
 
+#ifdef MMGC_GENERATIONAL
+    // A nursery collection traces only the objects allocated since the previous
+    // collection.  In generational mode Sweep does not clear the mark bits, so the
+    // survivors of every collection stay marked - they are the old generation, and
+    // surviving a collection is all it takes to be promoted.  The tracer never pushes
+    // marked objects, so old objects are not traced unless the write barrier has
+    // queued them because something was stored into them; those queued objects on
+    // m_barrierWork are the remembered set.  Old objects that have become garbage are
+    // retained until the next full collection, which clears all marks and the
+    // remembered set in StartIncrementalMark.
+    //
+    // Objects are never moved: allocation proceeds from the allocators' free lists as
+    // usual, and a promoted object stays where it is.  The conservative stack scan
+    // and the other untyped references into the heap rule out a copying nursery.
+    //
+    // The collection is not incremental.  Roots, the remembered set and the stack are
+    // marked and the heap is finalized and swept in one pause.
+
+    void GC::NurseryCollect()
+    {
+        GCAssert(generational);
+        GCAssert(!marking && !collecting && !Reaping());
+
+        TELEMETRY_METHOD(getTelemetry(), ".gc.NurseryCollect");
+
+        uint64_t start = VMPI_getPerformanceCounter();
+        uint64_t bytesMarkedBefore = policy.bytesMarked();
+
+        marking = true;
+
+        // Garbage from the previous collection that has not been swept yet is unmarked
+        // too and must not be mistaken for young objects.
+        SweepNeedsSweeping();
+        policy.signalNurseryCollectionStart(GetBytesInUse());
+
+        {
+            TELEMETRY_METHOD(getTelemetry(), ".gc.Mark");
+
+            FlushBarrierWork();
+            MarkNonstackRoots();
+            MarkQueueAndStack(true);
+
+            // The remembered set may have overflowed since the last collection, in
+            // which case m_markStackOverflow is already set.  For discussion of
+            // completion, see the comments above HandleMarkStackOverflow.
+
+            while (m_markStackOverflow) {
+                m_markStackOverflow = false;
+                HandleMarkStackOverflow();
+                FlushBarrierWork();
+                MarkQueueAndStack(true);
+            }
+            ClearMarkStack();
+            m_barrierWork.Clear();
+            zct.Prune();
+        }
+
+#ifdef _DEBUG
+        FindMissingWriteBarriers();
+#endif
+
+        sweepStart = VMPI_getPerformanceCounter();
+        Sweep();
+
+        policy.signalNurseryCollectionEnd(VMPI_getPerformanceCounter() - start, policy.bytesMarked() - bytesMarkedBefore);
+    }
+#endif
+
     void GC::Collect(double allocationBudgetFractionUsed)
     {
         if (allocationBudgetFractionUsed < 0.25) allocationBudgetFractionUsed = 0.25;
@@ -503,12 +664,62 @@ namespace MMgc
         GC::Collect(true, false);
     }
 
+    REALLY_INLINE GCMarkStack& GC::MarkStack()
+    {
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL && parallelMarker->Active())
+            return *parallelMarker->CurrentWorker()->stack;
+#endif
+        return m_incrementalWork;
+    }
+
+    REALLY_INLINE void GC::SignalExactMarkWork(size_t nbytes)
+    {
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL && parallelMarker->Active()) {
+            GCParallelMarker::Worker* w = parallelMarker->CurrentWorker();
+            w->objectsExactly++;
+            w->bytesExactly += uint32_t(nbytes);
+            return;
+        }
+#endif
+        policy.signalExactMarkWork(nbytes);
+    }
+
+    REALLY_INLINE void GC::SignalConservativeMarkWork(size_t nbytes, bool fromRoot)
+    {
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL && parallelMarker->Active()) {
+            GCParallelMarker::Worker* w = parallelMarker->CurrentWorker();
+            w->objectsConservatively++;
+            w->bytesConservatively += uint32_t(nbytes);
+            if (fromRoot)
+                w->bytesConservativeRoots += uint32_t(nbytes);
+            return;
+        }
+#endif
+        policy.signalConservativeMarkWork(nbytes, fromRoot);
+    }
+
+    REALLY_INLINE void GC::SignalPointerfreeMarkWork(size_t nbytes)
+    {
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL && parallelMarker->Active()) {
+            GCParallelMarker::Worker* w = parallelMarker->CurrentWorker();
+            w->objectsPointerfree++;
+            w->bytesPointerfree += uint32_t(nbytes);
+            return;
+        }
+#endif
+        policy.signalPointerfreeMarkWork(nbytes);
+    }
+
     REALLY_INLINE void GC::Push_StackMemory(const void* p, uint32_t size, const void* baseptr)
     {
         GCAssert(p != NULL);
         GCAssert(!IsPointerToGCPage(GetRealPointer(p)) || !IsPointerToGCObject(GetRealPointer(p)));
 
-        if (!m_incrementalWork.Push_StackMemory(p, size, baseptr))
+        if (!MarkStack().Push_StackMemory(p, size, baseptr))
             SignalMarkStackOverflow_NonGCObject();
     }
     
@@ -517,7 +728,7 @@ namespace MMgc
         GCAssert(p != NULL);
         GCAssert(!IsPointerToGCPage(GetRealPointer(p)) || !IsPointerToGCObject(GetRealPointer(p)));
 
-        if (!m_incrementalWork.Push_RootProtector(p)) {
+        if (!MarkStack().Push_RootProtector(p)) {
             SignalMarkStackOverflow_NonGCObject();
             return false;
         }
@@ -529,7 +740,7 @@ namespace MMgc
         GCAssert(p != NULL);
         GCAssert(IsPointerToGCPage(GetRealPointer(p)) && IsPointerToGCObject(GetRealPointer(p)));
 
-        if (!m_incrementalWork.Push_LargeObjectProtector(p))
+        if (!MarkStack().Push_LargeObjectProtector(p))
             SignalMarkStackOverflow_NonGCObject();
     }
     
@@ -539,7 +750,7 @@ namespace MMgc
         GCAssert(cursor != 0);
         GCAssert(IsPointerToGCPage(GetRealPointer(p)) && IsPointerToGCObject(GetRealPointer(p)));
 
-        if (!m_incrementalWork.Push_LargeExactObjectTail(p, cursor))
+        if (!MarkStack().Push_LargeExactObjectTail(p, cursor))
             SignalMarkStackOverflow_NonGCObject();
     }
 
@@ -549,7 +760,7 @@ namespace MMgc
         GCAssert(IsPointerToGCPage(p));
         GCAssert(IsPointerToGCPage((char*)p + size - 1));
 
-        if (!m_incrementalWork.Push_LargeObjectChunk(p, size, baseptr))
+        if (!MarkStack().Push_LargeObjectChunk(p, size, baseptr))
             SignalMarkStackOverflow_NonGCObject();
     }
 
@@ -559,7 +770,7 @@ namespace MMgc
         GCAssert(!IsPointerToGCPage(p));
         GCAssert(!IsPointerToGCPage((char*)p + size - 1));
         
-        if (!m_incrementalWork.Push_LargeRootChunk(p, size, baseptr))
+        if (!MarkStack().Push_LargeRootChunk(p, size, baseptr))
             SignalMarkStackOverflow_NonGCObject();
     }
     
@@ -568,7 +779,7 @@ namespace MMgc
 #ifdef DEBUG
         WorkItemInvariants_GCObject(p);
 #endif
-        if (!m_incrementalWork.Push_GCObject(p))
+        if (!MarkStack().Push_GCObject(p))
             SignalMarkStackOverflow_GCObject(p);
     }
 
@@ -587,6 +798,11 @@ namespace MMgc
         GCAssert(IsPointerToGCObject(GetRealPointer(p)));
         GCAssert(ContainsPointers(p));
         GCAssert(!IsRCObject(p) || ((RCObject*)p)->composite != 0);
+#ifdef MMGC_PARALLEL_MARKING
+        // Another marker thread may have won the race to mark the object, see GCThreads.h.
+        if (parallelMarker != NULL && parallelMarker->Active())
+            return;
+#endif
         GCAssert((GetGCBits(GetRealPointer(p)) & (kQueued|kMark)) == kQueued);
     }
 
@@ -596,6 +812,9 @@ namespace MMgc
     {
         ClearMarkStack();
         m_barrierWork.Clear();
+#ifdef MMGC_CARD_MARKING
+        FreeCards();
+#endif
         ClearMarks();
 #ifdef MMGC_HEAP_GRAPH
         markerGraph.clear();
@@ -606,7 +825,7 @@ namespace MMgc
 #ifdef DEBUG
     void GC::DRCValidationTrace(bool scanStack)
     {
-        if(marking) {
+        if(marking || generational) {
             AbortInProgressMarking();
         }
         performingDRCValidationTrace = true;
@@ -673,6 +892,23 @@ namespace MMgc
             return;
 
         TELEMETRY_METHOD(getTelemetry(), ".gc.CollectionWork");
+#ifdef MMGC_HEAP_SNAPSHOT
+        // A snapshot requested asynchronously (eg from a signal handler) is written at
+        // the next collection boundary; it performs a full collection itself.
+        if (snapshotRequested && snapshotWriter != NULL && !collecting && !Reaping()) {
+            snapshotRequested = 0;
+            WriteHeapSnapshot(snapshotWriter);
+            return;
+        }
+#endif
+#ifdef MMGC_GENERATIONAL
+        // Between full collections the allocation budget is handed out one nursery
+        // at a time; when it runs out and more remains, collect the nursery.
+        if (generational && !marking && !collecting && !Reaping() && policy.queryNurseryCollection()) {
+            NurseryCollect();
+            return;
+        }
+#endif
         if (incremental) {
             // If we're reaping don't do any work, this simplifies policy event timing and improves
             // incrementality.
@@ -1039,6 +1275,10 @@ namespace MMgc
         // ClearMarks may sweep, although I'm far from sure that that's a good idea,
         // as SignalImminentAbort calls ClearMarks.
 
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (backgroundSweeper != NULL)
+            backgroundSweeper->Finish();
+#endif
         EstablishSweepInvariants();
 
         for (int i=0; i < kNumSizeClasses; i++) {
@@ -1057,6 +1297,10 @@ namespace MMgc
     void GC::Finalize()
     {
         MarkOrClearWeakRefs();
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if (allocationSampler != NULL)
+            allocationSampler->ClearUnmarked();
+#endif
 
         for(int i=0; i < kNumSizeClasses; i++) {
             containsPointersRCAllocs[i]->Finalize();
@@ -1085,6 +1329,11 @@ namespace MMgc
     void GC::SweepNeedsSweeping()
     {
         TELEMETRY_METHOD(getTelemetry(), ".gc.Sweep");
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // The sweeper must be idle before the mutator sweeps or the collector marks.
+        if (backgroundSweeper != NULL)
+            backgroundSweeper->Finish();
+#endif
         EstablishSweepInvariants();
 
         // clean up any pages that need sweeping
@@ -1131,14 +1380,10 @@ namespace MMgc
     {
         const void *realptr = GetRealPointer(userptr);
         GCAssert(GetGC(realptr)->IsPointerToGCObject(realptr));
-        if (flag) {
+        if (!GCLargeAlloc::IsLargeBlock(realptr))
+            GCAlloc::SetHasWeakRef(realptr, flag);
+        else if (flag)
             GetGCBits(realptr) |= kHasWeakRef;
-            // Small-object allocators maintain an extra flag
-            // about weak objects in a block, need to set that
-            // flag here.
-            if (!GCLargeAlloc::IsLargeBlock(realptr))
-                GCAlloc::SetBlockHasWeakRef(userptr);
-        }
         else
             GetGCBits(realptr) &= ~kHasWeakRef;
     }
@@ -1158,6 +1403,41 @@ namespace MMgc
 #ifdef MMGC_WEAKREF_PROFILER
         uint32_t count = weakRefs.count();
         uint32_t deleted = 0;
+#endif
+#ifdef MMGC_INLINE_WEAKREFS
+        if (inlineWeakRefs) {
+#ifdef MMGC_WEAKREF_PROFILER
+            count = weakRefSlotsPopulation;
+#endif
+            // Arrays emptied by ClearWeakRef are kept until the walk is done, then
+            // freed here; the walk must not free the array it is looking at.
+            GCWeakRefSlots* slots = weakRefSlots;
+            while (slots != NULL) {
+                GCWeakRefSlots* next = slots->next;
+                for (uint32_t i=0, limit=slots->capacity; i < limit && slots->population > 0; i++) {
+                    GCWeakRef* w = slots->refs[i];
+                    if (w == NULL)
+                        continue;
+                    GCObject* o = w->peek();
+                    if (o != NULL && !GC::GetMark(o)) {
+#ifdef MMGC_WEAKREF_PROFILER
+                        deleted++;
+#endif
+                        ClearWeakRef(o, false);
+                    }
+                    else if (!GC::GetMark(w))
+                        GC::SetMark(w);
+                }
+                if (slots->population == 0)
+                    FreeWeakRefSlots(slots);
+                slots = next;
+            }
+#ifdef MMGC_WEAKREF_PROFILER
+            if (weaklings)
+                weaklings->reportGCStats(count, deleted);
+#endif
+            return;
+        }
 #endif
         {
             GCHashtable::Iterator it(&weakRefs);
@@ -1277,6 +1557,14 @@ namespace MMgc
             pruneBlacklist();
 #endif
 
+#ifdef MMGC_COMPACTION
+        // Only after a full mark.  Finalize frees the blocks that were emptied.
+        if (compactOnSweep) {
+            compactOnSweep = false;
+            Compact();
+        }
+#endif
+
         Finalize();
 
         SAMPLE_CHECK();
@@ -1323,6 +1611,10 @@ namespace MMgc
 
         if (heap->Config().eagerSweeping)
             SweepNeedsSweeping();
+#ifdef MMGC_BACKGROUND_SWEEPING
+        else if (backgroundSweeper != NULL)
+            backgroundSweeper->Start();
+#endif
 
         // we potentially freed a lot of memory, tell heap to regulate
         heap->Decommit();
@@ -1431,13 +1723,16 @@ namespace MMgc
     void GC::Mark()
     {
         markerActive++;
-        while(m_incrementalWork.Count()) {
-            const void* ptr;
-            if ((ptr = m_incrementalWork.Pop_GCObject()) != NULL)
-                MarkItem_GCObject(ptr);
-            else
-                MarkTopItem_NonGCObject();
+#ifdef MMGC_PARALLEL_MARKING
+        if (parallelMarker != NULL) {
+            parallelMarker->Mark();
+            markerActive--;
+            return;
         }
+#endif
+        GCMarkPrefetchQueue prefetched;
+        while (MarkNextItem(m_incrementalWork, prefetched))
+            ;
         markerActive--;
     }
 
@@ -1445,13 +1740,10 @@ namespace MMgc
     {
         // Caller's responsibility to make the marker active!
         GCAssert(markerActive > 0);
-        for(unsigned int i=0; i<count && !m_incrementalWork.IsEmpty() ; i++) {
-            const void* ptr;
-            if ((ptr = m_incrementalWork.Pop_GCObject()) != NULL)
-                MarkItem_GCObject(ptr);
-            else
-                MarkTopItem_NonGCObject();
-        }
+        GCMarkPrefetchQueue prefetched;
+        for(unsigned int i=0; i<count && MarkNextItem(m_incrementalWork, prefetched) ; i++)
+            ;
+        MarkPrefetchedItems(prefetched);
     }
 
     // This must not trigger OOM handling.  It is /possible/ to restructure the
@@ -1532,10 +1824,88 @@ namespace MMgc
         // Push the stack onto the mark stack and then mark synchronously until
         // everything reachable from the stack has been marked.
 
-        gc->Push_StackMemory(stackPointer, uint32_t(stackBase - (char*)stackPointer), stackPointer);
+        gc->ScanProgramStack(stackPointer, stackBase, GC::MarkStackRange, gc);
         gc->Mark();
     }
 
+    /*static*/
+    void GC::MarkStackRange(void* arg, const void* p, size_t nbytes)
+    {
+        ((GC*)arg)->Push_StackMemory(p, uint32_t(nbytes), p);
+    }
+
+#ifdef MMGC_STACK_MAPS
+    // Turns the frames claimed by the host into the list of ranges to scan: the
+    // gaps between claimed frames in full, and only the reported words inside them.
+    class GCStackRangeScanner : public GCStackScanner
+    {
+    public:
+        GCStackRangeScanner(const void* sp, const void* base, GC::StackRangeProc scan, void* arg)
+            : low((const char*)sp)
+            , high((const char*)base)
+            , cursor((const char*)sp)
+            , frameLow(NULL)
+            , frameHigh(NULL)
+            , scan(scan)
+            , arg(arg)
+        {
+        }
+
+        virtual const void* Low() const { return low; }
+        virtual const void* High() const { return high; }
+
+        virtual void Frame(const void* lo, const void* hi)
+        {
+            if ((const char*)lo < cursor || (const char*)hi > high || lo >= hi) {
+                frameLow = frameHigh = NULL;
+                return;
+            }
+            if ((const char*)lo > cursor)
+                scan(arg, cursor, (const char*)lo - cursor);
+            frameLow = (const char*)lo;
+            frameHigh = cursor = (const char*)hi;
+        }
+
+        virtual void Words(const void* p, size_t nbytes)
+        {
+            const char* start = (const char*)p;
+            const char* limit = start + nbytes;
+            GCAssert(((uintptr_t)start & (sizeof(void*)-1)) == 0);
+            if (start < frameLow || limit > frameHigh || start >= limit)
+                return;
+            scan(arg, start, nbytes);
+        }
+
+        void Finish()
+        {
+            if (high > cursor)
+                scan(arg, cursor, high - cursor);
+        }
+
+    private:
+        const char* const low;
+        const char* const high;
+        const char* cursor;         // everything below it has been handled
+        const char* frameLow;       // the frame claimed last, or NULL
+        const char* frameHigh;
+        GC::StackRangeProc const scan;
+        void* const arg;
+    };
+#endif
+
+    void GC::ScanProgramStack(const void* sp, const void* base, StackRangeProc scan, void* arg)
+    {
+#ifdef MMGC_STACK_MAPS
+        if (stackMaps != NULL) {
+            GCStackRangeScanner scanner(sp, base, scan, arg);
+            stackMaps->ScanFrames(scanner);
+            scanner.Finish();
+            return;
+        }
+#endif
+        scan(arg, sp, (const char*)base - (const char*)sp);
+    }
+
     struct CreateRootFromCurrentStackArgs
     {
         GC* gc;
@@ -1881,6 +2251,7 @@ namespace MMgc
         }
         GCLog("[mem] \tmark increments %d\n", markIncrements());
         GCLog("[mem] \tsweeps %d \n", sweeps);
+        policy.dumpMarkWorkInfo();
 
         size_t total_overhead = 0;
         size_t total_internal_waste = 0;
@@ -1929,6 +2300,13 @@ namespace MMgc
                   double(ticksToMicros(policy.timeMaxFinalRootAndStackScan)) / 1000.0,
                   double(ticksToMicros(policy.timeMaxFinalizeAndSweep)) / 1000.0,
                   double(ticksToMicros(policy.timeMaxReapZCT)) / 1000.0);
+            GCLog("[mem] \tzct reaping, entire run: reaps=%u slices=%u longest reap=%.2fms (end-to-end %.2fms) stack pinning=%.2fms (max %.2fms)\n",
+                  unsigned(policy.countReapZCTEpochs),
+                  unsigned(policy.countReapZCT),
+                  double(ticksToMicros(policy.timeMaxReapZCTEpoch)) / 1000.0,
+                  double(ticksToMicros(policy.timeMaxReapZCTEpochEndToEnd)) / 1000.0,
+                  double(ticksToMicros(policy.timeReapZCTStackPinning)) / 1000.0,
+                  double(ticksToMicros(policy.timeMaxReapZCTStackPinning)) / 1000.0);
             GCLog("[mem] \tpause clustering in GC, most recent: gctime=%.2fms end-to-end=%.2fms;  mutator efficacy: %.2f%%\n",
                   double(ticksToMicros(policy.timeInLastCollection)) / 1000.0,
                   double(ticksToMicros(policy.timeEndToEndLastCollection)) / 1000.0,
@@ -2045,6 +2423,13 @@ namespace MMgc
         GCAssert(!collecting);
         GCAssert(!Reaping());       // bugzilla 564800
 
+#ifdef MMGC_GENERATIONAL
+        // A full collection retraces the entire heap: the survivors of earlier
+        // collections lose their marks and the remembered set is discarded.
+        if (generational)
+            AbortInProgressMarking();
+#endif
+
         lastStartMarkIncrementCount = markIncrements();
 
         // set the stack cleaning trigger
@@ -2052,6 +2437,11 @@ namespace MMgc
 
         marking = true;
 
+#ifdef MMGC_CARD_MARKING
+        if (cardMarking)
+            AllocateCards();
+#endif
+
         GCAssert(m_incrementalWork.Count() == 0);
         GCAssert(m_barrierWork.Count() == 0);
 
@@ -2465,7 +2855,8 @@ namespace MMgc
     
     void GC::MarkTopItem_NonGCObject()
     {
-        switch (m_incrementalWork.PeekTypetag()) {
+        GCMarkStack& stack = MarkStack();
+        switch (stack.PeekTypetag()) {
             default:
                 GCAssert(!"Unhandled mark item tag");
                 break;
@@ -2473,7 +2864,7 @@ namespace MMgc
             case GCMarkStack::kLargeExactObjectTail: {
                 const void* ptr;
                 size_t cursor;
-                m_incrementalWork.Pop_LargeExactObjectTail(ptr, cursor);
+                stack.Pop_LargeExactObjectTail(ptr, cursor);
                 MarkItem_ExactObjectTail(ptr, cursor);
                 break;
             }
@@ -2482,7 +2873,7 @@ namespace MMgc
                 const void* ptr;
                 const void* baseptr;
                 uint32_t size;
-                m_incrementalWork.Pop_StackMemory(ptr, size, baseptr);
+                stack.Pop_StackMemory(ptr, size, baseptr);
                 MarkItem_ConservativeOrNonGCObject(ptr, size, GCMarkStack::kStackMemory, baseptr, true);
                 break;
             }
@@ -2491,7 +2882,7 @@ namespace MMgc
                 const void* ptr;
                 const void* baseptr;
                 uint32_t size;
-                m_incrementalWork.Pop_LargeObjectChunk(ptr, size, baseptr);
+                stack.Pop_LargeObjectChunk(ptr, size, baseptr);
                 MarkItem_ConservativeOrNonGCObject(ptr, size, GCMarkStack::kLargeObjectChunk, baseptr, MMGC_INTERIOR_PTRS_FLAG);
                 break;
             }
@@ -2500,14 +2891,14 @@ namespace MMgc
                 const void* ptr;
                 const void* baseptr;
                 uint32_t size;
-                m_incrementalWork.Pop_LargeRootChunk(ptr, size, baseptr);
+                stack.Pop_LargeRootChunk(ptr, size, baseptr);
                 MarkItem_ConservativeOrNonGCObject(ptr, size, GCMarkStack::kLargeRootChunk, baseptr, MMGC_INTERIOR_PTRS_FLAG);
                 break;
             }
 
             case GCMarkStack::kRootProtector: {
                 const void* ptr;
-                m_incrementalWork.Pop_RootProtector(ptr);
+                stack.Pop_RootProtector(ptr);
                 GCRoot *sentinelRoot = (GCRoot*)ptr;
                 // The GCRoot is no longer on the stack, clear the pointers into the stack.
                 sentinelRoot->ClearMarkStackSentinelPointer();
@@ -2516,7 +2907,7 @@ namespace MMgc
 
             case GCMarkStack::kLargeObjectProtector: {
                 const void* ptr;
-                m_incrementalWork.Pop_LargeObjectProtector(ptr);
+                stack.Pop_LargeObjectProtector(ptr);
                 // Unprotect an item that was protected earlier, see comment block above.
                 GCLargeAlloc::UnprotectAgainstFree(ptr);
                 break;
@@ -2571,7 +2962,7 @@ namespace MMgc
             // object here, even if that object is being split.  Can that go wrong somehow,
             // eg, will it upset the computation of the mark rate?
 
-            policy.signalExactMarkWork(size);
+            SignalExactMarkWork(size);
             return;
         }
 #endif
@@ -2586,12 +2977,13 @@ namespace MMgc
         
         // Save the new state.
         Push_LargeExactObjectTail(userptr, cursor+1);
-        uintptr_t e1 = m_incrementalWork.Top();
+        GCMarkStack& stack = MarkStack();
+        uintptr_t e1 = stack.Top();
         
         if (!exactlyTraced->gcTrace(this, cursor))
         {
             // No more mark work, so clean up the mark state.
-            m_incrementalWork.ClearItemAt(e1);
+            stack.ClearItemAt(e1);
         }
     }
     
@@ -2616,7 +3008,7 @@ namespace MMgc
         if (type == GCMarkStack::kGCObject)
             SetMark(userptr);
 
-        policy.signalConservativeMarkWork(size);
+        SignalConservativeMarkWork(size, type == GCMarkStack::kStackMemory || type == GCMarkStack::kLargeRootChunk);
 #ifdef MMGC_CONSERVATIVE_PROFILER
         if (demos != NULL)
         {
@@ -2725,8 +3117,23 @@ namespace MMgc
 #endif
 
             gcbits_t& bits2 = block->bits[GCAlloc::GetBitsIndex(block, item)];
+#ifdef MMGC_COMPACTION
+            if (compactionPhase != kNotCompacting)
+            {
+                // Marking is complete, see GC::Compact; just keep the object in place.
+                if (compactionPhase == kPinning && (bits2 & kMovable))
+                    bits2 |= kPinned;
+                goto end;
+            }
+#endif
             if ((bits2 & (kMark|kQueued)) == 0)
             {
+#ifdef MMGC_HEAP_SNAPSHOT
+                if (snapshot != NULL) {
+                    SnapshotEdge(GetUserPointer(item));
+                    goto end;
+                }
+#endif
                 uint32_t itemSize = block->size - (uint32_t)DebugSize();
                 if(block->containsPointers)
                 {
@@ -2753,7 +3160,7 @@ namespace MMgc
                 else
                 {
                     bits2 |= kMark;
-                    policy.signalPointerfreeMarkWork(itemSize);
+                    SignalPointerfreeMarkWork(itemSize);
                 }
 #ifdef MMGC_HEAP_GRAPH
                 markerGraph.edge(loc, GetUserPointer(item));
@@ -2794,9 +3201,21 @@ namespace MMgc
             actually_is_pointer++;
 #endif
 
+#ifdef MMGC_COMPACTION
+            // Large objects are never moved.
+            if (compactionPhase != kNotCompacting)
+                goto end;
+#endif
+
             GCLargeAlloc::LargeBlock *b = GCLargeAlloc::GetLargeBlock(item);
             if((b->flags[0] & (kQueued|kMark)) == 0)
             {
+#ifdef MMGC_HEAP_SNAPSHOT
+                if (snapshot != NULL) {
+                    SnapshotEdge(GetUserPointer(item));
+                    goto end;
+                }
+#endif
                 uint32_t itemSize = b->size - (uint32_t)DebugSize();
                 if(b->containsPointers)
                 {
@@ -2807,7 +3226,7 @@ namespace MMgc
                 {
                     // doesn't need marking go right to black
                     b->flags[0] |= kMark;
-                    policy.signalPointerfreeMarkWork(itemSize);
+                    SignalPointerfreeMarkWork(itemSize);
                 }
 #ifdef MMGC_HEAP_GRAPH
                 markerGraph.edge(loc, GetUserPointer(item));
@@ -2842,13 +3261,27 @@ namespace MMgc
 
         if ((bits2 & (kMark|kQueued)) == 0)
         {
+#ifdef MMGC_COMPACTION
+            // Once marking is complete only the old copies of moved objects are unmarked.
+            if (compactionPhase != kNotCompacting) {
+                ForwardLocation(obj, loc);
+                return;
+            }
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+            // While a snapshot is written all live objects are unmarked, see WriteHeapSnapshot.
+            if (snapshot != NULL) {
+                SnapshotEdge(obj);
+                return;
+            }
+#endif
             if (ContainsPointers(obj)) {
                 bits2 |= kQueued;
                 Push_GCObject(obj);
             }
             else {
                 bits2 |= kMark;
-                policy.signalPointerfreeMarkWork(Size(obj));
+                SignalPointerfreeMarkWork(Size(obj));
             }
 #ifdef MMGC_HEAP_GRAPH
             markerGraph.edge(loc, obj);
@@ -2886,9 +3319,9 @@ namespace MMgc
     {
         GCAssert(!markerActive);
 
-        uint32_t time = incrementalValidation ? 1 : policy.incrementalMarkMilliseconds();
+        uint32_t time = incrementalValidation ? 1000 : policy.incrementalMarkMicroseconds();
 #ifdef _DEBUG
-        time = 1;
+        time = 1000;
 #endif
 
         TELEMETRY_METHOD(getTelemetry(), ".gc.Mark");
@@ -2927,7 +3360,7 @@ namespace MMgc
         uint64_t numObjects=policy.objectsMarked();
         uint64_t objSize=policy.bytesMarked();
 
-        uint64_t ticks = start + time * VMPI_getPerformanceFrequency() / 1000;
+        uint64_t ticks = start + time * VMPI_getPerformanceFrequency() / 1000000;
         do {
             // EXACTGC OPTIMIZEME: Count can overestimate the amount of work on the stack
             // because exactly traced large split items occupy two slots on the
@@ -3002,6 +3435,12 @@ namespace MMgc
             GCAssert(!m_markStackOverflow);
             
             FlushBarrierWork();
+#ifdef MMGC_CARD_MARKING
+            // Retrace what was stored into during marking.  The remaining stores
+            // of the cycle, if any, use the queuing barrier.
+            ScanDirtyCards();
+            FreeCards();
+#endif
             MarkNonstackRoots();
             MarkQueueAndStack(scanStack);
             
@@ -3046,6 +3485,9 @@ namespace MMgc
 
         GCAssert(m_incrementalWork.Count() == 0);
         GCAssert(m_barrierWork.Count() == 0);
+#ifdef MMGC_COMPACTION
+        compactOnSweep = compaction;
+#endif
         Sweep();
         GCAssert(m_incrementalWork.Count() == 0);
         GCAssert(m_barrierWork.Count() == 0);
@@ -3113,6 +3555,674 @@ namespace MMgc
         GCAssert(bwork_count_old == 0 || m_incrementalWork.Count() > 0);
     }
 
+#ifdef MMGC_CARD_MARKING
+    // With cardMarking the barrier does not look at the object that is stored into:
+    // it dirties the card covering the store and the marked objects on dirty cards are
+    // retraced by FinishIncrementalMark.  Marking then never sees the stores, so hot
+    // objects are retraced at most once per cycle, but the final pause grows with the
+    // number of dirty cards.
+    //
+    // The table covers the page map's range at the start of marking and is discarded
+    // at the end of marking, so cards never need to be mapped to blocks that have come
+    // and gone between cycles.
+
+    void GC::AllocateCards()
+    {
+        GCAssert(m_cards == NULL);
+        GCAssert(m_cardLimit == 0);
+
+        uintptr_t base = pageMap.MemStart();
+        if (pageMap.MemEnd() <= base)
+            return;
+        uintptr_t limit = pageMap.MemEnd() - base;
+
+        // Heap regions can be widely separated on 64-bit systems; don't let the table
+        // for a sparse range dwarf the heap, just use the queuing barrier for the cycle.
+        if (limit / 8 > heap->GetTotalHeapSize() * GCHeap::kBlockSize)
+            return;
+
+        m_cards = mmfx_new_array_opt(uint8_t, (limit + kCardSize - 1) >> kCardShift, FixedMallocOpts(kCanFail|kZero));
+        if (m_cards == NULL)
+            return;
+        m_cardBase = base;
+        m_cardLimit = limit;
+    }
+
+    void GC::FreeCards()
+    {
+        m_cardLimit = 0;
+        m_cardBase = 0;
+        if (m_cards != NULL) {
+            mmfx_delete_array(m_cards);
+            m_cards = NULL;
+        }
+    }
+
+    // Clean every dirty card and requeue the marked objects on it.  The caller must
+    // drain the mark stack afterward.
+
+    void GC::ScanDirtyCards()
+    {
+        if (m_cards == NULL)
+            return;
+
+#ifdef MMGC_POLICY_PROFILING
+        uint64_t start = VMPI_getPerformanceCounter();
+#endif
+        uint32_t cards = 0;
+        uint32_t objects = 0;
+        size_t ncards = (m_cardLimit + kCardSize - 1) >> kCardShift;
+        size_t i = 0;
+        while (i < ncards) {
+            // Most of the table is clean, skip it a word at a time.
+            if ((i & (sizeof(uintptr_t)-1)) == 0 && i + sizeof(uintptr_t) <= ncards && *(uintptr_t*)(m_cards + i) == 0) {
+                i += sizeof(uintptr_t);
+                continue;
+            }
+            if (m_cards[i] != 0) {
+                m_cards[i] = 0;
+                cards++;
+                uintptr_t lo = m_cardBase + (uintptr_t(i) << kCardShift);
+                objects += RequeueMarkedObjectsOnCard(lo, lo + kCardSize);
+            }
+            i++;
+        }
+#ifdef MMGC_POLICY_PROFILING
+        policy.signalDirtyCardScan(cards, objects, VMPI_getPerformanceCounter() - start);
+#else
+        (void)cards;
+        (void)objects;
+#endif
+    }
+
+    // Requeue the marked objects in [lo,hi), which lies within one block.  Objects on
+    // the mark stack need nothing, and unmarked objects will be traced if reachable.
+    // A card may also hold RCObjects whose explicit deletion was aborted (see AbortFree):
+    // they have been zeroed, so there's nothing to retrace.
+
+    uint32_t GC::RequeueMarkedObjectsOnCard(uintptr_t lo, uintptr_t hi)
+    {
+        uint32_t n = 0;
+        switch (GetPageMapValue(lo)) {
+            case PageMap::kGCAllocPage: {
+                GCAlloc::GCBlock* b = GCAlloc::GetBlock((const void*)lo);
+                if (!b->containsPointers)
+                    break;
+                uintptr_t items = uintptr_t(b->items);
+                uintptr_t limit = items + uintptr_t(b->size) * b->GetCount();
+                uintptr_t item = lo <= items ? items : items + (lo - items) / b->size * b->size;
+                for ( ; item < hi && item < limit ; item += b->size ) {
+                    gcbits_t& bits = GetGCBits((const void*)item);
+                    if ((bits & GCAlloc::kFreelist) == kMark &&
+                        (!b->rcobject || ((RCObject*)GetUserPointer((const void*)item))->composite != 0)) {
+                        bits ^= (kMark|kQueued);
+                        Push_GCObject(GetUserPointer((const void*)item));
+                        n++;
+                    }
+                }
+                break;
+            }
+            case PageMap::kGCLargeAllocPageRest:
+            case PageMap::kGCLargeAllocPageFirst: {
+                uintptr_t page = lo & GCHeap::kBlockMask;
+                while (GetPageMapValue(page) == PageMap::kGCLargeAllocPageRest)
+                    page -= GCHeap::kBlockSize;
+                GCLargeAlloc::LargeBlock* b = GCLargeAlloc::GetLargeBlock((const void*)page);
+                if (!b->containsPointers)
+                    break;
+                const void* item = b->GetObject();
+                if ((!b->rcobject || ((RCObject*)GetUserPointer(item))->composite != 0) &&
+                    IsMarkedThenMakeQueued(GetUserPointer(item))) {
+                    Push_GCObject(GetUserPointer(item));
+                    n++;
+                }
+                break;
+            }
+            default:
+                // The block has been released since the card was dirtied.
+                break;
+        }
+        return n;
+    }
+#endif
+
+    void GC::SetMovable(const void* userptr)
+    {
+#ifdef MMGC_COMPACTION
+        GCAssert(userptr != NULL);
+        if (!compaction)
+            return;
+
+        const void* realptr = GetRealPointer(userptr);
+        GCAssert(IsPointerToGCObject(realptr));
+        if (GetPageMapValue(uintptr_t(realptr)) != PageMap::kGCAllocPage)
+            return;
+
+        gcbits_t& bits = GetGCBits(realptr);
+        GCAssert(ContainsPointers(userptr) && !IsRCObject(userptr) && !(bits & kFinalizable));
+        if (bits & kVirtualGCTrace)
+            bits |= kMovable;
+#else
+        (void)userptr;
+#endif
+    }
+
+#ifdef MMGC_COMPACTION
+    // Compaction moves the movable objects (see GC::SetMovable) out of sparsely occupied
+    // blocks of the allocators for non-finalized objects, so that Finalize can return those
+    // blocks to GCHeap.  It runs in Sweep after a full mark and before anything has been
+    // finalized or swept, in three passes over the roots, the stack and the marked objects:
+    //
+    //  - Pinning: every word scanned conservatively sets kPinned on the movable object it
+    //    may point into.  Interior pointers count, whatever MMGC_INTERIOR_PTRS says.
+    //  - Evacuation: each allocator picks the blocks whose live objects are all movable and
+    //    unpinned, copies those objects into other blocks and unmarks the originals; the
+    //    old and new addresses go into m_forwarding.
+    //  - Fixing up: exact tracing is rerun, and TracePointer redirects every location that
+    //    points to an unmarked object - after marking, only an evacuated one.
+    //
+    // The old copies stay intact until their blocks are swept, when the free hooks see
+    // them; the copies go through the alloc hook.  The pass is skipped while the memory
+    // profiler is installed, as it attributes objects to call sites by address.
+
+    void GC::Compact()
+    {
+        if (destroying)
+            return;
+#ifdef MMGC_MEMORY_PROFILER
+        if (heap->GetProfiler() != NULL)
+            return;
+#endif
+
+        uint32_t candidates = 0;
+        for (int i=0; i < kNumSizeClasses; i++)
+            candidates += containsPointersNonfinalizedAllocs[i]->CountEvacuationCandidates();
+        if (candidates < kCompactionMinBlocks)
+            return;
+
+        uint64_t start = VMPI_getPerformanceCounter();
+
+        compactionPhase = kPinning;
+        TraceForCompaction();
+        compactionPhase = kNotCompacting;
+
+        GCHashtable forwarding;
+        uint32_t objects = 0;
+        uint32_t blocks = 0;
+        for (int i=0; i < kNumSizeClasses; i++)
+            objects += containsPointersNonfinalizedAllocs[i]->Evacuate(forwarding, blocks);
+
+        if (objects > 0) {
+            m_forwarding = &forwarding;
+            compactionPhase = kFixingUp;
+            TraceForCompaction();
+            compactionPhase = kNotCompacting;
+            m_forwarding = NULL;
+        }
+
+#ifdef MMGC_POLICY_PROFILING
+        policy.signalCompaction(blocks, objects, VMPI_getPerformanceCounter() - start);
+#else
+        (void)start;
+#endif
+    }
+
+    void GC::TraceForCompaction()
+    {
+        GCAssert(compactionPhase != kNotCompacting);
+
+        TraceLocation(&emptyWeakRef);
+        TraceLocation(&lockedObjects);
+
+        {
+            MMGC_LOCK(m_rootListLock);
+            for (GCRoot* r = m_roots; r != NULL; r = r->next) {
+                if (r->IsExactlyTraced()) {
+                    bool result = r->gcTrace(this, 0);
+                    (void)result;
+                    GCAssertMsg(result == false, "A GCRoot tracer must never return true.");
+                }
+                else if (compactionPhase == kPinning) {
+                    const void* object;
+                    uint32_t size;
+                    bool isStackMemory;
+                    r->GetConservativeWorkItem(object, size, isStackMemory);
+                    if (object != NULL)
+                        TraceConservativeRangeForCompaction(object, size);
+                }
+            }
+        }
+
+        if (compactionPhase == kPinning)
+            VMPI_callWithRegistersSaved(GC::DoPinFromStack, this);
+
+        void* ptr;
+        for (int i=0; i < kNumSizeClasses; i++) {
+            GCAllocIterator iter1(containsPointersRCAllocs[i]);
+            while (iter1.GetNextMarkedObject(ptr))
+                TraceObjectForCompaction(ptr);
+            GCAllocIterator iter2(containsPointersNonfinalizedAllocs[i]);
+            while (iter2.GetNextMarkedObject(ptr))
+                TraceObjectForCompaction(ptr);
+            GCAllocIterator iter3(containsPointersFinalizedAllocs[i]);
+            while (iter3.GetNextMarkedObject(ptr))
+                TraceObjectForCompaction(ptr);
+        }
+
+        GCLargeAllocIterator iter(largeAlloc);
+        while (iter.GetNextMarkedObject(ptr))
+            TraceObjectForCompaction(ptr);
+    }
+
+    void GC::TraceObjectForCompaction(const void* userptr)
+    {
+#if defined VMCFG_EXACT_TRACING || defined VMCFG_SELECTABLE_EXACT_TRACING
+        if (GetGCBits(GetRealPointer(userptr)) & kVirtualGCTrace) {
+            size_t cursor = 0;
+            while (((GCTraceableBase*)userptr)->gcTrace(this, cursor))
+                cursor++;
+            return;
+        }
+#endif
+        // A conservatively traced object can only point to pinned objects, so there
+        // is nothing to fix up in it.
+        if (compactionPhase == kPinning)
+            TraceConservativeRangeForCompaction(userptr, Size(userptr));
+    }
+
+    void GC::TraceConservativeRangeForCompaction(const void* p, size_t size)
+    {
+        uintptr_t* q = (uintptr_t*)p;
+        uintptr_t* end = q + (size / sizeof(void*));
+        for ( ; q < end ; q++ )
+            TraceConservativePointer(*q, true HEAP_GRAPH_ARG(q));
+    }
+
+    /*static*/
+    void GC::DoPinFromStack(void* stackPointer, void* arg)
+    {
+        GC* gc = (GC*)arg;
+        char* stackBase = (char*)gc->GetStackTop();
+        gc->TraceConservativeRangeForCompaction(stackPointer, size_t(stackBase - (char*)stackPointer));
+    }
+
+    void GC::ForwardLocation(const void* obj, const uintptr_t* loc)
+    {
+        if (m_forwarding == NULL)
+            return;
+        const void* to = m_forwarding->get(obj);
+        GCAssertMsg(to != NULL, "Exactly traced pointer to an unmarked object after marking");
+        if (to != NULL)
+            *const_cast<uintptr_t*>(loc) = uintptr_t(to) | (*loc & 7);
+    }
+#endif // MMGC_COMPACTION
+
+#ifdef MMGC_HEAP_SNAPSHOT
+    // Encodes a heap snapshot into a fixed-size buffer that is handed to the writer
+    // whenever it fills up.  See GCHeapSnapshotWriter for the format.
+    class GCHeapSnapshot
+    {
+    public:
+        enum {
+            kExact = 1,
+            kFinalized = 2,
+            kRCObject = 4,
+            kContainsPointers = 8
+        };
+
+        GCHeapSnapshot(GCHeapSnapshotWriter* out, GCHeapSnapshotNamer* namer)
+            : out(out)
+            , namer(namer)
+            , fill(0)
+            , nextType(1)
+            , lastNode(0)
+            , source(0)
+            , nodes(0)
+            , edges(0)
+        {
+            Bytes("MMGCSNP1", 8);
+        }
+
+        void Root(uint32_t kind, const void* address)
+        {
+            Byte('R');
+            Number(kind);
+            Number(uintptr_t(address));
+            source = 0;
+        }
+
+        void Node(const void* userptr, size_t size, uint8_t flags)
+        {
+            uint32_t type = TypeOf(userptr, flags);
+            uintptr_t a = uintptr_t(userptr) >> 3;
+            Byte('N');
+            Delta(a, lastNode);
+            Number(size);
+            Number(type);
+            Byte(flags);
+            lastNode = source = a;
+            nodes++;
+        }
+
+        void Edge(const void* userptr)
+        {
+            Byte('E');
+            Delta(uintptr_t(userptr) >> 3, source);
+            edges++;
+        }
+
+        void Finish()
+        {
+            Byte('Z');
+            Number(nodes);
+            Number(edges);
+            Flush();
+        }
+
+    private:
+        static const uint32_t kBufferSize = 65536;
+        static const uint32_t kMaxRecord = 16;      // longest fixed part of a record, in bytes
+
+        uint32_t TypeOf(const void* userptr, uint8_t flags)
+        {
+            const void* key = namer != NULL ? namer->typeKey(userptr) : NULL;
+            bool isVTable = false;
+            if (key == NULL && (flags & (kExact|kFinalized)) != 0) {
+                // Unknown to the host, but it is a C++ object: its vtable pointer
+                // identifies its class and can be symbolized offline.
+                key = *(const void* const*)userptr;
+                isVTable = true;
+            }
+            if (key == NULL)
+                return 0;
+            uint32_t index = uint32_t(uintptr_t(types.get(key)));
+            if (index == 0) {
+                index = nextType++;
+                types.put(key, (const void*)uintptr_t(index));
+                char name[256];
+                name[0] = 0;
+                if (isVTable)
+                    VMPI_snprintf(name, sizeof(name), "vtable@0x%llx", (unsigned long long)uintptr_t(key));
+                else
+                    namer->typeName(key, name, sizeof(name));
+                name[sizeof(name)-1] = 0;
+                size_t length = VMPI_strlen(name);
+                Byte('T');
+                Number(index);
+                Number(length);
+                Bytes(name, length);
+            }
+            return index;
+        }
+
+        void Byte(uint8_t b)
+        {
+            if (fill == kBufferSize)
+                Flush();
+            buffer[fill++] = b;
+        }
+
+        void Bytes(const char* p, size_t n)
+        {
+            while (n-- > 0)
+                Byte(uint8_t(*p++));
+        }
+
+        void Number(uint64_t n)
+        {
+            if (fill > kBufferSize - kMaxRecord)
+                Flush();
+            while (n >= 0x80) {
+                buffer[fill++] = uint8_t(n | 0x80);
+                n >>= 7;
+            }
+            buffer[fill++] = uint8_t(n);
+        }
+
+        void Delta(uintptr_t a, uintptr_t from)
+        {
+            intptr_t d = intptr_t(a - from);
+            Number(d < 0 ? (uint64_t(~d) << 1) | 1 : uint64_t(d) << 1);
+        }
+
+        void Flush()
+        {
+            if (fill > 0)
+                out->write(buffer, fill);
+            fill = 0;
+        }
+
+        GCHeapSnapshotWriter* const out;
+        GCHeapSnapshotNamer* const namer;
+        GCHashtable types;          // type key -> type index
+        uint32_t fill;
+        uint32_t nextType;
+        uintptr_t lastNode;         // address/8 of the previous node
+        uintptr_t source;           // address/8 of the source of subsequent edges
+        uint64_t nodes;
+        uint64_t edges;
+        uint8_t buffer[kBufferSize];
+    };
+
+    // The snapshot is taken right after a full collection, when the heap holds only
+    // live objects and none of them is marked (in generational mode the survivors are
+    // unmarked here and re-marked afterward).  With 'snapshot' set, the tracers report
+    // every pointer to an unmarked object as an edge instead of marking it, so the
+    // ordinary exact and conservative tracers enumerate each object's references and
+    // nothing is ever pushed on the mark stack.
+
+    bool GC::WriteHeapSnapshot(GCHeapSnapshotWriter* out)
+    {
+        GCAssert(onThread());
+        if (out == NULL || nogc || destroying || snapshot != NULL)
+            return false;
+
+        // Objects freed while an incremental mark was in progress may have survived it
+        // as floating garbage; a second collection disposes of them.
+        bool wasMarking = marking;
+        Collect();
+        if (wasMarking)
+            Collect();
+        if (marking || collecting || Reaping())
+            return false;
+        if (!out->begin())
+            return false;
+
+#ifdef MMGC_GENERATIONAL
+        if (generational)
+            ClearMarks();
+#endif
+
+        GCHeapSnapshot* s = mmfx_new(GCHeapSnapshot(out, snapshotNamer));
+        snapshot = s;
+        markerActive++;
+
+        s->Root(0, this);
+        TraceLocation(&emptyWeakRef);
+        TraceLocation(&lockedObjects);
+
+        {
+            MMGC_LOCK(m_rootListLock);
+            for (GCRoot* r = m_roots; r != NULL; r = r->next) {
+                s->Root(1, r);
+                if (r->IsExactlyTraced()) {
+                    bool result = r->gcTrace(this, 0);
+                    (void)result;
+                    GCAssertMsg(result == false, "A GCRoot tracer must never return true.");
+                }
+                else {
+                    const void* object;
+                    uint32_t size;
+                    bool isStackMemory;
+                    r->GetConservativeWorkItem(object, size, isStackMemory);
+                    if (object != NULL)
+                        SnapshotConservativeRange(object, size, MMGC_INTERIOR_PTRS_FLAG);
+                }
+            }
+        }
+
+        s->Root(2, NULL);
+        VMPI_callWithRegistersSaved(GC::DoSnapshotStack, this);
+
+        for (int i=0; i < kNumSizeClasses; i++) {
+            SnapshotObjects(containsPointersRCAllocs[i]);
+            SnapshotObjects(containsPointersNonfinalizedAllocs[i]);
+            SnapshotObjects(containsPointersFinalizedAllocs[i]);
+            SnapshotObjects(noPointersNonfinalizedAllocs[i]);
+            SnapshotObjects(noPointersFinalizedAllocs[i]);
+        }
+        SnapshotObjects(bibopAllocFloat);
+        SnapshotObjects(bibopAllocFloat4);
+
+        void* ptr;
+        GCLargeAllocIterator iter(largeAlloc);
+        while (iter.GetNextLiveObject(ptr))
+            SnapshotObject(ptr);
+
+        markerActive--;
+        snapshot = NULL;
+        GCAssert(m_incrementalWork.Count() == 0);
+
+        s->Finish();
+        mmfx_delete(s);
+        out->end();
+
+#ifdef MMGC_GENERATIONAL
+        // The survivors are the old generation again.
+        if (generational) {
+            for (int i=0; i < kNumSizeClasses; i++) {
+                SnapshotRemark(containsPointersRCAllocs[i]);
+                SnapshotRemark(containsPointersNonfinalizedAllocs[i]);
+                SnapshotRemark(containsPointersFinalizedAllocs[i]);
+                SnapshotRemark(noPointersNonfinalizedAllocs[i]);
+                SnapshotRemark(noPointersFinalizedAllocs[i]);
+            }
+            SnapshotRemark(bibopAllocFloat);
+            SnapshotRemark(bibopAllocFloat4);
+            GCLargeAllocIterator large(largeAlloc);
+            while (large.GetNextLiveObject(ptr))
+                GetGCBits(GetRealPointer(ptr)) |= kMark;
+        }
+#endif
+        return true;
+    }
+
+    void GC::SnapshotEdge(const void* userptr)
+    {
+        snapshot->Edge(userptr);
+    }
+
+    void GC::SnapshotObjects(GCAlloc* alloc)
+    {
+        void* ptr;
+        GCAllocIterator iter(alloc);
+        while (iter.GetNextLiveObject(ptr))
+            SnapshotObject(ptr);
+    }
+
+    /*static*/
+    void GC::SnapshotRemark(GCAlloc* alloc)
+    {
+        void* ptr;
+        GCAllocIterator iter(alloc);
+        while (iter.GetNextLiveObject(ptr))
+            GetGCBits(GetRealPointer(ptr)) |= kMark;
+    }
+
+    void GC::SnapshotObject(const void* userptr)
+    {
+        const void* realptr = GetRealPointer(userptr);
+        gcbits_t bits = GetGCBits(realptr);
+        GCBlockHeader* block = GetBlockHeader(realptr);
+        GCAssert((bits & (kMark|kQueued)) == 0);
+
+        uint8_t flags = 0;
+        if (bits & kVirtualGCTrace)
+            flags |= GCHeapSnapshot::kExact;
+        if (bits & kFinalizable)
+            flags |= GCHeapSnapshot::kFinalized;
+        if (block->rcobject)
+            flags |= GCHeapSnapshot::kRCObject;
+        if (block->containsPointers)
+            flags |= GCHeapSnapshot::kContainsPointers;
+        snapshot->Node(userptr, Size(userptr), flags);
+
+        if (!block->containsPointers)
+            return;
+#if defined VMCFG_EXACT_TRACING || defined VMCFG_SELECTABLE_EXACT_TRACING
+        if (bits & kVirtualGCTrace) {
+            size_t cursor = 0;
+            while (((GCTraceableBase*)userptr)->gcTrace(this, cursor))
+                cursor++;
+            return;
+        }
+#endif
+        SnapshotConservativeRange(userptr, Size(userptr), MMGC_INTERIOR_PTRS_FLAG);
+    }
+
+    void GC::SnapshotConservativeRange(const void* p, size_t size, bool interiorPtrs)
+    {
+        uintptr_t* q = (uintptr_t*)p;
+        uintptr_t* end = q + (size / sizeof(void*));
+        for ( ; q < end ; q++ )
+            TraceConservativePointer(*q, interiorPtrs HEAP_GRAPH_ARG(q));
+    }
+
+    /*static*/
+    void GC::SnapshotStackRange(void* arg, const void* p, size_t nbytes)
+    {
+        ((GC*)arg)->SnapshotConservativeRange(p, nbytes, true);
+    }
+
+    /*static*/
+    void GC::DoSnapshotStack(void* stackPointer, void* arg)
+    {
+        GC* gc = (GC*)arg;
+        gc->ScanProgramStack(stackPointer, (const void*)gc->GetStackTop(), GC::SnapshotStackRange, gc);
+    }
+#endif // MMGC_HEAP_SNAPSHOT
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+    void GC::SampleAllocation(const void* userptr, size_t size)
+    {
+        if (allocationSampler == NULL) {
+            allocationSampleCountdown = kNoAllocationSample;
+            return;
+        }
+        if (allocationSampler->Sample(userptr, size, allocationSamplerHost)) {
+            const void* realptr = GetRealPointer(userptr);
+            if (!GCLargeAlloc::IsLargeBlock(realptr))
+                GCAlloc::SetSampled(realptr);
+            else
+                GetGCBits(realptr) |= kSampled;
+        }
+        allocationSampleCountdown = allocationSampler->NextInterval();
+    }
+
+    void GC::SampledObjectFreed(const void* userptr, size_t size)
+    {
+        if (allocationSampler != NULL)
+            allocationSampler->Freed(userptr, size);
+    }
+
+    bool GC::WriteAllocationProfile(GCAllocationProfileWriter* out, bool live)
+    {
+        GCAssert(onThread());
+        if (out == NULL || allocationSampler == NULL)
+            return false;
+
+        if (live && !nogc && !destroying) {
+            // See WriteHeapSnapshot.
+            bool wasMarking = marking;
+            Collect();
+            if (wasMarking)
+                Collect();
+        }
+        allocationSampler->Write(out, live, allocationSamplerHost);
+        return true;
+    }
+#endif
+
     void GC::WriteBarrierTrap(const void *container)
     {
         if (BarrierActive())
@@ -3421,11 +4531,82 @@ namespace MMgc
         return (GCObject*)m_obj;
     }
 
+#ifdef MMGC_INLINE_WEAKREFS
+    GCWeakRef** GC::WeakRefSlot(const void* userptr, bool create)
+    {
+        const void* realptr = GetRealPointer(userptr);
+        GCWeakRefSlots** owner;
+        uint32_t capacity;
+        uint32_t index;
+        if (GCLargeAlloc::IsLargeBlock(realptr)) {
+            owner = &GCLargeAlloc::GetLargeBlock(realptr)->weakRefs;
+            capacity = 1;
+            index = 0;
+        }
+        else {
+            GCAlloc::GCBlock* b = GCAlloc::GetBlock(realptr);
+            owner = &b->weakRefs;
+            capacity = uint32_t(((GCAlloc*)b->alloc)->m_itemsPerBlock);
+            index = GCAlloc::GetObjectIndex(b, realptr);
+        }
+        GCWeakRefSlots* slots = *owner;
+        if (slots == NULL) {
+            if (!create)
+                return NULL;
+            size_t nbytes = sizeof(GCWeakRefSlots) + (capacity - 1) * sizeof(GCWeakRef*);
+            slots = (GCWeakRefSlots*)mmfx_alloc_opt(nbytes, MMgc::kZero);
+            slots->owner = owner;
+            slots->capacity = capacity;
+            slots->prev = NULL;
+            slots->next = weakRefSlots;
+            if (weakRefSlots != NULL)
+                weakRefSlots->prev = slots;
+            weakRefSlots = slots;
+            *owner = slots;
+        }
+        GCAssert(index < slots->capacity);
+        return &slots->refs[index];
+    }
+
+    void GC::FreeWeakRefSlots(GCWeakRefSlots* slots)
+    {
+        GCAssert(slots->population == 0);
+        if (slots->prev != NULL)
+            slots->prev->next = slots->next;
+        else
+            weakRefSlots = slots->next;
+        if (slots->next != NULL)
+            slots->next->prev = slots->prev;
+        *slots->owner = NULL;
+        mmfx_free(slots);
+    }
+
+    /*static*/
+    GCWeakRefSlots* GC::WeakRefSlots(const void* userptr)
+    {
+        const void* realptr = GetRealPointer(userptr);
+        if (GCLargeAlloc::IsLargeBlock(realptr))
+            return GCLargeAlloc::GetLargeBlock(realptr)->weakRefs;
+        return GCAlloc::GetBlock(realptr)->weakRefs;
+    }
+#endif
+
     /*static*/
     GCWeakRef* GC::GetWeakRef(const void *userptr)
     {
         GC *gc = GetGC(userptr);
+#ifdef MMGC_INLINE_WEAKREFS
+        GCWeakRef **slot = NULL;
+        GCWeakRef *ref;
+        if (gc->inlineWeakRefs) {
+            slot = HasWeakRef(userptr) ? gc->WeakRefSlot(userptr, false) : NULL;
+            ref = slot ? *slot : NULL;
+        }
+        else
+            ref = (GCWeakRef*) gc->weakRefs.get(userptr);
+#else
         GCWeakRef *ref = (GCWeakRef*) gc->weakRefs.get(userptr);
+#endif
 
         GCAssert(gc->IsPointerToGCPage(userptr));
         GCAssert(gc->IsPointerToGCObject(GetRealPointer(userptr)));
@@ -3450,11 +4631,28 @@ namespace MMgc
                 }
             }
             ref = new (gc) GCWeakRef(userptr);
+#ifdef MMGC_INLINE_WEAKREFS
+            if (gc->inlineWeakRefs) {
+                // Get the slot only now: the allocation above may have collected, and
+                // that may have freed this block's slot array.
+                slot = gc->WeakRefSlot(userptr, true);
+                GCAssert(*slot == NULL);
+                *slot = ref;
+                WeakRefSlots(userptr)->population++;
+                gc->weakRefSlotsPopulation++;
+            }
+            else
+#endif
             gc->weakRefs.put(userptr, ref);
             SetHasWeakRef(userptr, true);
 #ifdef MMGC_WEAKREF_PROFILER
             if (gc->weaklings != NULL) {
                 gc->weaklings->accountForObject(ref);
+#ifdef MMGC_INLINE_WEAKREFS
+                if (gc->inlineWeakRefs)
+                    gc->weaklings->reportPopulation(gc->weakRefSlotsPopulation);
+                else
+#endif
                 gc->weaklings->reportPopulation(gc->weakRefs.count());
             }
 #endif
@@ -3466,6 +4664,26 @@ namespace MMgc
 
     void GC::ClearWeakRef(const void *item, bool allowRehash)
     {
+#ifdef MMGC_INLINE_WEAKREFS
+        if (inlineWeakRefs) {
+            // allowRehash=false means the caller is walking the slot arrays and will free
+            // the emptied ones itself.
+            GCWeakRefSlots* slots = WeakRefSlots(item);
+            GCWeakRef** slot = slots ? WeakRefSlot(item, false) : NULL;
+            GCWeakRef* ref = slot ? *slot : NULL;
+            GCAssert(ref != NULL || heap->GetStatus() == kMemAbort);
+            if (ref) {
+                GCAssert(ref->isNull() || ref->peek() == item);
+                *slot = NULL;
+                ref->m_obj = NULL;
+                SetHasWeakRef(item, false);
+                weakRefSlotsPopulation--;
+                if (--slots->population == 0 && allowRehash)
+                    FreeWeakRefSlots(slots);
+            }
+            return;
+        }
+#endif
         GCWeakRef *ref = (GCWeakRef*) weakRefs.remove(item, allowRehash);
         GCAssert(weakRefs.get(item) == NULL);
         GCAssert(ref != NULL || heap->GetStatus() == kMemAbort);
@@ -3887,6 +5105,9 @@ namespace MMgc
         {
             ClearMarkStack();
             m_barrierWork.Clear();
+#ifdef MMGC_CARD_MARKING
+            FreeCards();
+#endif
             ClearMarks();
             m_markStackOverflow = false;
             collecting = false;
@@ -364,6 +364,122 @@ namespace MMgc
         GCCallback *prevCB;
     };
 
+#ifdef MMGC_STACK_MAPS
+    /**
+     * GCStackScanner receives the host's description of the native stack
+     * from GCStackMaps::ScanFrames.  A frame claimed with Frame() is not
+     * scanned at all except for the words subsequently reported for it with
+     * Words(); all unclaimed parts of the stack are scanned conservatively.
+     *
+     * Frames must be claimed in increasing address order, must not overlap,
+     * and must lie within [Low(), High()).  A frame that violates these
+     * constraints is left unclaimed, and the words reported for it are
+     * ignored, so a confused host loses precision but not soundness.
+     */
+    class GCStackScanner
+    {
+    public:
+        // The part of the stack being scanned.
+        virtual const void* Low() const = 0;
+        virtual const void* High() const = 0;
+
+        // Claim the frame [lo,hi).
+        virtual void Frame(const void* lo, const void* hi) = 0;
+
+        // The nbytes bytes at p, which must be pointer aligned and lie in the
+        // most recently claimed frame, may hold pointers to GC objects.
+        virtual void Words(const void* p, size_t nbytes) = 0;
+
+    protected:
+        virtual ~GCStackScanner() {}
+    };
+
+    /**
+     * GCStackMaps is an interface that allows the application to describe
+     * the layout of some of its native stack frames, typically JIT-compiled
+     * ones, so that the GC need not scan them conservatively.  Install it
+     * with GC::SetStackMaps.
+     */
+    class GCStackMaps
+    {
+    public:
+        virtual ~GCStackMaps() {}
+
+        // Claim the precisely described frames of the current thread's stack,
+        // innermost first.  Must not allocate, and must not call back into the GC.
+        virtual void ScanFrames(GCStackScanner& scanner) = 0;
+    };
+#endif
+
+#ifdef MMGC_HEAP_SNAPSHOT
+    /**
+     * Destination of heap snapshots, see GC::WriteHeapSnapshot.  For every snapshot
+     * the GC calls begin(), then write() any number of times, then end().  The GC
+     * buffers its output, so write() sees large chunks.
+     *
+     * The snapshot is a byte stream.  It starts with the eight bytes "MMGCSNP1"; the
+     * rest is a sequence of records, each a tag byte followed by fields that are
+     * unsigned LEB128 numbers unless noted.  A "delta" is a signed difference that is
+     * zigzag encoded (0, -1, 1, -2, ... map to 0, 1, 2, 3, ...) and byte addresses are
+     * divided by 8 before they are differenced.
+     *
+     *   'T' index length bytes   Type 'index' (from 1) is named by 'length' UTF-8 bytes.
+     *                            It precedes the first node of that type.
+     *   'R' kind address         Start of a root: 0 = held by the GC itself, 1 = a
+     *                            GCRoot at 'address', 2 = the program stack.
+     *   'N' delta size type flags
+     *                            A live object of 'size' bytes whose address is 'delta'
+     *                            from the previous node's (from 0 for the first), of
+     *                            type 'type' or 0 if unknown.  'flags' is a byte: 1 if
+     *                            exactly traced, 2 if finalized, 4 if reference counted,
+     *                            8 if it may contain pointers.
+     *   'E' delta                A reference from the most recent 'R' or 'N' to the
+     *                            object whose address is 'delta' from the source's
+     *                            (from 0 for a root).
+     *   'Z' nodes edges          The end of the snapshot, with the record counts.
+     *
+     * All roots precede all nodes.  Exactly traced objects contribute the references
+     * their tracers report; conservatively traced objects, conservative roots and the
+     * stack contribute every word that looks like a pointer to a live object.  Weak
+     * references are not edges.
+     */
+    class GCHeapSnapshotWriter
+    {
+    public:
+        virtual ~GCHeapSnapshotWriter() {}
+
+        // Start a snapshot; return false to skip it.
+        virtual bool begin() = 0;
+
+        // Append nbytes bytes of the snapshot.
+        virtual void write(const void* data, size_t nbytes) = 0;
+
+        // The snapshot is complete.
+        virtual void end() = 0;
+    };
+
+    /**
+     * The host's knowledge of object types, used to name the nodes of heap snapshots.
+     * Install it with GC::SetHeapSnapshotNamer.  Neither method may allocate GC memory
+     * or call back into the GC.
+     */
+    class GCHeapSnapshotNamer
+    {
+    public:
+        virtual ~GCHeapSnapshotNamer() {}
+
+        // Return a non-NULL key identifying the type of the live object 'userptr' if
+        // the host knows it, otherwise NULL.  Keys must be addresses of host data
+        // structures (which the GC compares but does not dereference).
+        virtual const void* typeKey(const void* userptr) = 0;
+
+        // Write the NUL-terminated name of the type identified by 'key' into buf.
+        virtual void typeName(const void* key, char* buf, size_t bufsize) = 0;
+    };
+
+    class GCHeapSnapshot;
+#endif
+
     #ifdef MMGC_64BIT
     #define HIDDENPTRMASK (uintptr_t(0x1L)<<63)
     #else
@@ -445,8 +561,17 @@ namespace MMgc
         friend class GCWeakRef;
         friend class RCObject;
         friend class ZCT;
+#ifdef MMGC_STACK_MAPS
+        friend class GCStackRangeScanner;
+#endif
         friend class AutoRCRootSegment;
         friend class GCPolicyManager;
+#ifdef MMGC_PARALLEL_MARKING
+        friend class GCParallelMarker;
+#endif
+#ifdef MMGC_BACKGROUND_SWEEPING
+        friend class GCBackgroundSweeper;
+#endif
 
         // WriteBarrier classes use private write barriers.
         template<class T> friend class WriteBarrier;
@@ -518,6 +643,28 @@ namespace MMgc
          */
         const bool incremental;
 
+        /**
+         * generational is true if the collector runs nursery collections between
+         * full collections (GCHeapConfig::generational, MMGC_GENERATIONAL).  The
+         * survivors of every collection then keep their mark bits until the next full
+         * collection, and the write barrier is always active.
+         */
+        const bool generational;
+
+        /**
+         * cardMarking is true if the barrier dirties cards while the incremental
+         * collector is marking, rather than queuing marked objects for retracing
+         * (GCHeapConfig::cardMarking, MMGC_CARD_MARKING).  See GC::ScanDirtyCards.
+         */
+        const bool cardMarking;
+
+        /**
+         * compaction is true if full collections may move movable objects out of
+         * sparsely occupied blocks so that the blocks can be freed
+         * (GCHeapConfig::compaction, MMGC_COMPACTION).  See GC::Compact.
+         */
+        const bool compaction;
+
         /**
          * drcEnabled controls whether DRC is employed.  This is true
          * by default and disabling it is only recommended for
@@ -917,7 +1064,17 @@ namespace MMgc
          * Query the exactly traced flag.
          */
         static int IsExactlyTraced(const void* userptr);
-        
+
+        /**
+         * Allow compaction to move the given object to another address (MMGC_COMPACTION).
+         * The object must be exactly traced, contain pointers, and be neither finalized nor
+         * reference counted.  Every pointer to it must either be traced exactly, so that
+         * the GC can update it, or be found by conservative scanning, which pins the object
+         * for that collection; and its address must not be used as a hash key.  Large
+         * objects are never moved.  This does nothing unless compaction is enabled.
+         */
+        void SetMovable(const void* userptr);
+
         /**
          * Used by sub-allocators to obtain memory.
          */
@@ -1297,6 +1454,64 @@ namespace MMgc
 
         uintptr_t GetStackEnter() const;
 
+#ifdef MMGC_STACK_MAPS
+        /**
+         * Install the host's description of its native stack frames, or remove it
+         * with NULL.  Both marking and ZCT reaping consult it whenever they scan the
+         * program stack.  Hosts should only install one when GCHeapConfig::stackMaps
+         * is set.
+         */
+        void SetStackMaps(GCStackMaps* maps) { stackMaps = maps; }
+        GCStackMaps* GetStackMaps() const { return stackMaps; }
+#endif
+
+#ifdef MMGC_HEAP_SNAPSHOT
+        /**
+         * Run a full collection and then write every live object and every reference
+         * among them to 'out', in the format described at GCHeapSnapshotWriter.  The
+         * GC's memory use grows only by a fixed output buffer and a table of type names.
+         *
+         * Must be called on the GC's thread, outside any collection or reap, and
+         * not from a callback.  Returns false if no snapshot was written.
+         */
+        bool WriteHeapSnapshot(GCHeapSnapshotWriter* out);
+
+        /**
+         * Install (or with NULL, remove) the host's type namer for heap snapshots.
+         */
+        void SetHeapSnapshotNamer(GCHeapSnapshotNamer* namer) { snapshotNamer = namer; }
+
+        /**
+         * Install (or with NULL, remove) the destination of requested snapshots.
+         */
+        void SetHeapSnapshotWriter(GCHeapSnapshotWriter* out) { snapshotWriter = out; }
+
+        /**
+         * Ask for a snapshot to be written to the installed writer at the next
+         * opportunity, which is the next time the GC is asked to do collection work
+         * outside a collection.  Safe to call from a signal handler.
+         */
+        void RequestHeapSnapshot() { snapshotRequested = 1; }
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+        /**
+         * Install (or with NULL, remove) the host's view of the script stack for the
+         * allocation sampler.  Without one, samples record native frames only.
+         */
+        void SetAllocationSamplerHost(GCAllocationSamplerHost* host) { allocationSamplerHost = host; }
+
+        /**
+         * Write the sampled allocation sites to 'out', with the bytes allocated at each
+         * since the GC was created or, if 'live' is set, the bytes still live; see
+         * GCAllocationSampler::Write for the format.  A live profile is preceded by a
+         * full collection, so it must be requested on the GC's thread, outside any
+         * collection or reap.  Returns false if GCHeapConfig::allocationSampleInterval
+         * was 0 when the GC was created.
+         */
+        bool WriteAllocationProfile(GCAllocationProfileWriter* out, bool live);
+#endif
+
         bool GetMarkStackOverflow() const { return m_markStackOverflow; }
 
         // If the object is not marked and is not on the mark queue, then mark it and
@@ -1452,6 +1667,29 @@ namespace MMgc
 
         GCHashtable weakRefs;
 
+#ifdef MMGC_INLINE_WEAKREFS
+        // If true then weak refs are held in GCWeakRefSlots arrays hung off the block
+        // headers of their objects, and weakRefs is unused.  Fixed at construction.
+        const bool inlineWeakRefs;
+
+        // All slot arrays that hold at least one weak ref, doubly linked.
+        GCWeakRefSlots* weakRefSlots;
+
+        // Number of weak refs held in slot arrays.
+        uint32_t weakRefSlotsPopulation;
+
+        // Return the address of the slot for the weak ref of userptr, or NULL if the
+        // object's block has no slot array and 'create' is false.
+        GCWeakRef** WeakRefSlot(const void* userptr, bool create);
+
+        // Unlink 'slots' from weakRefSlots, clear the block header's pointer to it, and
+        // free it.  All its slots must be empty.
+        void FreeWeakRefSlots(GCWeakRefSlots* slots);
+
+        // Return the slot array of the block holding userptr, or NULL.
+        static GCWeakRefSlots* WeakRefSlots(const void* userptr);
+#endif
+
         // If a weak reference in the weakref table points to an unmarked object then
         // clear the weak reference and remove it from the weakref table.  If a weak
         // reference in the table points to a marked object and is itself unmarked then
@@ -1535,6 +1773,35 @@ namespace MMgc
         GCAutoEnter* stackEnter;
         uint32_t enterCount;
 
+#ifdef MMGC_STACK_MAPS
+        GCStackMaps* stackMaps;     // host description of its stack frames, or NULL
+#endif
+
+#ifdef MMGC_HEAP_SNAPSHOT
+        GCHeapSnapshot* snapshot;                   // non-NULL while WriteHeapSnapshot traces
+        GCHeapSnapshotNamer* snapshotNamer;
+        GCHeapSnapshotWriter* snapshotWriter;       // destination of requested snapshots
+        volatile int32_t snapshotRequested;
+
+        void SnapshotEdge(const void* userptr);
+        void SnapshotObjects(GCAlloc* alloc);
+        static void SnapshotRemark(GCAlloc* alloc);
+        void SnapshotObject(const void* userptr);
+        void SnapshotConservativeRange(const void* p, size_t size, bool interiorPtrs);
+        static void SnapshotStackRange(void* arg, const void* p, size_t nbytes);
+        static void DoSnapshotStack(void* stackPointer, void* arg);
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+        GCAllocationSampler* allocationSampler;         // NULL unless GCHeapConfig::allocationSampleInterval is set
+        GCAllocationSamplerHost* allocationSamplerHost;
+        intptr_t allocationSampleCountdown;             // the allocators sample when this goes negative
+        static const intptr_t kNoAllocationSample = intptr_t(~uintptr_t(0) >> 1);
+
+        void SampleAllocation(const void* userptr, size_t size);
+        void SampledObjectFreed(const void* userptr, size_t size);
+#endif
+
 #ifdef VMCFG_SELECTABLE_EXACT_TRACING
         const gcbits_t runtimeSelectableExactnessFlag; // 0 or kVirtualGCTrace
 #endif
@@ -1542,11 +1809,57 @@ namespace MMgc
         GCMarkStack m_incrementalWork;
         void StartIncrementalMark();
         void FinishIncrementalMark(bool scanNativeStack, bool okToShrinkHeapTarget=true);
+#ifdef MMGC_GENERATIONAL
+        void NurseryCollect();
+#endif
 
         GCMarkStack m_barrierWork;
         void CheckBarrierWork();
         void FlushBarrierWork();
 
+#ifdef MMGC_CARD_MARKING
+        // The card table holds one byte for every kCardSize bytes of the page map's
+        // address range as it was when marking started.  m_cards is non-NULL only while
+        // the incremental collector is marking with cardMarking set; m_cardLimit is zero
+        // otherwise, so DirtyCard fails without testing m_cards.  Stores to memory
+        // outside the table (heap obtained during marking) use the queuing barrier.
+        static const uint32_t kCardShift = 9;
+        static const uint32_t kCardSize = 1 << kCardShift;
+
+        uint8_t* m_cards;
+        uintptr_t m_cardBase;
+        uintptr_t m_cardLimit;  // Bytes covered by m_cards
+
+        // Dirty the card covering 'address', returning false if no card covers it.
+        bool DirtyCard(const void* address);
+
+        void AllocateCards();
+        void FreeCards();
+        void ScanDirtyCards();
+        uint32_t RequeueMarkedObjectsOnCard(uintptr_t lo, uintptr_t hi);
+#endif
+
+#ifdef MMGC_COMPACTION
+        // While compactionPhase is kPinning, TraceConservativePointer sets kPinned on the
+        // movable objects it finds instead of marking.  While it is kFixingUp, TracePointer
+        // redirects locations that point to moved objects, see GC::Compact.
+        enum CompactionPhase { kNotCompacting, kPinning, kFixingUp };
+
+        // Compaction is skipped unless at least this many blocks could be emptied.
+        static const uint32_t kCompactionMinBlocks = 8;
+
+        CompactionPhase compactionPhase;
+        bool compactOnSweep;            // FinishIncrementalMark requests compaction from Sweep
+        GCHashtable* m_forwarding;      // Old user pointer -> new user pointer of moved objects
+
+        void Compact();
+        void TraceForCompaction();
+        void TraceObjectForCompaction(const void* userptr);
+        void TraceConservativeRangeForCompaction(const void* p, size_t size);
+        static void DoPinFromStack(void* stackPointer, void* arg);
+        void ForwardLocation(const void* obj, const uintptr_t* loc);
+#endif
+
         bool m_markStackOverflow;
         void HandleMarkStackOverflow();
         
@@ -1587,15 +1900,15 @@ namespace MMgc
         /**
          * Tracks pages in use; 2 bits per page (see PageType enum).
          */
-#ifdef MMGC_USE_UNIFORM_PAGEMAP
+#if defined MMGC_RADIX_PAGEMAP
+        PageMap::Radix pageMap;
+#elif defined MMGC_USE_UNIFORM_PAGEMAP
         PageMap::Uniform pageMap;
-#else
-#ifdef MMGC_64BIT
+#elif defined MMGC_64BIT
         PageMap::DelayT4 pageMap;
 #else
         PageMap::Tiered2 pageMap;
-#endif // MMGC_64BIT
-#endif // MMGC_USE_UNIFORM_PAGEMAP
+#endif
 
         // This is very hot
         PageMap::PageType GetPageMapValue(uintptr_t addr) const;
@@ -1655,6 +1968,8 @@ namespace MMgc
         void MarkQueueAndStack(bool scanNativeStack=true);
         void MarkTopItem_NonGCObject();
         void MarkItem_GCObject(const void* object);
+        bool MarkNextItem(GCMarkStack& stack, GCMarkPrefetchQueue& prefetched);
+        void MarkPrefetchedItems(GCMarkPrefetchQueue& prefetched);
         void MarkItem_ExactObjectTail(const void* object, size_t cursor);
         void MarkItem_ConservativeOrNonGCObject(const void* object, uint32_t size, GCMarkStack::TypeTag type, const void* baseptr, bool interiorPtrs);
         void SplitExactGCObject(const void* object);
@@ -1665,6 +1980,13 @@ namespace MMgc
 
         static void DoCleanStack(void* stackPointer, void* arg);
         static void DoMarkFromStack(void* stackPointer, void* arg);
+        static void MarkStackRange(void* arg, const void* p, size_t nbytes);
+
+        // Call scan(arg, p, nbytes) for every part of the stack segment [sp,base)
+        // that has to be scanned: all of it, or with GCStackMaps installed, the
+        // unclaimed parts plus the words reported for the claimed frames.
+        typedef void (*StackRangeProc)(void* arg, const void* p, size_t nbytes);
+        void ScanProgramStack(const void* sp, const void* base, StackRangeProc scan, void* arg);
 
     public:
         // Sweep all small-block pages that need sweeping
@@ -1802,6 +2124,27 @@ namespace MMgc
         void Push_LargeRootChunk(const void *p, uint32_t size, const void* baseptr);
         bool Push_RootProtector(const void* p);
         void Push_LargeObjectProtector(const void* p);
+
+        // The stack that the calling thread should push onto and pop from: normally
+        // m_incrementalWork, but the marker thread's private stack during parallel
+        // marking.
+        GCMarkStack& MarkStack();
+
+        // Account for mark work, in the policy manager or in the calling marker
+        // thread's counters during parallel marking.
+        void SignalExactMarkWork(size_t nbytes);
+        void SignalConservativeMarkWork(size_t nbytes, bool fromRoot);
+        void SignalPointerfreeMarkWork(size_t nbytes);
+
+#ifdef MMGC_PARALLEL_MARKING
+        // Non-NULL iff GCHeapConfig::markThreads > 1; see GCThreads.h.
+        GCParallelMarker* parallelMarker;
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // Non-NULL iff GCHeapConfig::backgroundSweeping; see GCThreads.h.
+        GCBackgroundSweeper* backgroundSweeper;
+#endif
         
 #ifdef _DEBUG
         // Assert invariants on GCObjects about to go on the mark stack.
@@ -45,11 +45,6 @@ namespace MMgc
         return block->items + block->size * GetObjectIndex(block, item);
     }
 
-    REALLY_INLINE void GCAlloc::SetBlockHasWeakRef(const void *userptr)
-    {
-        GetBlock(userptr)->slowFlags |= kFlagWeakRefs;
-    }
-
     REALLY_INLINE void GCAlloc::AddToFreeList(GCBlock *b)
     {
         GCAssert(!IsOnEitherList(b) && !b->needsSweeping());
@@ -96,13 +91,18 @@ namespace MMgc
 
     REALLY_INLINE void GCAlloc::RemoveFromSweepList(GCBlock *b)
     {
-        GCAssert(m_needsSweeping == b || b->prevFree != NULL);
+#ifdef MMGC_BACKGROUND_SWEEPING
+        GCBlock*& list = (b->slowFlags & kFlagSweptInBackground) ? m_swept : m_needsSweeping;
+#else
+        GCBlock*& list = m_needsSweeping;
+#endif
+        GCAssert(list == b || b->prevFree != NULL);
         if ( ((b->prevFree && (b->prevFree->nextFree!=b))) ||
             ((b->nextFree && (b->nextFree->prevFree!=b))) )
             VMPI_abort();
 
-        if ( m_needsSweeping == b )
-            m_needsSweeping = b->nextFree;
+        if ( list == b )
+            list = b->nextFree;
         else
             b->prevFree->nextFree = b->nextFree;
 
@@ -157,7 +157,11 @@ namespace MMgc
     REALLY_INLINE void GCAlloc::GCBlock::setNeedsSweeping(int v)
     {
         GCAssert(v == 0 || v == kFlagNeedsSweeping);
+#ifdef MMGC_BACKGROUND_SWEEPING
+        slowFlags = (uint8_t)((slowFlags & ~(kFlagNeedsSweeping|kFlagSweptInBackground)) | v);
+#else
         slowFlags = (uint8_t)((slowFlags & ~kFlagNeedsSweeping) | v);
+#endif
     }
 
     REALLY_INLINE GCAllocIterator::GCAllocIterator(MMgc::GCAlloc* alloc)
@@ -185,6 +189,23 @@ namespace MMgc
             }
         }
     }
+
+    REALLY_INLINE bool GCAllocIterator::GetNextLiveObject(void*& out_ptr)
+    {
+        for (;;) {
+            if (idx == limit) {
+                idx = 0;
+                block = GCAlloc::Next(block);
+            }
+            if (block == NULL)
+                return false;
+            uint32_t i = idx++;
+            if ((GC::GetGCBits(block->items + i*size) & GCAlloc::kFreelist) != GCAlloc::kFreelist) {
+                out_ptr = GetUserPointer(block->items + i*size);
+                return true;
+            }
+        }
+    }
 }
 
 #endif /* __GCAlloc_inlines__ */
@@ -105,6 +105,14 @@
  * current system.  See comments about this invariant in GCObject.h.
  */
 
+// The background sweeper may be working on a block that needs sweeping; code that
+// touches the sweep lists, or the bits or free list of such a block, must lock.
+#ifdef MMGC_BACKGROUND_SWEEPING
+    #define MMGC_SWEEP_LOCK(_alloc) MMGC_LOCK((_alloc)->m_sweepLock)
+#else
+    #define MMGC_SWEEP_LOCK(_alloc)
+#endif
+
 namespace MMgc
 {
 #ifdef MMGC_FASTBITS
@@ -129,6 +137,10 @@ namespace MMgc
         m_lastBlock(NULL),
         m_firstFree(NULL),
         m_needsSweeping(NULL),
+#ifdef MMGC_BACKGROUND_SWEEPING
+        m_swept(NULL),
+        m_backgroundFreedItems(0),
+#endif
         m_qList(NULL),
         m_qBudget(0),
         m_qBudgetObtained(0),
@@ -165,10 +177,16 @@ namespace MMgc
         GCAssert(!_isRC || _isFinalized);
         m_gc->ObtainQuickListBudget(m_itemSize*m_itemsPerBlock);
         m_qBudget = m_qBudgetObtained = m_itemsPerBlock;
+#ifdef MMGC_BACKGROUND_SWEEPING
+        VMPI_lockInit(&m_sweepLock);
+#endif
     }
 
     GCAlloc::~GCAlloc()
     {
+#ifdef MMGC_BACKGROUND_SWEEPING
+        VMPI_lockDestroy(&m_sweepLock);
+#endif
         CoalesceQuickList();
 
         // Free all of the blocks
@@ -344,6 +362,9 @@ namespace MMgc
     void GCAlloc::FreeChunk(GCBlock* b)
     {
         GCAssert(b->numFree == m_itemsPerBlock);
+#ifdef MMGC_INLINE_WEAKREFS
+        GCAssert(b->weakRefs == NULL);
+#endif
         if(!m_bitsInPage) {
             VMPI_memset(b->bits, 0, m_numBitmapBytes);
             m_gc->FreeBits((uint32_t*)(void *)b->bits, m_sizeClassIndex);
@@ -456,6 +477,11 @@ namespace MMgc
 
         VALGRIND_MEMPOOL_ALLOC(b, item, m_itemSize);
 
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if ((m_gc->allocationSampleCountdown -= m_itemSize - DebugSize()) < 0)
+            m_gc->SampleAllocation(GetUserPointer(item), m_itemSize - DebugSize());
+#endif
+
         return item;
     }
 
@@ -468,8 +494,7 @@ namespace MMgc
         GCBlock* b = m_firstFree;
 
         while (b == NULL) {
-            if (m_needsSweeping && !m_gc->collecting) {
-                Sweep(m_needsSweeping);
+            if (!m_gc->collecting && SweepForAllocation()) {
                 b = m_firstFree;
                 if (b != NULL)
                     break;
@@ -551,10 +576,12 @@ namespace MMgc
         int bitsindex = GetBitsIndex(b, item);
 
         // We can't allow free'ing something during sweeping - it messes up
-        // the per-block statistics - or anything that's on a mark queue.
+        // the per-block statistics - or anything that's on a mark queue.  In
+        // generational mode the remembered set is a mark queue that persists
+        // between collections.
 
         GCAssert(m_gc->collecting == false || m_gc->marking == true);
-        if (m_gc->marking && (m_gc->collecting || b->bits[bitsindex] & kQueued)) {
+        if (m_gc->BarrierActive() && (m_gc->collecting || b->bits[bitsindex] & kQueued)) {
             m_gc->AbortFree(GetUserPointer(item));
             return;
         }
@@ -601,6 +628,13 @@ namespace MMgc
         // that would be bad; it could also mean that objects reachable from the
         // dead object would be marked in turn and would be retained for a GC cycle.
 
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (b->needsSweeping()) {
+            MMGC_SWEEP_LOCK(this);
+            b->bits[bitsindex] |= kFreelist;
+        }
+        else
+#endif
         b->bits[bitsindex] |= kFreelist;    // Don't clear the weak ref bit, FreeSlow may inspect it
         m_totalAllocatedBytes -= m_itemSize;
         if (b->slowFlags)   // needs sweeping, or may have weak refs
@@ -629,6 +663,10 @@ namespace MMgc
     {
         if(b->bits[bitsindex] & kHasWeakRef)
             b->gc->ClearWeakRef(GetUserPointer(item));
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if(b->bits[bitsindex] & kSampled)
+            b->gc->SampledObjectFreed(GetUserPointer(item), m_itemSize - DebugSize());
+#endif
 
 #ifndef _DEBUG
         ClearNonRCObject((void*)item, b->size);
@@ -645,14 +683,24 @@ namespace MMgc
             void* qList = m_qList;
             m_qList = NULL;
 
-            FLPush(b->firstFree, item);
-            b->numFree++;
+            {
+                MMGC_SWEEP_LOCK(this);
+
+                FLPush(b->firstFree, item);
+                b->numFree++;
 
-            blockSwept = Sweep(b);
+                blockSwept = Sweep(b);
+            }
 
             m_qList = qList;
         }
         else {
+#ifdef MMGC_ALLOCATION_SAMPLER
+            if (b->bits[bitsindex] & kSampled) {
+                b->bits[bitsindex] &= ~kSampled;
+                ClearSampledFlag(b);
+            }
+#endif
             *(void**)item = m_qList;
             m_qList = (void**)item;
 
@@ -661,6 +709,8 @@ namespace MMgc
         }
         if (!blockSwept)
             VALGRIND_MEMPOOL_FREE(b, item);
+
+        m_gc->SignalFreeWork(m_itemSize);
     }
 
     REALLY_INLINE void GCAlloc::ClearNonRCObject(void* item, size_t size)
@@ -754,8 +804,13 @@ namespace MMgc
 #ifdef _DEBUG
     void GCAlloc::VerifyNotFree(GCBlock* b, const void* item)
     {
-        for ( void *free = m_qList ; free != NULL ; free = FLNext(free) )
-            GCAssert(free != item);
+        // The quick list belongs to the mutator, which may be using it while the
+        // background sweeper runs.  It never holds items from unswept blocks (see
+        // FreeSlow), so there is nothing for the sweeper to check there.
+        if (m_gc->onThread()) {
+            for ( void *free = m_qList ; free != NULL ; free = FLNext(free) )
+                GCAssert(free != item);
+        }
 
         for ( void *free = b->firstFree ; free != NULL ; free = FLNext(free) )
             GCAssert(free != item);
@@ -865,10 +920,12 @@ namespace MMgc
                 b->gc->AddToSmallEmptyBlockList(b);
                 putOnFreeList = false;
             } else if(numMarkedItems == (m_itemsPerBlock - b->numFree)) {
-                // nothing changed on this page, clear marks
+                // nothing changed on this page, clear marks (unless the survivors
+                // keep them, see GC::NurseryCollect)
                 // note there will be at least one free item on the page (otherwise it
                 // would not have been scanned) so the page just stays on the freelist
-                ClearMarks(b);
+                if (!m_gc->generational)
+                    ClearMarks(b);
             } else if(!b->needsSweeping()) {
                 // Removed the block from the free list earlier, check again
                 GCAssert(!(b->nextFree || b->prevFree || b == m_firstFree));
@@ -944,6 +1001,9 @@ namespace MMgc
 
     void GCAlloc::SweepGuts(GCBlock *b)
     {
+#ifdef MMGC_ALLOCATION_SAMPLER
+        gcbits_t liveBits = 0;
+#endif
         gcbits_t* blockbits = b->bits;
         for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
         {
@@ -953,8 +1013,12 @@ namespace MMgc
             int mq = marks & kFreelist;
             if(mq == kMark || mq == kQueued)    // Sweeping is lazy; don't sweep objects on the mark stack
             {
-                // live item, clear bits
-                marks &= ~kFreelist;
+#ifdef MMGC_ALLOCATION_SAMPLER
+                liveBits |= marks;
+#endif
+                // live item, clear bits unless the survivors keep them (see GC::NurseryCollect)
+                if (!m_gc->generational)
+                    marks &= ~kFreelist;
                 continue;
             }
 
@@ -968,6 +1032,11 @@ namespace MMgc
 #endif
             b->FreeSweptItem(item, bitsindex);
         }
+#ifdef MMGC_ALLOCATION_SAMPLER
+        // Sampled objects that died here were dropped by GCAllocationSampler::ClearUnmarked.
+        if (!(liveBits & kSampled))
+            b->slowFlags &= ~kFlagSampled;
+#endif
     }
 
     // Incrementality: Note that there is the possibility for an unbounded pause here,
@@ -992,11 +1061,25 @@ namespace MMgc
         int oldNumFree;
         GCAssert(b->needsSweeping());
         GCAssert(m_qList == NULL);
+#ifdef MMGC_BACKGROUND_SWEEPING
+        bool sweptInBackground = (b->slowFlags & kFlagSweptInBackground) != 0;
+#endif
         RemoveFromSweepList(b);
 
-        oldNumFree = b->numFree;
-        SweepGuts(b);
-        m_totalAllocatedBytes -= (b->numFree - oldNumFree) * m_itemSize;
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (sweptInBackground) {
+            // Only the bookkeeping remains.  The byte count is adjusted for all swept
+            // blocks at once; that's good enough for the policy manager.
+            m_totalAllocatedBytes -= m_backgroundFreedItems * m_itemSize;
+            m_backgroundFreedItems = 0;
+        }
+        else
+#endif
+        {
+            oldNumFree = b->numFree;
+            SweepGuts(b);
+            m_totalAllocatedBytes -= (b->numFree - oldNumFree) * m_itemSize;
+        }
         if(b->numFree == m_itemsPerBlock)
         {
             UnlinkChunk(b);
@@ -1019,7 +1102,239 @@ namespace MMgc
             Sweep(b);
         }
         GCAssert(m_needsSweeping == NULL);
+#ifdef MMGC_BACKGROUND_SWEEPING
+        for (GCBlock* b = m_swept; b != NULL; b = next)
+        {
+            next = b->nextFree;
+            Sweep(b);
+        }
+        GCAssert(m_swept == NULL);
+#endif
+    }
+
+    bool GCAlloc::SweepForAllocation()
+    {
+        MMGC_SWEEP_LOCK(this);
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // Prefer blocks that are cheap to finish, and leave the others to the sweeper.
+        if (m_swept != NULL) {
+            Sweep(m_swept);
+            return true;
+        }
+#endif
+        if (m_needsSweeping != NULL) {
+            Sweep(m_needsSweeping);
+            return true;
+        }
+        return false;
     }
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+    bool GCAlloc::SweepInBackground()
+    {
+        MMGC_SWEEP_LOCK(this);
+
+        GCBlock* b = m_needsSweeping;
+        if (b == NULL)
+            return false;
+
+        // Unlink from m_needsSweeping, keeping kFlagNeedsSweeping set so that Free
+        // and Alloc will continue to leave the block alone.
+        m_needsSweeping = b->nextFree;
+        if (m_needsSweeping)
+            m_needsSweeping->prevFree = NULL;
+
+        int oldNumFree = b->numFree;
+        SweepGuts(b);
+        m_backgroundFreedItems += b->numFree - oldNumFree;
+
+        b->prevFree = NULL;
+        b->nextFree = m_swept;
+        if (m_swept)
+            m_swept->prevFree = b;
+        m_swept = b;
+        b->slowFlags |= kFlagSweptInBackground;
+        return true;
+    }
+#endif
+
+#ifdef MMGC_COMPACTION
+    bool GCAlloc::IsEvacuationCandidate(GCBlock* b, bool clearPins)
+    {
+        bool movable = !b->needsSweeping();
+        uint32_t numMarkedItems = 0;
+
+        gcbits_t* blockbits = b->bits;
+        for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
+        {
+            gcbits_t& marks = blockbits[GetBitsIndex(b,item)];
+            gcbits_t bits = marks;
+            if (clearPins)
+                marks &= ~kPinned;
+            else if (!movable)
+                break;
+
+            if ((bits & kFreelist) != kMark)
+                continue;
+
+            numMarkedItems++;
+            if ((bits & (kMovable|kPinned|kHasWeakRef|kSampled|kVirtualGCTrace)) != (kMovable|kVirtualGCTrace))
+                movable = false;
+        }
+        return movable && numMarkedItems > 0 && numMarkedItems * 100 <= uint32_t(m_itemsPerBlock) * kEvacuationMaxOccupancy;
+    }
+
+    uint32_t GCAlloc::CountEvacuationCandidates()
+    {
+        uint32_t n = 0;
+        for (GCBlock* b = m_firstBlock; b != NULL; b = Next(b)) {
+            if (IsEvacuationCandidate(b, false))
+                n++;
+        }
+        return n;
+    }
+
+    uint32_t GCAlloc::Evacuate(GCHashtable& forwarding, uint32_t& blocks)
+    {
+        GCAssert(m_gc->collecting && !m_finalized && m_qList == NULL);
+        GCAssert(containsPointers && !containsRCObjects && !containsFinalizedObjects);
+
+        // Take the candidates off the free list first so that none of them receives
+        // objects moved out of another.  They are chained through nextFree meanwhile.
+        GCBlock* candidates = NULL;
+        for (GCBlock* b = m_firstBlock; b != NULL; b = Next(b)) {
+            if (!IsEvacuationCandidate(b, true))
+                continue;
+            if (b->nextFree || b->prevFree || b == m_firstFree)
+                RemoveFromFreeList(b);
+            b->nextFree = candidates;
+            candidates = b;
+        }
+
+        uint32_t numMoved = 0;
+        bool outOfMemory = false;
+        while (candidates != NULL) {
+            GCBlock* b = candidates;
+            candidates = b->nextFree;
+            b->nextFree = NULL;
+
+            // An evacuated object is left unmarked, so LazySweepPass will see an empty
+            // block and free it.  If we run out of memory midway the remaining objects
+            // just stay where they are.
+            gcbits_t* blockbits = b->bits;
+            for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit && !outOfMemory ; item += m_itemSize )
+            {
+                gcbits_t& marks = blockbits[GetBitsIndex(b,item)];
+                if ((marks & kFreelist) != kMark)
+                    continue;
+
+                void* to = AllocForEvacuation();
+                if (to == NULL) {
+                    outOfMemory = true;
+                    break;
+                }
+                VMPI_memcpy(to, item, m_itemSize);
+                GCBlock* tob = GetBlock(to);
+                tob->bits[GetBitsIndex(tob, to)] = marks;
+                marks &= ~kMark;
+                forwarding.put(GetUserPointer(item), GetUserPointer(to));
+                numMoved++;
+            }
+            if (!outOfMemory)
+                blocks++;
+        }
+        return numMoved;
+    }
+
+    void* GCAlloc::AllocForEvacuation()
+    {
+        GCBlock* b = m_firstFree;
+        if (b == NULL) {
+            CreateChunk(GC::kCanFail);
+            b = m_firstFree;
+            if (b == NULL)
+                return NULL;
+        }
+        GCAssert(!b->needsSweeping());
+        GCAssert(b->firstFree != NULL);
+
+        void* item = FLPop(b->firstFree);
+        if (--b->numFree == 0)
+            RemoveFromFreeList(b);
+        m_totalAllocatedBytes += m_itemSize;
+
+        VALGRIND_MEMPOOL_ALLOC(b, item, m_itemSize);
+#ifdef MMGC_HOOKS
+        GCHeap* heap = GCHeap::GetGCHeap();
+        if (heap->HooksEnabled())
+            heap->AllocHook(GetUserPointer(item), 0, m_itemSize - DebugSize(), /*managed=*/true);
+#endif
+        return item;
+    }
+#endif
+
+    /*static*/
+    void GCAlloc::SetHasWeakRef(const void *realptr, bool flag)
+    {
+        GCBlock* b = GetBlock(realptr);
+        gcbits_t& bits = b->bits[GetBitsIndex(b, realptr)];
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // The background sweeper may be rewriting the bits of a block that needs sweeping.
+        if (b->needsSweeping()) {
+            MMGC_SWEEP_LOCK((GCAlloc*)b->alloc);
+            if (flag) {
+                bits |= kHasWeakRef;
+                b->slowFlags |= kFlagWeakRefs;
+            }
+            else
+                bits &= ~kHasWeakRef;
+            return;
+        }
+#endif
+        if (flag) {
+            bits |= kHasWeakRef;
+            // Small-object allocators maintain an extra flag
+            // about weak objects in a block, need to set that
+            // flag here.
+            b->slowFlags |= kFlagWeakRefs;
+        }
+        else
+            bits &= ~kHasWeakRef;
+    }
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+    // Once a block holds no sampled objects its frees can take the fast path again.
+    // Only called on blocks that do not need sweeping.
+    void GCAlloc::ClearSampledFlag(GCBlock* b)
+    {
+        GCAssert(!b->needsSweeping());
+        gcbits_t* blockbits = b->bits;
+        for ( char *item = b->items, *limit = b->items + m_itemSize * b->GetCount() ; item < limit ; item += m_itemSize )
+        {
+            if (blockbits[GetBitsIndex(b, item)] & kSampled)
+                return;
+        }
+        b->slowFlags &= ~kFlagSampled;
+    }
+
+    /*static*/
+    void GCAlloc::SetSampled(const void *realptr)
+    {
+        GCBlock* b = GetBlock(realptr);
+        gcbits_t& bits = b->bits[GetBitsIndex(b, realptr)];
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // See SetHasWeakRef.
+        if (b->needsSweeping()) {
+            MMGC_SWEEP_LOCK((GCAlloc*)b->alloc);
+            bits |= kSampled;
+            b->slowFlags |= kFlagSampled;
+            return;
+        }
+#endif
+        bits |= kSampled;
+        b->slowFlags |= kFlagSampled;
+    }
+#endif
     
     void GCAlloc::ClearMarks(GCAlloc::GCBlock* block)
     {
@@ -1244,6 +1559,10 @@ namespace MMgc
 #ifdef _DEBUG
     bool GCAlloc::IsOnEitherList(GCBlock *b)
     {
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (b == m_swept)
+            return true;
+#endif
         return b->nextFree != NULL || b->prevFree != NULL || b == m_firstFree || b == m_needsSweeping;
     }
     
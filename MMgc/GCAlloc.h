@@ -56,11 +56,11 @@ namespace MMgc
         kMark=1,                // object has been marked
         kQueued=2,              // object is on the mark or barrier queues
         kFinalizable=4,         // object's destructor must be called when the object is destroyed
-        kHasWeakRef=8,          // there's an entry for the object in the weakRefs table
-        kVirtualGCTrace = 16    // object derived from GCTraceableBase and has gcTrace override(s), see GCObject.h
-        // free: 32
-        // free: 64
-        // free: 128
+        kHasWeakRef=8,          // there's an entry for the object in the weakRefs table or its GCWeakRefSlots
+        kVirtualGCTrace = 16,   // object derived from GCTraceableBase and has gcTrace override(s), see GCObject.h
+        kMovable = 32,          // small object may be moved by compaction, see GC::SetMovable
+        kPinned = 64,           // movable object is referenced conservatively; only set while GC::Compact runs
+        kSampled = 128          // object is in the GCAllocationSampler's table of live samples
     };
 
     /**
@@ -108,6 +108,9 @@ namespace MMgc
         friend class GC;
         friend class GCAllocIterator;
         friend class ZCT;
+#ifdef MMGC_BACKGROUND_SWEEPING
+        friend class GCBackgroundSweeper;
+#endif
 
     public:
         // The destructor needs to be public because it is called explicitly by
@@ -140,7 +143,10 @@ namespace MMgc
 
         static void *FindBeginning(const void *item);
         static bool IsUnmarkedPointer(const void *val);
-        static void SetBlockHasWeakRef(const void *userptr);
+        static void SetHasWeakRef(const void *realptr, bool flag);
+#ifdef MMGC_ALLOCATION_SAMPLER
+        static void SetSampled(const void *realptr);
+#endif
 
         // Return the actual size of items managed by this allocator (includes debugging overheads)
         REALLY_INLINE uint32_t GetItemSize() { return m_itemSize; }
@@ -175,6 +181,16 @@ namespace MMgc
 
         const static short kFlagNeedsSweeping = 1;  // set if the block had finalized objects and needs to be swept
         const static short kFlagWeakRefs = 2;       // set if the block may have weak refs and we should check during free
+#ifdef MMGC_BACKGROUND_SWEEPING
+        const static short kFlagSweptInBackground = 4;  // set if the block is on m_swept; kFlagNeedsSweeping is also set
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        const static short kFlagSampled = 8;        // set if the block may have sampled objects and we should check during free
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+        void ClearSampledFlag(GCBlock* b);
+#endif
 
         // Objects on the free list all have a next pointer in the first word and
         // the object index within its block as the second word.  Only the low 16 bits
@@ -192,6 +208,9 @@ namespace MMgc
             uint8_t slowFlags;      // flags for special circumstances: kFlagNeedsSweeping, etc
             bool finalizeState:1;   // whether we've been visited during the Finalize stage
             char   *items;          // pointer to the array of objects in the block
+#ifdef MMGC_INLINE_WEAKREFS
+            GCWeakRefSlots* weakRefs;   // weak refs of objects in this block, or NULL (see GCWeakRefSlots)
+#endif
 
             int GetCount() const;
             void FreeSweptItem(const void *item, int index);
@@ -215,6 +234,21 @@ namespace MMgc
         // List of blocks that need sweeping
         GCBlock* m_needsSweeping;
 
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // List of blocks that need sweeping and whose bits and free lists have been swept
+        // by the background sweeper; Sweep() finishes the job on the mutator's thread.
+        GCBlock* m_swept;
+
+        // Number of items freed by the background sweeper that have not yet been
+        // subtracted from m_totalAllocatedBytes.
+        uint32_t m_backgroundFreedItems;
+
+        // Protects m_needsSweeping, m_swept, m_backgroundFreedItems, and the flags,
+        // bits, and free lists of blocks that need sweeping, against the background
+        // sweeper.  The mutator only takes it when it touches such a block.
+        vmpi_spin_lock_t m_sweepLock;
+#endif
+
         // Quick list of free objects.  See comment in GCAlloc.cpp for general information.
 
         void *m_qList;              // Linked list of some free objects for this allocator
@@ -309,6 +343,39 @@ namespace MMgc
         void ClearMarks(GCAlloc::GCBlock* block);
         void SweepNeedsSweeping();
 
+        // Sweep one block that needs sweeping so that AllocSlow can make progress.
+        // Returns false if there are no such blocks.
+        bool SweepForAllocation();
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // Called on the background sweeper's thread: sweep the bits and free list of one
+        // block that needs sweeping and move it to m_swept.  Returns false if there are
+        // no such blocks.
+        bool SweepInBackground();
+#endif
+
+#ifdef MMGC_COMPACTION
+        // A block is worth evacuating if at most kEvacuationMaxOccupancy percent of its
+        // objects are live and all of those are movable, exactly traced, unpinned, and
+        // without weak references or allocation samples.  If 'clearPins' is set the kPinned bits of the block
+        // are cleared on the way.
+        static const uint32_t kEvacuationMaxOccupancy = 25;
+        bool IsEvacuationCandidate(GCBlock* b, bool clearPins);
+
+        // Number of blocks Evacuate would empty if no objects were pinned.
+        uint32_t CountEvacuationCandidates();
+
+        // Called by GC::Compact after pinning: move the live objects out of all candidate
+        // blocks, add their old and new user pointers to 'forwarding', and clear all
+        // kPinned bits.  Returns the number of objects moved and adds the number of
+        // blocks emptied to 'blocks'; GC::Finalize frees those.
+        uint32_t Evacuate(GCHashtable& forwarding, uint32_t& blocks);
+
+        // Allocate the destination of an evacuated object without the quick list,
+        // returning NULL on OOM.  The caller sets the bits.
+        void* AllocForEvacuation();
+#endif
+
 #ifdef _DEBUG
         static bool IsPointerIntoGCObject(const void *item);
         static int ConservativeGetMark(const void *item, bool bogusPointerReturnValue);
@@ -359,6 +426,9 @@ namespace MMgc
 
         bool GetNextMarkedObject(void*& out_ptr);
 
+        // Like GetNextMarkedObject, but returns every object that is not on a free list.
+        bool GetNextLiveObject(void*& out_ptr);
+
     private:
         GCAlloc* const alloc;
         GCAlloc::GCBlock* block;
@@ -79,11 +79,28 @@ namespace MMgc
         gcbehavior(2),   // unconditional, if MMGC_POLICY_PROFILING is on
 #endif
         eagerSweeping(false),
+        backgroundSweeping(false),
 #ifdef MMGC_HEAP_GRAPH
         dumpFalsePositives(false),
 #endif
         gcLoadCeiling(1.15), // Bug 619885: need > 1.0 to get belt loosening effect
         gcEfficiency(0.25),
+        markThreads(1),
+        generational(false),
+        nurserySize(kDefaultNurserySize),
+        cardMarking(false),
+        hugePages(false),
+        compaction(false),
+        fixedMagazines(false),
+        gcPauseTarget(0),
+        gcMinUtilization(0.5),
+        stackMaps(false),
+        inlineWeakRefs(false),
+        allocationSampleInterval(0),
+        backgroundDecommit(false),
+        decommitDelay(kDefaultDecommitDelay),
+        decommitReserve(0),
+        incrementalReap(false),
         _checkFixedMemory(true) // See comment in GCHeap.h for why the default must be 'true'
     {
         // Bugzilla 544695 - large heaps need to be controlled more tightly than
@@ -125,7 +142,12 @@ namespace MMgc
             || !VMPI_strcmp(arg, "-load")
             || !VMPI_strcmp(arg, "-loadCeiling")
             || !VMPI_strcmp(arg, "-gcwork")
-            || !VMPI_strcmp(arg, "-gcstack"))
+            || !VMPI_strcmp(arg, "-gcstack")
+            || !VMPI_strcmp(arg, "-gcmarkthreads")
+            || !VMPI_strcmp(arg, "-gcnursery")
+            || !VMPI_strcmp(arg, "-gcpause")
+            || !VMPI_strcmp(arg, "-gcsample")
+            || !VMPI_strcmp(arg, "-gcdecommit"))
             return true;
         else
             return false;
@@ -196,6 +218,12 @@ namespace MMgc
             eagerSweeping = true;
             return true;
         }
+#ifdef MMGC_BACKGROUND_SWEEPING
+        else if (!VMPI_strcmp(arg, "-backgroundsweep")) {
+            backgroundSweeping = true;
+            return true;
+        }
+#endif
         else if (HasPrefix(arg, "-load") && !HasPrefix(arg, "-loadCeiling")) {
             const char *param =
                 useDefaultOrSkipForward(arg, "-load", successorString);
@@ -319,6 +347,190 @@ namespace MMgc
                 return true;
             }
         }
+#ifdef MMGC_PARALLEL_MARKING
+        else if (HasPrefix(arg, "-gcmarkthreads")) {
+            const char* param =
+                useDefaultOrSkipForward(arg, "-gcmarkthreads", successorString);
+            if (param == NULL) {
+                wrong = true;
+                return true;
+            }
+
+            int threads;
+            int nchar;
+            const char* val = param;
+            if (VMPI_sscanf(val, "%d%n", &threads, &nchar) == 1 && size_t(nchar) == VMPI_strlen(val) && threads >= 1 && threads <= int(kMaxMarkThreads)) {
+                markThreads = uint32_t(threads);
+                return true;
+            }
+            else {
+                wrong = true;
+                return true;
+            }
+        }
+#endif
+#ifdef MMGC_GENERATIONAL
+        else if (!VMPI_strcmp(arg, "-gcgenerational")) {
+            generational = true;
+            return true;
+        }
+        else if (HasPrefix(arg, "-gcnursery")) {
+            const char* param =
+                useDefaultOrSkipForward(arg, "-gcnursery", successorString);
+            if (param == NULL) {
+                wrong = true;
+                return true;
+            }
+
+            int kbytes;
+            int nchar;
+            const char* val = param;
+            if (VMPI_sscanf(val, "%d%n", &kbytes, &nchar) == 1 && size_t(nchar) == VMPI_strlen(val) && kbytes >= 1 && kbytes <= int(kMaxNurserySize / 1024)) {
+                nurserySize = uint32_t(kbytes) * 1024;
+                return true;
+            }
+            else {
+                wrong = true;
+                return true;
+            }
+        }
+#endif
+#ifdef MMGC_CARD_MARKING
+        else if (!VMPI_strcmp(arg, "-gccardbarrier")) {
+            cardMarking = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_HUGE_PAGES
+        else if (!VMPI_strcmp(arg, "-gchugepages")) {
+            hugePages = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_COMPACTION
+        else if (!VMPI_strcmp(arg, "-gccompact")) {
+            compaction = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        else if (!VMPI_strcmp(arg, "-fixedmagazines")) {
+            fixedMagazines = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_PAUSE_TARGET
+        else if (HasPrefix(arg, "-gcpause")) {
+            const char* param =
+                useDefaultOrSkipForward(arg, "-gcpause", successorString);
+            if (param == NULL) {
+                wrong = true;
+                return true;
+            }
+
+            double target;
+            double utilization;
+            int nchar;
+            const char* val = param;
+            if (VMPI_sscanf(val, "%lf,%lf%n", &target, &utilization, &nchar) == 2 &&
+                size_t(nchar) == VMPI_strlen(val) &&
+                target > 0.0 &&
+                utilization >= 0.0 && utilization < 1.0)
+            {
+                gcPauseTarget = target;
+                gcMinUtilization = utilization;
+                return true;
+            }
+            else if (VMPI_sscanf(val, "%lf%n", &target, &nchar) == 1 &&
+                     size_t(nchar) == VMPI_strlen(val) &&
+                     target > 0.0)
+            {
+                gcPauseTarget = target;
+                return true;
+            }
+            else {
+                wrong = true;
+                return true;
+            }
+        }
+#endif
+#ifdef MMGC_STACK_MAPS
+        else if (!VMPI_strcmp(arg, "-gcstackmaps")) {
+            stackMaps = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_INLINE_WEAKREFS
+        else if (!VMPI_strcmp(arg, "-gcweakslots")) {
+            inlineWeakRefs = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        else if (HasPrefix(arg, "-gcsample")) {
+            const char* param =
+                useDefaultOrSkipForward(arg, "-gcsample", successorString);
+            if (param == NULL) {
+                wrong = true;
+                return true;
+            }
+
+            int kbytes;
+            int nchar;
+            const char* val = param;
+            if (VMPI_sscanf(val, "%d%n", &kbytes, &nchar) == 1 && size_t(nchar) == VMPI_strlen(val) && kbytes >= 1 && kbytes <= 1024*1024) {
+                allocationSampleInterval = uint32_t(kbytes) * 1024;
+                return true;
+            }
+            else {
+                wrong = true;
+                return true;
+            }
+        }
+#endif
+#ifdef MMGC_INCREMENTAL_REAP
+        else if (!VMPI_strcmp(arg, "-gcincrementalreap")) {
+            incrementalReap = true;
+            return true;
+        }
+#endif
+#ifdef MMGC_BACKGROUND_DECOMMIT
+        else if (HasPrefix(arg, "-gcdecommit")) {
+            const char* param =
+                useDefaultOrSkipForward(arg, "-gcdecommit", successorString);
+            if (param == NULL) {
+                wrong = true;
+                return true;
+            }
+
+            int kbytes;
+            int millis;
+            int nchar;
+            const char* val = param;
+            if (VMPI_sscanf(val, "%d,%d%n", &kbytes, &millis, &nchar) == 2 &&
+                size_t(nchar) == VMPI_strlen(val) &&
+                kbytes >= 0 && kbytes <= 1024*1024 &&
+                millis >= 0 && millis <= 60*60*1000)
+            {
+                backgroundDecommit = true;
+                decommitReserve = size_t(kbytes) * 1024;
+                decommitDelay = uint32_t(millis);
+                return true;
+            }
+            else if (VMPI_sscanf(val, "%d%n", &kbytes, &nchar) == 1 &&
+                     size_t(nchar) == VMPI_strlen(val) &&
+                     kbytes >= 0 && kbytes <= 1024*1024)
+            {
+                backgroundDecommit = true;
+                decommitReserve = size_t(kbytes) * 1024;
+                return true;
+            }
+            else {
+                wrong = true;
+                return true;
+            }
+        }
+#endif
 
         // arg unmatched; option not handled here.
         return false;
@@ -351,6 +563,21 @@ namespace MMgc
         return leakedBytes;
     }
 
+    static inline size_t alignmentSlop(char* baseAddr, size_t alignment);
+
+    // The huge page size in blocks, or 0 if the OS offers no huge pages or
+    // their size is not a power-of-two multiple of kBlockSize.
+    static size_t ComputeHugePageBlocks()
+    {
+#ifdef MMGC_HUGE_PAGES
+        size_t hugePageSize = AVMPI_getHugePageSize();
+        size_t blocks = hugePageSize / GCHeap::kBlockSize;
+        if (blocks > 1 && blocks * GCHeap::kBlockSize == hugePageSize && (blocks & (blocks - 1)) == 0)
+            return blocks;
+#endif
+        return 0;
+    }
+
     GCHeap::GCHeap(const GCHeapConfig& c)
         : kNativePageSize(VMPI_getVMPageSize()),
           lastRegion(NULL),
@@ -370,6 +597,10 @@ namespace MMgc
           preventDestruct(0),
           m_oomHandling(true),
           m_notificationBeingSent(false),
+          lastRecommitTicks(0),
+#ifdef MMGC_BACKGROUND_DECOMMIT
+          decommitter(NULL),
+#endif
     #ifdef MMGC_MEMORY_PROFILER
           hasSpy(false),
     #endif
@@ -378,6 +609,7 @@ namespace MMgc
           maxPrivateMemory(0),
     #endif
           largeAllocs(0),
+          hugePageBlocks(ComputeHugePageBlocks()),
     #ifdef MMGC_HOOKS
           hooksEnabled(false),
     #endif
@@ -386,6 +618,10 @@ namespace MMgc
     {
         VMPI_lockInit(&m_spinlock);
         VMPI_lockInit(&gclog_spinlock);
+#ifdef MMGC_EVENT_STREAM
+        eventWriter = NULL;
+        VMPI_lockInit(&eventWriterLock);
+#endif
 
         // ResetStatics should be called at the start here before using/initializing any statics
         ResetStatics();
@@ -410,6 +646,13 @@ namespace MMgc
 
         instance = this;
 
+        VMPI_memset(&commitStats, 0, sizeof(commitStats));
+#ifdef MMGC_BACKGROUND_DECOMMIT
+        // Hosts may set config.backgroundDecommit after Init, so the decommitter always
+        // exists; its helper thread is only started when there is a surplus to release.
+        decommitter = new GCBackgroundDecommitter(this);
+#endif
+
 #ifdef MMGC_MEMORY_PROFILER
         //create profiler if turned on and if it is not already created
         if(!IsProfilerInitialized())
@@ -435,6 +678,13 @@ namespace MMgc
 
     void GCHeap::DestroyInstance()
     {
+#ifdef MMGC_BACKGROUND_DECOMMIT
+        // Stop the helper before anything it touches goes away.
+        if (decommitter != NULL) {
+            delete decommitter;
+            decommitter = NULL;
+        }
+#endif
 #ifdef MMGC_MEMORY_PROFILER
         if (profiler) 
             profiler->DumpAllocationProfile();
@@ -446,6 +696,9 @@ namespace MMgc
         gcManager.destroy();
         callbacks.Destroy();
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        fixedMalloc.DestroyThreadCaches();
+#endif
         leakedBytes = GetFixedMalloc()->GetBytesInUse();
         fixedMalloc.DestroyInstance();
         GCAssertMsg(leakedBytes == 0 || GetStatus() == kMemAbort, "Leaks!");
@@ -499,6 +752,9 @@ namespace MMgc
         VMPI_lockAcquire(&gclog_spinlock);
         VMPI_lockRelease(&gclog_spinlock);
         VMPI_lockDestroy(&gclog_spinlock);
+#ifdef MMGC_EVENT_STREAM
+        VMPI_lockDestroy(&eventWriterLock);
+#endif
 
         if(enterFrame)
             enterFrame->Destroy();  // Destroy the pointed-to value
@@ -736,37 +992,95 @@ namespace MMgc
         // commit if > kDecommitThresholdPercentage is free
         if(FreeMemoryExceedsDecommitThreshold())
         {
-            decommitSize = int((freeSize * 100 - heapSize * kDecommitThresholdPercentage) / 100);
+#ifdef MMGC_BACKGROUND_DECOMMIT
+            // A surplus that is not due to a limit is left for the helper, which only
+            // releases it if the heap does not need it again in the meantime.
+            if (config.backgroundDecommit && decommitter != NULL && status == kMemNormal)
+            {
+                if (DecommitSurplus() > 0)
+                    decommitter->Request();
+                return;
+            }
+#endif
+            decommitSize = DecommitSurplus();
+            if (decommitSize == 0)
+                return;
         }
-        //  If we're over the heapLimit, attempt to decommit enough to get just under the limit
-        else if ( (heapSize > config.heapLimit) && ((heapSize - freeSize) < config.heapLimit))
+        else
         {
-            decommitSize = heapSize - config.heapLimit + 1;
+            //  If we're over the heapLimit, attempt to decommit enough to get just under the limit
+            if ( (heapSize > config.heapLimit) && ((heapSize - freeSize) < config.heapLimit))
+            {
+                decommitSize = heapSize - config.heapLimit + 1;
 
-        }
-        //  If we're over the SoftLimit, attempt to decommit enough to get just under the softLimit
-        else if ((config.heapSoftLimit!= 0) &&  (heapSize > config.heapSoftLimit) && ((heapSize - freeSize) < config.heapSoftLimit))
-        {
-            decommitSize = heapSize - config.heapSoftLimit + 1;
-        }
-        else {
-            return;
+            }
+            //  If we're over the SoftLimit, attempt to decommit enough to get just under the softLimit
+            else if ((config.heapSoftLimit!= 0) &&  (heapSize > config.heapSoftLimit) && ((heapSize - freeSize) < config.heapSoftLimit))
+            {
+                decommitSize = heapSize - config.heapSoftLimit + 1;
+            }
+            else {
+                return;
+            }
+
+            if ((decommitSize < (size_t)kMinHeapIncrement) && (freeSize > (size_t)kMinHeapIncrement))
+            {
+
+                decommitSize = kMinHeapIncrement;
+            }
+
+            //  Don't decommit more than our initial config size.
+            if (heapSize - decommitSize < config.initialSize)
+            {
+                decommitSize = heapSize - config.initialSize;
+            }
         }
 
-        if ((decommitSize < (size_t)kMinHeapIncrement) && (freeSize > (size_t)kMinHeapIncrement))
-        {
 
+        MMGC_LOCK(m_spinlock);
+
+        DecommitBlocks(decommitSize);
+
+        if(config.verbose)
+            DumpHeapRep();
+        CheckForStatusReturnToNormal();
+    }
+
+    GCHeap::CommitStats GCHeap::GetCommitStats()
+    {
+        MMGC_LOCK(m_spinlock);
+        return commitStats;
+    }
+
+    size_t GCHeap::DecommitSurplus()
+    {
+        if (!FreeMemoryExceedsDecommitThreshold())
+            return 0;
+
+        size_t heapSize = GetTotalHeapSize();
+        size_t freeSize = GetFreeHeapSize();
+        size_t decommitSize = (freeSize * 100 - heapSize * kDecommitThresholdPercentage) / 100;
+
+        if ((decommitSize < (size_t)kMinHeapIncrement) && (freeSize > (size_t)kMinHeapIncrement))
             decommitSize = kMinHeapIncrement;
-        }
 
         //  Don't decommit more than our initial config size.
         if (heapSize - decommitSize < config.initialSize)
-        {
-            decommitSize = heapSize - config.initialSize;
-        }
+            decommitSize = heapSize > config.initialSize ? heapSize - config.initialSize : 0;
 
+        //  Nor into the reserve of committed free memory.
+        size_t reserve = config.decommitReserve / kBlockSize;
+        if (freeSize < reserve + decommitSize)
+            decommitSize = freeSize > reserve ? freeSize - reserve : 0;
 
-        MMGC_LOCK(m_spinlock);
+        return decommitSize;
+    }
+
+    // m_spinlock is held
+    void GCHeap::DecommitBlocks(size_t decommitSize)
+    {
+        size_t heapSize = GetTotalHeapSize();
+        size_t freeSize = GetFreeHeapSize();
 
     restart:
 
@@ -796,7 +1110,42 @@ namespace MMgc
 
                 if(config.useVirtualMemory)
                 {
+#ifdef MMGC_HUGE_PAGES
+                    // In huge-page mode only whole, aligned huge pages are
+                    // decommitted; decommitting part of one would make the OS
+                    // split it back into small pages.
+                    const size_t hugePage = HugePageBlocks();
+                    size_t hugeSlop = 0, hugeAvail = 0;
+                    if(hugePage != 0)
+                    {
+                        hugeSlop = alignmentSlop(block->baseAddr, hugePage);
+                        if(hugeSlop < (size_t)block->size)
+                            hugeAvail = ((block->size - hugeSlop) / hugePage) * hugePage;
+                        if(hugeAvail == 0)
+                            continue;
+                    }
+#endif
                     RemoveFromList(block);
+#ifdef MMGC_HUGE_PAGES
+                    if(hugePage != 0)
+                    {
+                        if(hugeSlop != 0)
+                        {
+                            HeapBlock *newBlock = Split(block, hugeSlop);
+                            AddToFreeList(block);
+                            block = newBlock;
+                        }
+                        size_t hugeSize = hugeAvail;
+                        if(decommitSize < hugeAvail)
+                            hugeSize = ((decommitSize + hugePage - 1) / hugePage) * hugePage;
+                        if((size_t)block->size > hugeSize)
+                        {
+                            HeapBlock *newBlock = Split(block, hugeSize);
+                            AddToFreeList(newBlock);
+                        }
+                    }
+                    else
+#endif
                     if((size_t)block->size > decommitSize)
                     {
                         HeapBlock *newBlock = Split(block, (int)decommitSize);
@@ -823,7 +1172,9 @@ namespace MMgc
                             AddToFreeList(newBlock);
                         }
 
-                        decommitSize -= block->size;
+                        decommitSize -= (size_t)block->size < decommitSize ? block->size : decommitSize;
+                        commitStats.decommitCalls++;
+                        commitStats.decommitBlocks += block->size;
                         RemoveBlock(block);
                         goto restart;
                     }
@@ -831,7 +1182,8 @@ namespace MMgc
                     {
                         block->committed = false;
                         block->dirty = false;
-                        decommitSize -= block->size;
+                        commitStats.decommitCalls++;
+                        decommitSize -= (size_t)block->size < decommitSize ? block->size : decommitSize;
                         if(config.verbose) {
                             GCLog("decommitted %d page block from %p\n", block->size, block->baseAddr);
                         }
@@ -849,6 +1201,7 @@ namespace MMgc
                     }
 
                     numDecommitted += block->size;
+                    commitStats.decommitBlocks += block->size;
 
                     // merge with previous/next if not in use and not committed
                     HeapBlock *prev = block - block->sizePrevious;
@@ -909,10 +1262,6 @@ namespace MMgc
                 }
             }
         }
-
-        if(config.verbose)
-            DumpHeapRep();
-        CheckForStatusReturnToNormal();
     }
 
     // m_spinlock is held
@@ -1316,6 +1665,27 @@ namespace MMgc
 
     REALLY_INLINE char *GCHeap::ReserveSomeRegion(size_t sizeInBytes)
     {
+#ifdef MMGC_HUGE_PAGES
+        if (HugePageBlocks() != 0)
+        {
+            // Over-reserve to find a huge-page aligned address, then reserve
+            // exactly the request there.  Another thread may grab the range
+            // between the release and the second reserve; just fall back to
+            // an unaligned region then.
+            size_t hugePageSize = HugePageBlocks() * kBlockSize;
+            char *addr = (char*)AVMPI_reserveMemoryRegion(NULL, sizeInBytes + hugePageSize);
+            if (addr != NULL)
+            {
+                char *alignedAddr = addr + alignmentSlop(addr, HugePageBlocks()) * kBlockSize;
+                AVMPI_releaseMemoryRegion(addr, sizeInBytes + hugePageSize);
+                addr = (char*)AVMPI_reserveMemoryRegion(alignedAddr, sizeInBytes);
+                if (addr == alignedAddr)
+                    return addr;
+                if (addr != NULL)
+                    AVMPI_releaseMemoryRegion(addr, sizeInBytes);
+            }
+        }
+#endif
 #ifdef DEBUG
         if (!config.dispersiveAdversarial)
             return (char*)AVMPI_reserveMemoryRegion(NULL, sizeInBytes);
@@ -1333,6 +1703,11 @@ namespace MMgc
         
         size_t sizeInBytes = size * kBlockSize;
 
+        // Start large objects on a huge page so that all but their tail can be
+        // backed by huge pages.
+        if (HugePageBlocks() > alignment && size >= HugePageBlocks())
+            alignment = HugePageBlocks();
+
         if(!EnsureFreeRegion(true))
             return NULL;
 
@@ -1352,7 +1727,7 @@ namespace MMgc
         }
 
         char *alignedAddr = addr + alignmentSlop(addr, alignment) * kBlockSize;
-        if(!AVMPI_commitMemory(alignedAddr, sizeInBytes)) {
+        if(!CommitMemory(alignedAddr, sizeInBytes)) {
             AVMPI_releaseMemoryRegion(addr, sizeInBytes);
             return NULL;
         }
@@ -1586,6 +1961,16 @@ namespace MMgc
         size_t toCommit = request > kMinHeapIncrement ? request : kMinHeapIncrement;
         size_t leftOver = available - request;
 
+#ifdef MMGC_HUGE_PAGES
+        // Keep the committed part ending on a huge page boundary so the
+        // decommitted remainder doesn't split a huge page.
+        if (HugePageBlocks() != 0 && leftOver > 0)
+        {
+            size_t slop = alignmentSlop(block->baseAddr + (block->size - leftOver) * kBlockSize, HugePageBlocks());
+            leftOver = slop < leftOver ? leftOver - slop : 0;
+        }
+#endif
+
         if (available > toCommit && leftOver > 0)
         {
             HeapBlock *newBlock = Split(block, block->size - leftOver);
@@ -1613,7 +1998,7 @@ namespace MMgc
     {
         GCAssert(config.sloppyCommit || !block->committed);
 
-        if(!AVMPI_commitMemory(block->baseAddr, block->size * kBlockSize))
+        if(!CommitMemory(block->baseAddr, block->size * kBlockSize))
         {
             GCAssert(false);
         }
@@ -1622,10 +2007,29 @@ namespace MMgc
             DumpHeapRep();
         }
         numDecommitted -= block->size;
+        commitStats.recommitCalls++;
+        commitStats.recommitBlocks += block->size;
+        lastRecommitTicks = VMPI_getPerformanceCounter();
         block->committed = true;
         block->dirty = AVMPI_areNewPagesDirty();
     }
 
+    bool GCHeap::CommitMemory(void *address, size_t size)
+    {
+#ifdef MMGC_HUGE_PAGES
+        if (HugePageBlocks() != 0)
+            return AVMPI_commitHugePageMemory(address, size);
+#endif
+        return AVMPI_commitMemory(address, size);
+    }
+
+    size_t GCHeap::HugePageBlocks() const
+    {
+        // config.hugePages may be set by the host after the initial region was
+        // allocated, so this is checked on every use rather than cached.
+        return config.hugePages && config.useVirtualMemory ? hugePageBlocks : 0;
+    }
+
 #ifdef _DEBUG
     // Non-debug version in GCHeap.h
     void GCHeap::CheckFreelist()
@@ -1897,8 +2301,10 @@ namespace MMgc
         bool contiguous = false;
         size_t commitAvail = 0;
 
-        // Round up to the nearest kMinHeapIncrement
-        size = roundUp(size, kMinHeapIncrement);
+        // Round up to the nearest kMinHeapIncrement, or to whole huge pages in
+        // huge-page mode so that regions end on a huge page boundary.
+        const size_t heapIncrement = HugePageBlocks() > (size_t)kMinHeapIncrement ? HugePageBlocks() : (size_t)kMinHeapIncrement;
+        size = roundUp(size, heapIncrement);
 
         // when we allocate a new region the space needed for the HeapBlocks, if it won't fit
         // in existing space it must fit in new space so we may need to increase the new space
@@ -1919,7 +2325,7 @@ namespace MMgc
             while(newHeapBlocksSize > curHeapBlocksSize)
             {
                 // use askSize so HeapBlock's can fit in rounding slop
-                size = roundUp(askSize + newHeapBlocksSize + extraBlocks, kMinHeapIncrement);
+                size = roundUp(askSize + newHeapBlocksSize + extraBlocks, heapIncrement);
 
                 // tells us use new memory for blocks below
                 newBlocks = NULL;
@@ -1945,7 +2351,7 @@ namespace MMgc
                 // Can this request be satisfied purely by committing more memory that
                 // is already reserved?
                 if (size <= commitAvail) {
-                    if (AVMPI_commitMemory(region->commitTop, size * kBlockSize))
+                    if (CommitMemory(region->commitTop, size * kBlockSize))
                     {
                         // Succeeded!
                         baseAddr = region->commitTop;
@@ -2003,7 +2409,7 @@ namespace MMgc
 
                     // Commit available space from the existing region.
                     if (commitAvail != 0) {
-                        if (!AVMPI_commitMemory(region->commitTop, commitAvail * kBlockSize))
+                        if (!CommitMemory(region->commitTop, commitAvail * kBlockSize))
                         {
                             // We couldn't commit even this space.  We're doomed.
                             // Un-reserve the space we just reserved and fail.
@@ -2013,7 +2419,7 @@ namespace MMgc
                     }
 
                     // Commit needed space from the new region.
-                    if (!AVMPI_commitMemory(newRegionAddr, (size - commitAvail) * kBlockSize))
+                    if (!CommitMemory(newRegionAddr, (size - commitAvail) * kBlockSize))
                     {
                         // We couldn't commit this space.  We can't meet the
                         // request.  Un-commit any memory we just committed,
@@ -2068,7 +2474,7 @@ namespace MMgc
             }
 
             // - Try to commit the memory.
-            if (AVMPI_commitMemory(newRegionAddr,
+            if (CommitMemory(newRegionAddr,
                              size*kBlockSize) == 0)
             {
                 // Failed.  Un-reserve the memory and fail.
@@ -2617,6 +3023,14 @@ namespace MMgc
             }
         }
 
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        // Leaving the outermost frame: the thread may be about to exit, so it must not
+        // keep FixedMalloc objects.  Done before EnterLock as flushing may enter GCHeap.
+        EnterFrame* outer = enterFrame;
+        if (outer == NULL || outer->Previous() == NULL)
+            fixedMalloc.ReleaseThreadCache();
+#endif
+
         EnterLock();
 
         // do this after StatusChangeNotify it affects ShouldNotEnter
@@ -2644,8 +3058,33 @@ namespace MMgc
         }
     }
 
+    size_t GCHeap::GetHugePageBackedSize()
+    {
+        size_t bytes = 0;
+#ifdef MMGC_HUGE_PAGES
+        if (HugePageBlocks() != 0)
+        {
+            MMGC_LOCK(m_spinlock);
+            for (Region *r = lastRegion; r != NULL; r = r->prev)
+            {
+                // A mapping the OS reports can span adjacent regions, so clamp
+                // to the region to avoid counting it twice.
+                size_t committed = r->commitTop - r->baseAddr;
+                size_t backed = AVMPI_getHugePageBackedSize(r->baseAddr, committed);
+                bytes += backed < committed ? backed : committed;
+            }
+        }
+#endif
+        return bytes;
+    }
+
     void GCHeap::DumpMemoryInfo()
     {
+        size_t hugePageBacked = GetHugePageBackedSize();
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        uint64_t magazineOps, magazineLocks;
+        fixedMalloc.GetMagazineStats(magazineOps, magazineLocks);
+#endif
         MMGC_LOCK(m_spinlock);
         size_t priv = AVMPI_getPrivateResidentPageCount() * VMPI_getVMPageSize();
         size_t mmgc = GetTotalHeapSize() * GCHeap::kBlockSize;
@@ -2697,6 +3136,8 @@ namespace MMgc
             log_percentage("[mem]\t\t unmanaged", unmanaged, priv);
             log_percentage("[mem]\t\t managed", gc_total, priv);
             log_percentage("[mem]\t\t free",  (size_t)GetFreeHeapSize() * GCHeap::kBlockSize, priv);
+            if (HugePageBlocks() != 0)
+                log_percentage("[mem]\t\t huge-page backed", hugePageBacked, mmgc);
             log_percentage("[mem]\t other",  priv - mmgc, priv);
             log_percentage("[mem] \tunmanaged overhead ", unmanaged-fixed_alloced, unmanaged);
             log_percentage("[mem] \tmanaged overhead ", gc_total - gc_allocated_total, gc_total);
@@ -2708,6 +3149,21 @@ namespace MMgc
             }
 #endif
             GCLog("[mem] number of collectors %u\n", unsigned(gc_count));
+            GCLog("[mem] commit churn: %llu decommits (%llu KB), %llu recommits (%llu KB)",
+                  (unsigned long long)commitStats.decommitCalls,
+                  (unsigned long long)commitStats.decommitBlocks * (kBlockSize / 1024),
+                  (unsigned long long)commitStats.recommitCalls,
+                  (unsigned long long)commitStats.recommitBlocks * (kBlockSize / 1024));
+            if (config.backgroundDecommit)
+                GCLog(", %llu KB decommitted in the background",
+                      (unsigned long long)commitStats.backgroundBlocks * (kBlockSize / 1024));
+            GCLog("\n");
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+            if (config.fixedMagazines)
+                GCLog("[mem] FixedMalloc magazines: %llu operations, %llu lock acquisitions (%.1f%%)\n",
+                      (unsigned long long)magazineOps, (unsigned long long)magazineLocks,
+                      magazineOps == 0 ? 0.0 : magazineLocks * 100.0 / magazineOps);
+#endif
         }
 #ifdef MMGC_MEMORY_PROFILER
         else
@@ -3024,6 +3480,21 @@ namespace MMgc
         callbacks.Remove(p);
     }
 
+#ifdef MMGC_EVENT_STREAM
+    void GCHeap::SetEventWriter(GCEventWriter* writer)
+    {
+        MMGC_LOCK(eventWriterLock);
+        eventWriter = writer;
+    }
+
+    void GCHeap::WriteEvent(const char* record)
+    {
+        MMGC_LOCK(eventWriterLock);
+        if (eventWriter != NULL)
+            eventWriter->write(record);
+    }
+#endif
+
     bool GCHeap::EnsureFreeRegion(bool allowExpansion)
     {
         if(!HaveFreeRegion()) {
@@ -11,6 +11,43 @@ namespace avmplus { namespace ST_mmgc_gcoption { class ST_mmgc_gcoption; } };
 
 namespace MMgc
 {
+#ifdef MMGC_BACKGROUND_DECOMMIT
+    class GCBackgroundDecommitter;
+#endif
+
+#ifdef MMGC_EVENT_STREAM
+    /**
+     * Receiver for the GC event stream, subclass and call GCHeap::SetEventWriter.
+     *
+     * Each record is a single JSON object without a trailing newline, so a writer that
+     * appends one newline per record produces a JSON-lines file.  Every GC phase that
+     * the policy manager times produces a "phase" record, and every completed collection
+     * a "collection" record:
+     *
+     *   {"type":"phase","gc":"0x..","collection":3,"phase":"IncrementalMark",
+     *    "start_us":..,"end_us":..,"duration_us":..}
+     *   {"type":"collection","gc":"0x..","collection":3,"start_us":..,"end_us":..,
+     *    "gc_us":..,"max_pause_us":..,"bytes_allocated":..,
+     *    "pause_histogram":{"bounds_us":[100,..],"counts":[..]}}
+     *
+     * ReapZCT phase records also carry "objects_reaped" and "bytes_reaped", and
+     * FinalizeAndSweep records carry "bytes_marked", "bytes_before_sweep",
+     * "bytes_after_sweep", "bytes_swept" and "heap_blocks".  Timestamps are in
+     * microseconds on the VMPI_getPerformanceCounter clock.  The histogram counts every
+     * pause of the collector since it was created; the last bucket is unbounded.
+     * The same records are written to an active telemetry session as ".gc.Event".
+     *
+     * Calls to write() are serialized by the GCHeap but may come from any thread that
+     * runs a collector.
+     */
+    class GCEventWriter
+    {
+    public:
+        virtual ~GCEventWriter() {}
+        virtual void write(const char* record) = 0;
+    };
+#endif
+
     class GCHeapConfig
     {
     public:
@@ -60,6 +97,10 @@ namespace MMgc
 
         static const size_t kNumLoadFactors = 7;
         static const size_t kDefaultHeapLimit = (size_t)-1;
+        static const uint32_t kMaxMarkThreads = 8;
+        static const uint32_t kDefaultNurserySize = 1024*1024;
+        static const uint32_t kMaxNurserySize = 1024*1024*1024;
+        static const uint32_t kDefaultDecommitDelay = 1000;
 
         size_t initialSize;
         /**
@@ -136,6 +177,7 @@ namespace MMgc
         bool autoGCStats;
         int32_t gcbehavior;     // Print gross history and policy decisions (MMGC_POLICY_PROFILING): 0=off, 1=at end, 2=after every gc and at end
         bool eagerSweeping;     // Enable full-heap sweeping at the end of Sweep()
+        bool backgroundSweeping; // Sweep blocks of non-finalized objects on a helper thread after Sweep() (MMGC_BACKGROUND_SWEEPING)
 #ifdef MMGC_HEAP_GRAPH
         bool dumpFalsePositives;
 #endif
@@ -143,6 +185,22 @@ namespace MMgc
         double gcLoadCutoff[kNumLoadFactors]; // Heap sizes (MB) following GC below which the corresponding load factor applies, last entry is +infinity
         double gcLoadCeiling;   // Max multiple of gcLoad policy should use after adjusting L for various factors (0=unlimited)
         double gcEfficiency;    // Max fraction of time to spend in the collector while the incremental collector is active
+        uint32_t markThreads;   // Number of threads used for non-incremental marking (MMGC_PARALLEL_MARKING), 1=serial
+        bool generational;      // Run nursery collections between full collections (MMGC_GENERATIONAL)
+        uint32_t nurserySize;   // Bytes allocated between nursery collections (MMGC_GENERATIONAL)
+        bool cardMarking;       // Write barrier dirties cards that are rescanned at the end of marking (MMGC_CARD_MARKING)
+        bool hugePages;         // Align regions to huge pages and advise the OS to back them with huge pages (MMGC_HUGE_PAGES)
+        bool compaction;        // Evacuate movable objects out of sparse blocks during full collections (MMGC_COMPACTION)
+        bool fixedMagazines;    // Threads inside MMGC_ENTER cache free FixedMalloc objects per size class (MMGC_FIXEDMALLOC_MAGAZINES)
+        double gcPauseTarget;   // Max GC pause in milliseconds the policy should aim for, 0=no target (MMGC_PAUSE_TARGET)
+        double gcMinUtilization; // Min fraction of time left to the mutator around each pause when gcPauseTarget is set (MMGC_PAUSE_TARGET)
+        bool stackMaps;         // Scan frames described by the host's GCStackMaps precisely, the rest of the stack conservatively (MMGC_STACK_MAPS)
+        bool inlineWeakRefs;    // Find weak refs through per-block slot arrays rather than the weakRefs hashtable (MMGC_INLINE_WEAKREFS)
+        uint32_t allocationSampleInterval; // Mean bytes allocated between allocation samples, 0=no sampling (MMGC_ALLOCATION_SAMPLER)
+        bool backgroundDecommit; // Release surplus free memory on a helper thread once it has outlived decommitDelay (MMGC_BACKGROUND_DECOMMIT)
+        uint32_t decommitDelay; // Milliseconds a surplus of free memory must persist before the helper releases it (MMGC_BACKGROUND_DECOMMIT)
+        size_t decommitReserve; // Bytes of committed free memory Decommit() leaves in place once the heap is past its threshold
+        bool incrementalReap;   // Reap the ZCT in time-bounded slices scheduled by the policy manager (MMGC_INCREMENTAL_REAP)
         
     private:
         bool _checkFixedMemory;
@@ -543,12 +601,42 @@ namespace MMgc
          */
         size_t GetTotalHeapSize() const;
 
+        /**
+         * Returns the number of bytes of committed heap memory that the OS
+         * currently backs with huge pages.  This asks the OS and may be slow;
+         * it is meant for reporting only.
+         * @return 0 unless GCHeapConfig::hugePages is set (MMGC_HUGE_PAGES)
+         */
+        size_t GetHugePageBackedSize();
+
         /**
          * gives memory back to the OS when there hasn't been any memory activity in a while
-         * and we have lots of free memory
+         * and we have lots of free memory.  With GCHeapConfig::backgroundDecommit set, a
+         * surplus that is not due to a heap limit is only noted here and released later
+         * by the background decommitter.
          */
         void Decommit();
 
+        /**
+         * Counters for the churn between decommitting free memory and committing it again.
+         * "decommits" and "recommits" count the blocks passed to the OS calls, "recommits"
+         * only those that had been decommitted before; "background" counts the blocks
+         * released by the background decommitter.
+         */
+        struct CommitStats
+        {
+            uint64_t decommitCalls;
+            uint64_t decommitBlocks;
+            uint64_t recommitCalls;
+            uint64_t recommitBlocks;
+            uint64_t backgroundBlocks;
+        };
+
+        /**
+         * @return the commit/decommit counters since the heap was created.
+         */
+        CommitStats GetCommitStats();
+
         void PreventDestruct();
         void AllowDestruct();
 
@@ -587,6 +675,18 @@ namespace MMgc
 
         void RemoveOOMCallback(OOMCallback *p);
 
+#ifdef MMGC_EVENT_STREAM
+        // Install (or with NULL, remove) the receiver of the GC event stream.  The
+        // writer is not owned by the heap and must be removed before it is destroyed.
+        void SetEventWriter(GCEventWriter* writer);
+
+        // Returns the current event writer, or NULL.
+        GCEventWriter* GetEventWriter() { return eventWriter; }
+
+        // Hand one record to the event writer, if there is one.
+        void WriteEvent(const char* record);
+#endif
+
         // Signal a failure to allocate 'size' bytes from the system heap (VMPI_alloc
         // or other internal allocation).  The value 'attempt' denotes the number of
         // previous attempts made to satisfy this particular memory request; the
@@ -888,6 +988,22 @@ namespace MMgc
 
         void Commit(HeapBlock *block);
 
+        // Blocks of committed free memory that Decommit() would release for being over
+        // kDecommitThresholdPercentage, after leaving config.decommitReserve in place.
+        size_t DecommitSurplus();
+
+        // Decommit up to decommitSize blocks from the back of the free lists.
+        // m_spinlock is held.
+        void DecommitBlocks(size_t decommitSize);
+
+        // Commit memory within a reserved region, advising the OS to use huge
+        // pages for it when huge-page mode is on.
+        bool CommitMemory(void *address, size_t size);
+
+        // The huge page size in blocks when huge-page mode is on, otherwise 0.
+        // Regions, large allocations and decommits are aligned to this size.
+        size_t HugePageBlocks() const;
+
         HeapBlock *InteriorAddrToBlock(const void *item) const;
         HeapBlock *BaseAddrToBlock(const void *item) const;
         Region *AddrToRegion(const void *item) const;
@@ -981,7 +1097,17 @@ namespace MMgc
         uint32_t preventDestruct;
         bool m_oomHandling;                 // temporarily false when allocating or deallocating with kNoOOMHandling
         bool m_notificationBeingSent;
+        CommitStats commitStats;            // protected by m_spinlock
+        uint64_t lastRecommitTicks;         // VMPI_getPerformanceCounter() at the last recommit, protected by m_spinlock
+#ifdef MMGC_BACKGROUND_DECOMMIT
+        GCBackgroundDecommitter* decommitter;
+        friend class GCBackgroundDecommitter;
+#endif
         vmpi_spin_lock_t gclog_spinlock;    // a lock used by GC::gclog for exclusive access to GCHeap::DumpMemoryInfo
+#ifdef MMGC_EVENT_STREAM
+        GCEventWriter* eventWriter;
+        vmpi_spin_lock_t eventWriterLock;   // serializes calls to eventWriter
+#endif
 
 #ifdef MMGC_MEMORY_PROFILER
         static MemoryProfiler *profiler;
@@ -995,6 +1121,9 @@ namespace MMgc
         // number of blocks in LargeAlloc allocations
         size_t largeAllocs;
 
+        // OS huge page size in blocks, 0 if the platform has no usable huge pages
+        const size_t hugePageBlocks;
+
 #ifdef MMGC_HOOKS
         bool hooksEnabled;
 #endif
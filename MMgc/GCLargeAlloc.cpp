@@ -88,6 +88,9 @@ namespace MMgc
 
             block->flags[0] = flagbits0;
             block->flags[1] = flagbits1;
+#ifdef MMGC_INLINE_WEAKREFS
+            block->weakRefs = NULL;
+#endif
 #ifdef _DEBUG
             (void)originalSize;
             if (flags & GC::kZero)
@@ -119,6 +122,10 @@ namespace MMgc
             }
 #endif
             m_totalAllocatedBytes += computedSize;
+#ifdef MMGC_ALLOCATION_SAMPLER
+            if ((m_gc->allocationSampleCountdown -= intptr_t(computedSize - DebugSize())) < 0)
+                m_gc->SampleAllocation(GetUserPointer(item), computedSize - DebugSize());
+#endif
         }
         return item;
     }
@@ -140,7 +147,7 @@ namespace MMgc
         // We can't allow free'ing something during Sweeping, otherwise alloc counters
         // get decremented twice and destructors will be called twice.
         GCAssert(m_gc->collecting == false || m_gc->marking == true);
-        if (m_gc->marking && (m_gc->collecting || IsProtectedAgainstFree(b))) {
+        if (m_gc->BarrierActive() && (m_gc->collecting || IsProtectedAgainstFree(b))) {
             m_gc->AbortFree(GetUserPointer(item));
             return;
         }
@@ -164,6 +171,13 @@ namespace MMgc
 
         if(b->flags[0] & kHasWeakRef)
             m_gc->ClearWeakRef(GetUserPointer(item));
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if(b->flags[0] & kSampled)
+            m_gc->SampledObjectFreed(GetUserPointer(item), b->size - DebugSize());
+#endif
+#ifdef MMGC_INLINE_WEAKREFS
+        GCAssert(b->weakRefs == NULL);
+#endif
 
         LargeBlock **prev = &m_blocks;
         while(*prev)
@@ -253,8 +267,9 @@ namespace MMgc
                 m_totalAllocatedBytes -= b->size;
                 continue;
             }
-            // clear marks
-            b->flags[0] &= ~(kMark|kQueued);
+            // clear marks, unless the survivors keep them (see GC::NurseryCollect)
+            if (!m_gc->generational)
+                b->flags[0] &= ~(kMark|kQueued);
             prev = (LargeBlock**)(&b->next);
         }
         m_startedFinalize = false;
@@ -76,7 +76,10 @@ namespace MMgc
             // Static checks in GC.cpp test that sizeof(gcbits_t) == 1 and that LargeBlock
             // alignment is 8 bytes.
             gcbits_t flags[4];
-#ifndef MMGC_64BIT
+#ifdef MMGC_INLINE_WEAKREFS
+            GCWeakRefSlots* weakRefs;   // the weak ref of the object, or NULL (see GCWeakRefSlots)
+#endif
+#if !defined MMGC_64BIT && !defined MMGC_INLINE_WEAKREFS
             uint32_t padding;    // Pad to 8-byte aligned.
 #endif
             int GetNumBlocks() const;
@@ -129,6 +132,9 @@ namespace MMgc
 
         bool GetNextMarkedObject(void*& out_ptr);
 
+        // Returns every object, marked or not, with or without pointers.
+        bool GetNextLiveObject(void*& out_ptr);
+
     private:
         GCLargeAlloc* const alloc;
         GCLargeAlloc::LargeBlock* block;
@@ -1098,6 +1098,233 @@ namespace MMgc
 
 #endif //MMGC_MEMORY_PROFILER
 
+#ifdef MMGC_ALLOCATION_SAMPLER
+
+    GCAllocationSampler::GCAllocationSampler(size_t meanInterval)
+        : meanInterval(double(meanInterval))
+        , random(VMPI_getPerformanceCounter() | 1)
+        , writing(false)
+    {
+        GCAssert(meanInterval > 0);
+        VMPI_memset(sites, 0, sizeof(sites));
+    }
+
+    GCAllocationSampler::~GCAllocationSampler()
+    {
+        for (uint32_t i=0; i < kNumSiteBuckets; i++) {
+            Site* site = sites[i];
+            while (site != NULL) {
+                Site* next = site->next;
+                delete site;
+                site = next;
+            }
+        }
+    }
+
+    intptr_t GCAllocationSampler::NextInterval()
+    {
+        // xorshift64; u is uniform on (0,1] and -log(u) is exponentially distributed.
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        double u = double((random >> 11) + 1) * (1.0 / 9007199254740992.0);
+        double interval = -log(u) * meanInterval;
+        if (interval > 1073741824.0)
+            interval = 1073741824.0;
+        return intptr_t(interval) + 1;
+    }
+
+    double GCAllocationSampler::Weight(size_t size)
+    {
+        return double(size) / (1.0 - exp(-double(size) / meanInterval));
+    }
+
+    bool GCAllocationSampler::Sample(const void* userptr, size_t size, GCAllocationSamplerHost* host)
+    {
+        if (writing)
+            return false;
+
+        const void* scriptFrames[kMaxScriptFrames];
+        uint32_t numScriptFrames = 0;
+        if (host != NULL)
+            numScriptFrames = host->captureScriptFrames(scriptFrames, kMaxScriptFrames);
+
+        // Skip this function and GC::SampleAllocation; the allocator's frames remain.
+        uintptr_t nativeFrames[kMaxNativeFrames+1];
+        uint32_t numNativeFrames = 0;
+        if (AVMPI_captureStackTrace(nativeFrames, kMaxNativeFrames+1, 2)) {
+            while (numNativeFrames < kMaxNativeFrames && nativeFrames[numNativeFrames] != 0)
+                numNativeFrames++;
+        }
+
+        Site* site = FindSite(scriptFrames, numScriptFrames, nativeFrames, numNativeFrames);
+        if (site == NULL)
+            return false;
+        double weight = Weight(size);
+        site->allocBytes += weight;
+        site->liveBytes += weight;
+        liveSamples.put(userptr, site);
+        return true;
+    }
+
+    GCAllocationSampler::Site* GCAllocationSampler::FindSite(const void** scriptFrames, uint32_t numScriptFrames,
+                                                             const uintptr_t* nativeFrames, uint32_t numNativeFrames)
+    {
+        uint32_t hash = numScriptFrames * 31 + numNativeFrames;
+        for (uint32_t i=0; i < numScriptFrames; i++)
+            hash = hash * 31 + GCHashtableKeyHandler::hash(scriptFrames[i]);
+        for (uint32_t i=0; i < numNativeFrames; i++)
+            hash = hash * 31 + uint32_t(nativeFrames[i]);
+
+        Site** bucket = &sites[hash % kNumSiteBuckets];
+        for (Site* site = *bucket; site != NULL; site = site->next) {
+            if (site->hash == hash &&
+                site->numScriptFrames == numScriptFrames &&
+                site->numNativeFrames == numNativeFrames &&
+                VMPI_memcmp(site->scriptFrames, scriptFrames, numScriptFrames * sizeof(const void*)) == 0 &&
+                VMPI_memcmp(site->nativeFrames, nativeFrames, numNativeFrames * sizeof(uintptr_t)) == 0)
+                return site;
+        }
+
+        Site* site = new Site;
+        if (site == NULL)
+            return NULL;
+        site->next = *bucket;
+        site->hash = hash;
+        site->numScriptFrames = numScriptFrames;
+        site->numNativeFrames = numNativeFrames;
+        VMPI_memcpy(site->scriptFrames, scriptFrames, numScriptFrames * sizeof(const void*));
+        VMPI_memcpy(site->nativeFrames, nativeFrames, numNativeFrames * sizeof(uintptr_t));
+        site->allocBytes = 0;
+        site->liveBytes = 0;
+        *bucket = site;
+        return site;
+    }
+
+    void GCAllocationSampler::ReleaseLive(Site* site, size_t size)
+    {
+        site->liveBytes -= Weight(size);
+        if (site->liveBytes < 0)
+            site->liveBytes = 0;
+    }
+
+    void GCAllocationSampler::Freed(const void* userptr, size_t size)
+    {
+        Site* site = (Site*)liveSamples.remove(userptr);
+        if (site != NULL)
+            ReleaseLive(site, size);
+    }
+
+    void GCAllocationSampler::ClearUnmarked()
+    {
+        bool removed = false;
+        {
+            GCHashtable_VMPI::Iterator it(&liveSamples);
+            const void* obj;
+            while ((obj = it.nextKey()) != NULL) {
+                if (!GC::GetMark(obj)) {
+                    ReleaseLive((Site*)it.value(), GC::Size(obj));
+                    liveSamples.remove(obj, /*allowRehash=*/false);
+                    removed = true;
+                }
+            }
+        }
+        if (removed)
+            liveSamples.prune();
+    }
+
+    // Reduce the output of AVMPI_getFunctionNameFromPC to a function name.  glibc's
+    // backtrace_symbols writes "binary(symbol+0x1c) [0x...]", or "binary(+0x1c)" for
+    // a function it cannot name, in which case we write "binary+0x1c" so that the
+    // frame can be looked up later; atos writes "symbol (in binary) (file:line)".
+    // Anything else, such as JIT code, is written as an address.
+    static void NativeFrameName(uintptr_t pc, char* buf, size_t bufsize)
+    {
+        char name[512];
+        const char* begin = NULL;
+        const char* end = NULL;
+        if (AVMPI_getFunctionNameFromPC(pc, name, sizeof(name))) {
+            name[sizeof(name)-1] = 0;
+            const char* in = VMPI_strstr(name, " (in ");
+            const char* paren = VMPI_strchr(name, '(');
+            if (in != NULL) {
+                begin = name;
+                end = in;
+            }
+            else if (paren != NULL && paren[1] == '+' && paren > name) {
+                begin = paren;
+                while (begin > name && begin[-1] != '/')
+                    begin--;
+                const char* close = VMPI_strchr(paren, ')');
+                char module[256];
+                size_t n = size_t(paren - begin) < sizeof(module) ? size_t(paren - begin) : sizeof(module)-1;
+                VMPI_memcpy(module, begin, n);
+                module[n] = 0;
+                VMPI_snprintf(buf, bufsize, "%s%.*s", module, close != NULL ? int(close - paren - 1) : 0, paren + 1);
+                return;
+            }
+            else if (paren != NULL) {
+                begin = paren + 1;
+                for (end = begin; *end != 0 && *end != '+' && *end != ')'; end++)
+                    ;
+            }
+        }
+        if (begin == NULL || end == begin) {
+            VMPI_snprintf(buf, bufsize, "0x%llx", (unsigned long long)pc);
+            return;
+        }
+        size_t i = 0;
+        for (; begin < end && i+1 < bufsize; begin++)
+            buf[i++] = *begin;
+        buf[i] = 0;
+    }
+
+    static void AppendFrame(char* line, size_t& len, size_t max, const char* name)
+    {
+        if (len > 0 && len+1 < max)
+            line[len++] = ';';
+        for (; *name != 0 && len+1 < max; name++)
+            line[len++] = (*name == ' ' || *name == ';') ? '_' : *name;
+        line[len] = 0;
+    }
+
+    void GCAllocationSampler::Write(GCAllocationProfileWriter* out, bool live, GCAllocationSamplerHost* host)
+    {
+        // Naming script frames may allocate, which must not add sites under our feet.
+        writing = true;
+        AVMPI_setupPCResolution();
+        char line[kMaxLine];
+        char name[512];
+        for (uint32_t b=0; b < kNumSiteBuckets; b++) {
+            for (Site* site = sites[b]; site != NULL; site = site->next) {
+                double bytes = live ? site->liveBytes : site->allocBytes;
+                if (bytes < 1.0)
+                    continue;
+                size_t len = 0;
+                line[0] = 0;
+                for (uint32_t i=site->numScriptFrames; i > 0; i--) {
+                    if (host != NULL)
+                        host->scriptFrameName(site->scriptFrames[i-1], name, sizeof(name));
+                    else
+                        VMPI_snprintf(name, sizeof(name), "%p", site->scriptFrames[i-1]);
+                    AppendFrame(line, len, kMaxLine - 32, name);
+                }
+                for (uint32_t i=site->numNativeFrames; i > 0; i--) {
+                    NativeFrameName(site->nativeFrames[i-1], name, sizeof(name));
+                    AppendFrame(line, len, kMaxLine - 32, name);
+                }
+                if (len == 0)
+                    AppendFrame(line, len, kMaxLine - 32, "(unknown)");
+                VMPI_snprintf(line + len, kMaxLine - len, " %llu\n", (unsigned long long)bytes);
+                out->write(line);
+            }
+        }
+        AVMPI_desetupPCResolution();
+        writing = false;
+    }
+
+#endif // MMGC_ALLOCATION_SAMPLER
+
 #ifdef MMGC_WEAKREF_PROFILER
     WeakRefAllocationSiteProfiler::WeakRefAllocationSiteProfiler(GC* gc, const char* profileName)
         : ObjectPopulationProfiler<AllocationSiteHandler>(gc, profileName, false, false)
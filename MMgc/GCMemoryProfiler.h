@@ -335,6 +335,113 @@ namespace MMgc
 
 #endif // !MMGC_MEMORY_PROFILER
 
+#ifdef MMGC_ALLOCATION_SAMPLER
+
+    /**
+     * The host's view of the script stack for GCAllocationSampler.  Script frames are
+     * identified by keys that the sampler does not interpret; it asks for their names
+     * only when it writes a profile.
+     */
+    class GCAllocationSamplerHost
+    {
+    public:
+        virtual ~GCAllocationSamplerHost() {}
+
+        // Store the keys of at most 'max' script frames on the current thread's stack,
+        // innermost first, and return how many were stored.  Called from the allocator:
+        // must not allocate and must not call back into the GC.
+        virtual uint32_t captureScriptFrames(const void** keys, uint32_t max) = 0;
+
+        // Store the NUL-terminated name of the frame 'key' in 'buf'.  May allocate.
+        virtual void scriptFrameName(const void* key, char* buf, size_t bufsize) = 0;
+    };
+
+    /**
+     * Destination of GC::WriteAllocationProfile, which calls write() once per line.
+     */
+    class GCAllocationProfileWriter
+    {
+    public:
+        virtual ~GCAllocationProfileWriter() {}
+        virtual void write(const char* line) = 0;
+    };
+
+    /**
+     * Samples managed allocations and accounts them to the allocation site, the
+     * combination of the script stack and the native stack at the time of allocation.
+     *
+     * The allocator counts down GC::allocationSampleCountdown by the size of every
+     * object and takes a sample when it goes negative; the countdown is then reset to
+     * a random number of bytes drawn from an exponential distribution.  An object of
+     * size s is thus sampled with probability p = 1-exp(-s/mean), independently of the
+     * other allocations, and a sample stands for s/p bytes.  The estimates per site are
+     * unbiased whatever the mix of object sizes, and objects smaller than the mean
+     * interval cost nothing beyond the countdown.
+     *
+     * Sampled objects carry the kSampled bit until they are freed explicitly or found
+     * unmarked by ClearUnmarked, so the sampler also knows the bytes still live at each
+     * site.  The sampler's own memory comes from VMPI_alloc.
+     */
+    class GCAllocationSampler : public GCAllocObject
+    {
+    public:
+        GCAllocationSampler(size_t meanInterval);
+        ~GCAllocationSampler();
+
+        // The number of bytes to allocate until the next sample.
+        intptr_t NextInterval();
+
+        // Record a sample of 'size' bytes at 'userptr'.  Returns false if the sample
+        // was dropped, in which case the object must not be marked kSampled.
+        bool Sample(const void* userptr, size_t size, GCAllocationSamplerHost* host);
+
+        // A sampled object of 'size' bytes is about to be freed.
+        void Freed(const void* userptr, size_t size);
+
+        // Forget the sampled objects that are about to be swept.  Called after marking,
+        // when every live sampled object is marked.
+        void ClearUnmarked();
+
+        // Write one line per site to 'out' in the "folded stacks" format read by
+        // flame graph tools: the frames from the outermost in, separated by ';', then
+        // a space and the estimated number of bytes allocated at that site since the
+        // sampler was created, or if 'live' is set the estimated number still live.
+        // Script frames precede native frames; native frames are named by
+        // AVMPI_getFunctionNameFromPC and may need demangling.
+        void Write(GCAllocationProfileWriter* out, bool live, GCAllocationSamplerHost* host);
+
+    private:
+        static const uint32_t kMaxScriptFrames = 16;
+        static const uint32_t kMaxNativeFrames = 24;
+        static const uint32_t kNumSiteBuckets = 1024;
+        static const size_t kMaxLine = 8192;
+
+        struct Site : public GCAllocObject
+        {
+            Site* next;
+            uint32_t hash;
+            uint32_t numScriptFrames;
+            uint32_t numNativeFrames;
+            const void* scriptFrames[kMaxScriptFrames];
+            uintptr_t nativeFrames[kMaxNativeFrames];
+            double allocBytes;
+            double liveBytes;
+        };
+
+        double Weight(size_t size);
+        Site* FindSite(const void** scriptFrames, uint32_t numScriptFrames,
+                       const uintptr_t* nativeFrames, uint32_t numNativeFrames);
+        void ReleaseLive(Site* site, size_t size);
+
+        double meanInterval;
+        uint64_t random;
+        bool writing;                       // Sample drops samples while Write runs
+        Site* sites[kNumSiteBuckets];
+        GCHashtable_VMPI liveSamples;       // sampled object -> Site*
+    };
+
+#endif // MMGC_ALLOCATION_SAMPLER
+
 #ifndef MMGC_MEMORY_INFO
 
 #define GetRealPointer(_x) _x
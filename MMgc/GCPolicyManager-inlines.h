@@ -62,6 +62,9 @@ namespace MMgc
 #ifdef MMGC_POLICY_PROFILING
         objectsAllocated++;
         bytesAllocated += nbytes;
+#endif
+#ifdef MMGC_EVENT_STREAM
+        eventBytesAllocated += nbytes;
 #endif
         remainingMinorAllocationBudget -= int32_t(nbytes);
 
@@ -81,10 +84,12 @@ namespace MMgc
         bytesScannedExactlyLastCollection += uint32_t(nbytes);
     }
 
-    REALLY_INLINE void GCPolicyManager::signalConservativeMarkWork(size_t nbytes)
+    REALLY_INLINE void GCPolicyManager::signalConservativeMarkWork(size_t nbytes, bool fromRoot)
     {
         objectsScannedConservativelyLastCollection++;
         bytesScannedConservativelyLastCollection += uint32_t(nbytes);
+        if (fromRoot)
+            bytesScannedConservativeRootsLastCollection += uint32_t(nbytes);
     }
 
     REALLY_INLINE void GCPolicyManager::signalPointerfreeMarkWork(size_t nbytes)
@@ -6,6 +6,8 @@
 
 #include "MMgc.h"
 
+#include "ITelemetry.h"
+
 namespace MMgc
 {
 #ifndef max
@@ -25,6 +27,15 @@ namespace MMgc
 #define R_INITIAL_VALUE (10*R_LOWER_LIMIT)
 #define GREEDY_TRIGGER (-(INT_MAX/2))               // must be <= 0 but should never go positive as a result of a single alloc action or multiple free actions
 
+#ifdef MMGC_PAUSE_TARGET
+    // Bounds on the adaptation to a pause time target, see adjustForPause and
+    // queryEndOfCollectionCycle.
+
+#define MIN_MARK_QUANTUM_SCALE (1.0/16)             // smallest fraction of P a mark increment is given
+#define MAX_MUTATOR_SPACING 8.0                     // largest multiple of A allowed between mark increments
+#define FINISH_SLACK 0.25                           // fraction of the major budget that may be overshot to avoid a long finish
+#endif
+
     GCConfig::GCConfig()
         : collectionThreshold(256) // 4KB blocks, that is, 1MB
         , markstackAllowance(0)
@@ -60,6 +71,13 @@ namespace MMgc
         , countFinalRootAndStackScan(0)
         , countFinalizeAndSweep(0)
         , countReapZCT(0)
+        , countReapZCTEpochs(0)
+        , timeMaxReapZCTEpoch(0)
+        , timeMaxReapZCTEpochEndToEnd(0)
+        , timeReapZCTStackPinning(0)
+        , timeMaxReapZCTStackPinning(0)
+        , countReapZCTStackScans(0)
+        , countReapZCTStackScansPartial(0)
         // private
         , gc(gc)
         , heap(heap)
@@ -81,6 +99,8 @@ namespace MMgc
         , bytesScannedExactlyTotal(0)
         , bytesScannedConservativelyTotal(0)
         , bytesScannedPointerfreeTotal(0)
+        , bytesScannedConservativeRootsLastCollection(0)
+        , bytesScannedConservativeRootsTotal(0)
         , start_time(0)
         , start_event(NO_EVENT)
         , collectionThreshold(config.collectionThreshold)
@@ -96,6 +116,39 @@ namespace MMgc
         , objectsPinned(0)
         , objectsAllocated(0)
         , bytesAllocated(0)
+#ifdef MMGC_PARALLEL_MARKING
+        , parallelMarkThreads(0)
+        , countParallelMark(0)
+        , parallelMarkSteals(0)
+        , parallelMarkBytes(0)
+        , timeParallelMark(0)
+        , timeMaxParallelMark(0)
+#endif
+#ifdef MMGC_BACKGROUND_SWEEPING
+        , countBackgroundSweep(0)
+        , backgroundSweepBlocks(0)
+        , timeBackgroundSweep(0)
+#endif
+#ifdef MMGC_GENERATIONAL
+        , countNurseryCollection(0)
+        , nurseryBytesMarked(0)
+        , timeNurseryCollection(0)
+        , timeMaxNurseryCollection(0)
+#endif
+#ifdef MMGC_CARD_MARKING
+        , countCardScan(0)
+        , cardsDirty(0)
+        , cardObjectsRescanned(0)
+        , timeCardScan(0)
+        , timeMaxCardScan(0)
+#endif
+#ifdef MMGC_COMPACTION
+        , countCompaction(0)
+        , compactionBlocksEmptied(0)
+        , compactionObjectsMoved(0)
+        , timeCompaction(0)
+        , timeMaxCompaction(0)
+#endif
 #endif
 #ifdef MMGC_POINTINESS_PROFILING
         , candidateWords(0)
@@ -128,14 +181,48 @@ namespace MMgc
         , remainingMajorAllocationBudget(0)
         , minorAllocationBudget(0)
         , remainingMinorAllocationBudget(0)
+#ifdef MMGC_GENERATIONAL
+        , deferredNurseryBudget(0)
+        , nurseryBudget(0)
+        , H_nursery(0)
+#endif
         , adjustR_startTime(0)
         , adjustR_totalTime(0)
+#ifdef MMGC_PAUSE_TARGET
+        , pauseTarget(uint64_t(heap->Config().gcPauseTarget * double(VMPI_getPerformanceFrequency()) / 1000.0))
+        , minUtilization(heap->Config().gcMinUtilization)
+        , markQuantumScale(1.0)
+        , reapQuantumScale(1.0)
+        , mutatorSpacing(1.0)
+        , reapTicksPerEntry(0)
+        , lastReapEntries(0)
+        , timeEndOfLastPause(0)
+        , countPauseTargetViolations(0)
+        , countUtilizationViolations(0)
+        , timeMaxPause(0)
+#endif
+#ifdef MMGC_EVENT_STREAM
+        , eventBytesAllocated(0)
+        , eventObjectsReaped(0)
+        , eventBytesReaped(0)
+        , eventBytesBeforeSweep(0)
+#endif
     {
+#ifdef MMGC_EVENT_STREAM
+        for ( size_t i=0 ; i < ARRAY_SIZE(pauseHistogram) ; i++ )
+            pauseHistogram[i] = 0;
+#endif
 #ifdef MMGC_POLICY_PROFILING
         for ( size_t i=0 ; i < ARRAY_SIZE(barrierStageTotal) ; i++ ) {
             barrierStageTotal[i] = 0;
             barrierStageLastCollection[i] = 0;
         }
+#endif
+#ifdef MMGC_PAUSE_TARGET
+        // The pause time target replaces the default P, so that mark increments are
+        // both shorter and, through A, more frequent.
+        if (pauseTargetActive())
+            P = heap->Config().gcPauseTarget / 1000.0;
 #endif
         adjustPolicyInitially();
     }
@@ -157,9 +244,10 @@ namespace MMgc
     // Parameters fixed in the code:
     //
     // P (max pause)  can be tuned but within a limited range, but we treat it as
-    //   constant.  Right now we use it to limit pauses in incremental marking only;
-    //   it does not control ZCT reaping, final root and stack scan, or finalize
-    //   and sweep.  (Those are all bugs.)  On a desktop system the marker sticks
+    //   constant unless the host sets a pause time target, in which case P is the
+    //   target (see adjustForPause below).  Right now we use it to limit pauses in incremental marking
+    //   and, if GCHeapConfig::incrementalReap is set, in ZCT reaping only; it does not control
+    //   final root and stack scan, or finalize and sweep.  (Those are bugs.)  On a desktop system the marker sticks
     //   to P pretty well; on phones it has trouble with that, either because of
     //   clock resolution (P=5ms normally) or because of its recursive behavior
     //   that means the timeout is not checked sufficiently often, or because large
@@ -290,6 +378,12 @@ namespace MMgc
             remainingMinorAllocationBudget = int32_t(remainingMajorAllocationBudget);
 
         remainingMajorAllocationBudget -= remainingMinorAllocationBudget;
+#ifdef MMGC_GENERATIONAL
+        if (gc->generational) {
+            deferredNurseryBudget = remainingMinorAllocationBudget;
+            grantNurseryBudget();
+        }
+#endif
         if (gc->greedy)
             remainingMinorAllocationBudget = GREEDY_TRIGGER;
     }
@@ -329,6 +423,13 @@ namespace MMgc
                   (H+remainingMajorAllocationBudget) / 1024.0);
 #endif
         remainingMajorAllocationBudget -= remainingMinorAllocationBudget;
+#ifdef MMGC_GENERATIONAL
+        if (gc->generational) {
+            deferredNurseryBudget = remainingMinorAllocationBudget;
+            H_nursery = 0;
+            grantNurseryBudget();
+        }
+#endif
 
         if (gc->greedy)
             remainingMinorAllocationBudget = GREEDY_TRIGGER;
@@ -346,6 +447,10 @@ namespace MMgc
         }
 
         double aval = A();
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive())
+            aval *= mutatorSpacing;
+#endif
         if(aval > INT_MAX)
             aval = INT_MAX;
         else if (aval < 1)
@@ -369,18 +474,208 @@ namespace MMgc
     // allowed before the next mark downward, but as soon as we do that aggressively
     // we get into pause clustering issues and it will seem like one long GC pause anyway.
 
-    uint32_t GCPolicyManager::incrementalMarkMilliseconds() {
+    //
+    // With a pause time target the overshoot is not made up for in one long increment:
+    // the quantum is capped at the adapted slice, and the overshoot has already been
+    // charged to the major budget by adjustPolicyForNextMinorCycle.
+
+    uint32_t GCPolicyManager::incrementalMarkMicroseconds() {
         // Nonsensical to call this in non-incremental mode
         GCAssert(gc->incremental);
         // Bad to divide by 0 here.
         GCAssert(minorAllocationBudget != 0);
-        return uint32_t(P * 1000.0 * double(minorAllocationBudget - remainingMinorAllocationBudget) / double(minorAllocationBudget));
+        double quantum = P * 1000000.0 * double(minorAllocationBudget - remainingMinorAllocationBudget) / double(minorAllocationBudget);
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive() && quantum > P * 1000000.0 * markQuantumScale)
+            quantum = P * 1000000.0 * markQuantumScale;
+#endif
+        if (quantum > double(uint32_t(-1)))
+            quantum = double(uint32_t(-1));
+        return uint32_t(quantum);
     }
 
+    // With a pause time target the end of the cycle is put off while there is mark work
+    // queued, because FinishIncrementalMark drains the mark stack in the same pause as
+    // the final root scan and the sweep.  The allocation budget is allowed to overshoot
+    // by FINISH_SLACK of the major budget for this; past that the heap size target wins.
+
     bool GCPolicyManager::queryEndOfCollectionCycle() {
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive() &&
+            remainingMajorAllocationBudget <= 0 &&
+            remainingMajorAllocationBudget > -majorAllocationBudget * FINISH_SLACK &&
+            (gc->m_incrementalWork.Count() > 0 || gc->m_barrierWork.Count() > 0))
+        {
+            return false;
+        }
+#endif
         return remainingMajorAllocationBudget <= 0;
     }
 
+#ifdef MMGC_PAUSE_TARGET
+    bool GCPolicyManager::pauseTargetActive() {
+        return pauseTarget != 0;
+    }
+
+    uint32_t GCPolicyManager::pauseTargetViolations() {
+        return countPauseTargetViolations;
+    }
+
+    uint32_t GCPolicyManager::utilizationViolations() {
+        return countUtilizationViolations;
+    }
+
+    // Called at the end of every pause.  Mutator utilization is measured over the
+    // interval from the end of the previous pause to the end of this one; pauses
+    // are far apart except while a collection is in progress, so in practice this
+    // covers the incremental part of the cycle.
+    //
+    // The mark quantum shrinks in proportion to how far an increment overshot the
+    // target, and grows back slowly while increments stay within it.  The spacing
+    // between increments grows by the factor by which the mutator fell short of its
+    // share of the time, and relaxes slowly when the share is met.
+
+    void GCPolicyManager::adjustForPause(PolicyEvent ev, uint64_t start, uint64_t elapsed)
+    {
+        if (elapsed > timeMaxPause)
+            timeMaxPause = elapsed;
+        if (elapsed > pauseTarget)
+            countPauseTargetViolations++;
+
+        double mutatorTime = 0;
+        double mutatorNeeded = double(elapsed) * minUtilization / (1.0 - minUtilization);
+        if (timeEndOfLastPause != 0 && start > timeEndOfLastPause)
+            mutatorTime = double(start - timeEndOfLastPause);
+        bool utilizationMet = timeEndOfLastPause == 0 || mutatorTime >= mutatorNeeded;
+        if (!utilizationMet)
+            countUtilizationViolations++;
+
+        switch (ev) {
+            case END_IncrementalMark:
+                if (elapsed > pauseTarget) {
+                    markQuantumScale *= double(pauseTarget) / double(elapsed);
+                    if (markQuantumScale < MIN_MARK_QUANTUM_SCALE)
+                        markQuantumScale = MIN_MARK_QUANTUM_SCALE;
+                }
+                else {
+                    markQuantumScale *= 1.125;
+                    if (markQuantumScale > 1.0)
+                        markQuantumScale = 1.0;
+                }
+                if (!utilizationMet) {
+                    mutatorSpacing *= (mutatorTime > 0 ? mutatorNeeded / mutatorTime : MAX_MUTATOR_SPACING);
+                    if (mutatorSpacing > MAX_MUTATOR_SPACING)
+                        mutatorSpacing = MAX_MUTATOR_SPACING;
+                }
+                else {
+                    mutatorSpacing *= 0.875;
+                    if (mutatorSpacing < 1.0)
+                        mutatorSpacing = 1.0;
+                }
+                break;
+            case END_ReapZCT:
+                if (lastReapEntries > 0)
+                    reapTicksPerEntry = double(elapsed) / double(lastReapEntries);
+                if (elapsed > pauseTarget) {
+                    reapQuantumScale *= double(pauseTarget) / double(elapsed);
+                    if (reapQuantumScale < MIN_MARK_QUANTUM_SCALE)
+                        reapQuantumScale = MIN_MARK_QUANTUM_SCALE;
+                }
+                else {
+                    reapQuantumScale *= 1.125;
+                    if (reapQuantumScale > 1.0)
+                        reapQuantumScale = 1.0;
+                }
+                break;
+            default:
+                break;
+        }
+        timeEndOfLastPause = start + elapsed;
+    }
+#endif
+
+#ifdef MMGC_GENERATIONAL
+    void GCPolicyManager::grantNurseryBudget()
+    {
+        double grant = double(heap->Config().nurserySize);
+        if (grant > deferredNurseryBudget)
+            grant = deferredNurseryBudget;
+        if (grant < 1)
+            grant = 1;
+        nurseryBudget = int32_t(grant);
+        remainingMinorAllocationBudget = nurseryBudget;
+        deferredNurseryBudget -= grant;
+    }
+
+    bool GCPolicyManager::queryNurseryCollection() {
+        return deferredNurseryBudget > 0;
+    }
+
+    // A nursery budget is charged only for what survived the nursery collection, so
+    // the full collection is started when the old generation has grown by the amount
+    // budgeted for the cycle, not when that much has been allocated.
+    //
+    // The survivors are not known until the heap has been swept, which may be done
+    // lazily or in the background, so the charge for one nursery collection is made
+    // at the start of the next one: the heap size then, less what has been allocated
+    // since, is the heap size following the previous nursery collection.
+
+    void GCPolicyManager::signalNurseryCollectionStart(size_t bytesInUse)
+    {
+        double H = double(bytesInUse) - (double(nurseryBudget) - double(remainingMinorAllocationBudget));
+        if (H_nursery > 0 && H > H_nursery)
+            deferredNurseryBudget -= H - H_nursery;
+        H_nursery = H > 0 ? H : 1;
+
+        // Refund the nursery budget, it has now been paid for.
+        deferredNurseryBudget += nurseryBudget;
+        remainingMinorAllocationBudget = 0;
+        nurseryBudget = 0;
+    }
+
+    void GCPolicyManager::signalNurseryCollectionEnd(uint64_t ticks, uint64_t bytes)
+    {
+        grantNurseryBudget();
+
+        // The nursery marking counts toward the mark rate.
+        adjustR_totalTime += ticks;
+
+#ifdef MMGC_POLICY_PROFILING
+        countNurseryCollection++;
+        nurseryBytesMarked += bytes;
+        timeNurseryCollection += ticks;
+        if (ticks > timeMaxNurseryCollection)
+            timeMaxNurseryCollection = ticks;
+#else
+        (void)bytes;
+#endif
+    }
+#endif
+
+#if defined MMGC_POLICY_PROFILING && defined MMGC_CARD_MARKING
+    void GCPolicyManager::signalDirtyCardScan(uint32_t cards, uint32_t objects, uint64_t ticks)
+    {
+        countCardScan++;
+        cardsDirty += cards;
+        cardObjectsRescanned += objects;
+        timeCardScan += ticks;
+        if (ticks > timeMaxCardScan)
+            timeMaxCardScan = ticks;
+    }
+#endif
+
+#if defined MMGC_POLICY_PROFILING && defined MMGC_COMPACTION
+    void GCPolicyManager::signalCompaction(uint32_t blocks, uint32_t objects, uint64_t ticks)
+    {
+        countCompaction++;
+        compactionBlocksEmptied += blocks;
+        compactionObjectsMoved += objects;
+        timeCompaction += ticks;
+        if (ticks > timeMaxCompaction)
+            timeMaxCompaction = ticks;
+    }
+#endif
+
     void GCPolicyManager::setLowerLimitCollectionThreshold(uint32_t blocks) {
         collectionThreshold = blocks;
     }
@@ -399,7 +694,41 @@ namespace MMgc
                 (objectsScannedExactlyLastCollection + objectsScannedConservativelyLastCollection + objectsScannedPointerfreeLastCollection));
     }
 
-    uint32_t GCPolicyManager::queryZCTBudget(uint32_t zctSizeBlocks) {
+    // A reap slice is given the time of a full mark increment, P, and with a pause time
+    // target the fraction of it within which the reaper has been observed to stay.  The
+    // reaper checks the time only every so often and always does some minimum amount of
+    // work per slice, see ZCT::ReapSlice.
+
+    uint32_t GCPolicyManager::reapSliceMicroseconds() {
+        double quantum = P * 1000000.0;
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive())
+            quantum *= reapQuantumScale;
+#endif
+        if (quantum < 1)
+            quantum = 1;
+        return uint32_t(quantum);
+    }
+
+    // A reap processes the entire ZCT, so with a pause time target the ZCT is allowed
+    // to grow only while, at the cost per entry observed in the last reap, a ZCT one
+    // block larger could be reaped within half the target (the cost per entry varies
+    // a lot with the finalizers run).  An empty budget makes the ZCT reap whenever it
+    // fills up.
+    //
+    // While an incremental reap is suspended the ZCT grows by one block between slices,
+    // like the allocation budget between two mark increments.
+
+    uint32_t GCPolicyManager::queryZCTBudget(uint32_t zctSizeBlocks, bool reapInProgress) {
+        if (reapInProgress)
+            return 1;
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive() && reapTicksPerEntry > 0) {
+            const double entriesPerBlock = double(GCHeap::kBlockSize / sizeof(RCObject*));
+            double reapTicks = reapTicksPerEntry * entriesPerBlock * double(zctSizeBlocks + 1);
+            return reapTicks <= double(pauseTarget) / 2 ? 1 : 0;
+        }
+#endif
         (void)zctSizeBlocks;
         return 1;
     }
@@ -410,6 +739,20 @@ namespace MMgc
             maxBlocksOwned = blocksOwned;
     }
     
+    void GCPolicyManager::signalReapStackPinning(uint64_t ticks, bool partial) {
+        countReapZCTStackScans++;
+        if (partial)
+            countReapZCTStackScansPartial++;
+        timeReapZCTStackPinning += ticks;
+        timeMaxReapZCTStackPinning = max(timeMaxReapZCTStackPinning, ticks);
+    }
+
+    void GCPolicyManager::signalReapEnd(uint64_t ticks, uint64_t endToEndTicks) {
+        countReapZCTEpochs++;
+        timeMaxReapZCTEpoch = max(timeMaxReapZCTEpoch, ticks);
+        timeMaxReapZCTEpochEndToEnd = max(timeMaxReapZCTEpochEndToEnd, endToEndTicks);
+    }
+
     void GCPolicyManager::signalBlockDeallocation(size_t blocks) {
         blocksOwned -= blocks;
     }
@@ -464,6 +807,8 @@ namespace MMgc
                 bytesScannedExactlyLastCollection = 0;
                 bytesScannedConservativelyLastCollection = 0;
                 bytesScannedPointerfreeLastCollection = 0;
+                bytesScannedConservativeRootsTotal += bytesScannedConservativeRootsLastCollection;
+                bytesScannedConservativeRootsLastCollection = 0;
 #ifdef MMGC_POINTINESS_PROFILING
                 candidateWords = 0;
                 couldBePointer = 0;
@@ -483,6 +828,10 @@ namespace MMgc
                 heapUsedBeforeSweep = (heap->GetTotalHeapSize() - heap->GetFreeHeapSize());
                 gcAllocatedBeforeSweep = gc->GetNumBlocks();
                 gcBytesUsedBeforeSweep = gc->GetBytesInUse();
+#endif
+#ifdef MMGC_EVENT_STREAM
+                if (eventStreamActive())
+                    eventBytesBeforeSweep = gc->GetBytesInUse();
 #endif
                 goto common_actions;
             case START_ReapZCT:
@@ -562,6 +911,30 @@ namespace MMgc
         if (ev != END_ReapZCT)
             timeInLastCollection += elapsed;
 
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive())
+            adjustForPause(ev, start_time, elapsed);
+#endif
+
+#ifdef MMGC_EVENT_STREAM
+        {
+            uint64_t pause = ticksToMicros(elapsed);
+            uint32_t bucket = 0;
+            while (bucket < kPauseHistogramBuckets-1 && pause > pauseHistogramBounds[bucket])
+                bucket++;
+            pauseHistogram[bucket]++;
+
+            bool endOfCollection = (ev == END_FinalizeAndSweep || ev == END_FinalizeAndSweepNoShrink);
+            if (eventStreamActive()) {
+                writePhaseEvent(ev, start_time, t);
+                if (endOfCollection)
+                    writeCollectionEvent(t);
+            }
+            if (endOfCollection)
+                eventBytesAllocated = 0;
+        }
+#endif
+
 #ifdef MMGC_POLICY_PROFILING
         bool endOfCollection = (ev == END_FinalizeAndSweep || ev == END_FinalizeAndSweepNoShrink);
         if (summarizeGCBehavior() && endOfCollection)
@@ -748,6 +1121,83 @@ namespace MMgc
               double(removeZCTFinalTotal) / double(removeZCTLastCollection + removeZCTTotal));
 #endif
 
+#ifdef MMGC_PARALLEL_MARKING
+        if (countParallelMark > 0)
+        {
+            GCLog("[gcbehavior] parallel-mark: threads=%u phases=%u steals=%.0f kbytes=%.0f time=%.1f kbytes-per-ms=%.1f max-pause=%.1f\n",
+                  unsigned(parallelMarkThreads),
+                  unsigned(countParallelMark),
+                  double(parallelMarkSteals),
+                  double(parallelMarkBytes)/1024,
+                  ticksToMillis(timeParallelMark),
+                  timeParallelMark > 0 ? (double(parallelMarkBytes)/1024)/ticksToMillis(timeParallelMark) : 0,
+                  ticksToMillis(timeMaxParallelMark));
+        }
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        if (countBackgroundSweep > 0)
+        {
+            GCLog("[gcbehavior] background-sweep: cycles=%u blocks=%.0f time=%.1f\n",
+                  unsigned(countBackgroundSweep),
+                  double(backgroundSweepBlocks),
+                  ticksToMillis(timeBackgroundSweep));
+        }
+#endif
+
+#ifdef MMGC_GENERATIONAL
+        if (gc->generational)
+        {
+            GCLog("[gcbehavior] generational: minor-collections=%u minor-kbytes-marked=%.0f minor-time=%.1f minor-max-pause=%.1f major-collections=%u major-max-pause=%.1f\n",
+                  unsigned(countNurseryCollection),
+                  double(nurseryBytesMarked)/1024,
+                  ticksToMillis(timeNurseryCollection),
+                  ticksToMillis(timeMaxNurseryCollection),
+                  unsigned(countFinalizeAndSweep),
+                  ticksToMillis(max(max(timeMaxStartIncrementalMark, timeMaxIncrementalMark),
+                                    max(timeMaxFinalRootAndStackScan, timeMaxFinalizeAndSweep))));
+        }
+#endif
+
+#ifdef MMGC_CARD_MARKING
+        if (gc->cardMarking)
+        {
+            GCLog("[gcbehavior] card-barrier: scans=%u cards-dirty=%.0f objects-rescanned=%.0f scan-time=%.1f scan-max-pause=%.1f\n",
+                  unsigned(countCardScan),
+                  double(cardsDirty),
+                  double(cardObjectsRescanned),
+                  ticksToMillis(timeCardScan),
+                  ticksToMillis(timeMaxCardScan));
+        }
+#endif
+
+#ifdef MMGC_COMPACTION
+        if (gc->compaction)
+        {
+            GCLog("[gcbehavior] compaction: passes=%u blocks-emptied=%.0f objects-moved=%.0f time=%.1f max-pause=%.1f\n",
+                  unsigned(countCompaction),
+                  double(compactionBlocksEmptied),
+                  double(compactionObjectsMoved),
+                  ticksToMillis(timeCompaction),
+                  ticksToMillis(timeMaxCompaction));
+        }
+#endif
+
+#ifdef MMGC_PAUSE_TARGET
+        if (pauseTargetActive())
+        {
+            GCLog("[gcbehavior] pause-target: target=%.1f min-utilization=%.2f max-pause=%.1f over-target=%u under-utilization=%u mark-quantum=%.2f reap-quantum=%.2f increment-spacing=%.2f\n",
+                  ticksToMillis(pauseTarget),
+                  minUtilization,
+                  ticksToMillis(timeMaxPause),
+                  unsigned(countPauseTargetViolations),
+                  unsigned(countUtilizationViolations),
+                  P * 1000.0 * markQuantumScale,
+                  P * 1000.0 * reapQuantumScale,
+                  mutatorSpacing);
+        }
+#endif
+
         GCLog("[gcbehavior] time-zct-reap: last-cycle=%.1f total=%.1f\n",
               ticksToMillis(timeReapZCTLastCollection),
               ticksToMillis(timeReapZCT));
@@ -762,6 +1212,15 @@ namespace MMgc
         GCLog("[gcbehavior] pause-zct-reap: last-cycle=%.1f overall=%.1f\n",
               pendingClearZCTStats ? 0.0 : ticksToMillis(timeMaxReapZCTLastCollection),
               ticksToMillis(timeMaxReapZCT));
+        GCLog("[gcbehavior] slices-zct-reap: completed-reaps=%u slices=%u max-reap=%.1f max-reap-end2end=%.1f stack-pinning=%.1f max-stack-pinning=%.1f partial-stack-scans=%u/%u\n",
+              unsigned(countReapZCTEpochs),
+              unsigned(countReapZCT),
+              ticksToMillis(timeMaxReapZCTEpoch),
+              ticksToMillis(timeMaxReapZCTEpochEndToEnd),
+              ticksToMillis(timeReapZCTStackPinning),
+              ticksToMillis(timeMaxReapZCTStackPinning),
+              unsigned(countReapZCTStackScansPartial),
+              unsigned(countReapZCTStackScans));
         if (afterCollection)
         {
             GCLog("[gcbehavior] time-last-gc: in-gc=%.1f end2end=%.1f mutator-efficiency=%.2f%%\n",
@@ -795,12 +1254,172 @@ namespace MMgc
               ticksToMillis(timeMaxFinalizeAndSweep));
     }
 #endif // MMGC_POLICY_PROFILING
-#ifdef MMGC_POLICY_PROFILING
+#if defined MMGC_POLICY_PROFILING || defined MMGC_EVENT_STREAM || defined MMGC_PAUSE_TARGET
     void GCPolicyManager::signalReapWork(uint32_t objects_reaped, uint32_t bytes_reaped, uint32_t objects_pinned)
     {
+        (void)objects_pinned;
+#ifdef MMGC_POLICY_PROFILING
         objectsReaped += objects_reaped;
         bytesReaped += bytes_reaped;
         objectsPinned += objects_pinned;
+#endif
+#ifdef MMGC_EVENT_STREAM
+        eventObjectsReaped = objects_reaped;
+        eventBytesReaped = bytes_reaped;
+#endif
+#ifdef MMGC_PAUSE_TARGET
+        lastReapEntries = objects_reaped + objects_pinned;
+#endif
+    }
+#endif
+
+#ifdef MMGC_EVENT_STREAM
+    const uint32_t GCPolicyManager::pauseHistogramBounds[GCPolicyManager::kPauseHistogramBuckets-1] = {
+        100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000
+    };
+
+    bool GCPolicyManager::eventStreamActive()
+    {
+        if (heap->GetEventWriter() != NULL)
+            return true;
+#ifdef VMCFG_TELEMETRY
+        telemetry::ITelemetry* t = gc->getTelemetry();
+        if (t != NULL && t->IsActive())
+            return true;
+#endif
+        return false;
+    }
+
+    uint64_t GCPolicyManager::ticksToMicros(uint64_t ticks)
+    {
+        // Split the conversion so that a large tick count does not overflow.
+        uint64_t freq = VMPI_getPerformanceFrequency();
+        return (ticks / freq) * 1000000 + (ticks % freq) * 1000000 / freq;
+    }
+
+    void GCPolicyManager::writeEvent(const char* record)
+    {
+        heap->WriteEvent(record);
+        TELEMETRY_STRING(gc->getTelemetry(), ".gc.Event", record);
+    }
+
+    void GCPolicyManager::writePhaseEvent(PolicyEvent ev, uint64_t start, uint64_t end)
+    {
+        const char* phase = NULL;
+        switch (ev) {
+            case END_StartIncrementalMark:      phase = "StartIncrementalMark"; break;
+            case END_IncrementalMark:           phase = "IncrementalMark"; break;
+            case END_FinalRootAndStackScan:     phase = "FinalRootAndStackScan"; break;
+            case END_FinalizeAndSweep:
+            case END_FinalizeAndSweepNoShrink:  phase = "FinalizeAndSweep"; break;
+            case END_ReapZCT:                   phase = "ReapZCT"; break;
+            default:                            return;
+        }
+
+        // A collection is numbered from its StartIncrementalMark; countFinalizeAndSweep
+        // has already been bumped for the phase that ends it.
+        bool endOfCollection = (ev == END_FinalizeAndSweep || ev == END_FinalizeAndSweepNoShrink);
+        uint64_t collection = countFinalizeAndSweep + (endOfCollection ? 0 : 1);
+
+        char record[512];
+        int n = VMPI_snprintf(record, sizeof(record),
+                              "{\"type\":\"phase\",\"gc\":\"0x%llx\",\"collection\":%llu,\"phase\":\"%s\","
+                              "\"start_us\":%llu,\"end_us\":%llu,\"duration_us\":%llu",
+                              (unsigned long long)(uintptr_t)gc,
+                              (unsigned long long)collection,
+                              phase,
+                              (unsigned long long)ticksToMicros(start),
+                              (unsigned long long)ticksToMicros(end),
+                              (unsigned long long)ticksToMicros(end - start));
+        if (ev == END_ReapZCT) {
+            n += VMPI_snprintf(record + n, sizeof(record) - n,
+                               ",\"objects_reaped\":%u,\"bytes_reaped\":%u",
+                               eventObjectsReaped,
+                               eventBytesReaped);
+        }
+        else if (endOfCollection) {
+            uint64_t marked = uint64_t(bytesScannedExactlyLastCollection) +
+                              uint64_t(bytesScannedConservativelyLastCollection) +
+                              uint64_t(bytesScannedPointerfreeLastCollection);
+            size_t after = gc->GetBytesInUse();
+            n += VMPI_snprintf(record + n, sizeof(record) - n,
+                               ",\"bytes_marked\":%llu,\"bytes_before_sweep\":%llu,\"bytes_after_sweep\":%llu,"
+                               "\"bytes_swept\":%llu,\"heap_blocks\":%llu",
+                               (unsigned long long)marked,
+                               (unsigned long long)eventBytesBeforeSweep,
+                               (unsigned long long)after,
+                               (unsigned long long)(eventBytesBeforeSweep > after ? eventBytesBeforeSweep - after : 0),
+                               (unsigned long long)heap->GetTotalHeapSize());
+        }
+        VMPI_snprintf(record + n, sizeof(record) - n, "}");
+        writeEvent(record);
+    }
+
+    void GCPolicyManager::writeCollectionEvent(uint64_t end)
+    {
+        uint64_t maxPause = max(max(timeMaxStartIncrementalMarkLastCollection, timeMaxIncrementalMarkLastCollection),
+                                max(timeMaxFinalRootAndStackScanLastCollection, timeMaxFinalizeAndSweepLastCollection));
+
+        char record[768];
+        int n = VMPI_snprintf(record, sizeof(record),
+                              "{\"type\":\"collection\",\"gc\":\"0x%llx\",\"collection\":%llu,"
+                              "\"start_us\":%llu,\"end_us\":%llu,\"gc_us\":%llu,\"max_pause_us\":%llu,"
+                              "\"bytes_allocated\":%llu,\"pause_histogram\":{\"bounds_us\":[",
+                              (unsigned long long)(uintptr_t)gc,
+                              (unsigned long long)countFinalizeAndSweep,
+                              (unsigned long long)ticksToMicros(timeStartOfLastCollection),
+                              (unsigned long long)ticksToMicros(end),
+                              (unsigned long long)ticksToMicros(timeInLastCollection),
+                              (unsigned long long)ticksToMicros(maxPause),
+                              (unsigned long long)eventBytesAllocated);
+        for ( uint32_t i=0 ; i < kPauseHistogramBuckets-1 ; i++ )
+            n += VMPI_snprintf(record + n, sizeof(record) - n, i == 0 ? "%u" : ",%u", pauseHistogramBounds[i]);
+        n += VMPI_snprintf(record + n, sizeof(record) - n, "],\"counts\":[");
+        for ( uint32_t i=0 ; i < kPauseHistogramBuckets ; i++ )
+            n += VMPI_snprintf(record + n, sizeof(record) - n, i == 0 ? "%llu" : ",%llu", (unsigned long long)pauseHistogram[i]);
+        VMPI_snprintf(record + n, sizeof(record) - n, "]}}");
+        writeEvent(record);
+    }
+#endif
+
+#ifdef MMGC_POLICY_PROFILING
+
+#ifdef MMGC_PARALLEL_MARKING
+    void GCPolicyManager::signalParallelMarkWork(uint32_t threads, uint64_t ticks, uint64_t bytes, uint32_t steals)
+    {
+        parallelMarkThreads = threads;
+        countParallelMark++;
+        parallelMarkSteals += steals;
+        parallelMarkBytes += bytes;
+        timeParallelMark += ticks;
+        if (ticks > timeMaxParallelMark)
+            timeMaxParallelMark = ticks;
+    }
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+    void GCPolicyManager::signalBackgroundSweepWork(uint32_t blocks, uint64_t ticks)
+    {
+        countBackgroundSweep++;
+        backgroundSweepBlocks += blocks;
+        timeBackgroundSweep += ticks;
+    }
+#endif
+#endif
+
+#ifdef MMGC_PARALLEL_MARKING
+    void GCPolicyManager::signalMarkWork(uint32_t objectsExactly, uint32_t bytesExactly,
+                                         uint32_t objectsConservatively, uint32_t bytesConservatively,
+                                         uint32_t bytesConservativeRoots,
+                                         uint32_t objectsPointerfree, uint32_t bytesPointerfree)
+    {
+        objectsScannedExactlyLastCollection += objectsExactly;
+        bytesScannedExactlyLastCollection += bytesExactly;
+        objectsScannedConservativelyLastCollection += objectsConservatively;
+        bytesScannedConservativelyLastCollection += bytesConservatively;
+        bytesScannedConservativeRootsLastCollection += bytesConservativeRoots;
+        objectsScannedPointerfreeLastCollection += objectsPointerfree;
+        bytesScannedPointerfreeLastCollection += bytesPointerfree;
     }
 #endif
 
@@ -812,6 +1431,31 @@ namespace MMgc
             return 0;
         return uint32_t(exact * 100 / (exact+conserv));
     }
+
+    void GCPolicyManager::dumpMarkWorkInfo()
+    {
+        // Roots and stacks are always scanned conservatively, heap objects only when
+        // they have no exact tracer, so the heap number is the one to watch.
+        uint32_t conservHeap = bytesScannedConservativelyLastCollection - bytesScannedConservativeRootsLastCollection;
+        GCLog("[mem] \ttraced last gc: exactly %u kb (%u objects), conservatively %u kb (%u objects, %u kb roots and stacks), pointer-free %u kb (%u objects)\n",
+              unsigned(bytesScannedExactlyLastCollection >> 10),
+              unsigned(objectsScannedExactlyLastCollection),
+              unsigned(bytesScannedConservativelyLastCollection >> 10),
+              unsigned(objectsScannedConservativelyLastCollection),
+              unsigned(bytesScannedConservativeRootsLastCollection >> 10),
+              unsigned(bytesScannedPointerfreeLastCollection >> 10),
+              unsigned(objectsScannedPointerfreeLastCollection));
+
+        uint64_t exact = bytesScannedExactlyTotal + bytesScannedExactlyLastCollection;
+        uint64_t conserv = (bytesScannedConservativelyTotal + bytesScannedConservativelyLastCollection) -
+                           (bytesScannedConservativeRootsTotal + bytesScannedConservativeRootsLastCollection);
+        uint64_t lastTotal = uint64_t(bytesScannedExactlyLastCollection) + conservHeap;
+        GCLog("[mem] \theap objects traced conservatively: last gc %u kb (%.1f%%), all gcs %llu kb (%.1f%%)\n",
+              unsigned(conservHeap >> 10),
+              lastTotal == 0 ? 0.0 : conservHeap * 100.0 / double(lastTotal),
+              (unsigned long long)(conserv >> 10),
+              exact + conserv == 0 ? 0.0 : double(conserv) * 100.0 / double(exact + conserv));
+    }
     
     double GCPolicyManager::queryAllocationBudgetFractionUsed()
     {
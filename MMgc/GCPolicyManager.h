@@ -93,8 +93,8 @@ namespace MMgc
      * documented extensively in GC.cpp and in doc/mmgc/policy.pdf.  The policy improves
      * on the first-cut policy by running the GC less often and having lower pause times.
      *
-     * ZCT reaping times are not bounded, so ZCT reaping may violate any kind of
-     * incrementality guarantee.  This will be fixed by and by.
+     * ZCT reaping times are not bounded unless GCHeapConfig::incrementalReap is set,
+     * in which case the ZCT is reaped in slices of reapSliceMicroseconds() each.
      */
     class GCPolicyManager {
     public:
@@ -112,12 +112,12 @@ namespace MMgc
         /**
          * Situation: the GC is about to run the incremental marker.
          *
-         * @return the desired length of the next incremental mark quantum.
+         * @return the desired length of the next incremental mark quantum, in microseconds.
          * @note the result can vary from call to call; the function should
          *       be called as an incremental mark is about to start and the
          *       result should not be cached.
          */
-        uint32_t incrementalMarkMilliseconds();
+        uint32_t incrementalMarkMicroseconds();
 
         /**
          * @return the number of blocks owned by this GC, as accounted for by calls to
@@ -136,11 +136,20 @@ namespace MMgc
         uint64_t bytesMarked();
 
         /**
-         * Compute a ZCT growth budget (in blocks) based on its current size.
+         * Situation: the ZCT reaper is about to run a slice of an incremental reap.
+         *
+         * @return the desired length of the slice, in microseconds.
+         */
+        uint32_t reapSliceMicroseconds();
+
+        /**
+         * Compute a ZCT growth budget (in blocks) based on its current size.  If
+         * reapInProgress is true then an incremental reap has been suspended and
+         * the budget is the growth allowed before its next slice.
          *
          * @return the growth budget
          */
-        uint32_t queryZCTBudget(uint32_t zctBlocksUsed);
+        uint32_t queryZCTBudget(uint32_t zctBlocksUsed, bool reapInProgress);
 
         /**
          * Set the lower limit beyond which we try not to run the garbage collector.
@@ -201,9 +210,10 @@ namespace MMgc
         
         /**
          * Situation: signal that one pointer-containing object, whose size is nbytes,
-         * has been traced conservatively by the garbage collector.
+         * has been traced conservatively by the garbage collector.  fromRoot is true
+         * if the memory was a root or stack segment rather than a heap object.
          */
-        void signalConservativeMarkWork(size_t nbytes);
+        void signalConservativeMarkWork(size_t nbytes, bool fromRoot);
         
         /**
          * Situation: signal that one pointer-free object, whose size is nbytes,
@@ -211,6 +221,18 @@ namespace MMgc
          */
         void signalPointerfreeMarkWork(size_t nbytes);
 
+#ifdef MMGC_PARALLEL_MARKING
+        /**
+         * Situation: signal the mark work accumulated by one marker thread during
+         * parallel marking.  The arguments are counts of the work that would
+         * otherwise have been signaled one object at a time by the three methods above.
+         */
+        void signalMarkWork(uint32_t objectsExactly, uint32_t bytesExactly,
+                            uint32_t objectsConservatively, uint32_t bytesConservatively,
+                            uint32_t bytesConservativeRoots,
+                            uint32_t objectsPointerfree, uint32_t bytesPointerfree);
+#endif
+
         /**
          * Situation: signal that some number of bytes have just been successfully
          * allocated and are about to be returned to the caller of the allocator.
@@ -248,6 +270,26 @@ namespace MMgc
          */
         bool queryEndOfCollectionCycle();
 
+#ifdef MMGC_PAUSE_TARGET
+        /**
+         * @return true if the policy is scheduling work against a pause time target
+         * (GCHeapConfig::gcPauseTarget is nonzero).
+         */
+        bool pauseTargetActive();
+
+        /**
+         * @return the number of collector pauses, of any kind, since startup that were
+         * longer than the pause time target.
+         */
+        uint32_t pauseTargetViolations();
+
+        /**
+         * @return the number of collector pauses since startup that left the mutator less
+         * than the minimum utilization in the interval from the end of the previous pause.
+         */
+        uint32_t utilizationViolations();
+#endif
+
 #ifdef MMGC_POLICY_PROFILING
         /**
          * Situation: signal that one write has been examined by the write barrier and made
@@ -256,11 +298,60 @@ namespace MMgc
          */
         /*REALLY_INLINE*/ void signalWriteBarrierWork(int stage);
 
+#ifdef MMGC_CARD_MARKING
+        /**
+         * Situation: the dirty cards have been rescanned at the end of marking: 'cards'
+         * cards were dirty, 'objects' marked objects on them were queued for retracing,
+         * and the scan (not counting the retracing) took 'ticks' time.
+         */
+        void signalDirtyCardScan(uint32_t cards, uint32_t objects, uint64_t ticks);
+#endif
+
+#ifdef MMGC_COMPACTION
+        /**
+         * Situation: compaction has moved 'objects' objects out of 'blocks' blocks that
+         * will be freed by the sweep, and took 'ticks' time.
+         */
+        void signalCompaction(uint32_t blocks, uint32_t objects, uint64_t ticks);
+#endif
+
+#ifdef MMGC_PARALLEL_MARKING
+        /**
+         * Situation: signal that a parallel mark phase using 'threads' threads has
+         * just completed, having taken 'ticks' time to scan 'bytes' bytes and having
+         * moved work between threads 'steals' times.
+         */
+        void signalParallelMarkWork(uint32_t threads, uint64_t ticks, uint64_t bytes, uint32_t steals);
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        /**
+         * Situation: signal that the background sweeper has been stopped, having swept
+         * 'blocks' blocks in 'ticks' time since it was started.
+         */
+        void signalBackgroundSweepWork(uint32_t blocks, uint64_t ticks);
+#endif
+#endif
+#if defined MMGC_POLICY_PROFILING || defined MMGC_EVENT_STREAM || defined MMGC_PAUSE_TARGET
         /**
          * Situation: signal that the ZCT reaper has run and performed some work.
          */
         void signalReapWork(uint32_t objects_reaped, uint32_t bytes_reaped, uint32_t objects_pinned);
 #endif
+
+        /**
+         * Situation: the ZCT reaper has pinned the objects referenced from the program
+         * stack, taking 'ticks' time.  If 'partial' is true then only the part of the
+         * stack that changed since the previous slice of the same reap was scanned.
+         */
+        void signalReapStackPinning(uint64_t ticks, bool partial);
+
+        /**
+         * Situation: a ZCT reap has completed, having spent 'ticks' time in its slices
+         * and 'endToEndTicks' time from the start of its first slice to the end of its
+         * last one.  A reap that is not incremental has a single slice.
+         */
+        void signalReapEnd(uint64_t ticks, uint64_t endToEndTicks);
 #ifdef MMGC_POINTINESS_PROFILING
         /**
          * Situation: signal that 'words' words have been scanned; that 'could_be_pointer'
@@ -339,11 +430,42 @@ namespace MMgc
          */
         uint32_t queryExactPercentage();
 
+        /**
+         * Print, for -memstats, the number of bytes traced exactly, conservatively
+         * and as pointer-free during the last collection and since startup.
+         */
+        void dumpMarkWorkInfo();
+
         /**
          * Return the fraction [0,1] of allocation budget used.
          */
         double queryAllocationBudgetFractionUsed();
 
+#ifdef MMGC_GENERATIONAL
+        /**
+         * @return true if the allocation budget that has just been exhausted is a
+         * nursery budget, ie, the collector should collect the nursery rather than
+         * start a full collection.  Only meaningful when the collector is generational
+         * and not marking.
+         */
+        bool queryNurseryCollection();
+
+        /**
+         * Situation: a nursery collection is starting and the heap has been swept, so
+         * 'bytesInUse' is exact.  The growth of the old generation during the previous
+         * nursery collection is charged to the allocation budget for the full
+         * collection cycle.
+         */
+        void signalNurseryCollectionStart(size_t bytesInUse);
+
+        /**
+         * Situation: a nursery collection has just completed, having taken 'ticks'
+         * time and having marked 'bytes' bytes.  The nursery budget is refilled from
+         * what remains of the allocation budget for the full collection cycle.
+         */
+        void signalNurseryCollectionEnd(uint64_t ticks, uint64_t bytes);
+#endif
+
         // ----- Public data --------------------------------------
 
         // Elapsed time (in ticks) for various collection phases, and the maximum phase time
@@ -382,13 +504,29 @@ namespace MMgc
         uint64_t timeMaxFinalizeAndSweepLastCollection;
         uint64_t timeMaxReapZCTLastCollection;
 
-        // The total number of times each phase was run
+        // The total number of times each phase was run.  countReapZCT counts reap
+        // slices, ie pauses; a reap that is not incremental is a single slice.
         uint64_t countStartIncrementalMark;
         uint64_t countIncrementalMark;
         uint64_t countFinalRootAndStackScan;
         uint64_t countFinalizeAndSweep;
         uint64_t countReapZCT;
 
+        // ZCT reaps broken out from their slices: the number of completed reaps, the
+        // longest time spent in the slices of one reap and the longest time from the
+        // start of a reap's first slice to the end of its last one.
+        uint64_t countReapZCTEpochs;
+        uint64_t timeMaxReapZCTEpoch;
+        uint64_t timeMaxReapZCTEpochEndToEnd;
+
+        // Time spent by the reaper pinning from the program stack (included in the
+        // reap times above), the longest such scan, and the number of scans of which
+        // those that only looked at the part of the stack changed since the last slice.
+        uint64_t timeReapZCTStackPinning;
+        uint64_t timeMaxReapZCTStackPinning;
+        uint64_t countReapZCTStackScans;
+        uint64_t countReapZCTStackScansPartial;
+
     private:
         // The following parameters can vary not just from machine to machine and
         // run to run on the same machine, but within a run in response to memory
@@ -414,6 +552,24 @@ namespace MMgc
         void PrintGCBehaviorStats(bool afterCollection=true);
 #endif
 
+#ifdef MMGC_EVENT_STREAM
+        // @return true if event records should be formatted: there is an event writer
+        // or an active telemetry session
+        bool eventStreamActive();
+
+        // Emit the "phase" record for the phase ending with 'ev'
+        void writePhaseEvent(PolicyEvent ev, uint64_t start, uint64_t end);
+
+        // Emit the "collection" record for the collection that just ended at 'end'
+        void writeCollectionEvent(uint64_t end);
+
+        // Hand a formatted record to the event writer and to telemetry
+        void writeEvent(const char* record);
+
+        // Convert ticks to microseconds
+        static uint64_t ticksToMicros(uint64_t ticks);
+#endif
+
         // Various private methods for the GC policy follow.  See comment in GC.cpp for details.
 
         // Amount of GC work to perform (bytes to scan) per byte allocated while the GC is active
@@ -447,6 +603,19 @@ namespace MMgc
         // next one)
         void adjustPolicyForNextMinorCycle();
 
+#ifdef MMGC_GENERATIONAL
+        // Move at most one nursery's worth of the deferred allocation budget into the
+        // minor allocation budget
+        void grantNurseryBudget();
+#endif
+
+#ifdef MMGC_PAUSE_TARGET
+        // Called from the policy event handler at the end of every collector pause of
+        // 'elapsed' ticks that started at 'start', to record violations and to adapt the
+        // mark quantum and the spacing of mark increments to the pause time target
+        void adjustForPause(PolicyEvent ev, uint64_t start, uint64_t elapsed);
+#endif
+
         // ----- Private data --------------------------------------
 
         GC * const gc;
@@ -490,6 +659,11 @@ namespace MMgc
         uint64_t bytesScannedConservativelyTotal;
         uint64_t bytesScannedPointerfreeTotal;
 
+        // The part of bytesScannedConservatively{LastCollection,Total} that came from
+        // roots and stack segments rather than from conservatively traced heap objects.
+        uint32_t bytesScannedConservativeRootsLastCollection;
+        uint64_t bytesScannedConservativeRootsTotal;
+
         // Temporaries for holding the start time / start event until the end event arrives
         uint64_t start_time;
         PolicyEvent start_event;
@@ -525,6 +699,49 @@ namespace MMgc
         // Allocation work, overall
         uint64_t objectsAllocated;
         uint64_t bytesAllocated;
+
+#ifdef MMGC_PARALLEL_MARKING
+        // Parallel mark work, overall
+        uint32_t parallelMarkThreads;
+        uint32_t countParallelMark;
+        uint64_t parallelMarkSteals;
+        uint64_t parallelMarkBytes;
+        uint64_t timeParallelMark;
+        uint64_t timeMaxParallelMark;
+#endif
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+        // Background sweep work, overall
+        uint32_t countBackgroundSweep;
+        uint64_t backgroundSweepBlocks;
+        uint64_t timeBackgroundSweep;
+#endif
+
+#ifdef MMGC_GENERATIONAL
+        // Nursery collections, overall
+        uint32_t countNurseryCollection;
+        uint64_t nurseryBytesMarked;
+        uint64_t timeNurseryCollection;
+        uint64_t timeMaxNurseryCollection;
+#endif
+
+#ifdef MMGC_CARD_MARKING
+        // Card-marking barrier work, overall
+        uint32_t countCardScan;
+        uint64_t cardsDirty;
+        uint64_t cardObjectsRescanned;
+        uint64_t timeCardScan;
+        uint64_t timeMaxCardScan;
+#endif
+
+#ifdef MMGC_COMPACTION
+        // Compaction work, overall
+        uint32_t countCompaction;
+        uint64_t compactionBlocksEmptied;
+        uint64_t compactionObjectsMoved;
+        uint64_t timeCompaction;
+        uint64_t timeMaxCompaction;
+#endif
 #endif
 #ifdef MMGC_POINTINESS_PROFILING
         // Track the number of scannable words, the number that passes the initial range
@@ -597,9 +814,79 @@ namespace MMgc
         // budget.
         int32_t remainingMinorAllocationBudget;
 
+#ifdef MMGC_GENERATIONAL
+        // In generational mode, the part of the allocation budget before the start of
+        // the next full collection that has not yet been moved into the minor allocation
+        // budget.  The minor budget holds at most one nursery's worth of allocation
+        // when the collector is not marking.
+        double deferredNurseryBudget;
+
+        // The minor allocation budget most recently granted by grantNurseryBudget
+        int32_t nurseryBudget;
+
+        // The heap size following the previous nursery collection, or 0 if there
+        // has been a full collection since
+        double H_nursery;
+#endif
+
         // Temporaries used to compute R
         uint64_t adjustR_startTime;
         uint64_t adjustR_totalTime;
+
+#ifdef MMGC_PAUSE_TARGET
+        // Pause time target in ticks, 0 if there is none
+        uint64_t pauseTarget;
+
+        // Minimum fraction of the time from the end of one pause to the end of the
+        // next that should be left to the mutator, [0,1)
+        double minUtilization;
+
+        // Fraction of P the marker is currently given per increment, adapted to the
+        // marker's overshoot of its time slice, [MIN_MARK_QUANTUM_SCALE,1]
+        double markQuantumScale;
+
+        // Fraction of P the ZCT reaper is currently given per slice, adapted the same
+        // way to the reaper's overshoot (finalizers can run long), [MIN_MARK_QUANTUM_SCALE,1]
+        double reapQuantumScale;
+
+        // Factor applied to A to space mark increments out so that minUtilization is
+        // met, [1,MAX_MUTATOR_SPACING]
+        double mutatorSpacing;
+
+        // Observed ZCT reap cost in ticks per ZCT entry, 0 until the first reap
+        double reapTicksPerEntry;
+
+        // Number of ZCT entries (reaped or pinned) processed by the last reap
+        uint32_t lastReapEntries;
+
+        // The time recorded at the end of the last collector pause of any kind
+        uint64_t timeEndOfLastPause;
+
+        // Pauses that exceeded the target and pauses that left too little mutator
+        // time, since startup, and the longest pause seen
+        uint32_t countPauseTargetViolations;
+        uint32_t countUtilizationViolations;
+        uint64_t timeMaxPause;
+#endif
+
+#ifdef MMGC_EVENT_STREAM
+        // Upper bounds in microseconds of all but the last (unbounded) pause bucket
+        static const uint32_t kPauseHistogramBuckets = 11;
+        static const uint32_t pauseHistogramBounds[kPauseHistogramBuckets-1];
+
+        // Number of pauses of this collector that fell in each bucket, always maintained
+        uint64_t pauseHistogram[kPauseHistogramBuckets];
+
+        // Bytes allocated since the last collection record
+        uint64_t eventBytesAllocated;
+
+        // Work done by the most recent ZCT reap
+        uint32_t eventObjectsReaped;
+        uint32_t eventBytesReaped;
+
+        // GC bytes in use at the start of FinalizeAndSweep, only valid if eventStreamActive()
+        size_t eventBytesBeforeSweep;
+#endif
     };
 }
 
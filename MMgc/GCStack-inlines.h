@@ -101,6 +101,52 @@ namespace MMgc
         GCAssert(Invariants());
     }
 
+#ifdef MMGC_MARK_PREFETCH
+    REALLY_INLINE GCMarkPrefetchQueue::GCMarkPrefetchQueue()
+        : next(0)
+    {
+        for ( uint32_t i=0 ; i < kDepth ; i++ )
+            items[i] = NULL;
+    }
+
+    REALLY_INLINE const void* GCMarkPrefetchQueue::Rotate(const void* item)
+    {
+        VMPI_prefetch(item);
+        const void* oldest = items[next];
+        items[next] = item;
+        next = (next + 1) & (kDepth - 1);
+        return oldest;
+    }
+
+    REALLY_INLINE const void* GCMarkPrefetchQueue::Take()
+    {
+        for ( uint32_t i=0 ; i < kDepth ; i++ ) {
+            uint32_t slot = (next + i) & (kDepth - 1);
+            const void* item = items[slot];
+            if (item != NULL) {
+                items[slot] = NULL;
+                next = (slot + 1) & (kDepth - 1);
+                return item;
+            }
+        }
+        return NULL;
+    }
+#else
+    REALLY_INLINE GCMarkPrefetchQueue::GCMarkPrefetchQueue()
+    {
+    }
+
+    REALLY_INLINE const void* GCMarkPrefetchQueue::Rotate(const void* item)
+    {
+        return item;
+    }
+
+    REALLY_INLINE const void* GCMarkPrefetchQueue::Take()
+    {
+        return NULL;
+    }
+#endif
+
 }
 
 #endif /* __GCStack_inlines__ */
@@ -350,6 +350,43 @@ namespace MMgc
 #ifdef _DEBUG
         // Check as many invariants as possible
         bool Invariants();
+#endif
+    };
+
+    /**
+     * A short FIFO of gc objects that have been popped off a mark stack but not yet
+     * traced.  The marker hands every object it pops to Rotate, which prefetches the
+     * object and returns the one that was prefetched kDepth pops earlier, so that the
+     * object's first cache line has had time to arrive by the time it is traced.  When
+     * the mark stack runs dry the marker calls Take to trace the stragglers, which may
+     * of course push more work.
+     *
+     * The queue is local to one drain of one mark stack and must be empty when the
+     * drain returns; nothing else knows that the objects in it still need tracing.
+     *
+     * Without MMGC_MARK_PREFETCH (AVMTWEAK_MARK_PREFETCH) the queue has no capacity:
+     * Rotate returns its argument and Take returns NULL.
+     */
+    class GCMarkPrefetchQueue
+    {
+    public:
+        GCMarkPrefetchQueue();
+
+        // Prefetch 'item' and enqueue it.  Returns the item it displaces, or NULL.
+        const void* Rotate(const void* item);
+
+        // Remove and return the oldest item, or NULL if the queue is empty.
+        const void* Take();
+
+#ifdef MMGC_MARK_PREFETCH
+    private:
+        // Must be a power of two.  Deep enough to cover a memory latency with the
+        // tracing of the objects ahead in the queue, shallow enough that the
+        // prefetched lines are not evicted before they are used.
+        static const uint32_t kDepth = 8;
+
+        const void* items[kDepth];
+        uint32_t next;          // Oldest slot, and the next one to fill
 #endif
     };
 }
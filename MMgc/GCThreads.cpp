@@ -5,4 +5,572 @@
 
 #include "MMgc.h"
 
-// empty
+namespace MMgc
+{
+#ifdef MMGC_PARALLEL_MARKING
+
+    // An idle marker thread spins this many times looking for work before it
+    // starts yielding the processor between probes.
+    static const uint32_t kSpinsBeforeYield = 100;
+
+    GCMarkerThread::GCMarkerThread(GCParallelMarker* marker, uint32_t index)
+        : marker(marker)
+        , index(index)
+    {
+    }
+
+    void GCMarkerThread::run()
+    {
+        marker->HelperMain(index);
+    }
+
+    GCParallelMarker::Worker::Worker()
+        : stack(NULL)
+        , stash(NULL)
+        , stashed(0)
+        , steals(0)
+        , objectsExactly(0)
+        , bytesExactly(0)
+        , objectsConservatively(0)
+        , bytesConservatively(0)
+        , bytesConservativeRoots(0)
+        , objectsPointerfree(0)
+        , bytesPointerfree(0)
+    {
+        VMPI_lockInit(&lock);
+    }
+
+    static GCMarkStack* NewMarkStack(void* deadItem)
+    {
+        // The allowance is per-stack and the helper stacks are never limited; GC does not
+        // create the parallel marker if the collector's own stack is limited.
+#ifdef MMGC_MARKSTACK_ALLOWANCE
+        GCMarkStack* stack = mmfx_new(GCMarkStack(0));
+#else
+        GCMarkStack* stack = mmfx_new(GCMarkStack());
+#endif
+        stack->SetDeadItem(deadItem);
+        return stack;
+    }
+
+    GCParallelMarker::GCParallelMarker(GC* gc, uint32_t numThreads)
+        : gc(gc)
+        , numThreads(numThreads)
+        , numHelpersStarted(0)
+        , workers(NULL)
+        , runnables(NULL)
+        , threads(NULL)
+        , active(0)
+        , idle(0)
+        , epoch(0)
+        , helpersFinished(0)
+        , shutdown(false)
+    {
+        GCAssert(numThreads >= 2);
+        workers = mmfx_new_array(Worker, numThreads);
+        for ( uint32_t i=0 ; i < numThreads ; i++ ) {
+            workers[i].stack = (i == 0) ? &gc->m_incrementalWork : NewMarkStack(gc->emptyWeakRef);
+            workers[i].stash = NewMarkStack(gc->emptyWeakRef);
+        }
+    }
+
+    GCParallelMarker::~GCParallelMarker()
+    {
+        GCAssert(!Active());
+        StopThreads();
+        for ( uint32_t i=0 ; i < numThreads ; i++ ) {
+            GCAssert(workers[i].stash->IsEmpty());
+            if (i > 0)
+                mmfx_delete(workers[i].stack);
+            mmfx_delete(workers[i].stash);
+            VMPI_lockDestroy(&workers[i].lock);
+        }
+        mmfx_delete_array(workers);
+    }
+
+    void GCParallelMarker::StartThreads()
+    {
+        GCAssert(threads == NULL);
+        threads = mmfx_new_array(vmbase::VMThread*, numThreads);
+        runnables = mmfx_new_array(GCMarkerThread*, numThreads);
+        for ( uint32_t i=1 ; i < numThreads ; i++ ) {
+            runnables[i] = mmfx_new(GCMarkerThread(this, i));
+            threads[i] = mmfx_new(vmbase::VMThread("MMgc marker", runnables[i]));
+            if (!threads[i]->start()) {
+                // Run with the helpers we have; they're numbered consecutively from 1.
+                mmfx_delete(threads[i]);
+                mmfx_delete(runnables[i]);
+                break;
+            }
+            numHelpersStarted++;
+        }
+    }
+
+    void GCParallelMarker::StopThreads()
+    {
+        if (threads == NULL)
+            return;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            shutdown = true;
+            locker.notifyAll();
+        }
+        for ( uint32_t i=1 ; i <= numHelpersStarted ; i++ ) {
+            threads[i]->join();
+            mmfx_delete(threads[i]);
+            mmfx_delete(runnables[i]);
+        }
+        mmfx_delete_array(threads);
+        mmfx_delete_array(runnables);
+        threads = NULL;
+        runnables = NULL;
+        numHelpersStarted = 0;
+    }
+
+    void GCParallelMarker::Mark()
+    {
+        GCAssert(!Active());
+        GCAssert(gc->markerActive);
+
+        GCMarkStack& stack = gc->m_incrementalWork;
+
+        // Mark alone until there's at least one full segment that can be given away.
+        // Most drains are small and never get here, and those that do usually
+        // reach the threshold quickly.
+        GCMarkPrefetchQueue prefetched;
+        while (stack.InactiveSegments() == 0 || numHelpersStarted == 0) {
+            if (stack.InactiveSegments() > 0 && threads == NULL) {
+                StartThreads();
+                continue;
+            }
+            if (!gc->MarkNextItem(stack, prefetched))
+                return;
+        }
+        gc->MarkPrefetchedItems(prefetched);
+        if (stack.IsEmpty())
+            return;
+
+        uint64_t start = VMPI_getPerformanceCounter();
+
+        // Recursive marking in TraceConservativePointer updates the shared recursion
+        // budget, so turn it off for the duration.
+        uint32_t savedRecursionControl = gc->mark_item_recursion_control;
+        gc->mark_item_recursion_control = 0;
+
+        idle = 0;
+        active = 1;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            helpersFinished = 0;
+            epoch++;
+            locker.notifyAll();
+        }
+
+        RunWorker(0);
+
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            while (helpersFinished < numHelpersStarted)
+                locker.wait();
+        }
+        active = 0;
+
+        gc->mark_item_recursion_control = savedRecursionControl;
+        FinishPhase(VMPI_getPerformanceCounter() - start);
+
+        GCAssert(stack.IsEmpty());
+    }
+
+    void GCParallelMarker::HelperMain(uint32_t index)
+    {
+        uint32_t seen = 0;
+        for (;;) {
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (epoch == seen && !shutdown)
+                    locker.wait();
+                if (shutdown)
+                    return;
+                seen = epoch;
+            }
+
+            RunWorker(index);
+
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                if (++helpersFinished == numHelpersStarted)
+                    locker.notifyAll();
+            }
+        }
+    }
+
+    void GCParallelMarker::RunWorker(uint32_t index)
+    {
+        Worker* w = &workers[index];
+        const int32_t numWorkers = int32_t(numHelpersStarted + 1);
+
+        currentWorker = w;
+        for (;;) {
+            DrainLocal(w);
+            if (StealWork(index))
+                continue;
+
+            // Offer to terminate; see the class comment for why this works.
+            VMPI_atomicIncAndGet32WithBarrier(&idle);
+            for ( uint32_t spins=0 ;; spins++ ) {
+                if (idle == numWorkers)
+                    return;
+                if (StashedWorkAvailable()) {
+                    VMPI_atomicDecAndGet32WithBarrier(&idle);
+                    if (StealWork(index))
+                        break;
+                    VMPI_atomicIncAndGet32WithBarrier(&idle);
+                }
+                if (spins < kSpinsBeforeYield)
+                    VMPI_spinloopPause();
+                else
+                    VMPI_threadYield();
+            }
+        }
+    }
+
+    void GCParallelMarker::DrainLocal(Worker* w)
+    {
+        GCMarkStack& stack = *w->stack;
+        GCMarkPrefetchQueue prefetched;
+        while (gc->MarkNextItem(stack, prefetched)) {
+            // Only the owner sets 'stashed' so a stale value here just delays sharing.
+            if (stack.InactiveSegments() > 0 && !w->stashed) {
+                MMGC_LOCK(w->lock);
+                w->stash->TransferOneInactiveSegmentFrom(stack);
+                w->stashed = !w->stash->IsEmpty();
+            }
+        }
+    }
+
+    bool GCParallelMarker::StealWork(uint32_t index)
+    {
+        Worker* thief = &workers[index];
+        const uint32_t numWorkers = numHelpersStarted + 1;
+
+        // Look in our own stash first, then round-robin from our neighbor.
+        for ( uint32_t k=0 ; k < numWorkers ; k++ ) {
+            Worker* victim = &workers[(index + k) % numWorkers];
+            if (!victim->stashed)
+                continue;
+            MMGC_LOCK(victim->lock);
+            if (victim->stash->IsEmpty())
+                continue;
+            // This does not allocate: the stash keeps its emptied top segment cached
+            // after every donation, and the thief's stack is empty and unlimited.
+            if (thief->stack->TransferEverythingFrom(*victim->stash)) {
+                victim->stashed = 0;
+                if (victim != thief)
+                    thief->steals++;
+                return true;
+            }
+            GCAssert(!"Stealing from a mark stack stash should not fail");
+        }
+        return false;
+    }
+
+    bool GCParallelMarker::StashedWorkAvailable()
+    {
+        const uint32_t numWorkers = numHelpersStarted + 1;
+        for ( uint32_t i=0 ; i < numWorkers ; i++ )
+            if (workers[i].stashed)
+                return true;
+        return false;
+    }
+
+    void GCParallelMarker::FinishPhase(uint64_t parallelTicks)
+    {
+        uint32_t steals = 0;
+        uint64_t bytes = 0;
+        const uint32_t numWorkers = numHelpersStarted + 1;
+        for ( uint32_t i=0 ; i < numWorkers ; i++ ) {
+            Worker* w = &workers[i];
+            GCAssert(w->stack->IsEmpty());
+            GCAssert(w->stash->IsEmpty());
+            gc->policy.signalMarkWork(w->objectsExactly, w->bytesExactly,
+                                      w->objectsConservatively, w->bytesConservatively,
+                                      w->bytesConservativeRoots,
+                                      w->objectsPointerfree, w->bytesPointerfree);
+            steals += w->steals;
+            bytes += uint64_t(w->bytesExactly) + w->bytesConservatively + w->bytesPointerfree;
+            w->steals = 0;
+            w->objectsExactly = w->bytesExactly = 0;
+            w->objectsConservatively = w->bytesConservatively = w->bytesConservativeRoots = 0;
+            w->objectsPointerfree = w->bytesPointerfree = 0;
+        }
+#ifdef MMGC_POLICY_PROFILING
+        gc->policy.signalParallelMarkWork(numWorkers, parallelTicks, bytes, steals);
+#else
+        (void)parallelTicks;
+        (void)bytes;
+#endif
+    }
+
+#endif // MMGC_PARALLEL_MARKING
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+
+    GCSweeperThread::GCSweeperThread(GCBackgroundSweeper* sweeper)
+        : sweeper(sweeper)
+    {
+    }
+
+    void GCSweeperThread::run()
+    {
+        sweeper->HelperMain();
+    }
+
+    GCBackgroundSweeper::GCBackgroundSweeper(GC* gc)
+        : gc(gc)
+        , runnable(NULL)
+        , thread(NULL)
+        , threadFailed(false)
+        , running(false)
+        , abort(0)
+        , epoch(0)
+        , epochDone(0)
+        , shutdown(false)
+        , blocksSwept(0)
+        , sweepTicks(0)
+    {
+    }
+
+    GCBackgroundSweeper::~GCBackgroundSweeper()
+    {
+        Finish();
+        if (thread == NULL)
+            return;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            shutdown = true;
+            locker.notifyAll();
+        }
+        thread->join();
+        mmfx_delete(thread);
+        mmfx_delete(runnable);
+    }
+
+    void GCBackgroundSweeper::Start()
+    {
+        GCAssert(!running);
+        if (thread == NULL) {
+            if (threadFailed)
+                return;
+            runnable = mmfx_new(GCSweeperThread(this));
+            thread = mmfx_new(vmbase::VMThread("MMgc sweeper", runnable));
+            if (!thread->start()) {
+                // Don't try again; the allocators will sweep lazily.
+                mmfx_delete(thread);
+                mmfx_delete(runnable);
+                thread = NULL;
+                runnable = NULL;
+                threadFailed = true;
+                return;
+            }
+        }
+        abort = 0;
+        running = true;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            epoch++;
+            locker.notifyAll();
+        }
+    }
+
+    void GCBackgroundSweeper::Finish()
+    {
+        if (!running)
+            return;
+        abort = 1;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            while (epochDone != epoch)
+                locker.wait();
+        }
+        running = false;
+#ifdef MMGC_POLICY_PROFILING
+        gc->policy.signalBackgroundSweepWork(blocksSwept, sweepTicks);
+#endif
+    }
+
+    void GCBackgroundSweeper::HelperMain()
+    {
+        for (;;) {
+            uint32_t current;
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (epoch == epochDone && !shutdown)
+                    locker.wait();
+                if (shutdown)
+                    return;
+                current = epoch;
+            }
+
+            uint64_t start = VMPI_getPerformanceCounter();
+            uint32_t blocks = SweepAll();
+            uint64_t ticks = VMPI_getPerformanceCounter() - start;
+
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                blocksSwept = blocks;
+                sweepTicks = ticks;
+                epochDone = current;
+                locker.notifyAll();
+            }
+        }
+    }
+
+    uint32_t GCBackgroundSweeper::SweepAll()
+    {
+        // The allocators that use LazySweepPass, ie, those for non-finalized objects.
+        GCAlloc* allocs[2*GC::kNumSizeClasses + 2];
+        uint32_t numAllocs = 0;
+        for ( int i=0 ; i < GC::kNumSizeClasses ; i++ ) {
+            allocs[numAllocs++] = gc->containsPointersNonfinalizedAllocs[i];
+            allocs[numAllocs++] = gc->noPointersNonfinalizedAllocs[i];
+        }
+        allocs[numAllocs++] = gc->bibopAllocFloat;
+        allocs[numAllocs++] = gc->bibopAllocFloat4;
+
+        uint32_t blocks = 0;
+        for ( uint32_t i=0 ; i < numAllocs && !abort ; i++ ) {
+            while (!abort && allocs[i]->SweepInBackground())
+                blocks++;
+        }
+        return blocks;
+    }
+
+#endif // MMGC_BACKGROUND_SWEEPING
+
+#ifdef MMGC_BACKGROUND_DECOMMIT
+
+    GCDecommitterThread::GCDecommitterThread(GCBackgroundDecommitter* decommitter)
+        : decommitter(decommitter)
+    {
+    }
+
+    void GCDecommitterThread::run()
+    {
+        decommitter->HelperMain();
+    }
+
+    GCBackgroundDecommitter::GCBackgroundDecommitter(GCHeap* heap)
+        : heap(heap)
+        , runnable(NULL)
+        , thread(NULL)
+        , threadFailed(false)
+        , pending(false)
+        , requests(0)
+        , requestTicks(0)
+        , shutdown(false)
+    {
+    }
+
+    GCBackgroundDecommitter::~GCBackgroundDecommitter()
+    {
+        if (thread == NULL)
+            return;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            shutdown = true;
+            locker.notifyAll();
+        }
+        thread->join();
+        mmfx_delete(thread);
+        mmfx_delete(runnable);
+    }
+
+    void GCBackgroundDecommitter::Request()
+    {
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            if (thread == NULL) {
+                if (threadFailed)
+                    return;
+                runnable = mmfx_new(GCDecommitterThread(this));
+                thread = mmfx_new(vmbase::VMThread("MMgc decommitter", runnable));
+                if (!thread->start()) {
+                    // Don't try again; the surplus stays committed.
+                    mmfx_delete(thread);
+                    mmfx_delete(runnable);
+                    thread = NULL;
+                    runnable = NULL;
+                    threadFailed = true;
+                    return;
+                }
+            }
+            if (!pending) {
+                pending = true;
+                requestTicks = VMPI_getPerformanceCounter();
+            }
+            requests++;
+            locker.notifyAll();
+        }
+    }
+
+    void GCBackgroundDecommitter::HelperMain()
+    {
+        for (;;) {
+            uint32_t seen;
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (!pending && !shutdown)
+                    locker.wait();
+                if (shutdown)
+                    return;
+                seen = requests;
+            }
+
+            int32_t pause;
+            while ((pause = Step()) >= 0) {
+                SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                    if (shutdown)
+                        return;
+                    locker.wait(pause);
+                    if (shutdown)
+                        return;
+                }
+            }
+
+            // No surplus left.  A request that came in while we were looking keeps
+            // the helper going, without restarting the delay.
+            SCOPE_LOCK_NO_SP(monitor) {
+                if (requests == seen)
+                    pending = false;
+            }
+        }
+    }
+
+    int32_t GCBackgroundDecommitter::Step()
+    {
+        uint64_t since;
+        SCOPE_LOCK_NO_SP(monitor) {
+            since = requestTicks;
+        }
+        uint64_t frequency = VMPI_getPerformanceFrequency();
+        uint64_t delay = uint64_t(heap->config.decommitDelay) * frequency / 1000;
+
+        // The monitor must not be taken while holding the heap lock.
+        MMGC_LOCK(heap->m_spinlock);
+
+        if (!heap->config.returnMemory || !heap->m_oomHandling || heap->status != kMemNormal)
+            return -1;
+
+        size_t surplus = heap->DecommitSurplus();
+        if (surplus == 0)
+            return -1;
+
+        // Hysteresis: any recommit since the surplus was reported restarts the delay.
+        if (heap->lastRecommitTicks > since)
+            since = heap->lastRecommitTicks;
+        uint64_t now = VMPI_getPerformanceCounter();
+        uint64_t elapsed = now > since ? now - since : 0;
+        if (elapsed < delay)
+            return int32_t(((delay - elapsed) * 1000 + frequency - 1) / frequency);
+
+        uint64_t before = heap->commitStats.decommitBlocks;
+        heap->DecommitBlocks(surplus < kStepBlocks ? surplus : kStepBlocks);
+        uint64_t released = heap->commitStats.decommitBlocks - before;
+        heap->commitStats.backgroundBlocks += released;
+
+        // Nothing could be released, eg because no free block is big enough in
+        // huge-page mode; wait for the next request rather than spin.
+        if (released == 0)
+            return -1;
+        return kStepPause;
+    }
+
+#endif // MMGC_BACKGROUND_DECOMMIT
+}
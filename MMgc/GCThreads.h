@@ -4,4 +4,313 @@
  * License, v. 2.0. If a copy of the MPL was not distributed with this
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
-// empty
+#ifndef __GCThreads__
+#define __GCThreads__
+
+namespace MMgc
+{
+#ifdef MMGC_PARALLEL_MARKING
+    class GCParallelMarker;
+
+    /**
+     * Body of a marker helper thread; it just calls back into the marker.
+     */
+    class GCMarkerThread : public vmbase::Runnable
+    {
+    public:
+        GCMarkerThread(GCParallelMarker* marker, uint32_t index);
+        virtual void run();
+
+    private:
+        GCParallelMarker* const marker;
+        const uint32_t index;
+    };
+
+    /**
+     * The parallel marker drains the mark stack using several threads while the
+     * mutator is stopped, ie, for the unbounded GC::Mark() calls made from
+     * FinishIncrementalMark, stack overflow handling, and presweep.  The
+     * incremental marker is not affected.
+     *
+     * Each marker thread has a private GCMarkStack that it pushes and pops without
+     * synchronization, plus a lock-protected "stash" stack that other threads can
+     * steal from.  Work moves between threads only at segment granularity: when a
+     * thread's private stack has a full inactive segment and its stash is empty, the
+     * segment is moved to the stash; when a thread runs out of work it takes the
+     * entire contents of some other thread's stash.  Since items never straddle a
+     * segment boundary a segment is always a self-contained unit of work.
+     *
+     * Thread 0 is the collector's own thread and uses GC::m_incrementalWork as its
+     * private stack; the helper threads are created when the marker is first used
+     * and are parked on a monitor between marking phases.
+     *
+     * Mark bits: Threads race to set kQueued on an unmarked object.  The races are
+     * benign: the loser either sees the bit and does nothing, or also queues the
+     * object, which is then traced twice.  Tracing is idempotent, and no other bits in
+     * an object's gcbits_t change while the mutator is stopped, so a lost update only
+     * ever rewrites bits with their current values.  Objects whose queued bit is
+     * cleared by mark stack overflow in one thread are recovered by the normal
+     * overflow handling, which rescans marked objects.
+     *
+     * Termination: a thread that finds no work to steal increments a shared idle
+     * count and spins, looking for stashed work.  An idle thread's stash is always
+     * empty, since only the owner stashes work and it takes it back before going
+     * idle, so once all threads are idle there is no more work and the phase is over.
+     *
+     * Per-thread mark work counters are merged into the policy manager when the
+     * phase is over; the policy manager's counters are not thread safe.
+     */
+    class GCParallelMarker
+    {
+        friend class GCMarkerThread;
+    public:
+        /**
+         * Per-thread state.  The objects* and bytes* fields mirror the mark work
+         * counters in the policy manager.
+         */
+        struct Worker
+        {
+            Worker();
+
+            GCMarkStack* stack;             // Private stack, only touched by the owner
+            GCMarkStack* stash;             // Shared stack, protected by 'lock'
+            vmpi_spin_lock_t lock;
+            volatile int32_t stashed;       // Nonzero iff stash is nonempty; written under 'lock'
+            uint32_t steals;                // Number of successful steals in this phase
+            uint32_t objectsExactly;
+            uint32_t bytesExactly;
+            uint32_t objectsConservatively;
+            uint32_t bytesConservatively;
+            uint32_t bytesConservativeRoots;    // Subset of bytesConservatively from roots and stacks
+            uint32_t objectsPointerfree;
+            uint32_t bytesPointerfree;
+        };
+
+        /**
+         * @param gc          The collector to mark for
+         * @param numThreads  The total number of marker threads, including the
+         *                    collector's own thread; must be at least 2.
+         */
+        GCParallelMarker(GC* gc, uint32_t numThreads);
+        ~GCParallelMarker();
+
+        /**
+         * Drain the collector's mark stack, and transitively everything reachable from
+         * its contents.  The calling thread marks alone until there is at least one
+         * full segment of work that can be shared, then the helpers are released.
+         * Returns when all mark stacks are empty.
+         */
+        void Mark();
+
+        /**
+         * @return true while the helpers are marking.  GC reads this on every push to
+         * decide which stack to use.
+         */
+        bool Active() const;
+
+        /**
+         * @return the state for the calling marker thread.  Only valid while Active().
+         */
+        Worker* CurrentWorker();
+
+    private:
+        void StartThreads();
+        void StopThreads();
+
+        // Run by every marker thread while the phase is active
+        void RunWorker(uint32_t index);
+        void DrainLocal(Worker* w);
+        bool StealWork(uint32_t index);
+        bool StashedWorkAvailable();
+
+        // Run by the helper threads
+        void HelperMain(uint32_t index);
+
+        // Merge per-thread counters into the policy manager and reset them.
+        void FinishPhase(uint64_t parallelTicks);
+
+        GC* const gc;
+        const uint32_t numThreads;
+        uint32_t numHelpersStarted;         // May be less than numThreads-1 if thread creation failed
+        Worker* workers;
+        GCMarkerThread** runnables;
+        vmbase::VMThread** threads;
+        GCThreadLocal<Worker*> currentWorker;
+
+        volatile int32_t active;            // Nonzero during the parallel part of Mark()
+        volatile int32_t idle;              // Number of idle workers, see termination above
+
+        vmbase::WaitNotifyMonitor monitor;  // Protects the following, used to park helpers
+        uint32_t epoch;                     // Incremented to release the helpers
+        uint32_t helpersFinished;           // Number of helpers done with the current epoch
+        bool shutdown;
+    };
+
+    REALLY_INLINE bool GCParallelMarker::Active() const
+    {
+        return active != 0;
+    }
+
+    REALLY_INLINE GCParallelMarker::Worker* GCParallelMarker::CurrentWorker()
+    {
+        GCAssert(Active());
+        return currentWorker;
+    }
+#endif // MMGC_PARALLEL_MARKING
+
+#ifdef MMGC_BACKGROUND_SWEEPING
+    class GCBackgroundSweeper;
+
+    /**
+     * Body of the background sweeper thread; it just calls back into the sweeper.
+     */
+    class GCSweeperThread : public vmbase::Runnable
+    {
+    public:
+        GCSweeperThread(GCBackgroundSweeper* sweeper);
+        virtual void run();
+
+    private:
+        GCBackgroundSweeper* const sweeper;
+    };
+
+    /**
+     * The background sweeper sweeps the blocks of the allocators for non-finalized
+     * objects on a helper thread, after the collection that left them on the
+     * allocators' sweep lists.  Without it those blocks are swept lazily by the
+     * allocator, on the mutator thread, when it needs memory.
+     *
+     * The helper thread only sweeps the block's bits and free list; the swept block is
+     * moved to the allocator's list of swept blocks, and the mutator returns it to
+     * the free list or to the block manager when the allocator next needs memory.
+     * A block is swept while holding the allocator's sweep lock, and the mutator
+     * takes that lock when it needs to touch a block that has not yet been processed
+     * (see GCAlloc::SweepInBackground).
+     *
+     * The sweeper is started at the end of GC::Sweep and is always finished before
+     * the next collection starts, in GC::SweepNeedsSweeping; whatever it has not
+     * reached by then is swept on the mutator as before.  Allocators for finalized
+     * objects are not touched: finalization runs destructors on the mutator, and
+     * their blocks may hold objects that the reference counter manipulates.
+     */
+    class GCBackgroundSweeper
+    {
+        friend class GCSweeperThread;
+    public:
+        GCBackgroundSweeper(GC* gc);
+        ~GCBackgroundSweeper();
+
+        /**
+         * Release the helper thread to sweep the pending blocks.  The helper thread
+         * is created on first use; if that fails the blocks are left to the allocators.
+         */
+        void Start();
+
+        /**
+         * Stop the helper thread and wait for it to become idle.  It is safe to call
+         * this if the sweeper has not been started.
+         */
+        void Finish();
+
+    private:
+        // Run by the helper thread
+        void HelperMain();
+        uint32_t SweepAll();
+
+        GC* const gc;
+        GCSweeperThread* runnable;
+        vmbase::VMThread* thread;
+        bool threadFailed;
+        bool running;                       // Mutator's view: Start() called, Finish() not yet
+
+        volatile int32_t abort;             // Set by Finish() to make the helper stop early
+
+        vmbase::WaitNotifyMonitor monitor;  // Protects the following, used to park the helper
+        uint32_t epoch;                     // Incremented to release the helper
+        uint32_t epochDone;                 // Last epoch the helper has finished sweeping for
+        bool shutdown;
+        uint32_t blocksSwept;               // Blocks swept by the helper in the last epoch
+        uint64_t sweepTicks;                // Time the helper spent sweeping in the last epoch
+    };
+#endif // MMGC_BACKGROUND_SWEEPING
+
+#ifdef MMGC_BACKGROUND_DECOMMIT
+    class GCBackgroundDecommitter;
+
+    /**
+     * Body of the background decommitter thread; it just calls back into the decommitter.
+     */
+    class GCDecommitterThread : public vmbase::Runnable
+    {
+    public:
+        GCDecommitterThread(GCBackgroundDecommitter* decommitter);
+        virtual void run();
+
+    private:
+        GCBackgroundDecommitter* const decommitter;
+    };
+
+    /**
+     * The background decommitter takes over GCHeap::Decommit's job of returning surplus
+     * free memory to the OS when GCHeapConfig::backgroundDecommit is set.  A program
+     * whose heap oscillates in size otherwise decommits memory after one collection
+     * only to fault it back in soon after, paying for both on the mutator thread.
+     *
+     * GCHeap::Decommit only notes that there is a surplus.  The helper thread waits
+     * until the surplus has lasted for GCHeapConfig::decommitDelay milliseconds without
+     * the heap having to recommit memory, then releases it in steps of kStepBlocks,
+     * taking the heap lock for one step at a time and pausing between steps so that
+     * the mutator's allocations are not held up.  A recommit restarts the delay.  The
+     * surplus is recomputed for every step, and GCHeapConfig::decommitReserve bytes of
+     * committed free memory are always left in place (see GCHeap::DecommitSurplus).
+     *
+     * Surpluses caused by the heap limits, and decommits done in response to memory
+     * pressure, are still handled synchronously by GCHeap::Decommit.
+     *
+     * The decommitter is created with the heap, before there is an MMGC_ENTER on the
+     * stack, so it comes from the system allocator.
+     */
+    class GCBackgroundDecommitter : public GCAllocObject
+    {
+        friend class GCDecommitterThread;
+    public:
+        GCBackgroundDecommitter(GCHeap* heap);
+        ~GCBackgroundDecommitter();
+
+        /**
+         * Tell the helper thread there is a surplus of free memory.  The helper thread
+         * is created on first use; if that fails, requests are ignored.  The caller
+         * must not hold the heap lock.
+         */
+        void Request();
+
+    private:
+        // Blocks decommitted while holding the heap lock
+        static const size_t kStepBlocks = 64;
+
+        // Milliseconds between steps
+        static const int32_t kStepPause = 1;
+
+        // Run by the helper thread
+        void HelperMain();
+
+        // Release one step of the surplus if it has outlived the delay.  Returns the
+        // number of milliseconds to wait before the next step, or -1 if there is no
+        // surplus left.
+        int32_t Step();
+
+        GCHeap* const heap;
+        GCDecommitterThread* runnable;
+        vmbase::VMThread* thread;
+        bool threadFailed;
+
+        vmbase::WaitNotifyMonitor monitor;  // Protects the following
+        bool pending;                       // A surplus has been reported and not yet released
+        uint32_t requests;                  // Incremented by every Request()
+        uint64_t requestTicks;              // When 'pending' was last set
+        bool shutdown;
+    };
+#endif // MMGC_BACKGROUND_DECOMMIT
+}
+
+#endif /* __GCThreads__ */
@@ -99,6 +99,30 @@ namespace MMgc
 #endif
     };
 
+#ifdef MMGC_INLINE_WEAKREFS
+    /**
+     * When GCHeapConfig::inlineWeakRefs is set the GC does not map objects to their
+     * weakrefs through a hashtable.  Instead a block that holds at least one object with
+     * a weakref points to one of these from its header, and the weakref of the object at
+     * index i in the block is in refs[i].  (A large object's block has one slot.)  The
+     * kHasWeakRef bit still tells whether an object has a weakref, so the common case -
+     * an object without one - never touches the slots.
+     *
+     * The GC links all slot arrays together so that GC::MarkOrClearWeakRefs can visit
+     * every weakref without a table walk, and frees an array when its last weakref is
+     * cleared.
+     */
+    struct GCWeakRefSlots
+    {
+        GCWeakRefSlots* prev;
+        GCWeakRefSlots* next;
+        GCWeakRefSlots** owner;     // the block header field that points to this array
+        uint32_t capacity;          // number of slots
+        uint32_t population;        // number of non-NULL slots
+        GCWeakRef* refs[1];         // really 'capacity' slots
+    };
+#endif
+
 #if 0
     // something like this would be nice
     template<class T> class GCWeakRefPtr
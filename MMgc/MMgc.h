@@ -152,6 +152,117 @@
     #define MEMORY_INFO_ARG(x)
 #endif
 
+// MMGC_PARALLEL_MARKING allows the final, non-incremental drain of the mark stack
+// to be performed by several threads (see GCThreads.h).  It is off at run time unless
+// the host sets GCHeapConfig::markThreads.  The profilers that hook into the marker
+// are not thread safe, so parallel marking is disabled when they are.
+
+#if defined MMGC_LOCKING && !defined MMGC_HEAP_GRAPH && !defined MMGC_CONSERVATIVE_PROFILER && \
+    !defined MMGC_POINTINESS_PROFILING && !defined MMGC_MARKSTACK_DEPTH
+    #define MMGC_PARALLEL_MARKING
+#endif
+
+// MMGC_BACKGROUND_SWEEPING allows the blocks of the allocators for non-finalized objects
+// to be swept on a helper thread after a collection (see GCThreads.h), instead of lazily
+// by the allocator.  It is off at run time unless the host sets
+// GCHeapConfig::backgroundSweeping.
+
+#ifdef MMGC_LOCKING
+    #define MMGC_BACKGROUND_SWEEPING
+#endif
+
+// MMGC_BACKGROUND_DECOMMIT allows GCHeap to hand the decommitting of surplus free memory
+// to a helper thread that releases it gradually, and only once the surplus has outlived
+// a delay (see GCBackgroundDecommitter in GCThreads.h).  It is off at run time unless the
+// host sets GCHeapConfig::backgroundDecommit.
+
+#ifdef MMGC_LOCKING
+    #define MMGC_BACKGROUND_DECOMMIT
+#endif
+
+// MMGC_GENERATIONAL allows the collector to run nursery collections, which trace only
+// the objects allocated since the previous collection, between full collections (see
+// GC::NurseryCollect).  It is off at run time unless the host sets
+// GCHeapConfig::generational.
+
+#define MMGC_GENERATIONAL
+
+// MMGC_CARD_MARKING allows the incremental collector to use a card-marking write barrier:
+// while marking, a pointer store only dirties the byte covering its 512-byte card, and
+// the marked objects on dirty cards are rescanned when marking finishes (see
+// GC::ScanDirtyCards).  It is off at run time unless the host sets
+// GCHeapConfig::cardMarking.
+
+#define MMGC_CARD_MARKING
+
+// MMGC_HUGE_PAGES allows GCHeap to reserve its regions on huge-page boundaries and
+// advise the OS to back them with transparent huge pages (see AVMPI_getHugePageSize).
+// It is off at run time unless the host sets GCHeapConfig::hugePages, and it has no
+// effect on platforms where AVMPI_getHugePageSize returns 0.
+
+#define MMGC_HUGE_PAGES
+
+// MMGC_COMPACTION allows a full collection to evacuate the live objects out of sparsely
+// occupied small-object blocks so that those blocks can be returned to GCHeap (see
+// GC::Compact).  Only objects registered with GC::SetMovable are candidates.  It is
+// off at run time unless the host sets GCHeapConfig::compaction.
+
+#define MMGC_COMPACTION
+
+// MMGC_FIXEDMALLOC_MAGAZINES allows FixedMalloc to keep per-thread magazines of free
+// small objects, so that a thread inside MMGC_ENTER takes an allocator lock only to
+// refill or flush a magazine in batches.  It is off at run time unless the host sets
+// GCHeapConfig::fixedMagazines.
+
+#define MMGC_FIXEDMALLOC_MAGAZINES
+
+// MMGC_EVENT_STREAM allows the policy manager to describe every GC phase and every
+// completed collection as a one-line JSON record (see GCEventWriter).  Records are only
+// formatted when the host has installed a writer with GCHeap::SetEventWriter or when a
+// telemetry session is active.
+
+#define MMGC_EVENT_STREAM
+
+// MMGC_PAUSE_TARGET allows the policy manager to schedule incremental collection work
+// against a maximum pause time and a minimum mutator utilization instead of against the
+// load factor alone (see GCPolicyManager::adjustForPause).  It is off at run time unless
+// the host sets GCHeapConfig::gcPauseTarget.
+
+#define MMGC_PAUSE_TARGET
+
+// MMGC_STACK_MAPS allows the host to describe some native stack frames precisely (see
+// GCStackMaps), so that marking and ZCT reaping scan only the words the host reports as
+// possibly holding pointers in those frames, and scan the rest of the stack conservatively.
+// It is off at run time unless the host sets GCHeapConfig::stackMaps.
+
+#define MMGC_STACK_MAPS
+
+// MMGC_INLINE_WEAKREFS allows the GC to find an object's GCWeakRef through a slot array
+// hung off the object's block header and indexed by the object's position in the block,
+// instead of through the GC::weakRefs hashtable.  It is off at run time unless the host
+// sets GCHeapConfig::inlineWeakRefs.
+
+#define MMGC_INLINE_WEAKREFS
+
+// MMGC_HEAP_SNAPSHOT allows the host to write every live object and every reference
+// between live objects to a GCHeapSnapshotWriter for offline analysis of what retains
+// what (see GC::WriteHeapSnapshot and utils/heapsnapshot.py).  Nothing is written unless
+// the host asks for a snapshot.
+
+#define MMGC_HEAP_SNAPSHOT
+
+// MMGC_ALLOCATION_SAMPLER allows the host to sample managed allocations, about one per
+// GCHeapConfig::allocationSampleInterval bytes, and to write the sampled allocation sites
+// with the bytes allocated and still live at each (see GCAllocationSampler).  The cost
+// is a countdown on the allocation fast path unless sampling is configured.
+
+#define MMGC_ALLOCATION_SAMPLER
+
+// MMGC_INCREMENTAL_REAP allows the ZCT to be reaped in time-bounded slices scheduled by
+// the policy manager (see ZCT::ReapSlice), instead of all at once when the table fills
+// up.  It is off at run time unless the host sets GCHeapConfig::incrementalReap.
+
+#define MMGC_INCREMENTAL_REAP
 
 // Bugzilla 754281: MMGC_HAS_TRUSTWORTHY_GET_STACK_ENTER,
 // when defined, tells the GC that we can use GC::GetStackEnter()
@@ -209,7 +320,17 @@
 // https://bugzilla.mozilla.org/show_bug.cgi?id=581070
 //#define MMGC_USE_UNIFORM_PAGEMAP
 
-#ifdef MMGC_HEAP_GRAPH
+// MMGC_RADIX_PAGEMAP selects PageMap::Radix for the GC's page map.  Its lookups take no
+// lock and write no shared state, so the parallel marker threads can query it freely;
+// the DelayT4 map used by 64-bit builds otherwise updates a lookup cache on every query.
+
+#ifndef MMGC_USE_UNIFORM_PAGEMAP
+    #define MMGC_RADIX_PAGEMAP
+#endif
+
+// The tracing functions take the location of the traced pointer when the heap graph
+// is being built, and when compaction needs to update references to moved objects.
+#if defined MMGC_HEAP_GRAPH || defined MMGC_COMPACTION
     #define HEAP_GRAPH_ARG(x) , x
 #else
     #define HEAP_GRAPH_ARG(x)
@@ -220,6 +341,7 @@ namespace MMgc
     class GC;
     class RCObject;
     class GCWeakRef;
+    struct GCWeakRefSlots;
     class GCFinalizedObject;
     class GCObject;
     class Cleaner;
@@ -235,11 +357,11 @@ namespace MMgc
 #include "AllocationMacros.h"
 #include "OOM.h"
 #include "GCStack.h"
-#include "GCThreads.h"
 #include "GCAllocObject.h"
 #include "GCHashtable.h"
 #include "GCMemoryProfiler.h"
 #include "GCThreadLocal.h"
+#include "GCThreads.h"
 #include "FixedAlloc.h"
 #include "FixedMalloc.h"
 #include "GCGlobalNew.h"
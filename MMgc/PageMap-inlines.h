@@ -304,6 +304,50 @@ namespace MMgc
         }
 #endif // ! defined(MMGC_USE_UNIFORM_PAGEMAP) && defined(MMGC_64BIT)
 
+        /* static */
+        REALLY_INLINE uint32_t Radix::AddrToLeafWordIndex(uintptr_t addr)
+        {
+            return uint32_t(addr >> (kPageShift + 4)) & (leaf_words - 1);
+        }
+
+        /* static */
+        REALLY_INLINE uint32_t Radix::AddrToWordShiftAmt(uintptr_t addr)
+        {
+            // shift amount to determine position in the word (times 2 b/c 2 bits per page)
+            MMGC_STATIC_ASSERT(pages_per_word == 16);
+            return (uint32_t(addr >> kPageShift) & 0xf) * 2;
+        }
+
+        REALLY_INLINE const volatile Radix::LeafWord* Radix::AddrToLeaf(uintptr_t addr) const
+        {
+            // Each node is read with a single load of the slot that
+            // points to it, and the dependent loads below cannot be
+            // satisfied before that load on the hardware we run on, so
+            // the barrier in EnsureNode is the only one needed.
+            GCAssert((addr >> root_shift) < root_entries);
+            void* node = root[addr >> root_shift];
+#ifdef MMGC_64BIT
+            if (node == NULL)
+                return NULL;
+            node = ((Slot*)node)[(addr >> inner1_shift) & (inner_entries - 1)];
+            if (node == NULL)
+                return NULL;
+            node = ((Slot*)node)[(addr >> inner2_shift) & (inner_entries - 1)];
+#endif
+            return (const volatile LeafWord*)node;
+        }
+
+        REALLY_INLINE PageType Radix::AddrToVal(uintptr_t addr) const
+        {
+            const volatile LeafWord* leaf = AddrToLeaf(addr);
+
+            MMGC_STATIC_ASSERT(kNonGC == 0);
+            if (leaf == NULL)
+                return kNonGC;
+
+            LeafWord word = leaf[AddrToLeafWordIndex(addr)];
+            return PageType((word >> AddrToWordShiftAmt(addr)) & 0x3);
+        }
     }
 }
 
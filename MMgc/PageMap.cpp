@@ -571,5 +571,117 @@ namespace MMgc
             SimpleExpandSetAll(this, heap, item, numPages, val);
         }
 #endif // ! defined(MMGC_USE_UNIFORM_PAGEMAP) && defined(MMGC_64BIT)
+
+        Radix::Radix()
+            : PageMapBase()
+        {
+            for (uint32_t i=0; i < root_entries; i++)
+                root[i] = NULL;
+            VMPI_lockInit(&lock);
+        }
+
+        Radix::~Radix()
+        {
+            VMPI_lockDestroy(&lock);
+        }
+
+        void Radix::DestroyPageMapVia(GCHeap *heap)
+        {
+            MMGC_LOCK(lock);
+            for (uint32_t i=0; i < root_entries; i++) {
+                void* node = root[i];
+                if (node == NULL)
+                    continue;
+#ifdef MMGC_64BIT
+                Slot* subMap1 = (Slot*)node;
+                for (uint32_t j=0; j < inner_entries; j++) {
+                    Slot* subMap2 = (Slot*)subMap1[j];
+                    if (subMap2 == NULL)
+                        continue;
+                    for (uint32_t k=0; k < inner_entries; k++) {
+                        if (subMap2[k] != NULL)
+                            heap->Free(subMap2[k]);
+                    }
+                    heap->Free(subMap2);
+                }
+#endif
+                heap->Free(node);
+                root[i] = NULL;
+            }
+        }
+
+        /* static */
+        void* Radix::EnsureNode(GCHeap *heap, Slot* slot, uint32_t pages)
+        {
+            void* node = *slot;
+            if (node == NULL) {
+                // AllocNoOOM zeroes the node (and must not trigger OOM
+                // handling here; see GC::MarkGCPages).  The barrier
+                // orders the zeroing before the publication.
+                node = heap->AllocNoOOM(pages);
+                VMPI_memoryBarrier();
+                *slot = node;
+            }
+            return node;
+        }
+
+        volatile Radix::LeafWord* Radix::EnsureLeaf(GCHeap *heap, uintptr_t addr)
+        {
+            GCAssert((addr >> root_shift) < root_entries);
+            Slot* slot = &root[addr >> root_shift];
+#ifdef MMGC_64BIT
+            Slot* subMap1 = (Slot*)EnsureNode(heap, slot, inner_pages);
+            slot = &subMap1[(addr >> inner1_shift) & (inner_entries - 1)];
+            Slot* subMap2 = (Slot*)EnsureNode(heap, slot, inner_pages);
+            slot = &subMap2[(addr >> inner2_shift) & (inner_entries - 1)];
+#endif
+            return (volatile LeafWord*)EnsureNode(heap, slot, leaf_pages);
+        }
+
+        void Radix::ExpandSetAll(GCHeap *heap, void *item,
+                                 uint32_t numPages, PageType val)
+        {
+            MMGC_LOCK(lock);
+
+            uintptr_t addr = uintptr_t(item);
+            uintptr_t addr_lim = addr + uintptr_t(numPages)*kPageSize;
+            GCAssert((addr & (kPageSize-1)) == 0);
+
+            volatile LeafWord* leaf = NULL;
+            uintptr_t leaf_prefix = 0;
+            for (uintptr_t a = addr; a < addr_lim; a += kPageSize) {
+                if (leaf == NULL || (a >> leaf_shift) != leaf_prefix) {
+                    leaf = EnsureLeaf(heap, a);
+                    leaf_prefix = a >> leaf_shift;
+                }
+                volatile LeafWord& word = leaf[AddrToLeafWordIndex(a)];
+                uint32_t shift = AddrToWordShiftAmt(a);
+                LeafWord old = word;
+                GCAssert(((old >> shift) & 0x3) == 0);
+                word = old | (LeafWord(val) << shift);
+            }
+
+            // A lookup that sees the old range for a new page is told
+            // kNonGC, which is what it could have seen anyway.
+            if (addr < memStart)
+                memStart = addr;
+            if (addr_lim > memEnd)
+                memEnd = addr_lim;
+        }
+
+        void Radix::ClearAddrs(void *item, uint32_t numpages)
+        {
+            MMGC_LOCK(lock);
+
+            uintptr_t addr = uintptr_t(item);
+            while (numpages--) {
+                const volatile LeafWord* leaf = AddrToLeaf(addr);
+                if (leaf != NULL) {
+                    volatile LeafWord& word = const_cast<volatile LeafWord*>(leaf)[AddrToLeafWordIndex(addr)];
+                    word = word & ~(LeafWord(0x3) << AddrToWordShiftAmt(addr));
+                }
+                addr += kPageSize;
+            }
+        }
     }
 }
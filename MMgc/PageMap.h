@@ -354,6 +354,8 @@ namespace MMgc
         };
 
         // CacheT4 is like Tiered4 but caches most-recently used leaf.
+        // Lookups update the cache, so they must not run on more than
+        // one thread at a time (compare Radix).
         class CacheT4 : protected Tiered4
         {
         public:
@@ -439,6 +441,91 @@ namespace MMgc
             bool stillInitialDelay; // true iff only cache exists.
         };
 #endif // ! defined(MMGC_USE_UNIFORM_PAGEMAP) && defined(MMGC_64BIT)
+
+        // Radix is a radix tree like Tiered4 (Tiered2 on 32-bit
+        // systems) whose lookups take no lock and write no shared
+        // state, so that the parallel marker threads, or any other
+        // thread working for the GC, can query it while the mutator
+        // updates it.
+        //
+        // Updates are serialized by a spin lock.  A node is zeroed
+        // before it is published with a single pointer store behind a
+        // memory barrier, so a lookup sees either no node or a
+        // complete one.  Nodes are not freed until DestroyPageMapVia,
+        // so a lookup never reads a retired node and no grace period
+        // is needed.  A lookup that races with an update of the same
+        // page sees either the old or the new value.
+        //
+        // Leaves are bitmaps of 32-bit words, 16 pages to a word, and
+        // cover 2^16 pages each.  On 64-bit systems two tiers of 2^11
+        // entries sit between the leaves and a root of 2^4 entries
+        // inlined into the object, covering 56 address bits like
+        // Tiered4; on 32-bit systems the root points at the leaves.
+        class Radix : private PageMapBase
+        {
+        public:
+            Radix();
+            ~Radix();
+
+            // adjust access (aka "re-export") utilty methods.
+            using PageMapBase::MemStart;
+            using PageMapBase::MemEnd;
+            using PageMapBase::AddrIsMappable;
+
+            // Doc for public methods: see Uniform.
+            void DestroyPageMapVia(GCHeap *heap);
+            PageType AddrToVal(uintptr_t addr) const;
+            void ExpandSetAll(GCHeap *h, void *item, uint32_t np, PageType val);
+            void ClearAddrs(void *item, uint32_t numpages);
+
+        private:
+            typedef uint32_t LeafWord;
+            typedef void* volatile Slot;
+
+            static const uint32_t pages_per_word = 16;
+            static const uint32_t leaf_nbits = 16;
+            static const uint32_t leaf_words = (1 << leaf_nbits) / pages_per_word;
+            static const uint32_t leaf_pages = leaf_words*sizeof(LeafWord) / GCHeap::kBlockSize;
+            MMGC_STATIC_ASSERT(leaf_pages * GCHeap::kBlockSize == leaf_words*sizeof(LeafWord));
+            static const uintptr_t leaf_shift = kPageShift + leaf_nbits;
+
+#ifdef MMGC_64BIT
+            static const uint32_t inner_nbits = 11;
+            static const uint32_t inner_entries = 1 << inner_nbits;
+            static const uint32_t inner_pages = inner_entries*sizeof(Slot) / GCHeap::kBlockSize;
+            MMGC_STATIC_ASSERT(inner_pages * GCHeap::kBlockSize == inner_entries*sizeof(Slot));
+            static const uintptr_t inner2_shift = leaf_shift;
+            static const uintptr_t inner1_shift = inner2_shift + inner_nbits;
+            static const uintptr_t root_shift = inner1_shift + inner_nbits;
+            static const uint32_t root_nbits = 56 - root_shift;
+#else
+            static const uintptr_t root_shift = leaf_shift;
+            static const uint32_t root_nbits = 32 - root_shift;
+#endif
+            static const uint32_t root_entries = 1 << root_nbits;
+
+            /** @return the leaf covering addr, or NULL.  Takes no lock. */
+            const volatile LeafWord* AddrToLeaf(uintptr_t addr) const;
+
+            /**
+             * @return the leaf covering addr, allocating and publishing
+             * the missing nodes on the path to it.  Requires the lock.
+             */
+            volatile LeafWord* EnsureLeaf(GCHeap *heap, uintptr_t addr);
+
+            /**
+             * @return the node in slot, first allocating a zeroed node of
+             * the given number of blocks and publishing it there if the
+             * slot is empty.  Requires the lock.
+             */
+            static void* EnsureNode(GCHeap *heap, Slot* slot, uint32_t pages);
+
+            static uint32_t AddrToLeafWordIndex(uintptr_t addr);
+            static uint32_t AddrToWordShiftAmt(uintptr_t addr);
+
+            Slot root[root_entries];
+            vmpi_spin_lock_t lock;      // Serializes updates, lookups don't take it
+        };
     }
 }
 
@@ -119,17 +119,45 @@ namespace MMgc
         }
 #endif
         if (BarrierActive()) {
+#ifdef MMGC_CARD_MARKING
+            // The card can be dirtied without finding the object.
+            if (DirtyCard(address)) {
+                POLICY_PROFILING_ONLY( policy.signalWriteBarrierWork(0); )
+                return;
+            }
+#endif
             const void* container = FindBeginningFast(address);
             InlineWriteBarrierTrap(container);
         }
     }
 
+#ifdef MMGC_CARD_MARKING
+    /*private*/
+    REALLY_INLINE bool GC::DirtyCard(const void *address)
+    {
+        // m_cardLimit is zero when there is no card table, so one unsigned
+        // comparison covers that case and addresses outside the table.
+        uintptr_t offset = uintptr_t(address) - m_cardBase;
+        if (offset >= m_cardLimit)
+            return false;
+        m_cards[offset >> kCardShift] = 1;
+        return true;
+    }
+#endif
+
     /*private*/
     REALLY_INLINE void GC::InlineWriteBarrierTrap(const void *container)
     {
         GCAssert(BarrierActive());
         GCAssert(IsPointerToGCPage(container));
 
+#ifdef MMGC_CARD_MARKING
+        if (DirtyCard(container)) {
+            POLICY_PROFILING_ONLY( policy.signalWriteBarrierWork(0); )
+            return;
+        }
+#endif
+
         POLICY_PROFILING_ONLY(int stage=0;)
         // If the object is black then it needs to be gray, because we just stored
         // something into it.
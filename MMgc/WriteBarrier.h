@@ -59,7 +59,7 @@ namespace MMgc
      */
     template<class T> class WriteBarrier
     {
-#ifdef MMGC_HEAP_GRAPH
+#if defined MMGC_HEAP_GRAPH || defined MMGC_COMPACTION
         friend class GC;    // for location()
 #endif
         
@@ -103,7 +103,7 @@ namespace MMgc
         // WriteBarriers on the stack with it
         WriteBarrier(const WriteBarrier<T>& toCopy);    // unimplemented
 
-#ifdef MMGC_HEAP_GRAPH
+#if defined MMGC_HEAP_GRAPH || defined MMGC_COMPACTION
         const T* location() const { return &t; }
 #endif
         
@@ -116,7 +116,7 @@ namespace MMgc
      */
     template<class T> class WriteBarrierRC
     {
-#ifdef MMGC_HEAP_GRAPH
+#if defined MMGC_HEAP_GRAPH || defined MMGC_COMPACTION
         friend class GC;    // for location()
 #endif
 
@@ -164,7 +164,7 @@ namespace MMgc
         // WriteBarrierRCs on the stack with it
         WriteBarrierRC(const WriteBarrierRC<T>& toCopy);
 
-#ifdef MMGC_HEAP_GRAPH
+#if defined MMGC_HEAP_GRAPH || defined MMGC_COMPACTION
         const T* location() const { return &t; }
 #endif
         
@@ -194,7 +194,7 @@ namespace MMgc
         
         /**
          * @return the location of the Atom slot.  Used by GC::TraceAtom(AtomWBCore*)
-         * to implement MMGC_HEAP_GRAPH.
+         * to implement MMGC_HEAP_GRAPH and MMGC_COMPACTION.
          */
         avmplus::Atom* location() { return &m_atom; }
     };
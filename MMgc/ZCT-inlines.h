@@ -73,6 +73,11 @@ namespace MMgc
         return reaping;
     }
 
+    REALLY_INLINE bool ZCT::IsReapInProgress()
+    {
+        return reapInProgress;
+    }
+
     REALLY_INLINE uint32_t ZCT::BlockNumber(uint32_t idx)
     {
         return idx/CAPACITY(RCObject**);
@@ -67,8 +67,43 @@ namespace MMgc
      * - The ZCT will honor calls to Pin() from prereap() but not necessarily any
      *   calls to Pin() earlier than that.  When an object is added to the ZCT its
      *   pinned flag is cleared.  (This is consistent with the old ZCT code.)
+     *
+     *
+     * Incremental reaping (GCHeapConfig::incrementalReap):
+     *
+     * A reap triggered by the ZCT filling up runs for the time the policy manager gives
+     * it and then suspends, leaving the rest of the ZCT for later slices; the ZCT may
+     * grow by one block between slices.  The ZCT is in its normal state between slices:
+     * the pinned objects are moved back into it, still pinned, so that Remove() works
+     * on them.  prereap() is called before the first slice and postreap() after the
+     * last one.  A full collection or a thread edge (GC::ReapZCT) finishes the reap.
+     *
+     * The program runs between slices, so the stack must be pinned from again by every
+     * slice.  It is safe to scan only the stack words that changed since the previous
+     * slice pinned from the stack, given two observations:
+     *
+     * - A word that has not changed held the same value when the previous slice
+     *   pinned from it, and that slice pinned the object it pointed to unless the
+     *   object has been allocated since, at an address that was reused.
+     *
+     * - Every object entered into the ZCT since the previous slice pinned from the
+     *   stack, including every object allocated since, is at or above suspendIndex:
+     *   that is the lowest the ZCT was popped to by the previous slice.  Those objects
+     *   are all pinned at the start of the slice, and are reaped by the next reap.
+     *
+     * The objects that were pinned by the previous slice but that have been removed from
+     * and reentered into the ZCT since are also above suspendIndex, and are pinned again.
+     *
+     * The stack copy is not used if the stack is scanned through the host's stack
+     * maps, nor after a collection has swept the heap.
      */
 
+    // The reaper checks the time once per kReapCheckInterval objects reaped, and a
+    // slice never stops before it has reaped kReapMinimumSliceWork objects, so that a
+    // reap always makes progress however little time it is given.
+    static const uint32_t kReapCheckInterval = 64;
+    static const uint32_t kReapMinimumSliceWork = 1024;
+
 #ifdef ZCT_TESTING
     // Max number less 1 of blocks the ZCT may use for the second level of the block table
     // as well as the pinned table during reaping.
@@ -80,6 +115,8 @@ namespace MMgc
         , blocktable(NULL)
         , blocktop(NULL)
         , reaping(false)
+        , incremental(false)
+        , reapInProgress(false)
         , budget(0)
         , bottom(NULL)
         , top(NULL)
@@ -96,6 +133,14 @@ namespace MMgc
         , pinList(0)
         , pinLast(0)
         , freeList(0)
+        , suspendIndex(0)
+        , reapStart(0)
+        , reapTicks(0)
+        , lastStackScanPartial(false)
+        , stackCopy(NULL)
+        , stackCopyBlocks(0)
+        , stackCopyLow(NULL)
+        , stackCopyHigh(NULL)
     {
     }
 
@@ -134,6 +179,16 @@ namespace MMgc
         limit = blocktable[0] + CAPACITY(RCObject*);
         topIndex = 0;
 
+#ifdef MMGC_INCREMENTAL_REAP
+        // Slices are not compatible with DRC validation, which traces the heap once
+        // per reap and validates every object reaped against that trace.
+        incremental = gc->heap->Config().incrementalReap && gc->incremental;
+#ifdef DEBUG
+        if (gc->validateDefRef)
+            incremental = false;
+#endif
+#endif
+
         // if disable force slow path where we check this
         if(!gc->drcEnabled)
         {
@@ -146,6 +201,7 @@ namespace MMgc
 
     void ZCT::Destroy()
     {
+        ClearStackCopy();
         ClearBlockTable();
         ClearFreeList();
         GCHeap::GetGCHeap()->Free(blocktable);
@@ -164,6 +220,9 @@ namespace MMgc
 
         // Create a state that triggers the slow path
         top = limit;
+
+        // Swept objects' memory can be reused while stack words still point to it.
+        stackCopyHigh = NULL;
     }
 
     void ZCT::EndCollecting()
@@ -198,6 +257,11 @@ namespace MMgc
 
         if (reaping)
             reaping = false;
+
+        // Any pinned objects left in the ZCT by a suspended reap stay pinned until they
+        // are reentered into it, which is harmless.
+        reapInProgress = false;
+        stackCopyHigh = NULL;
     }
 
     void ZCT::AddSlow(RCObject *obj)
@@ -236,9 +300,9 @@ namespace MMgc
             shouldGrow = true;
         else {
             // 'obj' will not be reaped as it's on the stack; we'll add it to the ZCT below.
-            Reap();
+            ReapSlice(true, incremental);
             uint32_t avail = AvailableInCurrentSegment();
-            budget = gc->policy.queryZCTBudget(uint32_t(blocktop - blocktable));
+            budget = gc->policy.queryZCTBudget(uint32_t(blocktop - blocktable), reapInProgress);
             if (avail == 0)
                 shouldGrow = true;
         }
@@ -280,6 +344,11 @@ namespace MMgc
     }
 
     void ZCT::Reap(bool scanStack)
+    {
+        ReapSlice(scanStack, false);
+    }
+
+    void ZCT::ReapSlice(bool scanStack, bool bounded)
     {
         if(gc->collecting)
             return;
@@ -290,6 +359,8 @@ namespace MMgc
         if (reaping || topIndex == 0)
             return;
 
+        bool resuming = reapInProgress;
+
 #ifdef _DEBUG
         if (gc->validateDefRef)
             gc->DRCValidationTrace(scanStack);
@@ -301,7 +372,14 @@ namespace MMgc
         SAMPLE_FRAME("[reap]", gc->core());
 
         uint64_t start = VMPI_getPerformanceCounter();
-#ifdef MMGC_POLICY_PROFILING
+        uint64_t deadline = 0;
+        if (bounded)
+            deadline = start + uint64_t(gc->policy.reapSliceMicroseconds()) * VMPI_getPerformanceFrequency() / 1000000;
+        if (!resuming) {
+            reapStart = start;
+            reapTicks = 0;
+        }
+#if defined MMGC_POLICY_PROFILING || defined MMGC_EVENT_STREAM || defined MMGC_PAUSE_TARGET
         uint32_t objects_pinned = 0;
 #endif
         uint32_t objects_reaped = 0;
@@ -319,18 +397,29 @@ namespace MMgc
         //
         // For some generally difficult problems around pinning see bugzilla #506644.
 
+        if (resuming)
+            PinObjectsAddedSinceSuspend();
+
         if (scanStack) {
 #ifdef DEBUG
             // During DRC validation stack scanning happened already.
             // See GC::DRCValidationTrace().
             if(!gc->validateDefRef)
 #endif
-                VMPI_callWithRegistersSaved(ZCT::DoPinProgramStack, this);
+            {
+                uint64_t pinStart = VMPI_getPerformanceCounter();
+                lastStackScanPartial = false;
+                VMPI_callWithRegistersSaved(resuming ? ZCT::DoRepinProgramStack : ZCT::DoPinProgramStack, this);
+                gc->policy.signalReapStackPinning(VMPI_getPerformanceCounter() - pinStart, lastStackScanPartial);
+            }
         }
+        else
+            stackCopyHigh = NULL;
         PinRootSegments();
 
         // Invoke prereap on all callbacks
-        gc->DoPreReapCallbacks();
+        if (!resuming)
+            gc->DoPreReapCallbacks();
 
         // We perform depth-first reaping using the ZCT as a stack.
         //
@@ -347,7 +436,12 @@ namespace MMgc
         // Memory use is optimal to within a constant: space occupied by a pointer to a
         // reaped object is released immediately, and empty segments popped off the ZCT
         // are used for the list of replacement blocks.
+        //
+        // A bounded slice that runs out of time moves the pinned objects back into the
+        // ZCT instead, and leaves the rest of the ZCT for the next slice.
 
+        bool suspended = false;
+        uint32_t lowIndex = topIndex;
         SetupPinningMemory();
         for (;;) {
             SAMPLE_CHECK();
@@ -363,12 +457,14 @@ namespace MMgc
             }
             RCObject *rcobj = *--top;
             --topIndex;
+            if (topIndex < lowIndex)
+                lowIndex = topIndex;
 
             // Process the element
             if (rcobj == NULL)
                 ;
             else if (rcobj->IsPinned()) {
-#ifdef MMGC_POLICY_PROFILING
+#if defined MMGC_POLICY_PROFILING || defined MMGC_EVENT_STREAM || defined MMGC_PAUSE_TARGET
                 objects_pinned++;
 #endif
                 PinObject(rcobj);
@@ -377,46 +473,108 @@ namespace MMgc
                 objects_reaped++;
                 bytes_reaped += GC::Size(rcobj);
                 ReapObject(rcobj);
+                if (bounded &&
+                    objects_reaped % kReapCheckInterval == 0 &&
+                    objects_reaped >= kReapMinimumSliceWork &&
+                    topIndex > 0 &&
+                    VMPI_getPerformanceCounter() >= deadline)
+                {
+                    suspended = true;
+                    break;
+                }
             }
         }
-        UsePinningMemory();
+
+        if (suspended) {
+            ReturnPinnedObjects();
+            suspendIndex = lowIndex;
+            reapInProgress = true;
+        }
+        else {
+            UsePinningMemory();
+            reapInProgress = false;
+            stackCopyHigh = NULL;
 
 #ifdef DEBUG
-        if(gc->validateDefRef)
-            gc->AbortInProgressMarking();
+            if(gc->validateDefRef)
+                gc->AbortInProgressMarking();
 #endif
 
-        // Invoke postreap on all callbacks
-        gc->DoPostReapCallbacks();
+            // Invoke postreap on all callbacks
+            gc->DoPostReapCallbacks();
+        }
 
         if(gc->heap->Config().gcstats && objects_reaped > 0) {
             size_t blocks_after = gc->GetNumBlocks();
-            gc->gclog("[mem] DRC reaped %u objects (%u kb) freeing %u pages (%u kb) in %.2f millis (%.4f s)\n",
+            gc->gclog("[mem] DRC reaped %u objects (%u kb) freeing %u pages (%u kb) in %.2f millis (%.4f s)%s\n",
                       objects_reaped,
                       unsigned(bytes_reaped/1024),
                       unsigned(blocks_before - blocks_after),
                       unsigned(blocks_after * GCHeap::kBlockSize / 1024),
                       GC::duration(start),
-                      GC::duration(gc->t0)/1000);
+                      GC::duration(gc->t0)/1000,
+                      suspended ? " (suspended)" : "");
         }
 
         reaping = false;
 
 #ifdef _DEBUG
-        for ( uint32_t i=0 ; i < topIndex ; i++ ) {
-            // The first element of each block is usually NULL because it has
-            // been used as a link for pinList.
-            if (Get(i) != NULL) {
-                GCAssert(Get(i)->getZCTIndex() == i);
-                GCAssert(!Get(i)->IsPinned());
+        if (!suspended) {
+            for ( uint32_t i=0 ; i < topIndex ; i++ ) {
+                // The first element of each block is usually NULL because it has
+                // been used as a link for pinList.
+                if (Get(i) != NULL) {
+                    GCAssert(Get(i)->getZCTIndex() == i);
+                    GCAssert(!Get(i)->IsPinned());
+                }
             }
         }
 #endif
 
-#ifdef MMGC_POLICY_PROFILING
+#if defined MMGC_POLICY_PROFILING || defined MMGC_EVENT_STREAM || defined MMGC_PAUSE_TARGET
         gc->policy.signalReapWork(objects_reaped, uint32_t(bytes_reaped), objects_pinned);
 #endif
         gc->policy.signal(GCPolicyManager::END_ReapZCT);
+
+        uint64_t end = VMPI_getPerformanceCounter();
+        reapTicks += end - start;
+        if (!suspended)
+            gc->policy.signalReapEnd(reapTicks, end - reapStart);
+    }
+
+    void ZCT::PinObjectsAddedSinceSuspend()
+    {
+        GCAssert(suspendIndex <= topIndex);
+        for ( uint32_t i=suspendIndex ; i < topIndex ; i++ ) {
+            RCObject* obj = Get(i);
+            if (obj != NULL)
+                obj->Pin();
+        }
+    }
+
+    void ZCT::ReturnPinnedObjects()
+    {
+        GCAssert(reaping);
+        GCAssert(!slowState);
+
+        while (pinList != NULL) {
+            RCObject** block = pinList;
+            RCObject** blockLimit = block == pinLast ? pinTop : block + CAPACITY(RCObject*);
+            pinList = (RCObject**)block[0];
+            for ( RCObject** p = block + 1 ; p < blockLimit ; p++ ) {
+                RCObject* obj = *p;
+                // PinObject unpinned it and gave it an index into the pinning memory.
+                // Add() keeps the pinned flag while we're reaping.
+                obj->ClearZCTFlag();
+                obj->Pin();
+                Add(obj);
+            }
+            FreeBlock(block);
+        }
+        pinLast = NULL;
+        pinTop = NULL;
+        pinLimit = NULL;
+        pinIndex = 0;
     }
 
     void ZCT::PopFastSegment()
@@ -535,7 +693,11 @@ namespace MMgc
         ((GCFinalizedObject*)obj)->~GCFinalizedObject();
         gc->FreeFromGCNotNull(obj);
 
+#ifdef MMGC_INLINE_WEAKREFS
+        GCAssert(gc->inlineWeakRefs || gc->weakRefs.get(obj) == NULL);
+#else
         GCAssert(gc->weakRefs.get(obj) == NULL);
+#endif
     }
 
     /*static*/
@@ -544,7 +706,81 @@ namespace MMgc
         ZCT* zct = (ZCT*)arg;
         GC* gc = zct->gc;
         char* stackBase = (char*)gc->GetStackTop();
-        zct->PinStackObjects(stackPointer, stackBase - (char*)stackPointer);
+        gc->ScanProgramStack(stackPointer, stackBase, ZCT::PinStackRange, zct);
+        if (zct->incremental) {
+#ifdef MMGC_STACK_MAPS
+            if (gc->stackMaps != NULL)
+                return;
+#endif
+            zct->SaveStackCopy(stackPointer, stackBase);
+        }
+    }
+
+    /*static*/
+    void ZCT::DoRepinProgramStack(void* stackPointer, void* arg)
+    {
+        ZCT* zct = (ZCT*)arg;
+        if (zct->stackCopyHigh == NULL) {
+            DoPinProgramStack(stackPointer, arg);
+            return;
+        }
+        char* stackBase = (char*)zct->gc->GetStackTop();
+        zct->RepinChangedStackWords(stackPointer, stackBase);
+        zct->lastStackScanPartial = true;
+        zct->SaveStackCopy(stackPointer, stackBase);
+    }
+
+    void ZCT::RepinChangedStackWords(const void* sp, const void* base)
+    {
+        const uintptr_t* p = (const uintptr_t*)sp;
+        const uintptr_t* end = (const uintptr_t*)base;
+        const uintptr_t* low = (const uintptr_t*)stackCopyLow;
+        const uintptr_t* high = (const uintptr_t*)stackCopyHigh;
+        const uintptr_t* changed = NULL;     // Start of the current run of changed words
+
+        for ( ; p < end ; p++ ) {
+            if (p >= low && p < high && *p == stackCopy[p - low]) {
+                if (changed != NULL) {
+                    PinStackObjects(changed, (const char*)p - (const char*)changed);
+                    changed = NULL;
+                }
+            }
+            else if (changed == NULL)
+                changed = p;
+        }
+        if (changed != NULL)
+            PinStackObjects(changed, (const char*)end - (const char*)changed);
+    }
+
+    void ZCT::SaveStackCopy(const void* sp, const void* base)
+    {
+        size_t nbytes = (const char*)base - (const char*)sp;
+        size_t nblocks = (nbytes + GCHeap::kBlockSize - 1) / GCHeap::kBlockSize;
+        if (nblocks > stackCopyBlocks) {
+            ClearStackCopy();
+            stackCopy = (uintptr_t*)GCHeap::GetGCHeap()->AllocNoOOM(nblocks, GCHeap::flags_Alloc|GCHeap::kCanFail);
+            if (stackCopy == NULL)
+                return;
+            stackCopyBlocks = nblocks;
+        }
+        VMPI_memcpy(stackCopy, sp, nbytes);
+        stackCopyLow = sp;
+        stackCopyHigh = base;
+    }
+
+    void ZCT::ClearStackCopy()
+    {
+        if (stackCopy != NULL)
+            GCHeap::GetGCHeap()->FreeNoOOM(stackCopy);
+        stackCopy = NULL;
+        stackCopyBlocks = 0;
+        stackCopyHigh = NULL;
+    }
+
+    /*static*/
+    void ZCT::PinStackRange(void* arg, const void* p, size_t nbytes)
+    {
+        ((ZCT*)arg)->PinStackObjects(p, nbytes);
     }
 
     void ZCT::PinRootSegments()
@@ -608,6 +844,7 @@ namespace MMgc
     void ZCT::Prune()
     {
         ClearFreeList();
+        ClearStackCopy();
     }
 
     void ZCT::ClearBlockTable()
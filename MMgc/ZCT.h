@@ -19,7 +19,9 @@ namespace MMgc
      *
      * When Reap() is called the ZCT is traversed; objects that are not pinned are
      * destroyed.  Reap runs finalizers, which means more objects may be entered
-     * into the ZCT and visited by Reap.  The process is not currently time-bounded.
+     * into the ZCT and visited by Reap.  The process is not time-bounded, but if
+     * GCHeapConfig::incrementalReap is set then a reap triggered by the ZCT filling
+     * up is split into slices whose length is set by the policy manager; see ReapSlice.
      */
     class ZCT
     {
@@ -85,6 +87,8 @@ namespace MMgc
          * whether they were pinned by Reap or explicitly from the prereap() callback
          * or even earlier.  Reap does not unpin any pinned objects that were not in
          * the ZCT.
+         *
+         * If an incremental reap is in progress then Reap finishes it.
          */
         void Reap(bool scanNativeStack=true);
 
@@ -99,6 +103,12 @@ namespace MMgc
          */
         bool IsReaping();
 
+        /**
+         * @return true if an incremental reap has run some slices but is not yet
+         * finished, otherwise false.  IsReaping() is false between slices.
+         */
+        bool IsReapInProgress();
+
     private:
         // Slow path for Add().  The trick is that the slow path will be entered
         // if top==limit; in that case, we either have a simple overflow or the
@@ -134,9 +144,37 @@ namespace MMgc
         // @return true if the block was allocated, false otherwise.
         bool Grow();
 
+        // Run one slice of a reap.  If 'bounded' is false, or if the slice runs out of
+        // work, then the reap is finished; otherwise the slice stops once the time given
+        // by the policy manager is up and leaves the reap in progress.
+        void ReapSlice(bool scanNativeStack, bool bounded);
+
         // Capture the stack extent; then scan the stack and pin objects from it
         // (called from Reap, but only if scanNativeStack is true)
         static void DoPinProgramStack(void* stackTop, void* arg);
+        static void PinStackRange(void* arg, const void* p, size_t nbytes);
+
+        // Like DoPinProgramStack, but for a later slice of an incremental reap: only
+        // the words that differ from the copy of the stack taken by the previous slice
+        // are scanned, if that copy can be used.
+        static void DoRepinProgramStack(void* stackTop, void* arg);
+
+        // Keep a copy of the stack words in [sp,base) for the next slice; on failure
+        // the next slice scans the whole stack.
+        void SaveStackCopy(const void* sp, const void* base);
+
+        // Pin from the words in [sp,base) that differ from the saved copy.
+        void RepinChangedStackWords(const void* sp, const void* base);
+
+        // Discard the stack copy.
+        void ClearStackCopy();
+
+        // Pin the objects entered into the ZCT since the previous slice was suspended.
+        void PinObjectsAddedSinceSuspend();
+
+        // Suspending a slice: move the pinned objects from the pinning memory back
+        // into the ZCT, still pinned, and discard the pinning memory.
+        void ReturnPinnedObjects();
 
         // Scan the AllocaStackSegments and pin all objects directly reachable from them.
         void PinRootSegments();
@@ -194,6 +232,8 @@ namespace MMgc
         RCObject ***blocktable;     // Table of pointers to individual blocks
         RCObject ***blocktop;       // Next free item in blocktable
         bool reaping;               // Are we reaping the zct?
+        bool incremental;           // Reap in slices when the ZCT fills up?  Fixed by SetGC
+        bool reapInProgress;        // Has an incremental reap been suspended?
 
         uint32_t budget;            // Remaining number of full blocks to grow by before reaping
 
@@ -221,6 +261,18 @@ namespace MMgc
 
         // Block free list
         void** freeList;            // Linked list of blocks; element 0 is next
+
+        // Incremental reaping.  Objects entered into the ZCT at or above suspendIndex
+        // were entered between slices.  The stack copy is only valid if stackCopyHigh
+        // is not NULL.
+        uint32_t suspendIndex;      // topIndex when the last slice was suspended
+        uint64_t reapStart;         // Start of the first slice of the current reap
+        uint64_t reapTicks;         // Time spent in the slices of the current reap
+        bool lastStackScanPartial;  // Did the last stack scan use the stack copy?
+        uintptr_t* stackCopy;       // Stack words copied by the last slice, or NULL
+        size_t stackCopyBlocks;     // Size of stackCopy, in blocks
+        const void* stackCopyLow;   // Stack address corresponding to stackCopy[0]
+        const void* stackCopyHigh;  // Stack address beyond the last copied word
     };
 }
 
@@ -83,6 +83,11 @@ bool VMPI_condVarTimedWait(vmpi_condvar_t* condvar, vmpi_mutex_t* mutex, int32_t
     gettimeofday(&timeVal, NULL);
     timeSpec.tv_sec = timeVal.tv_sec + (timeout_millis / 1000);
     timeSpec.tv_nsec = (timeVal.tv_usec * 1000) + ((timeout_millis % 1000) * 1000000);
+    // pthread_cond_timedwait fails at once with EINVAL unless tv_nsec < 1s.
+    if (timeSpec.tv_nsec >= 1000000000) {
+        timeSpec.tv_sec += 1;
+        timeSpec.tv_nsec -= 1000000000;
+    }
     return pthread_cond_timedwait(condvar, mutex, &timeSpec) == ETIMEDOUT;
 #endif
 }
@@ -79,6 +79,13 @@
     #define NO_INLINE
 #endif
 
+// VMPI_prefetch(addr) is a hint that the cache line holding 'addr' will be read
+// soon.  It must not fault on any address.  Platforms without a prefetch
+// instruction get the no-op below.
+#ifndef VMPI_prefetch
+    #define VMPI_prefetch(addr) ((void)(addr))
+#endif
+
 #define ARRAY_SIZE(x) (sizeof(x)/sizeof(x[0]))
 
 /**
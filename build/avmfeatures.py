@@ -219,6 +219,11 @@ def featureSettings(o):
         args += "-DAVMTWEAK_HEAP_GRAPH=1 "
     if (arg == False):
         args += "-DAVMTWEAK_HEAP_GRAPH=0 "
+    arg = o.getBoolArg("mark-prefetch")
+    if (arg == True):
+        args += "-DAVMTWEAK_MARK_PREFETCH=1 "
+    if (arg == False):
+        args += "-DAVMTWEAK_MARK_PREFETCH=0 "
     return args
 
 def builtinBuildFlags(o):
@@ -279,7 +279,7 @@ namespace avmplus
 
     static inline bool defined(Atom atom) { return (atom != undefinedAtom); }
 
-    typedef HeapList<AtomList> HeapAtomList;
+    typedef ExactHeapList<AtomList> HeapAtomList;
 
     /**
      * ArraySort implements actionscript Array.sort().
@@ -434,7 +434,7 @@ namespace avmplus
         if ((len > 0) && (len < (0x10000000)))
         {
             index = (uint32_t*)avmStackAlloc(core, index_autoptr, GCHeap::CheckForCallocSizeOverflow(len, sizeof(uint32_t)));
-            atoms = new (core->GetGC()) HeapAtomList(core->GetGC(), len);
+            atoms = HeapAtomList::create(core->GetGC(), len);
         }
 
         if (!index || !atoms)
@@ -453,7 +453,7 @@ namespace avmplus
         // One field value - pre-get our field values so we can just do a regular sort
         if (cmpFunc == ArraySort::FieldCompareFunc && numFields == 1)
         {
-            fieldatoms = new (core->GetGC()) HeapAtomList(core->GetGC(), len);
+            fieldatoms = HeapAtomList::create(core->GetGC(), len);
 
             // note, loop needs to go until i = -1, but i is unsigned. 0xffffffff is a valid index, so check (i+1) != 0.
             for (i = (len - 1), j = len; (i+1) != 0; i--)
@@ -403,6 +403,14 @@ namespace avmplus
         config.interrupts = interrupts_default;
 
         gcInterface.SetCore(this);
+#ifdef MMGC_HEAP_SNAPSHOT
+        heapSnapshotNamer.SetCore(this);
+        gc->SetHeapSnapshotNamer(&heapSnapshotNamer);
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        allocationSamplerHost.SetCore(this);
+        gc->SetAllocationSamplerHost(&allocationSamplerHost);
+#endif
         xmlEntities                 = NULL;
         exceptionFrame              = NULL;
         exceptionAddr               = NULL;
@@ -415,7 +423,7 @@ namespace avmplus
         m_unversionedURIs = HeapHashtable::create(gc);
 #endif
 
-        m_domainMgr = new(gc) DomainMgr(this);
+        m_domainMgr = new (gc, MMgc::kExact) DomainMgr(this);
 
         GetGC()->SetGCContextVariable(MMgc::GC::GCV_AVMCORE, this);
 
@@ -593,6 +601,15 @@ namespace avmplus
         _sampler = NULL;
 #endif
 
+#if defined(VMCFG_NANOJIT) && defined(AVMPLUS_VERBOSE)
+        for (LivePoolNode* node = livePools; node != NULL; node = node->next)
+        {
+            PoolObject* pool = (PoolObject*)(void*)(node->pool->peek());
+            if (pool && pool->codeMgr && pool->isVerbose(VB_jit))
+                pool->codeMgr->printBindingCacheStats(console);
+        }
+#endif
+
         m_tbCache->flush();
         m_tmCache->flush();
         m_msCache->flush();
@@ -609,6 +626,12 @@ namespace avmplus
         if (gc)
         {
             gc->SetGCContextVariable(GC::GCV_AVMCORE, NULL);
+#ifdef MMGC_HEAP_SNAPSHOT
+            gc->SetHeapSnapshotNamer(NULL);
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+            gc->SetAllocationSamplerHost(NULL);
+#endif
         }
 
         strings = NULL;
@@ -647,6 +670,112 @@ namespace avmplus
 #endif
     }
 
+#ifdef MMGC_HEAP_SNAPSHOT
+    static const char kStringTypeKey[] = "String";
+    static const char kNamespaceTypeKey[] = "Namespace";
+
+    bool AvmCore::HeapSnapshotNamer::isObjectStart(const void* p)
+    {
+        MMgc::GC* gc = core->gc;
+        return p != NULL && gc->IsPointerToGCPage(p) && gc->FindBeginningGuarded(p, true) == p;
+    }
+
+    // Called on every object in the heap, which may be of any type: the tests must
+    // not trust anything they have not verified to be a GC object.
+    const void* AvmCore::HeapSnapshotNamer::typeKey(const void* userptr)
+    {
+        if (core == NULL || !MMgc::GC::IsRCObject(userptr))
+            return NULL;
+        const void* vptr = *(const void* const*)userptr;
+        String* emptyString = core->kEmptyString;
+        if (emptyString != NULL && vptr == *(const void* const*)emptyString)
+            return kStringTypeKey;
+        Namespace* publicNamespace = core->publicNamespace;
+        if (publicNamespace != NULL && vptr == *(const void* const*)publicNamespace)
+            return kNamespaceTypeKey;
+        if (MMgc::GC::Size(userptr) < sizeof(ScriptObject))
+            return NULL;
+        VTable* vtable = ((const ScriptObject*)userptr)->vtable;
+        if (!isObjectStart(vtable))
+            return NULL;
+        Traits* traits = vtable->traits;
+        if (!isObjectStart(traits) || MMgc::GC::Size(traits) < sizeof(Traits) || traits->core != core)
+            return NULL;
+        return traits;
+    }
+
+    void AvmCore::HeapSnapshotNamer::typeName(const void* key, char* buf, size_t bufsize)
+    {
+        if (key == kStringTypeKey || key == kNamespaceTypeKey) {
+            VMPI_strncpy(buf, (const char*)key, bufsize);
+            return;
+        }
+        // Copy "uri::name" one character at a time so as not to allocate.
+        Traits* traits = (Traits*)key;
+        Stringp parts[2] = { traits->ns() != NULL ? traits->ns()->getURI() : NULL, traits->name() };
+        size_t k = 0;
+        for (int i=0; i < 2; i++) {
+            Stringp s = parts[i];
+            if (i == 1 && k > 0 && k+2 < bufsize) {
+                buf[k++] = ':';
+                buf[k++] = ':';
+            }
+            if (s == NULL)
+                continue;
+            for (int32_t j=0, n=s->length(); j < n && k+1 < bufsize; j++) {
+                wchar c = s->charAt(j);
+                buf[k++] = c < 0x80 ? char(c) : '?';
+            }
+        }
+        if (bufsize > 0)
+            buf[k < bufsize ? k : bufsize-1] = 0;
+    }
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+    // Called from the allocator, so it must not allocate.
+    uint32_t AvmCore::AllocationSamplerHost::captureScriptFrames(const void** keys, uint32_t max)
+    {
+        if (core == NULL)
+            return 0;
+        uint32_t n = 0;
+        for (MethodFrame* frame = core->currentMethodFrame; frame != NULL && n < max; frame = frame->next) {
+            MethodEnv* env = frame->env();
+            if (env == NULL)
+                continue;
+            MethodInfo* info = env->method;
+            if (methodInfoVTable == NULL)
+                methodInfoVTable = *(const void* const*)info;
+            keys[n++] = info;
+        }
+        return n;
+    }
+
+    // The sampler does not keep the MethodInfos it has seen alive, so check that the
+    // key still looks like one before asking it for its name.
+    void AvmCore::AllocationSamplerHost::scriptFrameName(const void* key, char* buf, size_t bufsize)
+    {
+        MMgc::GC* gc = core != NULL ? core->gc : NULL;
+        if (gc != NULL &&
+            gc->IsPointerToGCPage(key) &&
+            gc->FindBeginningGuarded(key, true) == key &&
+            *(const void* const*)key == methodInfoVTable)
+        {
+            Stringp name = ((const MethodInfo*)key)->getMethodName();
+            if (name != NULL) {
+                StUTF8String utf8(name);
+                VMPI_strncpy(buf, utf8.c_str(), bufsize);
+                if (bufsize > 0)
+                    buf[bufsize-1] = 0;
+                return;
+            }
+        }
+        VMPI_strncpy(buf, "(unknown method)", bufsize);
+        if (bufsize > 0)
+            buf[bufsize-1] = 0;
+    }
+#endif
+
     void AvmCore::initBuiltinPool(
 #ifdef DEBUGGER
                                   int tracelevel
@@ -654,7 +783,7 @@ namespace avmplus
     )
     {
         // Create the singleton ExecMgr instance.
-        exec = new (gc) BaseExecMgr(this);
+        exec = new (gc, MMgc::kExact) BaseExecMgr(this);
 
         #ifdef DEBUGGER
         _debugger = createDebugger(tracelevel);
@@ -1643,7 +1772,7 @@ return the result of the comparison ToPrimitive(x) == y.
      */
     void AvmCore::throwAtom(Atom atom)
     {
-        throwException(new (GetGC()) Exception(this, atom));
+        throwException(new (GetGC(), MMgc::kExact) Exception(this, atom));
     }
 
 #ifdef DEBUGGER
@@ -69,8 +69,15 @@ const int kBufferPadding = 16;
         // Distinct from non-speculative inlining and specialization.
         bool opt_inline;
 
+        // Assemble methods that become hot on a background JitThread, running
+        // them in the interpreter until their code is ready.
+        bool jit_thread;
+
+        // Print the JitThread's queue and latency statistics at exit.
+        bool jit_thread_stats;
+
         // Initialize with default options.
-        JitConfig() : opt_inline(true) {}
+        JitConfig() : opt_inline(true), jit_thread(false), jit_thread_stats(false) {}
     };
 #endif
 
@@ -443,6 +450,7 @@ const int kBufferPadding = 16;
         friend class EnterCodeContext;
         friend class EnterMethodEnv;
         friend class ExceptionFrame;
+        friend class JitStackWalker;
         friend class MethodFrame;
         friend class Traits;
 
@@ -491,6 +499,37 @@ const int kBufferPadding = 16;
             AvmCore *core;
         };
 
+#ifdef MMGC_HEAP_SNAPSHOT
+        // Names the nodes of heap snapshots: strings, namespaces, and script objects
+        // by their traits.  Everything else is left to the GC's default naming.
+        class HeapSnapshotNamer : public MMgc::GCHeapSnapshotNamer
+        {
+        public:
+            HeapSnapshotNamer() : core(NULL) {}
+            void SetCore(AvmCore* _core) { this->core = _core; }
+            virtual const void* typeKey(const void* userptr);
+            virtual void typeName(const void* key, char* buf, size_t bufsize);
+        private:
+            bool isObjectStart(const void* p);
+            AvmCore *core;
+        };
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+        // Gives the allocation sampler the methods of the MethodFrames on the stack.
+        class AllocationSamplerHost : public MMgc::GCAllocationSamplerHost
+        {
+        public:
+            AllocationSamplerHost() : core(NULL), methodInfoVTable(NULL) {}
+            void SetCore(AvmCore* _core) { this->core = _core; }
+            virtual uint32_t captureScriptFrames(const void** keys, uint32_t max);
+            virtual void scriptFrameName(const void* key, char* buf, size_t bufsize);
+        private:
+            AvmCore *core;
+            const void* methodInfoVTable;   // vptr of the MethodInfos captured so far
+        };
+#endif
+
         class ICodeContextCreator
         {
         public:
@@ -743,6 +782,12 @@ const int kBufferPadding = 16;
         ExceptionFrame *exceptionFrame;
 
         GCInterface gcInterface;
+#ifdef MMGC_HEAP_SNAPSHOT
+        HeapSnapshotNamer heapSnapshotNamer;
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        AllocationSamplerHost allocationSamplerHost;
+#endif
 
         // END untraced public fields
         ////////////////////////////////////////////////////////////////////
@@ -2232,10 +2277,12 @@ const int kBufferPadding = 16;
         friend class CodegenLIR;
         friend class OSR;
         friend class halfmoon::JitFriend;
+        friend class JitStackWalker;
         enum {
             IS_EXPLICIT_CODECONTEXT = 0x1,
             DXNS_NOT_NULL = 0x2,
-            FLAGS_MASK = 0x3
+            IS_JIT_FRAME = 0x4,     // set by CodegenLIR when it records stack maps
+            FLAGS_MASK = 0x7
         };
         uintptr_t       envOrCodeContext;
         Namespace*      dxns; // NOTE: this struct is always stack-allocated (or via avmStackAlloc, which is just as good), so no GCMember needed
@@ -736,7 +736,7 @@ namespace avmplus
         else
         {
             // Create class info
-            info = new (core->GetGC()) ClassInfo(toplevel, traits);
+            info = new (core->GetGC(), MMgc::kExact) ClassInfo(toplevel, traits);
 
             // Add class info to relate tables
             ClassInfoListAdd(info);
@@ -1471,7 +1471,7 @@ namespace avmplus
     ClassInfo *ClassInfo::Read(Toplevel *toplevel, AvmPlusObjectInput *input, bool dynamic, bool externalizable, int count)
     {
         AvmCore* core = toplevel->core();
-        ClassInfo *info = new (core->GetGC()) ClassInfo(toplevel);
+        ClassInfo *info = new (core->GetGC(), MMgc::kExact) ClassInfo(toplevel);
         int i;
 
         info->m_dynamic = dynamic;
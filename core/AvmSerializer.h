@@ -183,7 +183,7 @@ namespace avmplus
         void WriteTypedVector(Atom atom);
     };
 
-    class ClassInfo : public MMgc::GCObject
+    class GC_CPP_EXACT(ClassInfo, MMgc::GCTraceableObject)
     {
     public:
         // for output, construct information from Traits
@@ -212,15 +212,21 @@ namespace avmplus
         bool methodContainsTransientMetadata(Traits *traits, int index);
         bool isSerializable(Traits * t, Namespace* ns, Binding b);
 
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(ClassInfo)
+
     private:
-        Toplevel* const         m_toplevel;
+        Toplevel* const         GC_POINTER(m_toplevel);
         GCMember<Traits>        m_traits;
         GCMember<String>        m_name;
         bool                    m_dynamic;
         Binding                 m_functionBinding;
         
         GCMember<ClassClosure>  m_closure;
-        RCList<String>          m_sealed;
+        RCList<String>          GC_STRUCTURE(m_sealed);
+
+        GC_DATA_END(ClassInfo)
+    // ------------------------ DATA SECTION END
     };
 
 
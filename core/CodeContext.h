@@ -12,8 +12,9 @@ namespace avmplus
     // CodeContext is used to track which security context we are in.
     // When an AS3 method is called, the AS3 method will ensure that core->codeContext() will return its context.
     // Note that CodeContext should not be instantiated directly (except in certain situations
-    // by AvmCore); client code should create a concrete subclass.
-    class CodeContext : public MMgc::GCObject
+    // by AvmCore); client code should create a concrete subclass.  CodeContext is traced
+    // exactly, so subclasses must be declared with GC_CPP_EXACT and allocated with kExact.
+    class GC_CPP_EXACT(CodeContext, MMgc::GCTraceableObject)
     {
         friend class AvmCore;
 
@@ -29,9 +30,15 @@ namespace avmplus
         REALLY_INLINE DomainEnv* domainEnv() const { return m_domainEnv; }
         REALLY_INLINE const BugCompatibility* bugCompatibility() const { return m_bugCompatibility; }
 
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(CodeContext)
+
     private:
         GCMember<DomainEnv>                 m_domainEnv;
         GCMember<const BugCompatibility>    m_bugCompatibility;
+
+        GC_DATA_END(CodeContext)
+    // ------------------------ DATA SECTION END
     };
 
     class EnterCodeContext
@@ -652,8 +652,16 @@ namespace avmplus
         blockLabels(NULL),
         cseFilter(NULL),
         noise(),
-        jit_debug_info(NULL)
+        jit_debug_info(NULL),
+        md_error(None),
+        md_codeList(NULL)
+#ifdef VMCFG_JIT_STACK_MAPS
+        , md_stackMap(NULL)
+#endif
         DEBUGGER_ONLY(, haveDebugger(core->debugger() != NULL) )
+#ifdef VMCFG_JIT_STACK_MAPS
+        , haveStackMaps(((BaseExecMgr*)core->exec)->stack_walker != NULL)
+#endif
     {
         #ifdef AVMPLUS_MAC_CARBON
         setjmpInit();
@@ -1207,7 +1215,13 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         // treat all exception handlers as if they were backward branch targets.
         va_list ap;
         va_start(ap, argc);
+        // A GC can only start inside a call, so calls are the only points
+        // that need a stack map.
+        if (haveStackMaps)
+            lirout->insSafe(LIR_safe, NULL);
         LIns* ins = LirHelper::vcallIns(ci, argc, ap);
+        if (haveStackMaps)
+            lirout->insSafe(LIR_endsafe, NULL);
         va_end(ap);
         return ins;
     }
@@ -1647,7 +1661,11 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         // save env in MethodFrame.envOrCodeContext
         //     explicitly leave IS_EXPLICIT_CODECONTEXT clear
         //     explicitly leave DXNS_NOT_NULL clear, dxns is effectively null without doing the store here.
-        stp(env_param, methodFrame, offsetof(MethodFrame,envOrCodeContext), ACCSET_OTHER);
+        //     set IS_JIT_FRAME if JitStackWalker is to find this frame.
+        LIns* envOrCodeContext = env_param;
+        if (haveStackMaps)
+            envOrCodeContext = binaryIns(LIR_orp, env_param, InsConstPtr((void*)MethodFrame::IS_JIT_FRAME));
+        stp(envOrCodeContext, methodFrame, offsetof(MethodFrame,envOrCodeContext), ACCSET_OTHER);
         stp(currentMethodFrame, methodFrame, offsetof(MethodFrame,next), ACCSET_OTHER);
         stp(methodFrame, coreAddr, offsetof(AvmCore,currentMethodFrame), ACCSET_OTHER);
         #ifdef _DEBUG
@@ -5268,7 +5286,10 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         Traits* slotType = tb->getSlotTraits(slot);
         if (!slotType || !slotType->isMachineType() || slotType == OBJECT_TYPE)
         {
-            // slot type is Atom (for *, Object) or RCObject* (String, Namespace, or other user types)
+            // slot type is Atom (for *, Object) or RCObject* (String, Namespace, or other user types).
+            // The helpers must call out for reference counting anyway, so the barrier is left to
+            // them; that way stores from jitted code also dirty cards when the GC uses the
+            // card-marking barrier (GCHeapConfig::cardMarking).
             const CallInfo *wbAddr = FUNCTIONID(privateWriteBarrierRC);
             if (slotType == NULL ||  slotType == OBJECT_TYPE) {
                 // use fast atom wb
@@ -8343,21 +8364,51 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         }
     }
 
-    CodeMgr::CodeMgr(nanojit::Config* config) : codeAlloc(config), bindingCaches(NULL), jit_mgr(NULL)
+    CodeMgr::CodeMgr(nanojit::Config* config)
+        : codeAlloc(config), threadCodeAlloc(config), bindingCaches(NULL)
+        , megaCalls(NULL), megaGets(NULL), megaSets(NULL)
+        , jit_mgr(NULL)
     {
         verbose_only( log.lcbits = 0; )
     }
 
+    template <class C>
+    static void flushMegaEntries(C* table)
+    {
+        if (table != NULL) {
+            for (uint32_t i = 0; i < BindingCache::kMegaEntries; i++)
+                table[i].vtable = NULL;
+        }
+    }
+
     void CodeMgr::flushBindingCaches()
     {
         // this clears vtable so all kObjectType receivers are invalidated.
         // of course, this field is also "tag" for primitive receivers,
         // but 0 is never a legal value there (and this is asserted when the tag is set)
         // so this should safely invalidate those as well (though we don't really need to invalidate them)
+        // The entries of polymorphic caches are on this list too; a cleared entry
+        // is free for reuse.  The megamorphic tables are not.
         for (BindingCache* b = bindingCaches; b != NULL; b = b->next)
             b->vtable = NULL;
+        flushMegaEntries(megaCalls);
+        flushMegaEntries(megaGets);
+        flushMegaEntries(megaSets);
     }
 
+#ifdef AVMPLUS_VERBOSE
+    void CodeMgr::printBindingCacheStats(PrintWriter& console)
+    {
+        static const char* const stateNames[] = { "monomorphic", "polymorphic", "megamorphic" };
+        for (BindingCache* b = bindingCaches; b != NULL; b = b->next) {
+            if (b->state == BindingCache::kEntry || (b->hits | b->misses) == 0)
+                continue;
+            console << "binding cache " << b->kind << " " << *b->name << " " << stateNames[b->state]
+                    << " hits " << b->hits << " misses " << b->misses << "\n";
+        }
+    }
+#endif
+
     void analyze_edge(LIns* label, nanojit::BitSet &livein,
                       LabelBitSet& labels, InsList* looplabels)
     {
@@ -8870,18 +8921,26 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
 
     // return pointer to generated code on success, NULL on failure (frame size too large)
     GprMethodProc CodegenLIR::emitMD()
+    {
+        prepareMD();
+        CodeMgr* mgr = pool->codeMgr;
+        return finishMD(assembleMD(mgr->codeAlloc, mgr->allocator));
+    }
+
+    // The parts of emitMD() that must run on the thread that owns the GC heap:
+    // deadvars() and the verbose listings, and later finishMD(); see JitThread.
+    void CodegenLIR::prepareMD()
     {
         deadvars();  // deadvars_kill() will add livep(vars) or livep(tags) if necessary
 
         // do this very last so it's after livep(vars)
         frag->lastIns = livep(undefConst);
 
-        PERFM_NTPROF_BEGIN("compile");
         mmfx_delete( alloc1 );
         alloc1 = NULL;
 
-        CodeMgr *mgr = pool->codeMgr;
         #ifdef NJ_VERBOSE
+        CodeMgr *mgr = pool->codeMgr;
         if (pool->isVerbose(LC_ReadLIR, info)) {
             StringBuffer sb(core);
             sb << info;
@@ -8928,15 +8987,34 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
             fclose(f);
         }
         #endif
+        verbose_only(
+            md_verbose = pool->isVerbose(VB_jit, info);
+            md_raw = pool->isVerbose(VB_raw, info);
+        )
+    }
+
+    // Run the assembler over the LIR, allocating the code from codeAlloc and
+    // its data from dataAlloc.  This only touches LIR and the allocators, so
+    // it may run on a JitThread.  Returns NULL if the assembler failed.
+    GprMethodProc CodegenLIR::assembleMD(CodeAlloc& codeAlloc, Allocator& dataAlloc)
+    {
+        PERFM_NTPROF_BEGIN("compile");
 
         // Use the 'active' log if we are in verbose output mode otherwise sink the output
-        LogControl* log = &(mgr->log);
+        LogControl* log = &(pool->codeMgr->log);
         verbose_only(
             SinkLogControl sink;
-            log = pool->isVerbose(VB_jit,info) ? log : &sink;
+            log = md_verbose ? log : &sink;
         )
 
-        Assembler *assm = new (*lir_alloc) Assembler(mgr->codeAlloc, mgr->allocator, *lir_alloc, log, core->config.njconfig);
+        MetaDataWriter* mdWriter = NULL;
+        #ifdef VMCFG_JIT_STACK_MAPS
+        JitStackMapWriter* stackMapWriter = NULL;
+        if (haveStackMaps)
+            mdWriter = stackMapWriter = new (*lir_alloc) JitStackMapWriter(*lir_alloc, methodFrame);
+        #endif
+
+        Assembler *assm = new (*lir_alloc) Assembler(codeAlloc, dataAlloc, *lir_alloc, log, core->config.njconfig, mdWriter);
         #ifdef VMCFG_VTUNE
         assm->vtuneHandle = vtuneInit(info->getMethodName());
         #endif /* VMCFG_VTUNE */
@@ -8945,7 +9023,7 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
 
         verbose_only(
             StringList asmOutput(*lir_alloc);
-            if (!pool->isVerbose(VB_raw, info))
+            if (!md_raw)
                 assm->_outputCache = &asmOutput;
         );
 
@@ -8966,17 +9044,17 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         PERFM_NVPROF("IR", frag->lirbuf->insCount());
 
         GprMethodProc code;
-        bool keep = !assm->error();
-        if (keep) {
+        md_error = assm->error();
+        if (md_error == None) {
             // save pointer to generated code
             code = (GprMethodProc) frag->code();
+            md_codeList = assm->codeList;
             PERFM_NVPROF("JIT method bytes", CodeAlloc::size(assm->codeList));
-            if (jit_observer)
-                jit_observer->notifyMethodJITed(info, assm->codeList, jit_debug_info);
+            #ifdef VMCFG_JIT_STACK_MAPS
+            if (stackMapWriter)
+                md_stackMap = stackMapWriter->finish(dataAlloc);
+            #endif
         } else {
-            verbose_only (if (pool->isVerbose(VB_execpolicy))
-                AvmLog("execpolicy revert to interp (%d) compiler error %d \n", info->unique_method_id(), assm->error());
-            )
             // assm puked, or we did something untested, so interpret.
             code = NULL;
             PERFM_NVPROF("lir-error",1);
@@ -8990,21 +9068,299 @@ FLOAT_ONLY(           !(v.sst_mask == (1 << SST_float)  && v.traits == FLOAT_TYP
         return code;
     }
 
-    BindingCache::BindingCache(const Multiname* name, BindingCache* next)
-        : name(name), next(next)
-    {}
+    // Publish the results of assembleMD() that live in the MethodInfo or
+    // are reported to the JITObserver, and return its code.
+    GprMethodProc CodegenLIR::finishMD(GprMethodProc code)
+    {
+        if (code) {
+            #ifdef VMCFG_JIT_STACK_MAPS
+            if (md_stackMap)
+                info->_stackMap = md_stackMap;
+            #endif
+            if (jit_observer)
+                jit_observer->notifyMethodJITed(info, md_codeList, jit_debug_info);
+        } else {
+            verbose_only (if (pool->isVerbose(VB_execpolicy))
+                AvmLog("execpolicy revert to interp (%d) compiler error %d \n", info->unique_method_id(), md_error);
+            )
+        }
+        return code;
+    }
 
-    CallCache::CallCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), call_handler(callprop_miss)
+#ifdef VMCFG_JIT_STACK_MAPS
+    const JitStackMapSite* JitStackMap::findSite(const uint8_t* ra) const
+    {
+        // find the last site that starts below ra
+        uint32_t lo = 0, hi = nsites;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (sites[mid].start < ra)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo == 0)
+            return NULL;
+        const JitStackMapSite* site = &sites[lo - 1];
+        return ra <= site->end ? site : NULL;
+    }
+
+    JitStackMapWriter::JitStackMapWriter(Allocator& alloc, LIns* methodFrame)
+        : alloc(alloc)
+        , methodFrame(methodFrame)
+        , sites(NULL)
+        , nsites(0)
+        , nranges(0)
+        , siteEnd(NULL)
+        , siteBroken(false)
+        , failed(false)
+        , sawMethodFrame(false)
+        , methodFrameDisp(0)
+        , frameSize(0)
+        , outgoingSize(0)
     {}
 
-    GetCache::GetCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), get_handler(getprop_miss)
+    void JitStackMapWriter::beginAssembly(Assembler*, uint8_t*)
     {}
 
-    SetCache::SetCache(const Multiname* name, BindingCache* next)
-        : BindingCache(name, next), set_handler(setprop_miss)
-    {}
+    // Code is generated backwards, so we see the end of each call site first.
+    void JitStackMapWriter::safepointEnd(Assembler*, void*, uint8_t* address)
+    {
+        siteEnd = address;
+        siteBroken = false;
+    }
+
+    // The return address of a call that was split across two code chunks can't
+    // be bounded by the chunk addresses, so we don't record the site.  Frames
+    // stopped there are scanned conservatively.
+    void JitStackMapWriter::setNativePc(uint8_t*)
+    {
+        siteBroken = true;
+    }
+
+    void JitStackMapWriter::safepointStart(Assembler* assm, void*, uint8_t* address)
+    {
+        const uint8_t* end = siteEnd;
+        siteEnd = NULL;
+        // address == end if the call was dead and generated no code.
+        if (end == NULL || siteBroken || address >= end)
+            return;
+
+        uint32_t n = collectRanges(assm->activation(), NULL);
+        JitStackMapRange* ranges = NULL;
+        if (n > 0) {
+            ranges = new (alloc) JitStackMapRange[n];
+            collectRanges(assm->activation(), ranges);
+        }
+
+        // Neighbouring call sites very often have the same live ranges.
+        PendingSite* prev = sites ? sites->head : NULL;
+        if (prev && prev->site.nranges == n && n > 0 &&
+            VMPI_memcmp(prev->ranges, ranges, n * sizeof(JitStackMapRange)) == 0) {
+            ranges = prev->ranges;
+        } else {
+            nranges += n;
+        }
+
+        PendingSite* p = new (alloc) PendingSite();
+        p->site.start = address;
+        p->site.end = end;
+        p->site.firstRange = 0;
+        p->site.nranges = n;
+        p->ranges = ranges;
+        sites = new (alloc) Seq<PendingSite*>(p, sites);
+        nsites++;
+    }
+
+    // Count the live entries of the activation record that may hold pointers,
+    // coalescing adjacent ones, and store them in out if it isn't NULL.  On
+    // 64-bit targets, 32-bit values can't be pointers, and CodegenLIR never
+    // stores pointers in double, float or float4 values.
+    uint32_t JitStackMapWriter::collectRanges(const AR& ar, JitStackMapRange* out)
+    {
+        uint32_t n = 0;
+        int32_t disp = 0;
+        uint32_t nbytes = 0;
+        AR::Iter iter(ar);
+        LIns* ins;
+        uint32_t nStackSlots;
+        int32_t arIndex;
+        while (iter.next(ins, nStackSlots, arIndex)) {
+            // The iterator reports the lowest slot index of each entry; slot
+            // i covers the four bytes at FP-4*i, so the entry starts at the
+            // FP offset of its highest slot.
+            int32_t d = -4 * (arIndex + int32_t(nStackSlots) - 1);
+            if (ins == methodFrame) {
+                AvmAssert(!sawMethodFrame || methodFrameDisp == d);
+                if (sawMethodFrame && methodFrameDisp != d)
+                    failed = true;
+                methodFrameDisp = d;
+                sawMethodFrame = true;
+            }
+            if (!ins->isQ() || nStackSlots < 2)
+                continue;
+            AvmAssert((d & 7) == 0);
+            if (nbytes > 0 && d + int32_t(4 * nStackSlots) == disp) {
+                // entries are visited in decreasing FP offset order
+                disp = d;
+                nbytes += 4 * nStackSlots;
+                continue;
+            }
+            if (nbytes > 0) {
+                if (out) {
+                    out[n].disp = disp;
+                    out[n].nbytes = nbytes;
+                }
+                n++;
+            }
+            disp = d;
+            nbytes = 4 * nStackSlots;
+        }
+        if (nbytes > 0) {
+            if (out) {
+                out[n].disp = disp;
+                out[n].nbytes = nbytes;
+            }
+            n++;
+        }
+        return n;
+    }
+
+    void JitStackMapWriter::endAssembly(Assembler* assm, uint8_t*)
+    {
+        // Everything below the activation record is the outgoing argument area
+        // (plus alignment padding), which we always scan.
+        frameSize = assm->frameSize();
+        uint32_t arSize = 4 * assm->activation().stackSlotsNeeded();
+        outgoingSize = frameSize > arSize ? frameSize - arSize : 0;
+    }
+
+    void JitStackMapWriter::abandon()
+    {
+        failed = true;
+    }
+
+    const JitStackMap* JitStackMapWriter::finish(Allocator& dataAlloc)
+    {
+        if (failed || frameSize == 0 || !sawMethodFrame || nsites == 0)
+            return NULL;
+
+        JitStackMapSite* outSites = new (dataAlloc) JitStackMapSite[nsites];
+        JitStackMapRange* outRanges = nranges ? new (dataAlloc) JitStackMapRange[nranges] : NULL;
+        uint32_t i = 0;
+        uint32_t r = 0;
+        const JitStackMapRange* lastRanges = NULL;
+        for (Seq<PendingSite*>* p = sites; p != NULL; p = p->tail) {
+            PendingSite* ps = p->head;
+            outSites[i] = ps->site;
+            if (ps->site.nranges == 0) {
+                outSites[i].firstRange = 0;
+            } else if (ps->ranges == lastRanges) {
+                outSites[i].firstRange = outSites[i-1].firstRange;
+            } else {
+                outSites[i].firstRange = r;
+                VMPI_memcpy(&outRanges[r], ps->ranges, ps->site.nranges * sizeof(JitStackMapRange));
+                r += ps->site.nranges;
+                lastRanges = ps->ranges;
+            }
+            i++;
+        }
+        AvmAssert(i == nsites && r == nranges);
+
+        // Sites were recorded backwards, so each code chunk contributes a run
+        // that is already in increasing address order; insertion sort is
+        // linear unless the method spans several chunks.
+        for (uint32_t j = 1; j < nsites; j++) {
+            JitStackMapSite s = outSites[j];
+            uint32_t k = j;
+            while (k > 0 && outSites[k-1].start > s.start) {
+                outSites[k] = outSites[k-1];
+                k--;
+            }
+            outSites[k] = s;
+        }
+
+        JitStackMap* map = new (dataAlloc) JitStackMap();
+        map->methodFrameDisp = methodFrameDisp;
+        map->frameSize = frameSize;
+        map->outgoingSize = outgoingSize;
+        map->nsites = nsites;
+        map->sites = outSites;
+        map->ranges = outRanges;
+        return map;
+    }
+
+    // Called by MMgc on the core's thread whenever it scans the stack.  A JIT
+    // frame looks like this, with FP at a per-method offset from the MethodFrame:
+    //
+    //     FP+8                   return address into the caller
+    //     FP                     saved FP of the caller
+    //     FP-4*stackSlotsNeeded  activation record (spills and allocas)
+    //     FP-frameSize           outgoing arguments
+    //     FP-frameSize-8         return address of the current call
+    //
+    // Every frame is sanity checked against the part of the stack being
+    // scanned and against the frames already claimed, and the scanner ignores
+    // anything that isn't in order; so at worst a frame is scanned conservatively.
+    void JitStackWalker::ScanFrames(MMgc::GCStackScanner& scanner)
+    {
+        const uint8_t* low = (const uint8_t*)scanner.Low();
+        const uint8_t* high = (const uint8_t*)scanner.High();
+        const uint8_t* floor = low;     // frames must lie above the last one claimed
+
+        for (MethodFrame* f = core->currentMethodFrame; f != NULL; f = f->next) {
+            if (!(f->envOrCodeContext & MethodFrame::IS_JIT_FRAME))
+                continue;
+            const uint8_t* mf = (const uint8_t*)f;
+            if (mf < floor || mf >= high)
+                continue;
+            const JitStackMap* map = f->env()->method->_stackMap;
+            if (map == NULL)
+                continue;
+
+            const uint8_t* fp = mf - map->methodFrameDisp;
+            const uint8_t* lo = fp - map->frameSize;
+            const uint8_t* hi = fp + 2*sizeof(void*);
+            if (lo < floor || lo - sizeof(void*) < low || hi > high)
+                continue;
+            const JitStackMapSite* site = map->findSite(*(const uint8_t* const*)(lo - sizeof(void*)));
+            if (site == NULL)
+                continue;
+
+            scanner.Frame(lo, hi);
+            if (map->outgoingSize > 0)
+                scanner.Words(lo, map->outgoingSize);
+            const JitStackMapRange* r = map->ranges + site->firstRange;
+            for (uint32_t i = 0; i < site->nranges; i++)
+                scanner.Words(fp + r[i].disp, r[i].nbytes);
+            floor = hi;
+        }
+    }
+#endif // VMCFG_JIT_STACK_MAPS
+
+    BindingCache::BindingCache(const Multiname* name, BindingCache* next, State state)
+        : vtable(NULL), name(name), next(next), poly(NULL), state(state)
+    {
+        verbose_only( kind = NULL; hits = misses = 0; )
+    }
+
+    CallCache::CallCache(const Multiname* name, BindingCache* next, State state)
+        : BindingCache(name, next, state), call_handler(callprop_miss)
+    {
+        verbose_only( kind = "call"; )
+    }
+
+    GetCache::GetCache(const Multiname* name, BindingCache* next, State state)
+        : BindingCache(name, next, state), get_handler(getprop_miss)
+    {
+        verbose_only( kind = "get"; )
+    }
+
+    SetCache::SetCache(const Multiname* name, BindingCache* next, State state)
+        : BindingCache(name, next, state), set_handler(setprop_miss)
+    {
+        verbose_only( kind = "set"; )
+    }
 
     template class CacheBuilder<CallCache>;
     template class CacheBuilder<GetCache>;
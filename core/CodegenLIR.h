@@ -169,9 +169,21 @@ namespace avmplus
     //     then we should consider an inline cache for it.
 
     // binding cache common code
+    //
+    // A cache starts out monomorphic: its handler is specialized for the one
+    // receiver vtable (or primitive tag) it saw last, and a miss rebinds it.
+    // When a bound cache misses on a second kind of receiver it becomes
+    // polymorphic, and its handler searches kPolyEntries entries, each of them
+    // a cache of the same kind bound to one receiver.  When those are all in use
+    // it becomes megamorphic, and looks receivers up in its CodeMgr's table of
+    // kMegaEntries entries, keyed by (receiver, name).  Entries never change state.
     class BindingCache {
     public:
-        BindingCache(const Multiname*, BindingCache* next);
+        enum State { kMonomorphic, kPolymorphic, kMegamorphic, kEntry };
+        static const uint32_t kPolyEntries = 4;
+        static const uint32_t kMegaEntries = 256;   // must be a power of 2
+
+        BindingCache(const Multiname*, BindingCache* next, State);
         union {
             VTable* vtable;         // for kObjectType receivers
             Atom tag;               // for primitive receivers
@@ -182,13 +194,21 @@ namespace avmplus
         };
         const Multiname* const name;      // multiname for this entry, saved when cache created.
         BindingCache* const next;         // singly-linked list
+        BindingCache* poly;               // kPolyEntries caches of the same kind, once kPolymorphic
+        State state;
+#ifdef AVMPLUS_VERBOSE
+        const char* kind;                 // "call", "get", or "set", for -Dverbose=jit
+        uint32_t hits;                    // calls that found their receiver cached (for a
+                                          // monomorphic cache, including the call after a miss)
+        uint32_t misses;                  // calls that had to look up the binding
+#endif
     };
 
     // cache for late bound calls
     class CallCache: public BindingCache {
     public:
         typedef Atom (*Handler)(CallCache&, Atom base, int argc, Atom* args, MethodEnv*);
-        CallCache(const Multiname*, BindingCache* next);
+        CallCache(const Multiname*, BindingCache* next, State state = kMonomorphic);
         Handler call_handler;
     };
 
@@ -196,7 +216,7 @@ namespace avmplus
     class GetCache: public BindingCache {
     public:
         typedef Atom (*Handler)(GetCache&, MethodEnv*, Atom);
-        GetCache(const Multiname*, BindingCache* next);
+        GetCache(const Multiname*, BindingCache* next, State state = kMonomorphic);
         Handler get_handler;
     };
 
@@ -206,7 +226,7 @@ namespace avmplus
     class SetCache: public BindingCache {
     public:
         typedef void (*Handler)(SetCache&, Atom obj, Atom val, MethodEnv*);
-        SetCache(const Multiname*, BindingCache* next);
+        SetCache(const Multiname*, BindingCache* next, State state = kMonomorphic);
         Handler set_handler;
         union {
             Traits* slot_type;  // slot or setter type, for implicit coercion
@@ -232,6 +252,101 @@ namespace avmplus
         C* allocateCacheSlot(const Multiname* name);
     };
 
+#ifdef VMCFG_JIT_STACK_MAPS
+    // GC Stack Maps
+    //
+    // When MMgc is configured to use stack maps, CodegenLIR brackets every helper
+    // call with LIR_safe/LIR_endsafe, and a JitStackMapWriter records, for each
+    // call site, the parts of the activation record that are live across the
+    // call and may hold pointers: allocas and spilled 64-bit values.  32-bit and
+    // floating point spill slots are never recorded, since CodegenLIR does not
+    // reinterpret pointers as doubles.  The outgoing argument area at the bottom
+    // of the frame is always scanned.
+    //
+    // JIT code marks its MethodFrame with MethodFrame::IS_JIT_FRAME, and
+    // JitStackWalker follows AvmCore::currentMethodFrame to find the frames:
+    // the frame pointer is at a fixed offset from the MethodFrame, and the
+    // return address below the frame identifies the call site.  Frames it cannot
+    // identify, and all native frames, are left to conservative scanning.
+
+    /** A run of FP-relative bytes that may hold pointers. */
+    struct JitStackMapRange {
+        int32_t disp;
+        uint32_t nbytes;
+    };
+
+    /** The code (start,end] of one call site and the ranges live across it. */
+    struct JitStackMapSite {
+        const uint8_t* start;
+        const uint8_t* end;
+        uint32_t firstRange;
+        uint32_t nranges;
+    };
+
+    /** Stack map of one JIT-compiled method, allocated with its code. */
+    class JitStackMap {
+    public:
+        /** @return the site whose code contains return address ra, or NULL */
+        const JitStackMapSite* findSite(const uint8_t* ra) const;
+
+        int32_t methodFrameDisp;        // FP-relative offset of the MethodFrame
+        uint32_t frameSize;             // bytes below the saved FP
+        uint32_t outgoingSize;          // bytes at the bottom of the frame that are always scanned
+        uint32_t nsites;
+        const JitStackMapSite* sites;   // sorted by start
+        const JitStackMapRange* ranges;
+    };
+
+    /** Collects a JitStackMap while the Assembler runs. */
+    class JitStackMapWriter : public nanojit::MetaDataWriter {
+    public:
+        JitStackMapWriter(Allocator& alloc, LIns* methodFrame);
+
+        void beginAssembly(Assembler* assm, uint8_t* address);
+        void safepointStart(Assembler* assm, void* payload, uint8_t* address);
+        void safepointEnd(Assembler* assm, void* payload, uint8_t* address);
+        void setNativePc(uint8_t* address);
+        void endAssembly(Assembler* assm, uint8_t* address);
+        void abandon();
+
+        /**
+         * Copy the map into dataAlloc, which must live as long as the code.
+         * @return the map, or NULL if the backend did not describe the frame.
+         */
+        const JitStackMap* finish(Allocator& dataAlloc);
+
+    private:
+        struct PendingSite {
+            JitStackMapSite site;
+            JitStackMapRange* ranges;
+        };
+
+        uint32_t collectRanges(const AR& ar, JitStackMapRange* out);
+
+        Allocator& alloc;
+        LIns* const methodFrame;
+        Seq<PendingSite*>* sites;
+        uint32_t nsites;
+        uint32_t nranges;
+        const uint8_t* siteEnd;         // end of the open site, or NULL
+        bool siteBroken;                // the open site spans two code chunks
+        bool failed;
+        bool sawMethodFrame;
+        int32_t methodFrameDisp;
+        uint32_t frameSize;
+        uint32_t outgoingSize;
+    };
+
+    /** Describes the JIT frames on the stack of one AvmCore to MMgc. */
+    class JitStackWalker : public MMgc::GCStackMaps {
+    public:
+        JitStackWalker(AvmCore* core) : core(core) {}
+        void ScanFrames(MMgc::GCStackScanner& scanner);
+    private:
+        AvmCore* const core;
+    };
+#endif
+
     class VarTracker;
     class MopsRangeCheckFilter;
     class PrologWriter;
@@ -329,6 +444,15 @@ namespace avmplus
         verbose_only(LInsPrinter* vbNames;)
         JITDebugInfo *jit_debug_info;
 
+        // results of assembleMD(), published by finishMD()
+        AssmError md_error;
+        CodeList* md_codeList;
+#ifdef VMCFG_JIT_STACK_MAPS
+        const JitStackMap* md_stackMap;
+#endif
+        verbose_only(bool md_verbose;)  // VB_jit and VB_raw, looked up by prepareMD()
+        verbose_only(bool md_raw;)
+
 #ifdef DEBUGGER
         bool haveDebugger;
 #else
@@ -339,6 +463,11 @@ namespace avmplus
 #else
         static const bool haveVTune = false;
 #endif
+#ifdef VMCFG_JIT_STACK_MAPS
+        bool haveStackMaps;     // bracket calls with safepoints for a JitStackMapWriter
+#else
+        static const bool haveStackMaps = false;
+#endif
 #ifdef DEBUG
         /** jit_sst is an array of sst_mask bytes, used to double check that we
          *  are modeling storage types the same way the verifier did for us.
@@ -595,6 +724,12 @@ namespace avmplus
                    OSR *osr_state);
         GprMethodProc emitMD();
 
+        // emitMD() in three steps, so that a JitThread can run the assembler:
+        // prepareMD() and finishMD() must run on the thread that owns the GC heap.
+        void prepareMD();
+        GprMethodProc assembleMD(CodeAlloc& codeAlloc, Allocator& dataAlloc);
+        GprMethodProc finishMD(GprMethodProc code);
+
         // May return true if JIT will always fail based on information known prior to invocation.
         static bool jitWillFail(const MethodSignaturep ms);
 
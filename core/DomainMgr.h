@@ -15,7 +15,7 @@ namespace avmplus
  *  is responsible for all aspects of
  *  finding names in a given Domain stack.
  */
-class DomainMgr : public MMgc::GCObject
+class GC_CPP_EXACT(DomainMgr, MMgc::GCTraceableObject)
 {
 public:
     DomainMgr(AvmCore* core);
@@ -56,8 +56,14 @@ private:
     MethodInfo* findScriptInPoolByNameOnlyImpl(PoolObject* pool, Stringp name);
 #endif
 
+    // ------------------------ DATA SECTION BEGIN
+    GC_DATA_BEGIN(DomainMgr)
+
 private:
     AvmCore* const core;
+
+    GC_DATA_END(DomainMgr)
+    // ------------------------ DATA SECTION END
 };
 
 
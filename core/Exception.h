@@ -18,7 +18,7 @@ namespace avmplus
      * AVM+.  To throw an exception, an Exception object is
      * instantiated and passed to AvmCore::throwException.
      */
-    class Exception : public MMgc::GCObject
+    class GC_CPP_EXACT(Exception, MMgc::GCTraceableObject)
     {
     public:
         Exception(AvmCore* core, Atom atom);
@@ -50,13 +50,16 @@ namespace avmplus
 #endif /* DEBUGGER */
 
     // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(Exception)
+
     public:
-        ATOM_WB             atom;
+        ATOM_WB             GC_ATOM(atom);
 #ifdef DEBUGGER
         GCMember<StackTrace> stackTrace;
 #endif
         int32_t             flags;
 
+        GC_DATA_END(Exception)
     // ------------------------ DATA SECTION END
     };
 
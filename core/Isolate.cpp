@@ -206,7 +206,7 @@ throw_terminated_error:
         AvmAssert(core->getIsolate()->getAggregate() == this);
         Stringp errorMessage = core->getErrorMessage(kWorkerTerminated);
         GCRef<ErrorObject> error = currentToplevel->errorClass()->constructObject(errorMessage->atom(), core->intToAtom(kWorkerTerminated));
-        Exception *exception = new (core->GetGC()) Exception(core, error->atom());
+        Exception *exception = new (core->GetGC(), MMgc::kExact) Exception(core, error->atom());
         exception->flags |= Exception::EXIT_EXCEPTION;
         exception->flags |= Exception::SUPPRESS_ERROR_REPORT;
         core->throwException(exception);
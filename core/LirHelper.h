@@ -47,6 +47,9 @@ namespace avmplus
     };
 
     class BindingCache; // forward.
+    class CallCache;
+    class GetCache;
+    class SetCache;
 
     /**
      * CodeMgr manages memory for compiled code, including the code itself
@@ -58,10 +61,18 @@ namespace avmplus
         CodeAlloc   codeAlloc;  // allocator for code memory
         AvmLogControl  log;        // controller for verbose output
         Allocator   allocator;  // data with same lifetime of this CodeMgr
+        CodeAlloc   threadCodeAlloc;    // the same, for methods assembled by a JitThread;
+        Allocator   threadAllocator;    // only the JitThread uses these
         BindingCache* bindingCaches;    // head of linked list of all BindingCaches allocated by this codeMgr
                                         // (only for flushing... lifetime is still managed by codeAlloc)
+        CallCache* megaCalls;           // megamorphic cache tables, shared by all the caches of this
+        GetCache* megaGets;             // codeMgr that saw too many receiver types; allocated on
+        SetCache* megaSets;             // first use (see BindingCache)
         CodeMgr(nanojit::Config* conf);
         void flushBindingCaches();      // invalidate all binding caches for this codemgr... needed when AbcEnv is unloaded
+#ifdef AVMPLUS_VERBOSE
+        void printBindingCacheStats(PrintWriter&);  // per-site hit/miss counts, for -Dverbose=jit
+#endif
 
         // DEOPT & PROFILER todo: provide some way to free code memory
         JitManager *jit_mgr;
@@ -1556,7 +1556,7 @@ namespace avmplus
         else if (type == kMethodTable)
         {
             activation = buildActivationVTable();
-            ActivationMethodTablePair *amtp = new (core()->GetGC()) ActivationMethodTablePair(activation, getMethodClosureTable());
+            ActivationMethodTablePair *amtp = new (core()->GetGC(), MMgc::kExact) ActivationMethodTablePair(activation, getMethodClosureTable());
             setActivationOrMCTable(amtp, kActivationMethodTablePair);
         }
         else if (type == kActivationMethodTablePair)
@@ -1604,7 +1604,7 @@ namespace avmplus
         else if(type == kActivation)
         {
             WeakKeyHashtable *wkh = WeakKeyHashtable::create(core()->GetGC());
-            ActivationMethodTablePair *amtp = new (core()->GetGC()) ActivationMethodTablePair(getActivationVTable(), wkh);
+            ActivationMethodTablePair *amtp = new (core()->GetGC(), MMgc::kExact) ActivationMethodTablePair(getActivationVTable(), wkh);
             setActivationOrMCTable(amtp, kActivationMethodTablePair);
             return wkh;
         }
@@ -212,14 +212,18 @@ namespace avmplus
     private:
         Atom findWithProperty(Atom obj, const Multiname* multiname);
 
-        class ActivationMethodTablePair : public MMgc::GCObject
+        class GC_CPP_EXACT(ActivationMethodTablePair, MMgc::GCTraceableObject)
         {
         public:
             ActivationMethodTablePair(VTable *a, WeakKeyHashtable*wkh);
         // ------------------------ DATA SECTION BEGIN
+            GC_DATA_BEGIN(ActivationMethodTablePair)
+
         public:
-            VTable* const activation;
-            WeakKeyHashtable* const methodTable;
+            VTable* const GC_POINTER(activation);
+            WeakKeyHashtable* const GC_POINTER(methodTable);
+
+            GC_DATA_END(ActivationMethodTablePair)
         // ------------------------ DATA SECTION END
         };
 
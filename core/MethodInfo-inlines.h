@@ -222,6 +222,16 @@ REALLY_INLINE void MethodInfo::setHasFailedJit()
     _hasFailedJit = 1;
 }
 
+REALLY_INLINE uint32_t MethodInfo::isJitPending() const
+{
+    return _isJitPending;
+}
+
+REALLY_INLINE void MethodInfo::setJitPending(bool pending)
+{
+    _isJitPending = pending;
+}
+
 REALLY_INLINE uint32_t MethodInfo::isInterpreted() const
 {
     return _isInterpImpl;
@@ -63,6 +63,7 @@ namespace avmplus
 
     class MethodSignature;
     class Deoptimizer;
+    class JitStackMap;
 
     /**
      * MethodInfo is the base class for all functions that
@@ -173,6 +174,7 @@ namespace avmplus
         uint32_t setsDxns() const;
         uint32_t isStaticInit() const;
         uint32_t hasFailedJit() const;
+        uint32_t isJitPending() const;
         uint32_t isInterpreted() const;
         uint32_t unboxThis() const;
         uint32_t onlyUntypedParameters() const;
@@ -180,6 +182,7 @@ namespace avmplus
         void setUnboxThis();
         void setStaticInit();
         void setHasFailedJit();
+        void setJitPending(bool pending);
         void setHasExceptions();
         void setLazyRest();
         void setNeedsDxns();
@@ -334,6 +337,13 @@ namespace avmplus
         Deoptimizer* _armed_deoptimizers;
 #endif
 
+#ifdef VMCFG_JIT_STACK_MAPS
+    public:
+        // GC stack map of the JIT-compiled body, allocated along with the code,
+        // or NULL if none was recorded.  See JitStackWalker.
+        const JitStackMap* _stackMap;
+#endif
+
     private:
         // -------- FLAGS SECTION
         // (Set in ABC) need arguments[0..argc].
@@ -404,6 +414,10 @@ namespace avmplus
         // set to indicate that an attempted jit compilation has failed
         uint32_t                _hasFailedJit:1;
 
+        // set while the method runs in the interpreter waiting for the
+        // JitThread to assemble its code
+        uint32_t                _isJitPending:1;
+
         // true if execution mechanism is the interpreter
         uint32_t                _isInterpImpl:1;
 
@@ -181,7 +181,7 @@ namespace avmplus
             const char *error;
             StUTF8String patternz(m_source);
             void* pcreInst = (void*)pcre_compile(patternz.c_str(), m_optionFlags, &error, &errptr, NULL);
-            CompiledRegExp* regex = new (gc()) CompiledRegExp(pcreInst);
+            CompiledRegExp* regex = new (gc(), MMgc::kExact) CompiledRegExp(pcreInst);
 
             if (!core()->m_regexCache.disabled())
             {
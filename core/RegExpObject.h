@@ -9,13 +9,20 @@
 
 namespace avmplus
 {
-    class CompiledRegExp : public MMgc::RCObject
+    class GC_CPP_EXACT(CompiledRegExp, MMgc::RCObject)
     {
     public:
         CompiledRegExp(void* regex) : regex(regex) {}
         ~CompiledRegExp();
 
-        void * regex; // The compiled regular expression
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(CompiledRegExp)
+
+    public:
+        void * regex; // The compiled regular expression (PCRE-owned, not a GC pointer)
+
+        GC_DATA_END(CompiledRegExp)
+    // ------------------------ DATA SECTION END
     };
 
     /**
@@ -147,6 +147,14 @@
 #  define NANOJIT_EAGER_REGSAVE
 #endif
 
+// Record GC stack maps at the call sites of JIT-compiled methods, so that MMgc
+// can scan their frames precisely when GCHeapConfig::stackMaps is set (see
+// JitStackMapWriter in CodegenLIR.h).  This relies on MMGC_STACK_MAPS, and on
+// the backend reporting its frame layout, which only the x64 backend does.
+#if defined(VMCFG_NANOJIT) && defined(AVMPLUS_AMD64)
+    #define VMCFG_JIT_STACK_MAPS
+#endif
+
 // Enable stack metrics API (for development purposes only)
 //#define VMCFG_STACK_METRICS
 
@@ -846,6 +846,15 @@ var FEATURES =
     <default> false </default>
   </tweak>
 
+  <tweak>
+    <desc> Have the GC marker prefetch each object it pops off the mark stack and hold it
+           in a small FIFO for a few iterations before tracing it, to hide cache misses.
+           Disable it on hardware where prefetching does not pay off. </desc>
+    <name> AVMTWEAK_MARK_PREFETCH </name>
+    <defines> MMGC_MARK_PREFETCH </defines>
+    <default> true </default>
+  </tweak>
+
   <at-most-one>
     <name> AVMTWEAK_EXACT_TRACING </name>
     <name> AVMTWEAK_SELECTABLE_EXACT_TRACING </name>
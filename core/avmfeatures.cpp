@@ -206,6 +206,9 @@ const char * const avmfeatures = ""
   #if AVMTWEAK_HEAP_GRAPH
     "AVMTWEAK_HEAP_GRAPH;"
   #endif
+  #if AVMTWEAK_MARK_PREFETCH
+    "AVMTWEAK_MARK_PREFETCH;"
+  #endif
 ;
 
 #endif // AVMSHELL_BUILD
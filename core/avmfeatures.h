@@ -100,6 +100,7 @@
 #undef VMCFG_EXACT_TRACING
 #undef VMCFG_SELECTABLE_EXACT_TRACING
 #undef MMGC_HEAP_GRAPH
+#undef MMGC_MARK_PREFETCH
 
 
 
@@ -832,6 +833,20 @@
 #  error "AVMTWEAK_HEAP_GRAPH must be defined and 0 or 1 (only)."
 #endif
 
+
+/* AVMTWEAK_MARK_PREFETCH
+ *
+ * Have the GC marker prefetch each object it pops off the mark stack and hold it
+ * in a small FIFO for a few iterations before tracing it, to hide cache misses.
+ * Disable it on hardware where prefetching does not pay off.
+ */
+#if !defined AVMTWEAK_MARK_PREFETCH
+#  define AVMTWEAK_MARK_PREFETCH 1
+#endif
+#if AVMTWEAK_MARK_PREFETCH != 0 && AVMTWEAK_MARK_PREFETCH != 1
+#  error "AVMTWEAK_MARK_PREFETCH must be defined and 0 or 1 (only)."
+#endif
+
 #if AVMSYSTEM_32BIT
 #  if AVMSYSTEM_64BIT
 #    error "AVMSYSTEM_64BIT is precluded for AVMSYSTEM_32BIT"
@@ -1345,6 +1360,9 @@
 #if AVMTWEAK_HEAP_GRAPH
 #  define MMGC_HEAP_GRAPH
 #endif
+#if AVMTWEAK_MARK_PREFETCH
+#  define MMGC_MARK_PREFETCH
+#endif
 
 #ifdef AVMSHELL_BUILD
 extern const char * const avmfeatures;
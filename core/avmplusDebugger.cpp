@@ -516,7 +516,7 @@ namespace avmplus
         {
             CallStackNode* trace = locateTrace(frameNbr);
             if (trace)
-                frame = new (core->GetGC()) DebugStackFrame(frameNbr, trace, this);
+                frame = new (core->GetGC(), MMgc::kExact) DebugStackFrame(frameNbr, trace, this);
         }
         return frame;
     }
@@ -89,7 +89,7 @@ namespace avmplus
         GC_NO_DATA(AbcInfo)
     };
 
-    class DebugFrame : public MMgc::GCObject
+    class GC_CPP_EXACT(DebugFrame, MMgc::GCTraceableObject)
     {
     public:
         // since we have virtual functions, we need a virtual dtor to shut up the
@@ -139,6 +139,8 @@ namespace avmplus
          */
 
         virtual bool argumentName(int which, Stringp& result);
+
+        GC_NO_DATA(DebugFrame)
     };
 
     // forward refs
@@ -609,7 +611,7 @@ namespace avmplus
         GC_DATA_END(AbcFile)
     };
 
-    class DebugStackFrame : public DebugFrame
+    class GC_CPP_EXACT(DebugStackFrame, DebugFrame)
     {
     public:
         /**
@@ -652,16 +654,24 @@ namespace avmplus
         // constructor
         DebugStackFrame(int nbr, CallStackNode* trace, Debugger* debug);
 
-        // expose this for all interested
-        CallStackNode* trace;
-
     protected:
         void argumentBounds(int* firstArgument, int* pastLastArgument);
         void localBounds(int* firstLocal, int* pastLastLocal);
         int indexOfFirstLocal();
 
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(DebugStackFrame)
+
+    public:
+        // expose this for all interested
+        CallStackNode* trace;   // stack allocated, not a GC pointer
+
+    protected:
         GCMember<Debugger> debugger;
         int       frameNbr;  // top of call stack == 0
+
+        GC_DATA_END(DebugStackFrame)
+    // ------------------------ DATA SECTION END
     };
 
 }
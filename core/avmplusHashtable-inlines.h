@@ -147,7 +147,10 @@ namespace avmplus
         size_t extra = 0;
         if (capacity > 0)
             extra = MMgc::GCHeap::CheckForCallocSizeOverflow(capacity-1, sizeof(Atom));
-        return new (gc, MMgc::kExact, extra) AtomContainer();
+        AtomContainer* atoms = new (gc, MMgc::kExact, extra) AtomContainer();
+        // m_atomsAndFlags is the only reference to the container and it is traced exactly.
+        gc->SetMovable(atoms);
+        return atoms;
     }
 
     REALLY_INLINE void InlineHashtable::freeAtoms()
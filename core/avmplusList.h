@@ -132,7 +132,10 @@ namespace avmplus
 
         REALLY_INLINE static TracedListData<STORAGE>* create(MMgc::GC* gc, size_t totalElements)
         {
-            return new (gc, MMgc::kExact, MMgc::GCHeap::CheckForCallocSizeOverflow(totalElements-1, sizeof(STORAGE))) TracedListData<STORAGE>();
+            TracedListData<STORAGE>* data = new (gc, MMgc::kExact, MMgc::GCHeap::CheckForCallocSizeOverflow(totalElements-1, sizeof(STORAGE))) TracedListData<STORAGE>();
+            // The owning list's m_data is the only reference to the data and it is traced exactly.
+            gc->SetMovable(data);
+            return data;
         }
         
         REALLY_INLINE static void free(MMgc::GC* gc, void* mem)
@@ -45,7 +45,16 @@ REALLY_INLINE bool OSR::countEdge(const MethodEnv* env, MethodInfo* m, MethodSig
     // is not supported, countEdge will remain 0 without triggering OSR,
     // until the next count which will wrap around to 0xFFFFFFFF.  So we only
     // test isSupported() once every 2^32 invocations.
-    return --m->_abc.countdown == 0 && isSupported(env->abcEnv(), m, ms);
+    if (--m->_abc.countdown != 0)
+        return false;
+    if (m->isJitPending() || !m->isInterpreted()) {
+        // The JitThread is compiling m, or has installed its code while this
+        // frame was running; don't compile it again here, but leave the count
+        // where OSR::countInvoke() will poll for or pick up the code.
+        m->_abc.countdown = 1;
+        return false;
+    }
+    return isSupported(env->abcEnv(), m, ms);
 }
 
 } // namespace avmplus
@@ -9,6 +9,7 @@
 
 #ifdef VMCFG_NANOJIT
 #include "CodegenLIR.h"
+#include "exec-jitthread.h"
 
 #ifdef VMCFG_SHARK
 #include <dlfcn.h> // dl apis for JITLoggingObserver
@@ -38,7 +39,7 @@ bool BaseExecMgr::prepPolicyRules()
     if (config.compilePolicyRules)
     {
         AvmAssert(_ruleSet == NULL);
-        _ruleSet = new (core->gc) JitInterpRuleSet(core->gc);
+        _ruleSet = new (core->gc, MMgc::kExact) JitInterpRuleSet(core->gc);
         const char* s = config.compilePolicyRules;
         while(*s)
         {
@@ -223,6 +224,8 @@ void BaseExecMgr::verifyJit(MethodInfo* m, MethodSignaturep ms,
     m->set_abc_exceptions(core->gc, NULL);
     // fall through to CodegenLIR JIT logic.
 #endif
+    if (osr == NULL && verifyJitInBackground(m, ms, toplevel, abc_env))
+        return; // m stays in the interpreter until the JitThread is done.
     CodegenLIR jit(m, ms, toplevel, osr);
     PERFM_NTPROF_BEGIN("verify & IR gen");
     verifyCommon(m, ms, toplevel, abc_env, &jit);
@@ -232,7 +235,7 @@ void BaseExecMgr::verifyJit(MethodInfo* m, MethodSignaturep ms,
         setJit(m, code);
     } else if (config.jitordie) {
         jit.~CodegenLIR(); // Explicit cleanup since destructor won't run otherwise.
-        Exception* e = new (core->GetGC())
+        Exception* e = new (core->GetGC(), MMgc::kExact)
                 Exception(core, core->newStringLatin1("JIT failed")->atom());
         e->flags |= Exception::EXIT_EXCEPTION;
 #ifdef AVMPLUS_VERBOSE
@@ -252,6 +255,65 @@ void BaseExecMgr::verifyJit(MethodInfo* m, MethodSignaturep ms,
     }
 }
 
+bool BaseExecMgr::verifyJitInBackground(MethodInfo* m, MethodSignaturep ms,
+        Toplevel *toplevel, AbcEnv* abc_env)
+{
+    // -Ojit and -Djitordie want the code now.
+    if (!config.jitconfig.jit_thread || config.runmode != RM_mixed || config.jitordie)
+        return false;
+#ifdef VMCFG_WORDCODE
+    // The method must keep running in the interpreter while it waits, and
+    // verifying it for the JIT does not translate it to wordcode.
+    if (!m->isInterpreted())
+        return false;
+#endif
+#ifdef AVMPLUS_VERBOSE
+    // Verbose jit output is easier to read in program order.
+    if (m->pool()->isVerbose(VB_jit, m))
+        return false;
+#endif
+#ifdef VMCFG_VTUNE
+    // The VTune hooks in CodegenLIR::assembleMD() are not thread safe.
+    return false;
+#else
+    if (!jit_thread)
+        jit_thread = mmfx_new(JitThread(core));
+    if (!jit_thread->start())
+        return false;
+
+    CodegenLIR* const jit = mmfx_new(CodegenLIR(m, ms, toplevel, NULL));
+    PERFM_NTPROF_BEGIN("verify & IR gen");
+    TRY(core, kCatchAction_Rethrow) {
+        verifyCommon(m, ms, toplevel, abc_env, jit);
+    }
+    CATCH (Exception *exception) {
+        mmfx_delete(jit);
+        core->throwException(exception);
+    }
+    END_CATCH
+    END_TRY
+    PERFM_NTPROF_END("verify & IR gen");
+    jit->prepareMD();
+
+#ifdef AVMPLUS_VERBOSE
+    if (m->pool()->isVerbose(VB_execpolicy))
+        core->console << "execpolicy jit-thread queued " << m << "\n";
+#endif
+    m->setJitPending(true);
+    jit_thread->enqueue(new JitJob(core->gc, m, ms, toplevel, jit));
+    // Poll on every call until the code is installed (see OSR::countInvoke).
+    setInterp(m, ms, true);
+    m->_abc.countdown = 1;
+    return true;
+#endif
+}
+
+void BaseExecMgr::pollJitThread()
+{
+    if (jit_thread)
+        jit_thread->poll(this);
+}
+
 uintptr_t BaseExecMgr::initInterpGPR(MethodEnv* env, int argc, uint32_t* ap)
 {
     initObj(env, (ScriptObject*) atomPtr(((uintptr_t*)ap)[0]));
@@ -768,6 +830,14 @@ void BaseExecMgr::setupJit(AvmCore* core)
         jit_observer = new JITLoggingObserver(core, core->config.jitprof_level);
 #endif
 
+#ifdef VMCFG_JIT_STACK_MAPS
+    // Let the GC scan JIT frames precisely.
+    if (MMgc::GCHeap::GetGCHeap()->Config().stackMaps) {
+        stack_walker = new JitStackWalker(core);
+        core->gc->SetStackMaps(stack_walker);
+    }
+#endif
+
     (void)core;
 }
 
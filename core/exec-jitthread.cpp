@@ -0,0 +1,231 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "avmplus.h"
+
+#ifdef VMCFG_NANOJIT
+#include "CodegenLIR.h"
+#include "exec-jitthread.h"
+
+namespace avmplus
+{
+    JitJob::JitJob(MMgc::GC* gc, MethodInfo* method, MethodSignaturep ms, Toplevel* toplevel, CodegenLIR* jit)
+        : GCRoot(gc, MMgc::kExact)
+        , method(method)
+        , ms(ms)
+        , toplevel(toplevel)
+        , jit(jit)
+        , code(NULL)
+        , queuedTicks(0)
+        , next(NULL)
+    {
+    }
+
+    bool JitJob::gcTrace(MMgc::GC* gc, size_t cursor)
+    {
+        (void)cursor;
+        gc->TraceLocation(&method);
+        gc->TraceLocation(&ms);
+        gc->TraceLocation(&toplevel);
+        return false;
+    }
+
+    JitThreadRunnable::JitThreadRunnable(JitThread* jit_thread)
+        : jit_thread(jit_thread)
+    {
+    }
+
+    void JitThreadRunnable::run()
+    {
+        jit_thread->HelperMain();
+    }
+
+    JitThread::JitThread(AvmCore* core)
+        : core(core)
+        , runnable(NULL)
+        , thread(NULL)
+        , threadFailed(false)
+        , queued(NULL)
+        , queuedTail(NULL)
+        , queueDepth(0)
+        , finished(NULL)
+        , shutdown(false)
+        , assemblyTicks(0)
+        , jobs(0)
+        , failures(0)
+        , maxQueueDepth(0)
+        , totalQueueDepth(0)
+        , totalLatencyTicks(0)
+        , maxLatencyTicks(0)
+    {
+    }
+
+    JitThread::~JitThread()
+    {
+        if (thread != NULL) {
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                shutdown = true;
+                locker.notifyAll();
+            }
+            thread->join();
+            mmfx_delete(thread);
+            mmfx_delete(runnable);
+        }
+        // The methods stay in the interpreter; the core is going away.
+        discard(queued);
+        discard(finished);
+    }
+
+    bool JitThread::start()
+    {
+        if (thread != NULL)
+            return true;
+        if (threadFailed)
+            return false;
+        runnable = mmfx_new(JitThreadRunnable(this));
+        thread = mmfx_new(vmbase::VMThread("avmplus jit", runnable));
+        if (!thread->start()) {
+            // Don't try again; methods are compiled synchronously.
+            mmfx_delete(thread);
+            mmfx_delete(runnable);
+            thread = NULL;
+            runnable = NULL;
+            threadFailed = true;
+            return false;
+        }
+        return true;
+    }
+
+    void JitThread::enqueue(JitJob* job)
+    {
+        AvmAssert(thread != NULL);
+        job->queuedTicks = VMPI_getPerformanceCounter();
+        uint32_t depth;
+        SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+            depth = queueDepth++;
+            if (queuedTail)
+                queuedTail->next = job;
+            else
+                queued = job;
+            queuedTail = job;
+            locker.notifyAll();
+        }
+        jobs++;
+        totalQueueDepth += depth;
+        if (depth > maxQueueDepth)
+            maxQueueDepth = depth;
+    }
+
+    void JitThread::HelperMain()
+    {
+        for (;;) {
+            JitJob* job;
+            SCOPE_LOCK_NO_SP_NAMED(locker, monitor) {
+                while (queued == NULL && !shutdown)
+                    locker.wait();
+                if (shutdown)
+                    return;
+                job = queued;
+                queued = job->next;
+                if (queued == NULL)
+                    queuedTail = NULL;
+                queueDepth--;
+            }
+
+            uint64_t start = VMPI_getPerformanceCounter();
+            assemble(job);
+            uint64_t elapsed = VMPI_getPerformanceCounter() - start;
+
+            SCOPE_LOCK_NO_SP(monitor) {
+                job->next = finished;
+                finished = job;
+                assemblyTicks += elapsed;
+            }
+        }
+    }
+
+    void JitThread::assemble(JitJob* job)
+    {
+        // The assembler allocates from FixedMalloc and the GCHeap, which want
+        // every thread that uses them to be entered.
+        MMGC_ENTER_VOID;
+        CodeMgr* mgr = job->method->pool()->codeMgr;
+        job->code = job->jit->assembleMD(mgr->threadCodeAlloc, mgr->threadAllocator);
+    }
+
+    void JitThread::poll(BaseExecMgr* exec)
+    {
+        JitJob* list;
+        SCOPE_LOCK_NO_SP(monitor) {
+            list = finished;
+            finished = NULL;
+        }
+        while (list != NULL) {
+            JitJob* job = list;
+            list = job->next;
+            install(exec, job);
+        }
+    }
+
+    void JitThread::install(BaseExecMgr* exec, JitJob* job)
+    {
+        MethodInfo* m = job->method;
+        GprMethodProc code = job->jit->finishMD(job->code);
+        AvmAssert(m->isJitPending() && m->isInterpreted());
+        m->setJitPending(false);
+        if (code) {
+            exec->setJit(m, code);
+        } else {
+            // Like a failure in verifyJit(): interpret from now on.
+#ifdef AVMPLUS_VERBOSE
+            if (m->pool()->isVerbose(VB_execpolicy))
+                core->console << "execpolicy interp " << m << " method-jit-failed\n";
+#endif
+            exec->setInterp(m, job->ms, false);
+            m->setHasFailedJit();
+            failures++;
+        }
+        // m's MethodEnvs still call the counting trampolines, and its countdown
+        // was left at 1 while it was pending, so the next invocation picks up
+        // the new code (see OSR::countInvoke).
+
+        uint64_t latency = VMPI_getPerformanceCounter() - job->queuedTicks;
+        totalLatencyTicks += latency;
+        if (latency > maxLatencyTicks)
+            maxLatencyTicks = latency;
+
+        mmfx_delete(job->jit);
+        delete job;
+    }
+
+    void JitThread::discard(JitJob* list)
+    {
+        while (list != NULL) {
+            JitJob* job = list;
+            list = job->next;
+            mmfx_delete(job->jit);
+            delete job;
+        }
+    }
+
+    void JitThread::printStats()
+    {
+        uint64_t assembly;
+        SCOPE_LOCK_NO_SP(monitor) {
+            assembly = assemblyTicks;
+        }
+        uint64_t frequency = VMPI_getPerformanceFrequency();
+        uint32_t n = jobs > 0 ? jobs : 1;
+        core->console << "jit-thread methods " << jobs << " failed " << failures
+                      << " queue-depth avg " << double(totalQueueDepth) / n
+                      << " max " << maxQueueDepth
+                      << " latency-ms avg " << double(totalLatencyTicks) * 1000 / frequency / n
+                      << " max " << double(maxLatencyTicks) * 1000 / frequency
+                      << " assembly-ms " << double(assembly) * 1000 / frequency << "\n";
+    }
+}
+
+#endif // VMCFG_NANOJIT
@@ -0,0 +1,113 @@
+/* -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+/* vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef __avmplus_exec_jitthread__
+#define __avmplus_exec_jitthread__
+
+namespace avmplus
+{
+    /**
+     * A method waiting for, or done with, assembly on the JitThread.  The job is
+     * an exact GC root for the method, its signature and toplevel, and so also
+     * for the pool whose CodeMgr the helper thread is assembling into.
+     */
+    class JitJob : public MMgc::GCRoot
+    {
+    public:
+        JitJob(MMgc::GC* gc, MethodInfo* method, MethodSignaturep ms, Toplevel* toplevel, CodegenLIR* jit);
+        virtual bool gcTrace(MMgc::GC* gc, size_t cursor);
+
+        MethodInfo* const method;
+        const MethodSignature* const ms;
+        Toplevel* const toplevel;
+        CodegenLIR* const jit;      // the LIR, ready for CodegenLIR::assembleMD()
+        GprMethodProc code;         // set by the helper thread; NULL if the assembler failed
+        uint64_t queuedTicks;       // when the job was queued
+        JitJob* next;
+    };
+
+    class JitThread;
+
+    /** Body of the JitThread's helper thread; it just calls back into the JitThread. */
+    class JitThreadRunnable : public vmbase::Runnable
+    {
+    public:
+        JitThreadRunnable(JitThread* jit_thread);
+        virtual void run();
+
+    private:
+        JitThread* const jit_thread;
+    };
+
+    /**
+     * JitThread runs the assembler on a helper thread when JitConfig::jit_thread is
+     * set, so that compiling a large method does not stall the program.
+     *
+     * BaseExecMgr::verifyJit still verifies the method and generates its LIR,
+     * since that needs the GC heap, and then queues the CodegenLIR here.  The
+     * helper thread runs CodegenLIR::assembleMD(), which only touches the LIR and
+     * the CodeMgr's threadCodeAlloc and threadAllocator.  Meanwhile the method runs
+     * in the interpreter with OSR's counting trampolines, so each invocation comes
+     * back to OSR::countInvoke(), which calls poll().  poll() installs finished
+     * methods on the mutator thread, which is the only thread that changes their
+     * invocation pointers.
+     */
+    class JitThread
+    {
+        friend class JitThreadRunnable;
+    public:
+        JitThread(AvmCore* core);
+
+        /** Stops the helper thread and discards the jobs it has not installed. */
+        ~JitThread();
+
+        /**
+         * Start the helper thread if it is not running yet.  Returns false if it
+         * can't be started, in which case methods must be compiled synchronously.
+         */
+        bool start();
+
+        /** Queue the job; the helper thread must have been started. */
+        void enqueue(JitJob* job);
+
+        /** Install the code of the methods the helper thread has finished with. */
+        void poll(BaseExecMgr* exec);
+
+        /** Print the queue and latency statistics to the core's console. */
+        void printStats();
+
+    private:
+        // Run by the helper thread
+        void HelperMain();
+        void assemble(JitJob* job);
+
+        void install(BaseExecMgr* exec, JitJob* job);
+        void discard(JitJob* list);
+
+        AvmCore* const core;
+        JitThreadRunnable* runnable;
+        vmbase::VMThread* thread;
+        bool threadFailed;
+
+        vmbase::WaitNotifyMonitor monitor;  // Protects the following
+        JitJob* queued;                     // FIFO of jobs for the helper thread
+        JitJob* queuedTail;
+        uint32_t queueDepth;
+        JitJob* finished;                   // jobs waiting for poll(), in no order
+        bool shutdown;
+        uint64_t assemblyTicks;             // time the helper thread spent assembling
+
+        // Statistics kept by the mutator thread
+        uint32_t jobs;
+        uint32_t failures;
+        uint32_t maxQueueDepth;             // jobs queued ahead of a new job, at most
+        uint64_t totalQueueDepth;
+        uint64_t totalLatencyTicks;         // time from queueing to installation
+        uint64_t maxLatencyTicks;
+    };
+}
+
+#endif /* __avmplus_exec_jitthread__ */
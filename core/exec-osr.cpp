@@ -312,17 +312,29 @@ namespace avmplus
         MethodInfo* m = env->method;
         if (--m->_abc.countdown)
             return false;
+        BaseExecMgr* exec = BaseExecMgr::exec(env);
+        if (m->isJitPending()) {
+            // Keep coming back here until the JitThread has assembled m.
+            exec->pollJitThread();
+            if (m->isJitPending()) {
+                m->_abc.countdown = 1;
+                return false;
+            }
+        }
         if (m->isInterpreted()) {
+            if (m->hasFailedJit()) {
+                // The JitThread failed to compile m; stop counting.
+                env->_implGPR = m->_implGPR;
+                return false;
+            }
 #ifdef AVMPLUS_VERBOSE
             if (m->pool()->isVerbose(VB_execpolicy))
                 env->core()->console <<
                     "execpolicy jit hot-call " << env->method << "\n";
 #endif
-            AvmAssert(!m->hasFailedJit());
-            BaseExecMgr* exec = BaseExecMgr::exec(env);
             exec->verifyJit(m, m->getMethodSignature(),
                             env->toplevel(), env->abcEnv(), NULL);
-            if (m->hasFailedJit())
+            if (m->hasFailedJit() || m->isJitPending())
                 return false;
         }
         // Method was already compiled; we got here because env->_implGPR
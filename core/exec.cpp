@@ -8,6 +8,10 @@
 #include "../vprof/vprof.h"
 #include "Interpreter.h"
 
+#ifdef VMCFG_NANOJIT
+#include "exec-jitthread.h"
+#endif
+
 namespace avmplus {
 
 // Computes the size in bytes of an argument of type t, when passed
@@ -46,6 +50,10 @@ BaseExecMgr::BaseExecMgr(AvmCore* core)
 #ifdef VMCFG_NANOJIT
     , current_osr(NULL)
     , jit_observer(NULL)
+    , jit_thread(NULL)
+#endif
+#ifdef VMCFG_JIT_STACK_MAPS
+    , stack_walker(NULL)
 #endif
 {
 #ifdef SUPERWORD_PROFILING
@@ -67,6 +75,19 @@ BaseExecMgr::~BaseExecMgr()
 #ifdef VMCFG_NANOJIT
     delete jit_observer;
     jit_observer = NULL;
+    if (jit_thread) {
+        if (config.jitconfig.jit_thread_stats)
+            jit_thread->printStats();
+        mmfx_delete(jit_thread);
+        jit_thread = NULL;
+    }
+#endif
+#ifdef VMCFG_JIT_STACK_MAPS
+    if (stack_walker) {
+        core->gc->SetStackMaps(NULL);
+        delete stack_walker;
+        stack_walker = NULL;
+    }
 #endif
 }
 
@@ -125,6 +125,7 @@ extern const VecrThunkProc thunkEnterVECR_adapter;
 int32_t argSize(Traits*);
 
 class MethodRecognizer;
+class JitThread;
 
 /**
  * Associates debugfile/debugline information with locations in JITted code
@@ -187,7 +188,7 @@ public:
  * Extends GCFinalizedObject because instances contain GC object references
  * and have a destructor that needs to run.
  */
-class BaseExecMgr: public MMgc::GCFinalizedObject
+class GC_CPP_EXACT(BaseExecMgr, MMgc::GCFinalizedObject)
     , /* implements */ public ExecMgr
 {
 public:
@@ -372,6 +373,17 @@ private:
     /** Install JIT code pointers and set MethodInfo::_isJitImpl. */
     void setJit(MethodInfo*, GprMethodProc p);
 
+    /**
+     * Generate the method's LIR and queue it for the JitThread, leaving
+     * the method in the interpreter until its code is installed.  Returns
+     * false if the thread can't be used, in which case the caller compiles
+     * the method synchronously.
+     */
+    bool verifyJitInBackground(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*);
+
+    /** Install any code the JitThread has finished assembling. */
+    void pollJitThread();
+
     /**
      * Invoker called on the first invocation then calls invoke_generic,
      * installs jitInvokerNow yielding a 1-call delay before we try to
@@ -436,14 +448,21 @@ private:
      * and one for interp.  No attempt is made to determine if the
      * rules overlap and/or conflict in any manner.
      */
-    class JitInterpRuleSet : public MMgc::GCFinalizedObject
+    class GC_CPP_EXACT(JitInterpRuleSet, MMgc::GCFinalizedObject)
     {
+    public:
+        JitInterpRuleSet(MMgc::GC* gc);
+        ~JitInterpRuleSet();
+
+    // ------------------------ DATA SECTION BEGIN
+        GC_DATA_BEGIN(JitInterpRuleSet)
+
     public:
         PolicyRuleSet jit;
         PolicyRuleSet interp;
 
-        JitInterpRuleSet(MMgc::GC* gc);
-        ~JitInterpRuleSet();
+        GC_DATA_END(JitInterpRuleSet)
+    // ------------------------ DATA SECTION END
     };
 
     bool ruleMatch(PolicyRuleSet* rules, const MethodInfo* m) const;
@@ -464,24 +483,35 @@ public:
     void verifyProfilingJit(MethodInfo*, MethodSignaturep, Toplevel*, AbcEnv*);
 #endif
 
+    // ------------------------ DATA SECTION BEGIN
+    GC_DATA_BEGIN(BaseExecMgr)
+
 private:
     AvmCore* core;
     const struct Config& config;
 #ifdef VMCFG_COMPILEPOLICY
-    JitInterpRuleSet* _ruleSet;
+    JitInterpRuleSet* GC_POINTER(_ruleSet);
 #endif
 #ifdef VMCFG_VERIFYALL
-    GCList<MethodInfo> verifyFunctionQueue;
-    GCList<Traits> verifyTraitsQueue;
+    GCList<MethodInfo> GC_STRUCTURE(verifyFunctionQueue);
+    GCList<Traits> GC_STRUCTURE(verifyTraitsQueue);
 #endif
 #ifdef VMCFG_NANOJIT
     friend class OSR;
     friend class CodegenLIR;
     friend class halfmoon::JitFriend;
     friend class LirHelper;
+    friend class JitThread;
     OSR *current_osr;
     JITObserver *jit_observer; // Current JITObserver or NULL if not profiling.
+    JitThread *jit_thread;     // Created on first use when JitConfig::jit_thread is set, else NULL.
+#endif
+#ifdef VMCFG_JIT_STACK_MAPS
+    MMgc::GCStackMaps *stack_walker; // JitStackWalker installed in the GC when it uses stack maps, else NULL.
 #endif
+
+    GC_DATA_END(BaseExecMgr)
+    // ------------------------ DATA SECTION END
 };
 
 /**
@@ -35,12 +35,92 @@ namespace avmplus
     # define PROF_IF(label, expr) if (expr)
     #endif
 
+    #ifdef AVMPLUS_VERBOSE
+    # define COUNT_HIT(c, hit) ((hit) ? ((c).hits++, true) : false)
+    # define COUNT_MISS(c) ((c).misses++)
+    #else
+    # define COUNT_HIT(c, hit) (hit)
+    # define COUNT_MISS(c)
+    #endif
+
     // if the cached obj was a ScriptObject, we have a hit when
     // the new object's tag is kObjectType and the cached vtable matches exactly
-    #define OBJ_HIT(obj, c)  (atomKind(obj) == kObjectType && atomObj(obj)->vtable == (c).vtable)
+    #define OBJ_HIT(obj, c)  COUNT_HIT(c, atomKind(obj) == kObjectType && atomObj(obj)->vtable == (c).vtable)
 
     // if the cached obj was a primitive, we only need a matching atom tag for a hit
-    #define PRIM_HIT(val, c) (atomKind(val) == c.tag)
+    #define PRIM_HIT(val, c) COUNT_HIT(c, atomKind(val) == (c).tag)
+
+    // the vtable or tag a miss handler saves for obj; never 0, which is
+    // how a flushed or unused cache reads.
+    REALLY_INLINE Atom receiver_key(Atom obj)
+    {
+        return isObjectPtr(obj) ? Atom(atomObj(obj)->vtable) : Atom(atomKind(obj));
+    }
+
+    // called from a miss handler before it rebinds c: true if c is a bound
+    // monomorphic cache that has now seen another kind of receiver, and has
+    // become polymorphic.  The caller should then dispatch through its poly handler.
+    template <class C>
+    bool become_polymorphic(C& c, Atom obj, MethodEnv* env)
+    {
+        if (c.state != BindingCache::kMonomorphic || c.tag == 0 || c.tag == receiver_key(obj))
+            return false;
+        CodeMgr* mgr = env->method->pool()->codeMgr;
+        C* entries = (C*) mgr->allocator.alloc(BindingCache::kPolyEntries * sizeof(C));
+        for (uint32_t i = 0; i < BindingCache::kPolyEntries; i++) {
+            // link the entries in so flushBindingCaches() clears them too
+            new (&entries[i]) C(c.name, mgr->bindingCaches, BindingCache::kEntry);
+            mgr->bindingCaches = &entries[i];
+        }
+        c.poly = entries;
+        c.state = BindingCache::kPolymorphic;
+        return true;
+    }
+
+    // find the entry of polymorphic cache c bound to obj's receiver, or failing
+    // that a free entry, reset so its miss handler binds it on the first call.
+    // NULL when every entry is in use by another receiver.
+    template <class C>
+    C* poly_entry(C& c, Atom obj)
+    {
+        const Atom key = receiver_key(obj);
+        C* entries = (C*) c.poly;
+        C* free_entry = NULL;
+        for (uint32_t i = 0; i < BindingCache::kPolyEntries; i++) {
+            if (entries[i].tag == key) {
+                COUNT_HIT(c, true);
+                return &entries[i];
+            }
+            if (entries[i].tag == 0 && free_entry == NULL)
+                free_entry = &entries[i];
+        }
+        COUNT_MISS(c);
+        if (free_entry != NULL)
+            new (free_entry) C(c.name, free_entry->next, BindingCache::kEntry);
+        return free_entry;
+    }
+
+    // find the entry of the megamorphic table for (obj's receiver, c.name),
+    // evicting whatever was there before.
+    template <class C>
+    C* mega_entry(C& c, Atom obj, C*& table, Allocator& allocator)
+    {
+        if (table == NULL) {
+            table = (C*) allocator.alloc(BindingCache::kMegaEntries * sizeof(C));
+            for (uint32_t i = 0; i < BindingCache::kMegaEntries; i++)
+                new (&table[i]) C(NULL, NULL, BindingCache::kEntry);
+        }
+        const Atom key = receiver_key(obj);
+        uintptr_t h = (uintptr_t(key) >> 3) ^ (uintptr_t(c.name) >> 3) * 31;
+        C* e = &table[(h ^ (h >> 8)) & (BindingCache::kMegaEntries - 1)];
+        if (e->name == c.name && e->tag == key) {
+            COUNT_HIT(c, true);
+            return e;
+        }
+        COUNT_MISS(c);
+        new (e) C(c.name, NULL, BindingCache::kEntry);
+        return e;
+    }
 
     REALLY_INLINE Atom invoke_cached_method(CallCache& c, Atom obj, int argc, Atom* args)
     {
@@ -160,9 +240,32 @@ namespace avmplus
     //  - save the object vtable (for ScriptObject*) or atom tag (all others)
     //  - pick a handler and save the MethodEnv* or slot_offset
     //  - invoke the new handler, which WILL NOT miss on this first call
+    Atom callprop_mega(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
+    {
+        CodeMgr* mgr = env->method->pool()->codeMgr;
+        CallCache* e = mega_entry(c, obj, mgr->megaCalls, mgr->allocator);
+        return e->call_handler(*e, obj, argc, args, env);
+    }
+
+    Atom callprop_poly(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
+    {
+        CallCache* e = poly_entry(c, obj);
+        if (!e) {
+            c.state = BindingCache::kMegamorphic;
+            c.call_handler = callprop_mega;
+            return callprop_mega(c, obj, argc, args, env);
+        }
+        return e->call_handler(*e, obj, argc, args, env);
+    }
+
     Atom callprop_miss(CallCache& c, Atom obj, int argc, Atom* args, MethodEnv* env)
     {
         AssertNotNull(obj);
+        if (become_polymorphic(c, obj, env)) {
+            c.call_handler = callprop_poly;
+            return callprop_poly(c, obj, argc, args, env);
+        }
+        COUNT_MISS(c);
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* obj_type = vtable->traits;
@@ -340,10 +443,33 @@ namespace avmplus
         0,                    // BKIND_GETSET (impossible on primitive)
     };
 
+    Atom getprop_mega(GetCache& c, MethodEnv* env, Atom obj)
+    {
+        CodeMgr* mgr = env->method->pool()->codeMgr;
+        GetCache* e = mega_entry(c, obj, mgr->megaGets, mgr->allocator);
+        return e->get_handler(*e, env, obj);
+    }
+
+    Atom getprop_poly(GetCache& c, MethodEnv* env, Atom obj)
+    {
+        GetCache* e = poly_entry(c, obj);
+        if (!e) {
+            c.state = BindingCache::kMegamorphic;
+            c.get_handler = getprop_mega;
+            return getprop_mega(c, env, obj);
+        }
+        return e->get_handler(*e, env, obj);
+    }
+
     Atom getprop_miss(GetCache& c, MethodEnv* env, Atom obj)
     {
         // cache handler when cache miss occurs
         AvmAssert(!AvmCore::isNullOrUndefined(obj));
+        if (become_polymorphic(c, obj, env)) {
+            c.get_handler = getprop_poly;
+            return getprop_poly(c, env, obj);
+        }
+        COUNT_MISS(c);
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* actual_type = vtable->traits;
@@ -802,10 +928,35 @@ namespace avmplus
 #endif // VMCFG_FLOAT
     };
 
+    void setprop_mega(SetCache& c, Atom obj, Atom val, MethodEnv* env)
+    {
+        CodeMgr* mgr = env->method->pool()->codeMgr;
+        SetCache* e = mega_entry(c, obj, mgr->megaSets, mgr->allocator);
+        e->set_handler(*e, obj, val, env);
+    }
+
+    void setprop_poly(SetCache& c, Atom obj, Atom val, MethodEnv* env)
+    {
+        SetCache* e = poly_entry(c, obj);
+        if (!e) {
+            c.state = BindingCache::kMegamorphic;
+            c.set_handler = setprop_mega;
+            setprop_mega(c, obj, val, env);
+            return;
+        }
+        e->set_handler(*e, obj, val, env);
+    }
+
     void setprop_miss(SetCache& c, Atom obj, Atom val, MethodEnv* env)
     {
         // cache handler when cache miss occurs
         AvmAssert(!AvmCore::isNullOrUndefined(obj));
+        if (become_polymorphic(c, obj, env)) {
+            c.set_handler = setprop_poly;
+            setprop_poly(c, obj, val, env);
+            return;
+        }
+        COUNT_MISS(c);
         Toplevel* toplevel = env->toplevel();
         VTable* vtable = toplevel->toVTable(obj);
         Traits* actual_type = vtable->traits;
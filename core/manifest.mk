@@ -50,6 +50,7 @@ avmplus_CXXSRCS := $(avmplus_CXXSRCS) \
   $(curdir)/exec.cpp \
   $(curdir)/exec-jit.cpp \
   $(curdir)/exec-osr.cpp \
+  $(curdir)/exec-jitthread.cpp \
   $(curdir)/exec-verifyall.cpp \
   $(curdir)/FloatClass.cpp \
   $(curdir)/Float4Class.cpp \
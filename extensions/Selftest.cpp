@@ -198,7 +198,7 @@ namespace avmplus
     {
         if (!expr) {
             selftestRunner->logFailure(text_expr, file, line);
-            core->throwException(new (core->GetGC()) Exception(core, selftestRunner->token));
+            core->throwException(new (core->GetGC(), MMgc::kExact) Exception(core, selftestRunner->token));
         }
     }
 
@@ -1,4 +1,4 @@
-// Generated from ST_avmplus_basics.st, ST_avmplus_builtins.st, ST_avmplus_peephole.st, ST_avmplus_vector_accessors.st, ST_mmgc_543560.st, ST_mmgc_575631.st, ST_mmgc_580603.st, ST_mmgc_603411.st, ST_mmgc_637993.st, ST_mmgc_basics.st, ST_mmgc_dependent.st, ST_mmgc_exact.st, ST_mmgc_externalalloc.st, ST_mmgc_finalize_uninit.st, ST_mmgc_fixedmalloc_findbeginning.st, ST_mmgc_gcheap.st, ST_mmgc_gcoption.st, ST_mmgc_mmfx_array.st, ST_mmgc_threads.st, ST_mmgc_weakref.st, ST_nanojit_codealloc.st, ST_vmbase_concurrency.st, ST_vmbase_safepoints.st, ST_vmpi_threads.st, ST_workers_Buffer.st, ST_workers_NoSyncSingleItemBuffer.st, ST_workers_Promise.st
+// Generated from ST_avmplus_basics.st, ST_avmplus_builtins.st, ST_avmplus_peephole.st, ST_avmplus_vector_accessors.st, ST_mmgc_543560.st, ST_mmgc_575631.st, ST_mmgc_580603.st, ST_mmgc_603411.st, ST_mmgc_637993.st, ST_mmgc_basics.st, ST_mmgc_dependent.st, ST_mmgc_exact.st, ST_mmgc_externalalloc.st, ST_mmgc_finalize_uninit.st, ST_mmgc_fixedmalloc_findbeginning.st, ST_mmgc_gcheap.st, ST_mmgc_gcoption.st, ST_mmgc_mmfx_array.st, ST_mmgc_pagemap.st, ST_mmgc_threads.st, ST_mmgc_weakref.st, ST_nanojit_codealloc.st, ST_vmbase_concurrency.st, ST_vmbase_safepoints.st, ST_vmpi_threads.st, ST_workers_Buffer.st, ST_workers_NoSyncSingleItemBuffer.st, ST_workers_Promise.st
 // Generated from ST_avmplus_basics.st
 // -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
 // vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
@@ -1432,6 +1432,10 @@ void test14();
 void test15();
 void test16();
 void test17();
+void test18();
+void test19();
+void test20();
+void test21();
 private:
     MMgc::GC *gc;
     MMgc::FixedAlloc *fa;
@@ -1441,8 +1445,8 @@ private:
 ST_mmgc_basics::ST_mmgc_basics(AvmCore* core)
     : Selftest(core, "mmgc", "basics", ST_mmgc_basics::ST_names,ST_mmgc_basics::ST_explicits)
 {}
-const char* ST_mmgc_basics::ST_names[] = {"create_gc_instance","create_gc_object","get_bytesinuse","collect","getgcheap","fixedAlloc","fixedMalloc","gcheap","gcheapAlign","gcmethods","finalizerAlloc","finalizerDelete","nestedGCs","collectDormantGC","lockObject","regression_551169","blacklisting","get_bytesinusefast", NULL };
-const bool ST_mmgc_basics::ST_explicits[] = {false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false, false };
+const char* ST_mmgc_basics::ST_names[] = {"create_gc_instance","create_gc_object","get_bytesinuse","collect","getgcheap","fixedAlloc","fixedMalloc","gcheap","gcheapAlign","gcmethods","finalizerAlloc","finalizerDelete","nestedGCs","collectDormantGC","lockObject","regression_551169","blacklisting","get_bytesinusefast","event_stream","heap_snapshot","allocation_sampler","incremental_reap", NULL };
+const bool ST_mmgc_basics::ST_explicits[] = {false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false, false };
 void ST_mmgc_basics::run(int n) {
 switch(n) {
 case 0: test0(); return;
@@ -1463,6 +1467,10 @@ case 14: test14(); return;
 case 15: test15(); return;
 case 16: test16(); return;
 case 17: test17(); return;
+case 18: test18(); return;
+case 19: test19(); return;
+case 20: test20(); return;
+case 21: test21(); return;
 }
 }
 void ST_mmgc_basics::prologue() {
@@ -1572,6 +1580,13 @@ public:
     }
 };
 
+class CountedRCObject : public RCObject {
+public:
+    CountedRCObject(int* counter) : counter(counter) {}
+    ~CountedRCObject() { *counter = *counter + 1; counter = NULL; }
+    int *counter;
+};
+
 GCObjectLock* LockerAndUnlocker::lock[numlocked];
 GCObjectLock* LockerAndUnlocker::lock2[numlocked];
 int LockerAndUnlocker::counter = 0;
@@ -1932,6 +1947,182 @@ verifyPass(gc->GetBytesInUse() == gc->GetBytesInUseFast(), "gc->GetBytesInUse()
 verifyPass(gc->GetBytesInUse() == gc->GetBytesInUseFast() , "gc->GetBytesInUse() == gc->GetBytesInUseFast() ", __FILE__, __LINE__);
      
 
+}
+void ST_mmgc_basics::test18() {
+#ifdef MMGC_EVENT_STREAM
+    class CountingEventWriter : public GCEventWriter {
+    public:
+        CountingEventWriter() : phases(0), collections(0) {}
+        virtual void write(const char* record) {
+            if (VMPI_strncmp(record, "{\"type\":\"phase\"", 15) == 0)
+                phases++;
+            else if (VMPI_strncmp(record, "{\"type\":\"collection\"", 20) == 0)
+                collections++;
+        }
+        int phases;
+        int collections;
+    };
+    CountingEventWriter writer;
+    GCHeap* heap = GCHeap::GetGCHeap();
+    GCEventWriter* saved = heap->GetEventWriter();
+    heap->SetEventWriter(&writer);
+    {
+        MMGC_GCENTER(gc);
+        gc->Collect();
+    }
+    heap->SetEventWriter(saved);
+    // At least StartIncrementalMark, FinalRootAndStackScan and FinalizeAndSweep.
+// line 438 "ST_mmgc_basics.st"
+verifyPass(writer.collections >= 1, "writer.collections >= 1", __FILE__, __LINE__);
+// line 439 "ST_mmgc_basics.st"
+verifyPass(writer.phases >= 3, "writer.phases >= 3", __FILE__, __LINE__);
+#else
+// line 441 "ST_mmgc_basics.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+#endif
+}
+void ST_mmgc_basics::test19() {
+#ifdef MMGC_HEAP_SNAPSHOT
+    class CheckingSnapshotWriter : public GCHeapSnapshotWriter {
+    public:
+        CheckingSnapshotWriter() : begun(0), ended(0), nbytes(0) {}
+        virtual bool begin() { begun++; return true; }
+        virtual void write(const void* bytes, size_t n) {
+            for (size_t i=0 ; i < n && nbytes+i < 8 ; i++ )
+                header[nbytes+i] = ((const char*)bytes)[i];
+            nbytes += n;
+        }
+        virtual void end() { ended++; }
+        int begun;
+        int ended;
+        size_t nbytes;
+        char header[8];
+    };
+    CheckingSnapshotWriter writer;
+    bool written;
+    {
+        MMGC_GCENTER(gc);
+        MyGCObject* volatile mygcobject = (MyGCObject *) new (gc) MyGCObject();
+        written = gc->WriteHeapSnapshot(&writer);
+        (void)mygcobject;
+    }
+// line 469 "ST_mmgc_basics.st"
+verifyPass(written, "written", __FILE__, __LINE__);
+// line 470 "ST_mmgc_basics.st"
+verifyPass(writer.begun == 1 && writer.ended == 1, "writer.begun == 1 && writer.ended == 1", __FILE__, __LINE__);
+// line 471 "ST_mmgc_basics.st"
+verifyPass(writer.nbytes > 8 && VMPI_memcmp(writer.header, "MMGCSNP1", 8) == 0, "writer.nbytes > 8 && VMPI_memcmp(writer.header, \"MMGCSNP1\", 8) == 0", __FILE__, __LINE__);
+#else
+// line 473 "ST_mmgc_basics.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+#endif
+}
+void ST_mmgc_basics::test20() {
+#ifdef MMGC_ALLOCATION_SAMPLER
+    class SummingProfileWriter : public GCAllocationProfileWriter {
+    public:
+        SummingProfileWriter() : lines(0), bytes(0), wellFormed(true) {}
+        virtual void write(const char* line) {
+            // "frame;frame;... bytes\n"
+            size_t n = VMPI_strlen(line);
+            size_t space = n;
+            while (space > 0 && line[space-1] != ' ')
+                space--;
+            if (space <= 1 || n == 0 || line[n-1] != '\n')
+                wellFormed = false;
+            else
+                bytes += (uint64_t)VMPI_strtol(line + space, NULL, 10);
+            lines++;
+        }
+        int lines;
+        uint64_t bytes;
+        bool wellFormed;
+    };
+    SummingProfileWriter allocated;
+    SummingProfileWriter live;
+    bool written;
+    bool unsampledWritten;
+    const int numObjects = 40000;
+    {
+        GCHeapConfig& heapConfig = GCHeap::GetGCHeap()->Config();
+        uint32_t savedInterval = heapConfig.allocationSampleInterval;
+        heapConfig.allocationSampleInterval = 4096;
+        GCConfig sampledConfig;
+        GC* sampledGC = new GC(GCHeap::GetGCHeap(), sampledConfig);
+        heapConfig.allocationSampleInterval = savedInterval;
+        {
+            MMGC_GCENTER(sampledGC);
+            for ( int i=0 ; i < numObjects ; i++ )
+                new (sampledGC) MyGCObject();
+            written = sampledGC->WriteAllocationProfile(&allocated, false) &&
+                      sampledGC->WriteAllocationProfile(&live, true);
+        }
+        delete sampledGC;
+    }
+    {
+        MMGC_GCENTER(gc);
+        unsampledWritten = gc->WriteAllocationProfile(&live, false);
+    }
+    // About 150 samples: the estimate is well within a factor of two.
+// line 523 "ST_mmgc_basics.st"
+verifyPass(written && !unsampledWritten, "written && !unsampledWritten", __FILE__, __LINE__);
+// line 524 "ST_mmgc_basics.st"
+verifyPass(allocated.lines > 0 && allocated.wellFormed && live.wellFormed, "allocated.lines > 0 && allocated.wellFormed && live.wellFormed", __FILE__, __LINE__);
+// line 525 "ST_mmgc_basics.st"
+verifyPass(allocated.bytes > numObjects * sizeof(MyGCObject) / 2 && allocated.bytes < numObjects * sizeof(MyGCObject) * 2, "allocated.bytes > numObjects * sizeof(MyGCObject) / 2 && allocated.bytes < numObjects * sizeof(MyGCObject) * 2", __FILE__, __LINE__);
+// line 526 "ST_mmgc_basics.st"
+verifyPass(live.bytes < allocated.bytes, "live.bytes < allocated.bytes", __FILE__, __LINE__);
+#else
+// line 528 "ST_mmgc_basics.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+#endif
+}
+void ST_mmgc_basics::test21() {
+#ifdef MMGC_INCREMENTAL_REAP
+    const int numObjects = 40000;
+    int reaped = 0;
+    uint64_t slices;
+    uint64_t reaps;
+    {
+        GCHeapConfig& heapConfig = GCHeap::GetGCHeap()->Config();
+        bool savedIncrementalReap = heapConfig.incrementalReap;
+        heapConfig.incrementalReap = true;
+#ifdef MMGC_PAUSE_TARGET
+        // A tiny pause target makes every slice stop after the minimum amount of work.
+        double savedPauseTarget = heapConfig.gcPauseTarget;
+        heapConfig.gcPauseTarget = 0.001;
+#endif
+        GCConfig reapConfig;
+        GC* reapGC = new GC(GCHeap::GetGCHeap(), reapConfig);
+        heapConfig.incrementalReap = savedIncrementalReap;
+#ifdef MMGC_PAUSE_TARGET
+        heapConfig.gcPauseTarget = savedPauseTarget;
+#endif
+        {
+            MMGC_GCENTER(reapGC);
+            for ( int i=0 ; i < numObjects ; i++ )
+                new (reapGC) CountedRCObject(&reaped);
+            // The first call finishes the reap in progress; the objects allocated
+            // while it was suspended are pinned by it and reaped by the second.
+            reapGC->ReapZCT();
+            reapGC->ReapZCT();
+        }
+        slices = reapGC->policy.countReapZCT;
+        reaps = reapGC->policy.countReapZCTEpochs;
+        delete reapGC;
+    }
+// line 572 "ST_mmgc_basics.st"
+verifyPass(reaps > 0, "reaps > 0", __FILE__, __LINE__);
+#ifdef MMGC_PAUSE_TARGET
+// line 574 "ST_mmgc_basics.st"
+verifyPass(slices > reaps, "slices > reaps", __FILE__, __LINE__);
+#endif
+// line 576 "ST_mmgc_basics.st"
+verifyPass(reaped > numObjects - 100, "reaped > numObjects - 100", __FILE__, __LINE__);
+#else
+// line 578 "ST_mmgc_basics.st"
+verifyPass(true, "true", __FILE__, __LINE__);
+#endif
 }
 void create_mmgc_basics(AvmCore* core) { new ST_mmgc_basics(core); }
 }
@@ -2161,15 +2352,17 @@ private:
 static const char* ST_names[];
 static const bool ST_explicits[];
 void test0();
+void test1();
 };
 ST_mmgc_exact::ST_mmgc_exact(AvmCore* core)
     : Selftest(core, "mmgc", "exact", ST_mmgc_exact::ST_names,ST_mmgc_exact::ST_explicits)
 {}
-const char* ST_mmgc_exact::ST_names[] = {"IncorrectlySplitSmallObject", NULL };
-const bool ST_mmgc_exact::ST_explicits[] = {false, false };
+const char* ST_mmgc_exact::ST_names[] = {"IncorrectlySplitSmallObject","CoreObjectsAreExactlyTraced", NULL };
+const bool ST_mmgc_exact::ST_explicits[] = {false,false, false };
 void ST_mmgc_exact::run(int n) {
 switch(n) {
 case 0: test0(); return;
+case 1: test1(); return;
 }
 }
 void ST_mmgc_exact::test0() {
@@ -2183,6 +2376,17 @@ void ST_mmgc_exact::test0() {
 verifyPass(true, "true", __FILE__, __LINE__);
 
 
+}
+void ST_mmgc_exact::test1() {
+    int expected = MMgc::GC::IsExactlyTraced(Cthulhu::create(core->gc)) != 0;
+    avmplus::Exception* e = new (core->gc, MMgc::kExact) avmplus::Exception(core, avmplus::undefinedAtom);
+    int exception = MMgc::GC::IsExactlyTraced(e) != 0;
+    int domainMgr = MMgc::GC::IsExactlyTraced(core->domainMgr()) != 0;
+
+// line 54 "ST_mmgc_exact.st"
+verifyPass(exception == expected, "exception == expected", __FILE__, __LINE__);
+// line 55 "ST_mmgc_exact.st"
+verifyPass(domainMgr == expected, "domainMgr == expected", __FILE__, __LINE__);
 }
 void create_mmgc_exact(AvmCore* core) { new ST_mmgc_exact(core); }
 }
@@ -2874,6 +3078,19 @@ void test1();
 void test2();
 void test3();
 void test4();
+void test5();
+void test6();
+void test7();
+void test8();
+void test9();
+void test10();
+void test11();
+void test12();
+void test13();
+void test14();
+void test15();
+void test16();
+void test17();
     bool m_ret;
     bool m_wrong;
     GCHeap *m_heap;
@@ -2924,8 +3141,8 @@ void test4();
 ST_mmgc_gcoption::ST_mmgc_gcoption(AvmCore* core)
     : Selftest(core, "mmgc", "gcoption", ST_mmgc_gcoption::ST_names,ST_mmgc_gcoption::ST_explicits)
 {}
-const char* ST_mmgc_gcoption::ST_names[] = {"detect_parameterized_options","parse_memstats","parse_memlimit","parse_gcbehavior_gcsummary_eagersweep","parse_load_gcwork", NULL };
-const bool ST_mmgc_gcoption::ST_explicits[] = {false,false,false,false,false, false };
+const char* ST_mmgc_gcoption::ST_names[] = {"detect_parameterized_options","parse_memstats","parse_memlimit","parse_gcbehavior_gcsummary_eagersweep","parse_load_gcwork","parse_gcmarkthreads","parse_backgroundsweep","parse_generational","parse_cardbarrier","parse_hugepages","parse_compact","parse_fixedmagazines","parse_gcpause","parse_gcstackmaps","parse_gcweakslots","parse_gcsample","parse_gcdecommit","parse_gcincrementalreap", NULL };
+const bool ST_mmgc_gcoption::ST_explicits[] = {false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false,false, false };
 void ST_mmgc_gcoption::run(int n) {
 switch(n) {
 case 0: test0(); return;
@@ -2933,6 +3150,19 @@ case 1: test1(); return;
 case 2: test2(); return;
 case 3: test3(); return;
 case 4: test4(); return;
+case 5: test5(); return;
+case 6: test6(); return;
+case 7: test7(); return;
+case 8: test8(); return;
+case 9: test9(); return;
+case 10: test10(); return;
+case 11: test11(); return;
+case 12: test12(); return;
+case 13: test13(); return;
+case 14: test14(); return;
+case 15: test15(); return;
+case 16: test16(); return;
+case 17: test17(); return;
 }
 }
 void ST_mmgc_gcoption::prologue() {
@@ -3223,7 +3453,403 @@ verifyPass(approxEqual(m_heap->config.gcEfficiency, .3456), "approxEqual(m_heap-
     restoreHeapConfig();
 
 }
+}
+void ST_mmgc_gcoption::test5() {
+{
+#ifdef MMGC_PARALLEL_MARKING
+// line 275 "ST_mmgc_gcoption.st"
+verifyPass(isParamOption("-gcmarkthreads"), "isParamOption(\"-gcmarkthreads\")", __FILE__, __LINE__);
+// line 276 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gcmarkthreads 4"), "notParamOption(\"-gcmarkthreads 4\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcmarkthreads 4");
+// line 280 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 281 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.markThreads == 4, "m_heap->config.markThreads == 4", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcmarkthreads", "2");
+// line 286 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 287 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.markThreads == 2, "m_heap->config.markThreads == 2", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcmarkthreads 0");
+// line 292 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 293 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcmarkthreads 1000");
+// line 298 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 299 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test6() {
+{
+#ifdef MMGC_BACKGROUND_SWEEPING
+// line 307 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-backgroundsweep"), "notParamOption(\"-backgroundsweep\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-backgroundsweep");
+// line 311 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 312 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.backgroundSweeping, "m_heap->config.backgroundSweeping", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test7() {
+{
+#ifdef MMGC_GENERATIONAL
+// line 320 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gcgenerational"), "notParamOption(\"-gcgenerational\")", __FILE__, __LINE__);
+// line 321 "ST_mmgc_gcoption.st"
+verifyPass(isParamOption("-gcnursery"), "isParamOption(\"-gcnursery\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcgenerational");
+// line 325 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 326 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.generational, "m_heap->config.generational", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcnursery 256");
+// line 331 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 332 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.nurserySize == 256*1024, "m_heap->config.nurserySize == 256*1024", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcnursery", "4096");
+// line 337 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 338 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.nurserySize == 4096*1024, "m_heap->config.nurserySize == 4096*1024", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcnursery 0");
+// line 343 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 344 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test8() {
+{
+#ifdef MMGC_CARD_MARKING
+// line 353 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gccardbarrier"), "notParamOption(\"-gccardbarrier\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gccardbarrier");
+// line 357 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 358 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.cardMarking, "m_heap->config.cardMarking", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gccardbarrier 1");
+// line 363 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 364 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test9() {
+{
+#ifdef MMGC_HUGE_PAGES
+// line 373 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gchugepages"), "notParamOption(\"-gchugepages\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gchugepages");
+// line 377 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 378 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.hugePages, "m_heap->config.hugePages", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gchugepages 1");
+// line 383 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 384 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test10() {
+{
+#ifdef MMGC_COMPACTION
+// line 393 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gccompact"), "notParamOption(\"-gccompact\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gccompact");
+// line 397 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 398 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.compaction, "m_heap->config.compaction", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gccompact 1");
+// line 403 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 404 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test11() {
+{
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+// line 413 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-fixedmagazines"), "notParamOption(\"-fixedmagazines\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-fixedmagazines");
+// line 417 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 418 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.fixedMagazines, "m_heap->config.fixedMagazines", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-fixedmagazines 1");
+// line 423 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 424 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test12() {
+{
+#ifdef MMGC_PAUSE_TARGET
+// line 433 "ST_mmgc_gcoption.st"
+verifyPass(isParamOption("-gcpause"), "isParamOption(\"-gcpause\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcpause 2");
+// line 437 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 438 "ST_mmgc_gcoption.st"
+verifyPass(approxEqual(m_heap->config.gcPauseTarget, 2.0), "approxEqual(m_heap->config.gcPauseTarget, 2.0)", __FILE__, __LINE__);
+// line 439 "ST_mmgc_gcoption.st"
+verifyPass(approxEqual(m_heap->config.gcMinUtilization, m_config_orig.gcMinUtilization), "approxEqual(m_heap->config.gcMinUtilization, m_config_orig.gcMinUtilization)", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcpause", "0.5,0.7");
+// line 444 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 445 "ST_mmgc_gcoption.st"
+verifyPass(approxEqual(m_heap->config.gcPauseTarget, 0.5), "approxEqual(m_heap->config.gcPauseTarget, 0.5)", __FILE__, __LINE__);
+// line 446 "ST_mmgc_gcoption.st"
+verifyPass(approxEqual(m_heap->config.gcMinUtilization, 0.7), "approxEqual(m_heap->config.gcMinUtilization, 0.7)", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcpause 0");
+// line 451 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 452 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcpause 2,1");
+// line 457 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 458 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test13() {
+{
+#ifdef MMGC_STACK_MAPS
+// line 467 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gcstackmaps"), "notParamOption(\"-gcstackmaps\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcstackmaps");
+// line 471 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 472 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.stackMaps, "m_heap->config.stackMaps", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcstackmaps 1");
+// line 477 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 478 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test14() {
+{
+#ifdef MMGC_INLINE_WEAKREFS
+// line 487 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gcweakslots"), "notParamOption(\"-gcweakslots\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcweakslots");
+// line 491 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 492 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.inlineWeakRefs, "m_heap->config.inlineWeakRefs", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcweakslots 1");
+// line 497 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 498 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test15() {
+{
+#ifdef MMGC_ALLOCATION_SAMPLER
+// line 507 "ST_mmgc_gcoption.st"
+verifyPass(isParamOption("-gcsample"), "isParamOption(\"-gcsample\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcsample 512");
+// line 511 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 512 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.allocationSampleInterval == 512*1024, "m_heap->config.allocationSampleInterval == 512*1024", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcsample", "64");
+// line 517 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 518 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.allocationSampleInterval == 64*1024, "m_heap->config.allocationSampleInterval == 64*1024", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcsample 0");
+// line 523 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 524 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test16() {
+{
+#ifdef MMGC_BACKGROUND_DECOMMIT
+// line 533 "ST_mmgc_gcoption.st"
+verifyPass(isParamOption("-gcdecommit"), "isParamOption(\"-gcdecommit\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcdecommit 4096,250");
+// line 537 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 538 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.backgroundDecommit, "m_heap->config.backgroundDecommit", __FILE__, __LINE__);
+// line 539 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.decommitReserve == 4096*1024, "m_heap->config.decommitReserve == 4096*1024", __FILE__, __LINE__);
+// line 540 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.decommitDelay == 250, "m_heap->config.decommitDelay == 250", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcdecommit", "0");
+// line 545 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 546 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.backgroundDecommit, "m_heap->config.backgroundDecommit", __FILE__, __LINE__);
+// line 547 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.decommitReserve == 0, "m_heap->config.decommitReserve == 0", __FILE__, __LINE__);
+// line 548 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.decommitDelay == GCHeapConfig::kDefaultDecommitDelay, "m_heap->config.decommitDelay == GCHeapConfig::kDefaultDecommitDelay", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+
+    parseApply("-gcdecommit 1024,-1");
+// line 553 "ST_mmgc_gcoption.st"
+verifyPass(gcoptionButIncorrectFormat(), "gcoptionButIncorrectFormat()", __FILE__, __LINE__);
+// line 554 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
+}
+void ST_mmgc_gcoption::test17() {
+{
+#ifdef MMGC_INCREMENTAL_REAP
+// line 563 "ST_mmgc_gcoption.st"
+verifyPass(notParamOption("-gcincrementalreap"), "notParamOption(\"-gcincrementalreap\")", __FILE__, __LINE__);
+          ;
+
+    parseApply("-gcincrementalreap");
+// line 567 "ST_mmgc_gcoption.st"
+verifyPass(parsedCorrectly(), "parsedCorrectly()", __FILE__, __LINE__);
+// line 568 "ST_mmgc_gcoption.st"
+verifyPass(m_heap->config.incrementalReap, "m_heap->config.incrementalReap", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
 
+    parseApply("-gcincrementalreap 1");
+// line 573 "ST_mmgc_gcoption.st"
+verifyPass(!m_ret, "!m_ret", __FILE__, __LINE__);
+// line 574 "ST_mmgc_gcoption.st"
+verifyPass(configUnchanged(), "configUnchanged()", __FILE__, __LINE__);
+          ;
+    restoreHeapConfig();
+#endif
+}
 }
 void create_mmgc_gcoption(AvmCore* core) { new ST_mmgc_gcoption(core); }
 }
@@ -3309,6 +3935,394 @@ void create_mmgc_mmfx_array(AvmCore* core) { new ST_mmgc_mmfx_array(core); }
 }
 #endif
 
+// Generated from ST_mmgc_pagemap.st
+// -*- Mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*- */
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+#include "avmshell.h"
+#ifdef VMCFG_SELFTEST
+namespace avmplus {
+namespace ST_mmgc_pagemap {
+using namespace MMgc;
+
+// The addresses given to the page maps below are only keys, nothing is allocated
+// at them.  The ranges cross leaf boundaries, and on 64-bit systems interior node
+// boundaries too.  A range of one page is a small-object block, longer ranges are
+// large-object blocks.
+
+#ifdef MMGC_64BIT
+static const uintptr_t kTestBase = uintptr_t(0x7f12) << 32;
+static const uintptr_t kChurnStride = uintptr_t(1) << 30;
+#else
+static const uintptr_t kTestBase = 0x40000000;
+static const uintptr_t kChurnStride = uintptr_t(1) << 20;
+#endif
+
+struct TestRange
+{
+    uintptr_t offset;
+    uint32_t numPages;
+};
+
+static const TestRange testRanges[] = {
+    { 0, 1 },
+    { 2 * PageMap::kPageSize, 1 },
+    { 0x100000, 100 },
+    { 0x40000000 - 3 * PageMap::kPageSize, 6 },
+    { 0x50000000, 1 },
+#ifdef MMGC_64BIT
+    { uintptr_t(1) << 41, 20 },
+    { uintptr_t(1) << 46, 1 },
+#endif
+};
+
+static const size_t numTestRanges = sizeof(testRanges) / sizeof(testRanges[0]);
+
+static PageMap::PageType expectedVal(const TestRange& r, uint32_t page)
+{
+    if (r.numPages == 1)
+        return PageMap::kGCAllocPage;
+    return page == 0 ? PageMap::kGCLargeAllocPageFirst : PageMap::kGCLargeAllocPageRest;
+}
+
+template<class PM>
+static void populate(PM& pm, GCHeap* heap, uintptr_t base)
+{
+    for (size_t i=0; i < numTestRanges; i++) {
+        char* item = (char*)(base + testRanges[i].offset);
+        pm.ExpandSetAll(heap, item, 1, expectedVal(testRanges[i], 0));
+        if (testRanges[i].numPages > 1)
+            pm.ExpandSetAll(heap, item + PageMap::kPageSize, testRanges[i].numPages - 1, expectedVal(testRanges[i], 1));
+    }
+}
+
+template<class PM>
+static void clear(PM& pm, uintptr_t base)
+{
+    for (size_t i=0; i < numTestRanges; i++)
+        pm.ClearAddrs((void*)(base + testRanges[i].offset), testRanges[i].numPages);
+}
+
+// Returns the number of pages in and around the test ranges that do not map to
+// what they should.
+template<class PM>
+static uint32_t check(const PM& pm, uintptr_t base, bool populated)
+{
+    uint32_t errors = 0;
+    for (size_t i=0; i < numTestRanges; i++) {
+        uintptr_t addr = base + testRanges[i].offset;
+        if (pm.AddrToVal(addr - PageMap::kPageSize) != PageMap::kNonGC)
+            errors++;
+        for (uint32_t p=0; p < testRanges[i].numPages; p++, addr += PageMap::kPageSize) {
+            PageMap::PageType expected = populated ? expectedVal(testRanges[i], p) : PageMap::kNonGC;
+            // Look up the first and the last word of the page.
+            if (pm.AddrToVal(addr) != expected)
+                errors++;
+            if (pm.AddrToVal(addr + PageMap::kPageSize - sizeof(void*)) != expected)
+                errors++;
+        }
+        if (pm.AddrToVal(addr) != PageMap::kNonGC)
+            errors++;
+    }
+    return errors;
+}
+
+// Looks up the test ranges, and the first page of each of the churned regions
+// that the test is setting and clearing, until told to stop.
+class PageMapReader : public vmbase::Runnable
+{
+public:
+    PageMapReader(const PageMap::Radix* pm, uint32_t numChurned, volatile int32_t* stop)
+        : pm(pm)
+        , numChurned(numChurned)
+        , stop(stop)
+        , passes(0)
+        , errors(0)
+    {
+    }
+
+    virtual void run()
+    {
+        while (*stop == 0) {
+            errors += check(*pm, kTestBase, true);
+            for (uint32_t i=0; i < numChurned; i++) {
+                PageMap::PageType t = pm->AddrToVal(kTestBase + 0x60000000 + i * kChurnStride);
+                if (t != PageMap::kNonGC && t != PageMap::kGCAllocPage)
+                    errors++;
+            }
+            passes++;
+        }
+    }
+
+    const PageMap::Radix* const pm;
+    const uint32_t numChurned;
+    volatile int32_t* const stop;
+    uint32_t passes;
+    uint32_t errors;
+};
+
+// The lookup benchmark.  Two regions of 2048 pages 1.5GB apart are mapped (so that
+// they are in different leaves of all the tiered maps); three quarters of the
+// lookups land in the regions and the rest between them, like the words of a
+// conservatively scanned stack.  The "one region" workload only looks up addresses
+// in and below the first region.
+
+static const uint32_t kRegionPages = 2048;
+static const uintptr_t kRegionGap = 0x60000000;
+static const uint32_t kLookups = 1 << 16;
+static const uint32_t kRounds = 256;
+
+static void makeLookups(uintptr_t* addrs, bool twoRegions)
+{
+    uint32_t seed = 12345;
+    uintptr_t span = kRegionPages * PageMap::kPageSize;
+    for (uint32_t i=0; i < kLookups; i++) {
+        seed = seed * 1103515245 + 12345;
+        uintptr_t offset = (seed >> 4) % span;
+        uintptr_t region = (twoRegions && (seed & 1)) ? kRegionGap : 0;
+        if ((seed & 6) == 0)
+            addrs[i] = kTestBase + region - span + offset;
+        else
+            addrs[i] = kTestBase + region + offset;
+    }
+}
+
+template<class PM>
+static void populateRegions(PM& pm, GCHeap* heap)
+{
+    for (uintptr_t region = 0; region <= kRegionGap; region += kRegionGap) {
+        char* item = (char*)(kTestBase + region);
+        for (uint32_t p=0; p < kRegionPages; p += 64) {
+            // 48 small-object blocks followed by a 16-block large object
+            pm.ExpandSetAll(heap, item + p * PageMap::kPageSize, 48, PageMap::kGCAllocPage);
+            pm.ExpandSetAll(heap, item + (p + 48) * PageMap::kPageSize, 1, PageMap::kGCLargeAllocPageFirst);
+            pm.ExpandSetAll(heap, item + (p + 49) * PageMap::kPageSize, 15, PageMap::kGCLargeAllocPageRest);
+        }
+    }
+}
+
+template<class PM>
+static uint32_t lookupAll(const PM& pm, const uintptr_t* addrs)
+{
+    uint32_t sum = 0;
+    for (uint32_t r=0; r < kRounds; r++)
+        for (uint32_t i=0; i < kLookups; i++)
+            sum += pm.AddrToVal(addrs[i]);
+    return sum;
+}
+
+class PageMapBenchmarkThread : public vmbase::Runnable
+{
+public:
+    PageMapBenchmarkThread(const PageMap::Radix* pm, const uintptr_t* addrs)
+        : pm(pm)
+        , addrs(addrs)
+        , sum(0)
+    {
+    }
+
+    virtual void run()
+    {
+        sum = lookupAll(*pm, addrs);
+    }
+
+    const PageMap::Radix* const pm;
+    const uintptr_t* const addrs;
+    uint32_t sum;
+};
+
+class ST_mmgc_pagemap : public Selftest {
+public:
+ST_mmgc_pagemap(AvmCore* core);
+virtual void run(int n);
+private:
+static const char* ST_names[];
+static const bool ST_explicits[];
+void test0();
+void test1();
+void test2();
+private:
+    uintptr_t* lookups[2];
+    uint32_t sums[2];
+
+    // Times the lookups of both workloads on a map of type PM and prints the rates.
+    // Returns false if the map did not produce the same results as the previous one.
+    template<class PM>
+    bool benchmark(const char* name)
+    {
+        GCHeap* heap = GCHeap::GetGCHeap();
+        PM* pm = mmfx_new(PM());
+        populateRegions(*pm, heap);
+        bool agrees = true;
+        core->console << "pagemap " << name << ":";
+        for (int w=0; w < 2; w++) {
+            uint64_t start = VMPI_getPerformanceCounter();
+            uint32_t sum = lookupAll(*pm, lookups[w]);
+            uint64_t ticks = VMPI_getPerformanceCounter() - start;
+            printRate(w == 0 ? " one region " : ", two regions ", ticks);
+            if (sums[w] != 0 && sums[w] != sum)
+                agrees = false;
+            sums[w] = sum;
+        }
+        core->console << "\n";
+        pm->DestroyPageMapVia(heap);
+        mmfx_delete(pm);
+        return agrees;
+    }
+
+    void printRate(const char* workload, uint64_t ticks)
+    {
+        double seconds = double(ticks) / double(VMPI_getPerformanceFrequency());
+        core->console << workload << double(kLookups) * kRounds / seconds / 1e6 << "M/s";
+    }
+
+};
+ST_mmgc_pagemap::ST_mmgc_pagemap(AvmCore* core)
+    : Selftest(core, "mmgc", "pagemap", ST_mmgc_pagemap::ST_names,ST_mmgc_pagemap::ST_explicits)
+{}
+const char* ST_mmgc_pagemap::ST_names[] = {"radix_set_clear","radix_concurrent_lookups","lookup_throughput", NULL };
+const bool ST_mmgc_pagemap::ST_explicits[] = {false,false,true, false };
+void ST_mmgc_pagemap::run(int n) {
+switch(n) {
+case 0: test0(); return;
+case 1: test1(); return;
+case 2: test2(); return;
+}
+}
+void ST_mmgc_pagemap::test0() {
+    GCHeap* heap = GCHeap::GetGCHeap();
+    PageMap::Radix pm;
+// line 238 "ST_mmgc_pagemap.st"
+verifyPass(pm.AddrToVal(kTestBase) == PageMap::kNonGC, "pm.AddrToVal(kTestBase) == PageMap::kNonGC", __FILE__, __LINE__);
+// line 239 "ST_mmgc_pagemap.st"
+verifyPass(!pm.AddrIsMappable(kTestBase), "!pm.AddrIsMappable(kTestBase)", __FILE__, __LINE__);
+    populate(pm, heap, kTestBase);
+// line 241 "ST_mmgc_pagemap.st"
+verifyPass(check(pm, kTestBase, true) == 0, "check(pm, kTestBase, true) == 0", __FILE__, __LINE__);
+// line 242 "ST_mmgc_pagemap.st"
+verifyPass(pm.MemStart() == kTestBase, "pm.MemStart() == kTestBase", __FILE__, __LINE__);
+// line 243 "ST_mmgc_pagemap.st"
+verifyPass(pm.AddrIsMappable(kTestBase + testRanges[numTestRanges - 1].offset), "pm.AddrIsMappable(kTestBase + testRanges[numTestRanges - 1].offset)", __FILE__, __LINE__);
+    clear(pm, kTestBase);
+// line 245 "ST_mmgc_pagemap.st"
+verifyPass(check(pm, kTestBase, false) == 0, "check(pm, kTestBase, false) == 0", __FILE__, __LINE__);
+    pm.DestroyPageMapVia(heap);
+
+}
+void ST_mmgc_pagemap::test1() {
+    // Reader threads look up pages whose mapping does not change, and pages that
+    // are being set and cleared, while this thread keeps adding to the map.
+    const uint32_t numReaders = 3;
+    const uint32_t numChurned = 256;
+    GCHeap* heap = GCHeap::GetGCHeap();
+    PageMap::Radix* pm = mmfx_new(PageMap::Radix());
+    populate(*pm, heap, kTestBase);
+
+    volatile int32_t stop = 0;
+    PageMapReader* readers[numReaders];
+    vmbase::VMThread* threads[numReaders];
+    bool started[numReaders];
+    for (uint32_t i=0; i < numReaders; i++) {
+        readers[i] = mmfx_new(PageMapReader(pm, numChurned, &stop));
+        threads[i] = mmfx_new(vmbase::VMThread(readers[i]));
+        started[i] = threads[i]->start();
+    }
+
+    for (uint32_t round=0; round < 4; round++) {
+        for (uint32_t i=0; i < numChurned; i++) {
+            char* item = (char*)(kTestBase + 0x60000000 + i * kChurnStride);
+            pm->ExpandSetAll(heap, item, 16, PageMap::kGCAllocPage);
+            pm->ClearAddrs(item + PageMap::kPageSize, 15);
+        }
+        for (uint32_t i=0; i < numChurned; i++)
+            pm->ClearAddrs((void*)(kTestBase + 0x60000000 + i * kChurnStride), 1);
+    }
+
+    VMPI_memoryBarrier();
+    stop = 1;
+    uint32_t errors = 0;
+    for (uint32_t i=0; i < numReaders; i++) {
+        if (started[i])
+            threads[i]->join();
+        errors += readers[i]->errors;
+        mmfx_delete(threads[i]);
+        mmfx_delete(readers[i]);
+    }
+// line 287 "ST_mmgc_pagemap.st"
+verifyPass(errors == 0, "errors == 0", __FILE__, __LINE__);
+// line 288 "ST_mmgc_pagemap.st"
+verifyPass(check(*pm, kTestBase, true) == 0, "check(*pm, kTestBase, true) == 0", __FILE__, __LINE__);
+    pm->DestroyPageMapVia(heap);
+    mmfx_delete(pm);
+
+}
+void ST_mmgc_pagemap::test2() {
+    // Prints the lookup rates of the tiered page maps compiled into this build,
+    // and the per-thread rate of Radix with four threads looking up at once.  Run with
+    // -Dselftest=mmgc,pagemap,lookup_throughput.
+    lookups[0] = mmfx_new_array(uintptr_t, kLookups);
+    lookups[1] = mmfx_new_array(uintptr_t, kLookups);
+    makeLookups(lookups[0], false);
+    makeLookups(lookups[1], true);
+    sums[0] = sums[1] = 0;
+
+    bool agrees = benchmark<PageMap::Radix>("Radix");
+#if defined MMGC_64BIT && !defined MMGC_USE_UNIFORM_PAGEMAP
+    agrees &= benchmark<PageMap::Tiered4>("Tiered4");
+    agrees &= benchmark<PageMap::CacheT4>("CacheT4");
+    agrees &= benchmark<PageMap::DelayT4>("DelayT4");
+#elif !defined MMGC_USE_UNIFORM_PAGEMAP
+    agrees &= benchmark<PageMap::Tiered2>("Tiered2");
+#endif
+// line 310 "ST_mmgc_pagemap.st"
+verifyPass(agrees, "agrees", __FILE__, __LINE__);
+
+    const uint32_t numThreads = 4;
+    GCHeap* heap = GCHeap::GetGCHeap();
+    PageMap::Radix* pm = mmfx_new(PageMap::Radix());
+    populateRegions(*pm, heap);
+    core->console << "pagemap Radix, " << numThreads << " threads:";
+    for (int w=0; w < 2; w++) {
+        PageMapBenchmarkThread* runners[numThreads];
+        vmbase::VMThread* threads[numThreads];
+        bool started[numThreads];
+        uint64_t start = VMPI_getPerformanceCounter();
+        for (uint32_t i=0; i < numThreads; i++) {
+            runners[i] = mmfx_new(PageMapBenchmarkThread(pm, lookups[w]));
+            threads[i] = mmfx_new(vmbase::VMThread(runners[i]));
+            started[i] = threads[i]->start();
+        }
+        uint32_t ran = 0;
+        for (uint32_t i=0; i < numThreads; i++) {
+            if (started[i]) {
+                threads[i]->join();
+                ran++;
+                agrees &= runners[i]->sum == sums[w];
+            }
+            mmfx_delete(threads[i]);
+            mmfx_delete(runners[i]);
+        }
+        uint64_t ticks = VMPI_getPerformanceCounter() - start;
+        agrees &= ran > 0;
+        printRate(w == 0 ? " one region " : ", two regions ", ticks);
+    }
+    core->console << " per thread\n";
+    pm->DestroyPageMapVia(heap);
+    mmfx_delete(pm);
+// line 344 "ST_mmgc_pagemap.st"
+verifyPass(agrees, "agrees", __FILE__, __LINE__);
+
+    mmfx_delete_array(lookups[0]);
+    mmfx_delete_array(lookups[1]);
+
+}
+void create_mmgc_pagemap(AvmCore* core) { new ST_mmgc_pagemap(core); }
+}
+}
+#endif
 // Generated from ST_mmgc_threads.st
 // -*- mode: c; c-basic-offset: 4; indent-tabs-mode: nil; tab-width: 4 -*-
 // vi: set ts=4 sw=4 expandtab: (add to ~/.vimrc: set modeline modelines=5) */
@@ -102,6 +102,9 @@ extern void create_mmgc_gcoption(AvmCore* core);
 namespace ST_mmgc_mmfx_array {
 extern void create_mmgc_mmfx_array(AvmCore* core);
 }
+namespace ST_mmgc_pagemap {
+extern void create_mmgc_pagemap(AvmCore* core);
+}
 #if defined VMCFG_WORKERTHREADS
 namespace ST_mmgc_threads {
 extern void create_mmgc_threads(AvmCore* core);
@@ -166,6 +169,7 @@ ST_mmgc_fixedmalloc_findbeginning::create_mmgc_fixedmalloc_findbeginning(core);
 ST_mmgc_gcheap::create_mmgc_gcheap(core);
 ST_mmgc_gcoption::create_mmgc_gcoption(core);
 ST_mmgc_mmfx_array::create_mmgc_mmfx_array(core);
+ST_mmgc_pagemap::create_mmgc_pagemap(core);
 #if defined VMCFG_WORKERTHREADS
 ST_mmgc_threads::create_mmgc_threads(core);
 #endif
@@ -7,29 +7,37 @@
 #define avmplus_AbcEnv_isExactInterlock 1
 #define avmplus_AbcFile_isExactInterlock 1
 #define avmplus_AbcInfo_isExactInterlock 1
+#define avmplus_ActivationMethodTablePair_isExactInterlock 1
 #define avmplus_ArgumentErrorClass_isExactInterlock 1
 #define avmplus_ArgumentErrorObject_isExactInterlock 1
 #define avmplus_ArrayClass_isExactInterlock 1
 #define avmplus_ArrayObject_isExactInterlock 1
 #define avmplus_AtomContainer_isExactInterlock 1
 #define avmplus_AttributeE4XNode_isExactInterlock 1
+#define avmplus_BaseExecMgr_isExactInterlock 1
 #define avmplus_BooleanClass_isExactInterlock 1
 #define avmplus_ByteArrayClass_isExactInterlock 1
 #define avmplus_ByteArrayObject_isExactInterlock 1
 #define avmplus_CDATAE4XNode_isExactInterlock 1
 #define avmplus_ClassClass_isExactInterlock 1
 #define avmplus_ClassClosure_isExactInterlock 1
+#define avmplus_ClassInfo_isExactInterlock 1
+#define avmplus_CodeContext_isExactInterlock 1
 #define avmplus_CommentE4XNode_isExactInterlock 1
+#define avmplus_CompiledRegExp_isExactInterlock 1
 #define avmplus_ConditionClass_isExactInterlock 1
 #define avmplus_ConditionObject_isExactInterlock 1
 #define avmplus_DateClass_isExactInterlock 1
 #define avmplus_DateObject_isExactInterlock 1
+#define avmplus_DebugFrame_isExactInterlock 1
+#define avmplus_DebugStackFrame_isExactInterlock 1
 #define avmplus_Debugger_isExactInterlock 1
 #define avmplus_DebuggerMethodInfo_isExactInterlock 1
 #define avmplus_DefinitionErrorClass_isExactInterlock 1
 #define avmplus_DefinitionErrorObject_isExactInterlock 1
 #define avmplus_DictionaryClass_isExactInterlock 1
 #define avmplus_DictionaryObject_isExactInterlock 1
+#define avmplus_DomainMgr_isExactInterlock 1
 #define avmplus_Domain_isExactInterlock 1
 #define avmplus_DomainEnv_isExactInterlock 1
 #define avmplus_DoubleVectorClass_isExactInterlock 1
@@ -45,6 +53,7 @@
 #define avmplus_EvalErrorObject_isExactInterlock 1
 #define avmplus_ExactGCTest_isExactInterlock 1
 #define avmplus_ExceptionHandlerTable_isExactInterlock 1
+#define avmplus_Exception_isExactInterlock 1
 #define avmplus_Float4Class_isExactInterlock 1
 #define avmplus_Float4VectorClass_isExactInterlock 1
 #define avmplus_Float4VectorObject_isExactInterlock 1
@@ -61,6 +70,7 @@
 #define avmplus_IntVectorClass_isExactInterlock 1
 #define avmplus_IntVectorObject_isExactInterlock 1
 #define avmplus_JSONClass_isExactInterlock 1
+#define avmplus_JitInterpRuleSet_isExactInterlock 1
 #define avmplus_LivePoolNode_isExactInterlock 1
 #define avmplus_MathClass_isExactInterlock 1
 #define avmplus_MethodClosure_isExactInterlock 1
@@ -2368,6 +2368,32 @@ bool AbcInfo::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 #endif // defined(DEBUGGER)
 
 
+#ifdef DEBUG
+const uint32_t MethodEnv::ActivationMethodTablePair::gcTracePointerOffsets[] = {
+    offsetof(MethodEnv::ActivationMethodTablePair, activation),
+    offsetof(MethodEnv::ActivationMethodTablePair, methodTable),
+    0};
+
+MMgc::GCTracerCheckResult MethodEnv::ActivationMethodTablePair::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,2);
+}
+#endif // DEBUG
+
+bool MethodEnv::ActivationMethodTablePair::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    gc->TraceLocation(&activation);
+    gc->TraceLocation(&methodTable);
+    return false;
+}
+
+
+
 #ifdef DEBUG
 MMgc::GCTracerCheckResult InlineHashtable::AtomContainer::gcTraceOffsetIsTraced(uint32_t off) const
 {
@@ -2425,6 +2451,56 @@ bool AttributeE4XNode::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 
 
 
+#ifdef DEBUG
+const uint32_t BaseExecMgr::gcTracePointerOffsets[] = {
+#if defined(VMCFG_COMPILEPOLICY)
+    offsetof(BaseExecMgr, _ruleSet),
+#endif
+#if defined(VMCFG_VERIFYALL)
+    offsetof(BaseExecMgr, verifyFunctionQueue),
+#endif
+#if defined(VMCFG_VERIFYALL)
+    offsetof(BaseExecMgr, verifyTraitsQueue),
+#endif
+    0};
+
+MMgc::GCTracerCheckResult BaseExecMgr::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+#if defined(VMCFG_VERIFYALL)
+    if((result = verifyFunctionQueue.gcTraceOffsetIsTraced(off - offsetof(BaseExecMgr,verifyFunctionQueue))) != MMgc::kOffsetNotFound) {
+        return result;
+    }
+#endif
+#if defined(VMCFG_VERIFYALL)
+    if((result = verifyTraitsQueue.gcTraceOffsetIsTraced(off - offsetof(BaseExecMgr,verifyTraitsQueue))) != MMgc::kOffsetNotFound) {
+        return result;
+    }
+#endif
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,3);
+}
+#endif // DEBUG
+
+bool BaseExecMgr::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+#if defined(VMCFG_COMPILEPOLICY)
+    gc->TraceLocation(&_ruleSet);
+#endif
+#if defined(VMCFG_VERIFYALL)
+    verifyFunctionQueue.gcTrace(gc);
+#endif
+#if defined(VMCFG_VERIFYALL)
+    verifyTraitsQueue.gcTrace(gc);
+#endif
+    return false;
+}
+
+
+
 #ifdef DEBUG
 const uint32_t CDATAE4XNode::gcTracePointerOffsets[] = {
     offsetof(CDATAE4XNode, m_value),
@@ -2453,6 +2529,67 @@ bool CDATAE4XNode::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 
 
 
+#ifdef DEBUG
+const uint32_t ClassInfo::gcTracePointerOffsets[] = {
+    offsetof(ClassInfo, m_closure),
+    offsetof(ClassInfo, m_name),
+    offsetof(ClassInfo, m_sealed),
+    offsetof(ClassInfo, m_toplevel),
+    offsetof(ClassInfo, m_traits),
+    0};
+
+MMgc::GCTracerCheckResult ClassInfo::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = m_sealed.gcTraceOffsetIsTraced(off - offsetof(ClassInfo,m_sealed))) != MMgc::kOffsetNotFound) {
+        return result;
+    }
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,5);
+}
+#endif // DEBUG
+
+bool ClassInfo::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    gc->TraceLocation(&m_closure);
+    gc->TraceLocation(&m_name);
+    m_sealed.gcTrace(gc);
+    gc->TraceLocation(&m_toplevel);
+    gc->TraceLocation(&m_traits);
+    return false;
+}
+
+
+
+#ifdef DEBUG
+const uint32_t CodeContext::gcTracePointerOffsets[] = {
+    offsetof(CodeContext, m_bugCompatibility),
+    offsetof(CodeContext, m_domainEnv),
+    0};
+
+MMgc::GCTracerCheckResult CodeContext::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,2);
+}
+#endif // DEBUG
+
+bool CodeContext::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    gc->TraceLocation(&m_bugCompatibility);
+    gc->TraceLocation(&m_domainEnv);
+    return false;
+}
+
+
+
 #ifdef DEBUG
 const uint32_t CommentE4XNode::gcTracePointerOffsets[] = {
     offsetof(CommentE4XNode, m_value),
@@ -2480,6 +2617,78 @@ bool CommentE4XNode::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 }
 
 
+
+#ifdef DEBUG
+MMgc::GCTracerCheckResult CompiledRegExp::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool CompiledRegExp::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+
+    return false;
+}
+
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+MMgc::GCTracerCheckResult DebugFrame::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool DebugFrame::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t DebugStackFrame::gcTracePointerOffsets[] = {
+    offsetof(DebugStackFrame, debugger),
+    0};
+
+MMgc::GCTracerCheckResult DebugStackFrame::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = DebugFrame::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,1);
+}
+#endif // DEBUG
+
+bool DebugStackFrame::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    DebugFrame::gcTrace(gc, 0);
+    (void)(avmplus_DebugFrame_isExactInterlock != 0);
+    gc->TraceLocation(&debugger);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
 #if defined(DEBUGGER)
 
 #ifdef DEBUG
@@ -2603,6 +2812,26 @@ bool DomainEnv::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 
 
 
+#ifdef DEBUG
+MMgc::GCTracerCheckResult DomainMgr::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool DomainMgr::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+
+    return false;
+}
+
+
+
 #ifdef DEBUG
 const uint32_t E4XNode::gcTracePointerOffsets[] = {
     offsetof(E4XNode, m_nameOrAux),
@@ -2775,6 +3004,36 @@ bool ExactGCTest::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 #endif // defined(DEBUG)
 
 
+#ifdef DEBUG
+const uint32_t Exception::gcTracePointerOffsets[] = {
+    offsetof(Exception, atom),
+#if defined(DEBUGGER)
+    offsetof(Exception, stackTrace),
+#endif
+    0};
+
+MMgc::GCTracerCheckResult Exception::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,2);
+}
+#endif // DEBUG
+
+bool Exception::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    gc->TraceAtom(&atom);
+#if defined(DEBUGGER)
+    gc->TraceLocation(&stackTrace);
+#endif
+    return false;
+}
+
+
+
 #ifdef DEBUG
 MMgc::GCTracerCheckResult ExceptionHandlerTable::gcTraceOffsetIsTraced(uint32_t off) const
 {
@@ -2910,6 +3169,28 @@ bool InlineHashtable::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 }
 
 
+#if defined(VMCFG_COMPILEPOLICY)
+
+#ifdef DEBUG
+MMgc::GCTracerCheckResult BaseExecMgr::JitInterpRuleSet::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool BaseExecMgr::JitInterpRuleSet::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+
+    return false;
+}
+
+#endif // defined(VMCFG_COMPILEPOLICY)
+
 
 #ifdef DEBUG
 const uint32_t LivePoolNode::gcTracePointerOffsets[] = {
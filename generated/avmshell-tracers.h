@@ -8,9 +8,14 @@
 #define avmshell_AbstractBaseObject_isExactInterlock 1
 #define avmshell_AbstractRestrictedBaseClass_isExactInterlock 1
 #define avmshell_AbstractRestrictedBaseObject_isExactInterlock 1
+#define avmshell_ArgumentValue_isExactInterlock 1
+#define avmshell_BreakAction_isExactInterlock 1
 #define avmshell_CheckBaseClass_isExactInterlock 1
 #define avmshell_CheckBaseObject_isExactInterlock 1
+#define avmshell_ConstantValue_isExactInterlock 1
 #define avmshell_DebugCLI_isExactInterlock 1
+#define avmshell_IValue_isExactInterlock 1
+#define avmshell_LocalValue_isExactInterlock 1
 #define avmshell_NativeBaseClass_isExactInterlock 1
 #define avmshell_NativeBaseObject_isExactInterlock 1
 #define avmshell_NativeSubclassOfAbstractBaseClass_isExactInterlock 1
@@ -19,8 +24,10 @@
 #define avmshell_NativeSubclassOfAbstractRestrictedBaseObject_isExactInterlock 1
 #define avmshell_NativeSubclassOfRestrictedBaseClass_isExactInterlock 1
 #define avmshell_NativeSubclassOfRestrictedBaseObject_isExactInterlock 1
+#define avmshell_PropertyValue_isExactInterlock 1
 #define avmshell_RestrictedBaseClass_isExactInterlock 1
 #define avmshell_RestrictedBaseObject_isExactInterlock 1
+#define avmshell_ShellCodeContext_isExactInterlock 1
 #define avmshell_ShellToplevel_isExactInterlock 1
 #define avmshell_SystemClass_isExactInterlock 1
 
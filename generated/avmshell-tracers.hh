@@ -448,6 +448,98 @@ bool SystemClass::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 }
 
 
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t ArgumentValue::gcTracePointerOffsets[] = {
+    offsetof(ArgumentValue, frame),
+    0};
+
+MMgc::GCTracerCheckResult ArgumentValue::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = IValue::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,1);
+}
+#endif // DEBUG
+
+bool ArgumentValue::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    IValue::gcTrace(gc, 0);
+    (void)(avmshell_IValue_isExactInterlock != 0);
+    gc->TraceLocation(&frame);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t BreakAction::gcTracePointerOffsets[] = {
+    offsetof(BreakAction, filename),
+    offsetof(BreakAction, next),
+    offsetof(BreakAction, prev),
+    offsetof(BreakAction, sourceFile),
+    0};
+
+MMgc::GCTracerCheckResult BreakAction::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,4);
+}
+#endif // DEBUG
+
+bool BreakAction::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    gc->TraceLocation(&filename);
+    gc->TraceLocation(&next);
+    gc->TraceLocation(&prev);
+    gc->TraceLocation(&sourceFile);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t ConstantValue::gcTracePointerOffsets[] = {
+    offsetof(ConstantValue, value),
+    0};
+
+MMgc::GCTracerCheckResult ConstantValue::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = IValue::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,1);
+}
+#endif // DEBUG
+
+bool ConstantValue::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    IValue::gcTrace(gc, 0);
+    (void)(avmshell_IValue_isExactInterlock != 0);
+    gc->TraceAtom(&value);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
 #if defined(DEBUGGER)
 
 #ifdef DEBUG
@@ -482,6 +574,116 @@ bool DebugCLI::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
 
 #endif // defined(DEBUGGER)
 
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+MMgc::GCTracerCheckResult IValue::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool IValue::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t LocalValue::gcTracePointerOffsets[] = {
+    offsetof(LocalValue, frame),
+    0};
+
+MMgc::GCTracerCheckResult LocalValue::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = IValue::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,1);
+}
+#endif // DEBUG
+
+bool LocalValue::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    IValue::gcTrace(gc, 0);
+    (void)(avmshell_IValue_isExactInterlock != 0);
+    gc->TraceLocation(&frame);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+#if defined(DEBUGGER)
+
+#ifdef DEBUG
+const uint32_t PropertyValue::gcTracePointerOffsets[] = {
+    offsetof(PropertyValue, parent),
+    offsetof(PropertyValue, propertyname),
+    0};
+
+MMgc::GCTracerCheckResult PropertyValue::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = propertyname.gcTraceOffsetIsTraced(off - offsetof(PropertyValue,propertyname))) != MMgc::kOffsetNotFound) {
+        return result;
+    }
+    if((result = IValue::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::GC::CheckOffsetIsInList(off,gcTracePointerOffsets,2);
+}
+#endif // DEBUG
+
+bool PropertyValue::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    IValue::gcTrace(gc, 0);
+    (void)(avmshell_IValue_isExactInterlock != 0);
+    gc->TraceLocation(&parent);
+    propertyname.gcTrace(gc);
+    return false;
+}
+
+#endif // defined(DEBUGGER)
+
+
+#ifdef DEBUG
+MMgc::GCTracerCheckResult ShellCodeContext::gcTraceOffsetIsTraced(uint32_t off) const
+{
+    MMgc::GCTracerCheckResult result;
+    (void)off;
+    (void)result;
+    if((result = avmplus::CodeContext::gcTraceOffsetIsTraced(off)) != MMgc::kOffsetNotFound)
+        return result;
+    return MMgc::kOffsetNotFound;
+}
+#endif // DEBUG
+
+bool ShellCodeContext::gcTrace(MMgc::GC* gc, size_t _xact_cursor)
+{
+    (void)gc;
+    (void)_xact_cursor;
+    avmplus::CodeContext::gcTrace(gc, 0);
+    (void)(avmplus_CodeContext_isExactInterlock != 0);
+    return false;
+}
+
+
 
 #ifdef DEBUG
 const uint32_t ShellToplevel::gcTracePointerOffsets[] = {
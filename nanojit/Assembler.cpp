@@ -173,6 +173,7 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
     #ifdef VMCFG_VTUNE
         , vtuneHandle(NULL)
     #endif
+        , _frameSize(0)
         , _mdWriter(mdWriter)
         , _config(config)
     {
@@ -1059,6 +1060,7 @@ typedef void* (*decode_instructions_ftype) (void* start, void* end,
         if (error()) return;
 
         _epilogue = NULL;
+        _frameSize = 0;
         verbose_only( _nInsAfter = _nIns; )
 
         nBeginAssembly();
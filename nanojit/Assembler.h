@@ -343,6 +343,16 @@ namespace nanojit
              */
             int32_t    forceStackIndex(LIns* ins);
 
+            /**
+             * The activation record as of the instruction being assembled, and
+             * the number of bytes genPrologue() allocated below the saved frame
+             * pointer.  Used by MetaDataWriters that describe the native frame
+             * at safepoints.  frameSize() is 0 until genPrologue() has run, and
+             * stays 0 on backends that do not record it.
+             */
+            const AR&   activation() const  { return _activation; }
+            uint32_t    frameSize() const   { return _frameSize; }
+
         private:
             void        gen(LirFilter* toCompile);
             NIns*       genPrologue();
@@ -450,6 +460,7 @@ namespace nanojit
 
             AR          _activation;
             RegAlloc    _allocator;
+            uint32_t    _frameSize;     // set by genPrologue() on backends that report it
 
             MetaDataWriter* _mdWriter;
 
@@ -2469,6 +2469,7 @@ namespace nanojit
             sizeof(void*); // ebp
         uint32_t aligned = alignUp(stackNeeded + stackPushed, NJ_ALIGN_STACK);
         uint32_t amt = aligned - stackPushed;
+        _frameSize = amt;
 
 #ifdef _WIN64
         // Windows uses a single guard page for extending the stack, so
@@ -2623,6 +2624,7 @@ namespace nanojit
             // we're pedantic, but not *that* pedantic.
             pedanticTop = _nIns - br_size;
             JMP(pc);
+            if (_mdWriter) _mdWriter->setNativePc((uint8_t*)pc);
             pedanticTop = _nIns - bytes;
         }
     #else
@@ -2633,6 +2635,7 @@ namespace nanojit
             // This jump will call underrunProtect again, but since we're on a new
             // page, nothing will happen.
             JMP(pc);
+            if (_mdWriter) _mdWriter->setNativePc((uint8_t*)pc);
         }
     #endif
     }
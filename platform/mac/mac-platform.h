@@ -132,6 +132,8 @@ typedef pthread_t vmpi_thread_t;
 // Bug 569361.  See notes for NO_INLINE in VMPI.h
 #  define NO_INLINE __attribute__((noinline))
 
+#  define VMPI_prefetch(addr) __builtin_prefetch((const void*)(addr))
+
 // only define FASTCALL for x86-32; other gcc versions will spew warnings
 #  ifdef AVMPLUS_IA32
 #    ifndef VMCFG_AOT // Doesn't work with llvm compiler (need a better symbol for this, but don't know one)
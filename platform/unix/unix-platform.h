@@ -133,6 +133,8 @@ typedef void *maddr_ptr;
 // Bug 569361.  See notes for NO_INLINE in VMPI.h
 #define NO_INLINE __attribute__((noinline))
 
+#define VMPI_prefetch(addr) __builtin_prefetch((const void*)(addr))
+
 // only define FASTCALL for x86-32; other gcc versions will spew warnings
 #ifdef AVMPLUS_IA32
     #define FASTCALL __attribute__((fastcall))
@@ -190,6 +190,7 @@ typedef void *maddr_ptr;
   #endif
   #ifndef _ARM_
   #include <emmintrin.h>
+  #define VMPI_prefetch(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
   #endif
   #ifdef VMCFG_VTUNE
     #include "JITProfiling.h"
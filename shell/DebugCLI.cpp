@@ -392,7 +392,7 @@ namespace avmshell
                           << filename
                           << ", " << (targetLine) << ".\n";
 
-            BreakAction *breakAction = new (core->GetGC()) BreakAction(sourceFile,
+            BreakAction *breakAction = new (core->GetGC(), MMgc::kExact) BreakAction(sourceFile,
                                                                   breakpointId,
                                                                   filename,
                                                                   targetLine);
@@ -584,26 +584,26 @@ namespace avmshell
 
         avmplus::Stringp namestr = core->internStringLatin1(name, -1);
         if (VMPI_strcmp(name, "this") == 0)
-            return new (core->gc) ConstantValue(thisAtom);
+            return new (core->gc, MMgc::kExact) ConstantValue(thisAtom);
         if (VMPI_strcmp(name, "NaN") == 0)
-            return new (core->gc) ConstantValue(core->kNaN);
+            return new (core->gc, MMgc::kExact) ConstantValue(core->kNaN);
         if (namestr == core->kfalse)
-            return new (core->gc) ConstantValue(falseAtom);
+            return new (core->gc, MMgc::kExact) ConstantValue(falseAtom);
         if (namestr == core->ktrue)
-            return new (core->gc) ConstantValue(trueAtom);
+            return new (core->gc, MMgc::kExact) ConstantValue(trueAtom);
         if (namestr == core->knull)
-            return new (core->gc) ConstantValue(nullObjectAtom);
+            return new (core->gc, MMgc::kExact) ConstantValue(nullObjectAtom);
         if (namestr == core->kundefined)
-            return new (core->gc) ConstantValue(undefinedAtom);
+            return new (core->gc, MMgc::kExact) ConstantValue(undefinedAtom);
         if (name[0] == '-' || VMPI_isdigit(name[0]))
-            return new (core->gc) ConstantValue(core->numberAtom(namestr->atom()));
+            return new (core->gc, MMgc::kExact) ConstantValue(core->numberAtom(namestr->atom()));
         if (name[0] == '\'' || name[0] == '"') // String literal
         {
             int32_t length = namestr->length();
             if (length >= 2 && namestr->charAt(length-1) == namestr->charAt(0))
             {
                 // Note, this doesn't do any escaping
-                return new (core->gc) ConstantValue(namestr->substr(1, length-2)->atom());
+                return new (core->gc, MMgc::kExact) ConstantValue(namestr->substr(1, length-2)->atom());
             }
         }
         if (name[0] == '<') // XML or XMLList literal
@@ -612,9 +612,9 @@ namespace avmshell
             {
                 avmplus::Toplevel* toplevel = avmplus::AvmCore::atomToScriptObject(thisAtom)->toplevel();
                 if (name[1] == '>')
-                    return new (core->gc) ConstantValue(toplevel->xmlListClass()->ToXMLList(namestr->atom()));
+                    return new (core->gc, MMgc::kExact) ConstantValue(toplevel->xmlListClass()->ToXMLList(namestr->atom()));
                 else
-                    return new (core->gc) ConstantValue(toplevel->xmlClass()->ToXML(namestr->atom()));
+                    return new (core->gc, MMgc::kExact) ConstantValue(toplevel->xmlClass()->ToXML(namestr->atom()));
             }
         }
 
@@ -637,7 +637,7 @@ namespace avmshell
                     if (arg->equalsLatin1(name))
                     {
                         // match!
-                        return new (core->gc) ArgumentValue(frame, i);
+                        return new (core->gc, MMgc::kExact) ArgumentValue(frame, i);
                     }
                 }
 
@@ -649,7 +649,7 @@ namespace avmshell
                     if ( local->equalsLatin1(name))
                     {
                         // match!
-                        return new (core->gc) LocalValue(frame, i);
+                        return new (core->gc, MMgc::kExact) LocalValue(frame, i);
                     }
                 }
             }
@@ -687,7 +687,7 @@ namespace avmshell
                 avmplus::ScriptObject* global = script->global;
                 if (global)
                 {
-                    return new (core->gc) PropertyValue(global, mn);
+                    return new (core->gc, MMgc::kExact) PropertyValue(global, mn);
                 }
         }
     }
@@ -760,7 +760,7 @@ namespace avmshell
                             // that's the correct behavior.
                             avmplus::Multiname mn(core->getAnyPublicNamespace(),
                                          core->internStringLatin1(name));
-                            value = new (core->gc) PropertyValue(avmplus::AvmCore::atomToScriptObject(parent), mn);
+                            value = new (core->gc, MMgc::kExact) PropertyValue(avmplus::AvmCore::atomToScriptObject(parent), mn);
                         }
                         else
                         {
@@ -1055,7 +1055,7 @@ namespace avmshell
     {
         if (key->getName()->equalsLatin1(propertyname))
         {
-            value = new (core->gc) PropertyValue(object, *key);
+            value = new (core->gc, MMgc::kExact) PropertyValue(object, *key);
             return false; // stop iterating
         }
 
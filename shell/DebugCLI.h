@@ -13,9 +13,11 @@ namespace avmshell
     /**
      * Represents a single breakpoint in the Debugger.
      */
-    class BreakAction : public MMgc::GCObject
+    class GC_CPP_EXACT(BreakAction, MMgc::GCTraceableObject)
     {
     public:
+        GC_DATA_BEGIN(BreakAction)
+
         GCMember<BreakAction> prev;
         GCMember<BreakAction> next;
         GCMember<avmplus::SourceFile> sourceFile;
@@ -23,6 +25,8 @@ namespace avmshell
         GCMember<avmplus::String> filename;
         int linenum;
 
+        GC_DATA_END(BreakAction)
+
         BreakAction(avmplus::SourceFile *sourceFile,
                     int id,
                     avmplus::Stringp filename,
@@ -40,7 +44,7 @@ namespace avmshell
     /**
      * This can be either an l-value or an r-value.
      */
-    class IValue : public MMgc::GCFinalizedObject
+    class GC_CPP_EXACT(IValue, MMgc::GCFinalizedObject)
     {
     public:
         virtual ~IValue() {}
@@ -48,9 +52,11 @@ namespace avmshell
         virtual bool isLValue() = 0;
         virtual avmplus::Atom get() = 0;
         virtual void set(avmplus::Atom newValue) = 0;
+
+        GC_NO_DATA(IValue)
     };
 
-    class ConstantValue: public IValue
+    class GC_CPP_EXACT(ConstantValue, IValue)
     {
     public:
         ConstantValue(avmplus::Atom value) : value(value) { }
@@ -59,14 +65,18 @@ namespace avmshell
         virtual avmplus::Atom get() { return value; }
         virtual void set(avmplus::Atom /*newValue*/) { AvmAssert(false); }
 
+        GC_DATA_BEGIN(ConstantValue)
+
     private:
-        avmplus::AtomWB value;
+        avmplus::AtomWB GC_ATOM(value);
+
+        GC_DATA_END(ConstantValue)
     };
 
     /**
      * An IValue representing a local variable.
      */
-    class LocalValue: public IValue
+    class GC_CPP_EXACT(LocalValue, IValue)
     {
     public:
         LocalValue(avmplus::DebugFrame* frame, int index) : frame(frame), index(index) { }
@@ -84,15 +94,19 @@ namespace avmshell
             frame->setLocal(index, newValue);
         }
 
+        GC_DATA_BEGIN(LocalValue)
+
     private:
         GCMember<avmplus::DebugFrame> frame;
         int index;
+
+        GC_DATA_END(LocalValue)
     };
 
     /**
      * An IValue representing an argument to a function.
      */
-    class ArgumentValue: public IValue
+    class GC_CPP_EXACT(ArgumentValue, IValue)
     {
     public:
         ArgumentValue(avmplus::DebugFrame* frame, int index) : frame(frame), index(index) { }
@@ -110,15 +124,19 @@ namespace avmshell
             frame->setArgument(index, newValue);
         }
 
+        GC_DATA_BEGIN(ArgumentValue)
+
     private:
         GCMember<avmplus::DebugFrame> frame;
         int index;
+
+        GC_DATA_END(ArgumentValue)
     };
 
     /**
      * An IValue representing a property of an object.
      */
-    class PropertyValue: public IValue
+    class GC_CPP_EXACT(PropertyValue, IValue)
     {
     public:
         PropertyValue(avmplus::ScriptObject* parent, avmplus::Multiname& propertyname)
@@ -134,9 +152,13 @@ namespace avmshell
             parent->toplevel()->setproperty(parent->atom(), propertyname, newValue, parent->vtable);
         }
 
+        GC_DATA_BEGIN(PropertyValue)
+
     private:
         GCMember<avmplus::ScriptObject> parent;
-        avmplus::HeapMultiname propertyname;
+        avmplus::HeapMultiname GC_STRUCTURE(propertyname);
+
+        GC_DATA_END(PropertyValue)
     };
 
     /**
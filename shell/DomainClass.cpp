@@ -82,7 +82,7 @@ namespace avmplus
         }
 done:
 
-        ShellCodeContext* codeContext = new (core->GetGC()) ShellCodeContext(domainEnv, bugCompatibility);
+        ShellCodeContext* codeContext = new (core->GetGC(), MMgc::kExact) ShellCodeContext(domainEnv, bugCompatibility);
         return core->handleActionPool(pool, toplevel, codeContext);
     }
 
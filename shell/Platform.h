@@ -116,6 +116,17 @@ namespace avmshell
         * @return none
         */
         virtual void setTimer(int seconds, AvmTimerCallback callback, void* callbackData) = 0;
+
+        /**
+        * Method to have a callback invoked whenever the user asks for a heap snapshot from
+        * outside the process (on Unix systems, by sending SIGUSR2).  The callback runs
+        * asynchronously and may only set a flag.  Platforms without such a mechanism
+        * ignore the request.
+        * @param callback function to invoke, or NULL to stop listening
+        * @param callbackData context data that will be passed as an argument during "callback" invocation
+        * @return none
+        */
+        virtual void setHeapSnapshotSignal(AvmTimerCallback /*callback*/, void* /*callbackData*/) {}
     };
 }
 
@@ -92,7 +92,7 @@ namespace avmshell
 
         avmplus::Stringp errorMessage = getErrorMessage(kStackOverflowError);
         GCRef<avmplus::ErrorObject> error = toplevel->errorClass()->constructObject(errorMessage->atom(), this->intToAtom(0));
-        avmplus::Exception *exception = new (GetGC()) avmplus::Exception(this, error->atom());
+        avmplus::Exception *exception = new (GetGC(), MMgc::kExact) avmplus::Exception(this, error->atom());
 
         // Restore stack overflow checks
         inStackOverflow = false;
@@ -115,7 +115,7 @@ namespace avmshell
             // Throw an exception it cannot catch.
             avmplus::Stringp errorMessage = getErrorMessage(kScriptTerminatedError);
             GCRef<avmplus::ErrorObject> error = toplevel->errorClass()->constructObject(errorMessage->atom(), this->intToAtom(0));
-            avmplus::Exception *exception = new (GetGC()) avmplus::Exception(this, error->atom());
+            avmplus::Exception *exception = new (GetGC(), MMgc::kExact) avmplus::Exception(this, error->atom());
             exception->flags |= avmplus::Exception::EXIT_EXCEPTION;
             throwException(exception);
         }
@@ -159,7 +159,7 @@ namespace avmshell
 
             virtual avmplus::CodeContext* create(avmplus::DomainEnv* domainEnv, const avmplus::BugCompatibility* bugCompatibility)
             {
-                return new (gc) ShellCodeContext(domainEnv, bugCompatibility);
+                return new (gc, MMgc::kExact) ShellCodeContext(domainEnv, bugCompatibility);
             }
         };
 
@@ -177,7 +177,7 @@ namespace avmshell
         // Initialize the shell builtins in the new Toplevel
         // use the same bugCompatibility that the base builtins use
         const avmplus::BugCompatibility* shell_bugCompatibility = shell_toplevel->abcEnv()->codeContext()->bugCompatibility();
-        ShellCodeContext* shell_codeContext = new(GetGC()) ShellCodeContext(shell_domainEnv, shell_bugCompatibility);
+        ShellCodeContext* shell_codeContext = new (GetGC(), MMgc::kExact) ShellCodeContext(shell_domainEnv, shell_bugCompatibility);
 
         //handleActionPool(shellPool, shell_toplevel, shell_codeContext);
         shell_toplevel->shellClasses = prepareBuiltinActionPool<avmplus::shell_toplevelClassManifest>(shellPool, shell_toplevel, shell_codeContext);
@@ -435,7 +435,7 @@ namespace avmshell
             avmplus::Domain* user_domain = avmplus::Domain::newDomain(this, shell_domain);
             avmplus::DomainEnv* user_domainEnv = avmplus::DomainEnv::newDomainEnv(this, user_domain, shell_domainEnv);
             const avmplus::BugCompatibility* user_bugCompatibility = createBugCompatibility(defaultBugCompatibilityVersion);
-            this->user_codeContext = new (GetGC()) ShellCodeContext(user_domainEnv, user_bugCompatibility);
+            this->user_codeContext = new (GetGC(), MMgc::kExact) ShellCodeContext(user_domainEnv, user_bugCompatibility);
 
 #ifdef AVMPLUS_VERBOSE
             config.verbose_vb = settings.do_verbose;  // builtins is done, so propagate verbose
@@ -87,11 +87,13 @@ namespace avmshell
         }
     };
 
-    class ShellCodeContext : public avmplus::CodeContext
+    class GC_CPP_EXACT(ShellCodeContext, avmplus::CodeContext)
     {
     public:
         inline ShellCodeContext(avmplus::DomainEnv* env, const avmplus::BugCompatibility* bugCompatibility)
             : avmplus::CodeContext(env, bugCompatibility) { }
+
+        GC_NO_DATA(ShellCodeContext)
     };
 
     /**
@@ -36,6 +36,15 @@ namespace avmshell
         , numworkers(1)
         , repeats(1)
         , stackSize(0)
+#ifdef MMGC_EVENT_STREAM
+        , gcEventsFile(NULL)
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+        , gcSnapshotFile(NULL)
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        , allocProfileFile(NULL)
+#endif
     {
     }
 
@@ -83,6 +92,120 @@ namespace avmshell
         AvmCore::setStackLimit(minstack);
     }
 
+#ifdef MMGC_EVENT_STREAM
+    /**
+     * Writes the GC event stream to a file, one record per line (-gcevents).
+     */
+    class GCEventFileWriter : public MMgc::GCEventWriter
+    {
+    public:
+        GCEventFileWriter(File* file) : file(file) {}
+
+        virtual void write(const char* record)
+        {
+            file->write(record, VMPI_strlen(record));
+            file->write("\n", 1);
+        }
+
+    private:
+        File* file;
+    };
+#endif
+
+#ifdef MMGC_HEAP_SNAPSHOT
+    /**
+     * Writes heap snapshots to files (-gcsnapshot F).  Snapshots requested by signal
+     * go to F.1, F.2, and so on; the one taken when the program ends goes to F.
+     */
+    class GCHeapSnapshotFileWriter : public MMgc::GCHeapSnapshotWriter
+    {
+    public:
+        GCHeapSnapshotFileWriter(const char* basename) : basename(basename), file(NULL), sequence(0), final(false) {}
+
+        void setFinal() { final = true; }
+
+        virtual bool begin()
+        {
+            char name[1024];
+            if (final)
+                VMPI_snprintf(name, sizeof(name), "%s", basename);
+            else
+                VMPI_snprintf(name, sizeof(name), "%s.%d", basename, ++sequence);
+            file = Platform::GetInstance()->createFile();
+            if (file == NULL || !file->open(name, File::OPEN_WRITE_BINARY)) {
+                avmplus::AvmLog("Could not open %s for writing\n", name);
+                if (file != NULL)
+                    Platform::GetInstance()->destroyFile(file);
+                file = NULL;
+                return false;
+            }
+            return true;
+        }
+
+        virtual void write(const void* bytes, size_t nbytes)
+        {
+            file->write(bytes, nbytes);
+        }
+
+        virtual void end()
+        {
+            file->close();
+            Platform::GetInstance()->destroyFile(file);
+            file = NULL;
+        }
+
+        static void requestSnapshot(void* gc)
+        {
+            ((MMgc::GC*)gc)->RequestHeapSnapshot();
+        }
+
+    private:
+        const char* const basename;
+        File* file;
+        int sequence;
+        bool final;
+    };
+#endif
+
+#ifdef MMGC_ALLOCATION_SAMPLER
+    /**
+     * Writes the allocation profiles to F.alloc and F.live (-allocprofile F).
+     */
+    class GCAllocationProfileFileWriter : public MMgc::GCAllocationProfileWriter
+    {
+    public:
+        GCAllocationProfileFileWriter() : file(NULL) {}
+
+        static void writeProfiles(MMgc::GC* gc, const char* basename)
+        {
+            static const char* const suffixes[] = { "alloc", "live" };
+            for (int i=0; i < 2; i++) {
+                char name[1024];
+                VMPI_snprintf(name, sizeof(name), "%s.%s", basename, suffixes[i]);
+                GCAllocationProfileFileWriter writer;
+                writer.file = Platform::GetInstance()->createFile();
+                if (writer.file == NULL || !writer.file->open(name, File::OPEN_WRITE)) {
+                    avmplus::AvmLog("Could not open %s for writing\n", name);
+                    if (writer.file != NULL)
+                        Platform::GetInstance()->destroyFile(writer.file);
+                    return;
+                }
+                gc->WriteAllocationProfile(&writer, i == 1);
+                writer.file->close();
+                Platform::GetInstance()->destroyFile(writer.file);
+            }
+        }
+
+        virtual void write(const char* line)
+        {
+            file->write(line, VMPI_strlen(line));
+        }
+
+    private:
+        File* file;
+    };
+#endif
+
     /* static */
     int Shell::run(int argc, char *argv[])
     {
@@ -109,6 +232,20 @@ namespace avmshell
             if (instance->settings.do_log)
               initializeLogging(instance->settings.numfiles > 0 ? instance->settings.filenames[0] : "AVMLOG");
 
+#ifdef MMGC_EVENT_STREAM
+            File* eventsFile = NULL;
+            GCEventFileWriter* eventsWriter = NULL;
+            if (instance->settings.gcEventsFile != NULL) {
+                eventsFile = Platform::GetInstance()->createFile();
+                if (eventsFile == NULL || !eventsFile->open(instance->settings.gcEventsFile, File::OPEN_WRITE)) {
+                    avmplus::AvmLog("Could not open %s for writing\n", instance->settings.gcEventsFile);
+                    Platform::GetInstance()->exit(1);
+                }
+                eventsWriter = mmfx_new(GCEventFileWriter(eventsFile));
+                MMgc::GCHeap::GetGCHeap()->SetEventWriter(eventsWriter);
+            }
+#endif
+
 #ifdef VMCFG_WORKERTHREADS
             if (instance->settings.numworkers == 1 && instance->settings.numthreads == 1 && instance->settings.repeats == 1) 
             {
@@ -128,6 +265,14 @@ namespace avmshell
 			isolate->run();
 #endif
             instance->waitUntilNoIsolates();
+#ifdef MMGC_EVENT_STREAM
+            if (eventsWriter != NULL) {
+                MMgc::GCHeap::GetGCHeap()->SetEventWriter(NULL);
+                mmfx_delete(eventsWriter);
+                eventsFile->close();
+                Platform::GetInstance()->destroyFile(eventsFile);
+            }
+#endif
             // Shell is refcounted now
             //mmfx_delete(instance);
         }
@@ -319,6 +464,15 @@ namespace avmshell
         if (settings.do_testSWFHasAS3 && settings.numfiles != 1)
             Platform::GetInstance()->exit(1);
 
+#ifdef MMGC_HEAP_SNAPSHOT
+        GCHeapSnapshotFileWriter* snapshotWriter = NULL;
+        if (settings.gcSnapshotFile != NULL) {
+            snapshotWriter = mmfx_new(GCHeapSnapshotFileWriter(settings.gcSnapshotFile));
+            gc->SetHeapSnapshotWriter(snapshotWriter);
+            Platform::GetInstance()->setHeapSnapshotSignal(GCHeapSnapshotFileWriter::requestSnapshot, gc);
+        }
+#endif
+
         // execute each abc file
         for (int i=0 ; i < settings.numfiles ; i++ ) {
             int exitCode = shell->evaluateFile(settings, settings.filenames[i]);
@@ -330,6 +484,20 @@ namespace avmshell
         if (settings.do_repl)
                 Shell::repl(shell);
 #endif
+
+#ifdef MMGC_HEAP_SNAPSHOT
+        if (snapshotWriter != NULL) {
+            Platform::GetInstance()->setHeapSnapshotSignal(NULL, NULL);
+            gc->SetHeapSnapshotWriter(NULL);
+            snapshotWriter->setFinal();
+            gc->WriteHeapSnapshot(snapshotWriter);
+            mmfx_delete(snapshotWriter);
+        }
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        if (settings.allocProfileFile != NULL)
+            GCAllocationProfileFileWriter::writeProfiles(gc, settings.allocProfileFile);
+#endif
 		aggregate->requestAggregateExit();
         aggregate->beforeCoreDeletion(this);
         delete shell;
@@ -982,6 +1150,13 @@ namespace avmshell
                     settings.njconfig.harden_nop_insertion = true;
                     settings.njconfig.harden_function_alignment = true;
                 }
+                else if (!VMPI_strcmp(arg, "-jitthread")) {
+                    settings.jitconfig.jit_thread = true;
+                }
+                else if (!VMPI_strcmp(arg, "-jitthread=stats")) {
+                    settings.jitconfig.jit_thread = true;
+                    settings.jitconfig.jit_thread_stats = true;
+                }
                 else if (!VMPI_strcmp(arg, "-Ojit")) {
                     settings.runmode = avmplus::RM_jit_all;
                 }
@@ -1059,6 +1234,24 @@ namespace avmshell
                         usage();
                     }
                 }
+#endif
+#ifdef MMGC_EVENT_STREAM
+                else if (!VMPI_strcmp(arg, "-gcevents") && i+1 < argc ) {
+                    settings.gcEventsFile = argv[++i];
+                }
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+                else if (!VMPI_strcmp(arg, "-gcsnapshot") && i+1 < argc ) {
+                    settings.gcSnapshotFile = argv[++i];
+                }
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+                else if (!VMPI_strcmp(arg, "-allocprofile") && i+1 < argc ) {
+                    settings.allocProfileFile = argv[++i];
+                    MMgc::GCHeapConfig& config = MMgc::GCHeap::GetGCHeap()->Config();
+                    if (config.allocationSampleInterval == 0)
+                        config.allocationSampleInterval = 512*1024;
+                }
 #endif
                 else if (!VMPI_strcmp(arg, "-log")) {
                     settings.do_log = true;
@@ -1243,6 +1436,13 @@ namespace avmshell
         avmplus::AvmLog("          [-memlimit d] limit the heap size to d pages\n");
         avmplus::AvmLog("          [-eagersweep] sweep the heap synchronously at the end of GC;\n"
                "                        improves usage statistics.\n");
+#ifdef MMGC_BACKGROUND_SWEEPING
+        avmplus::AvmLog("          [-backgroundsweep] sweep blocks of non-finalized objects on a helper thread after GC\n");
+#endif
+#ifdef MMGC_BACKGROUND_DECOMMIT
+        avmplus::AvmLog("          [-gcdecommit R[,D]] keep R KB of free memory committed and decommit the rest\n"
+               "                        on a helper thread once it has been unused for D ms (default 1000)\n");
+#endif
 #ifdef MMGC_POLICY_PROFILING
         avmplus::AvmLog("          [-gcbehavior] summarize GC behavior and policy, after every gc\n");
         avmplus::AvmLog("          [-gcsummary]  summarize GC behavior and policy, at end only\n");
@@ -1253,6 +1453,50 @@ namespace avmshell
                "                        will be ignored and can be omitted\n", int(MMgc::GCHeapConfig::kNumLoadFactors));
         avmplus::AvmLog("          [-loadCeiling X] GC load multiplier ceiling (default 1.0)\n");
         avmplus::AvmLog("          [-gcwork G]   Max fraction of time (default 0.25) we're willing to spend in GC\n");
+#ifdef MMGC_PARALLEL_MARKING
+        avmplus::AvmLog("          [-gcmarkthreads N] Threads to use for the final mark phase (default 1, max %d)\n", int(MMgc::GCHeapConfig::kMaxMarkThreads));
+#endif
+#ifdef MMGC_GENERATIONAL
+        avmplus::AvmLog("          [-gcgenerational] collect recently allocated objects between full collections\n");
+        avmplus::AvmLog("          [-gcnursery N] Kilobytes allocated between nursery collections (default %u)\n", unsigned(MMgc::GCHeapConfig::kDefaultNurserySize / 1024));
+#endif
+#ifdef MMGC_CARD_MARKING
+        avmplus::AvmLog("          [-gccardbarrier] write barrier dirties cards that are rescanned at the end of marking\n");
+#endif
+#ifdef MMGC_HUGE_PAGES
+        avmplus::AvmLog("          [-gchugepages] align GC heap regions to huge pages and advise the OS to back them with huge pages\n");
+#endif
+#ifdef MMGC_COMPACTION
+        avmplus::AvmLog("          [-gccompact]  move movable objects out of sparsely occupied blocks during full collections\n");
+#endif
+#ifdef MMGC_FIXEDMALLOC_MAGAZINES
+        avmplus::AvmLog("          [-fixedmagazines] cache free FixedMalloc objects per thread to reduce allocator locking\n");
+#endif
+#ifdef MMGC_PAUSE_TARGET
+        avmplus::AvmLog("          [-gcpause T[,U]] aim for GC pauses of at most T milliseconds, leaving at least\n"
+               "                        a fraction U (default 0.5) of the time around each pause to the program\n");
+#endif
+#ifdef MMGC_STACK_MAPS
+        avmplus::AvmLog("          [-gcstackmaps] scan JIT frames precisely using stack maps recorded at call sites\n");
+#endif
+#ifdef MMGC_INLINE_WEAKREFS
+        avmplus::AvmLog("          [-gcweakslots] find weak references through per-block slot arrays instead of a hashtable\n");
+#endif
+#ifdef MMGC_INCREMENTAL_REAP
+        avmplus::AvmLog("          [-gcincrementalreap] reap the zero count table in time-bounded slices\n");
+#endif
+#ifdef MMGC_EVENT_STREAM
+        avmplus::AvmLog("          [-gcevents F] write a JSON record for every GC phase and collection to file F, one per line\n");
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+        avmplus::AvmLog("          [-gcsnapshot F] write a heap snapshot to file F when the program ends, and to F.1, F.2, ...\n"
+                        "                        whenever the process receives SIGUSR2 (see utils/heapsnapshot.py)\n");
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        avmplus::AvmLog("          [-gcsample N] sample about one managed allocation per N KB allocated\n");
+        avmplus::AvmLog("          [-allocprofile F] write the sampled allocation sites with the bytes allocated at each to F.alloc,\n"
+                        "                        and with the bytes still live to F.live, in folded stack format (-gcsample 512 unless given)\n");
+#endif
         avmplus::AvmLog("          [-stack N]    Stack size in bytes (will be honored approximately).\n"
                "                        Be aware of the stack margin: %u\n", avmshell::kStackMargin);
 #ifdef MMGC_MARKSTACK_ALLOWANCE
@@ -1320,6 +1564,8 @@ namespace avmshell
         avmplus::AvmLog("          [-Dnocse]     disable CSE optimization\n");
         avmplus::AvmLog("          [-Dnoinline]  disable speculative inlining\n");
         avmplus::AvmLog("          [-jitharden]  enable jit hardening techniques\n");
+        avmplus::AvmLog("          [-jitthread]  compile hot methods on a background thread, interpreting them meanwhile\n");
+        avmplus::AvmLog("          [-jitthread=stats] same, and print the thread's queue and latency statistics at exit\n");
         avmplus::AvmLog("          [-osr=T]      enable OSR with invocation threshold T; disable with -osr=0; default is -osr=%d\n",
                         avmplus::AvmCore::osr_threshold_default);
         avmplus::AvmLog("          [-prof=L]     enable jit profile level L; default 0=disabled; 1=function ranges, 2=functions+native asm)\n");
@@ -148,6 +148,15 @@ namespace avmshell
         int numworkers;
         int repeats;
         uint32_t stackSize;
+#ifdef MMGC_EVENT_STREAM
+        const char* gcEventsFile;       // file receiving the GC event stream, or NULL
+#endif
+#ifdef MMGC_HEAP_SNAPSHOT
+        const char* gcSnapshotFile;     // base name of heap snapshot files, or NULL
+#endif
+#ifdef MMGC_ALLOCATION_SAMPLER
+        const char* allocProfileFile;   // base name of allocation profile files, or NULL
+#endif
         char st_mem[200];               // Selftest scratch memory.  200 chars ought to be enough for anyone
     };
 
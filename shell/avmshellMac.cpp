@@ -22,6 +22,7 @@ namespace avmshell
         virtual ~MacPlatform() {}
 
         virtual void setTimer(int seconds, AvmTimerCallback callback, void* callbackData);
+        virtual void setHeapSnapshotSignal(AvmTimerCallback callback, void* callbackData);
         virtual uintptr_t getMainThreadStackLimit();
 
     private:
@@ -58,6 +59,22 @@ namespace avmshell
     {
         pCallbackFunc(pCallbackData);
     }
+
+    AvmTimerCallback pSnapshotFunc = 0;
+    void* pSnapshotData = 0;
+
+    static void snapshotProc(int /*signum*/)
+    {
+        pSnapshotFunc(pSnapshotData);
+    }
+
+    void MacPlatform::setHeapSnapshotSignal(AvmTimerCallback callback, void* callbackData)
+    {
+        pSnapshotFunc = callback;
+        pSnapshotData = callbackData;
+
+        signal(SIGUSR2, callback != NULL ? snapshotProc : SIG_DFL);
+    }
 }
 
 avmshell::MacPlatform* gPlatformHandle = NULL;
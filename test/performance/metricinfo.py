@@ -53,6 +53,10 @@ metric_info = {
             'best':max,
             'largerIsFaster':True,
         },
+        'MB/second':{
+            'best':max,
+            'largerIsFaster':True,
+        },
         
         # steps is a metric output by the avm when compiled with --enable-count-steps
         'steps':{
@@ -0,0 +1,49 @@
+/* -*- mode: java; tab-width: 4 -*- */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Deep stacks: allocate short-lived objects at the bottom of a deep chain
+// of AS3 calls, so that every ZCT reap and every collection has to scan
+// thousands of frames.  Compare runs with and without -gcstackmaps, which
+// lets the GC scan JIT frames precisely instead of conservatively.
+
+class Cell
+{
+    var next:Cell;
+    var value:int;
+    function Cell(next:Cell, value:int) { this.next = next; this.value = value; }
+}
+
+var kDepth = 2000;
+var kIterations = 60;
+var kChurn = 20000;
+
+function churn():int
+{
+    var sum:int = 0;
+    for (var i:int = 0 ; i < kChurn ; i++) {
+        var c:Cell = new Cell(null, i);
+        c = new Cell(c, i);
+        sum += c.next.value & 1;
+    }
+    return sum;
+}
+
+function descend(depth:int, held:Cell):int
+{
+    var mine:Cell = new Cell(held, depth);
+    if (depth == 0)
+        return churn();
+    return descend(depth - 1, mine) + (mine.value & 0);
+}
+
+var then = new Date();
+var total = 0;
+for (var i = 0 ; i < kIterations ; i++)
+    total += descend(kDepth, null);
+var elapsed = new Date() - then;
+
+if (total != kIterations * kChurn / 2)
+    print("validation failed: " + total);
+print("metric time " + elapsed);
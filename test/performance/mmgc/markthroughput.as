@@ -0,0 +1,61 @@
+/* -*- mode: java; tab-width: 4 -*- */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Mark throughput: build a large binary tree whose nodes are linked in an
+// order unrelated to their allocation order, so that nearly every object the
+// marker visits is a cache miss, then time full collections of it.  Reports
+// the time and the marking rate in MB/s of live heap.
+
+import avmplus.System;
+
+class Node
+{
+    var left:Node, right:Node;
+    var payload:int;
+}
+
+var kNodes = 1 << 20;
+var kCollections = 10;
+
+function buildTree(n)
+{
+    var nodes = new Array(n);
+    for (var i = 0 ; i < n ; i++)
+        nodes[i] = new Node();
+
+    // Shuffle with a fixed LCG so that runs are comparable.
+    var seed = 12345;
+    for (var i = n-1 ; i > 0 ; i--) {
+        seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+        var j = seed % (i+1);
+        var t = nodes[i];
+        nodes[i] = nodes[j];
+        nodes[j] = t;
+    }
+
+    for (var i = 0 ; i < n ; i++) {
+        var node = nodes[i];
+        node.payload = i;
+        if (2*i+1 < n)
+            node.left = nodes[2*i+1];
+        if (2*i+2 < n)
+            node.right = nodes[2*i+2];
+    }
+    return nodes[0];
+}
+
+var root = buildTree(kNodes);
+System.forceFullCollection();
+var live = System.totalMemory - System.freeMemory;
+
+var then = new Date();
+for (var i = 0 ; i < kCollections ; i++)
+    System.forceFullCollection();
+var elapsed = new Date() - then;
+
+if (root.payload != 0)
+    print("validation failed: bad tree");
+print("metric time " + elapsed);
+print("metric MB/second " + Math.round((live * kCollections / (1024*1024)) / (elapsed / 1000)));
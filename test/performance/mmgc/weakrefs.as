@@ -0,0 +1,43 @@
+/* -*- mode: java; tab-width: 4 -*- */
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+// Weak reference churn: every key of a weak-keyed Dictionary is held by a
+// GCWeakRef, so filling such dictionaries with fresh objects creates weak
+// refs, and dropping the keys makes the collector clear them.  Compare runs
+// with and without -gcweakslots, which finds weak refs through per-block
+// slot arrays instead of the GC::weakRefs hashtable.
+
+import flash.utils.Dictionary;
+
+class Key
+{
+    var value:int;
+    function Key(value:int) { this.value = value; }
+}
+
+var kRounds = 40;
+var kKeys = 50000;      // 2M weak refs created and cleared in all
+var kKept = 1000;       // keys that survive each round, so lookups hit live weak refs
+
+var kept:Array = [];
+var then = new Date();
+var total = 0;
+for (var r = 0 ; r < kRounds ; r++) {
+    var d = new Dictionary(true);
+    for (var i:int = 0 ; i < kKeys ; i++) {
+        var k:Key = new Key(i);
+        d[k] = i;
+        if (i < kKept)
+            kept[i] = k;
+    }
+    for (var j:int = 0 ; j < kKept ; j++)
+        total += d[kept[j]] & 1;
+    // Dropping 'd' and the unkept keys leaves every weak ref to be cleared.
+}
+var elapsed = new Date() - then;
+
+if (total != kRounds * kKept / 2)
+    print("validation failed: " + total);
+print("metric time " + elapsed);
@@ -0,0 +1,254 @@
+#!/usr/bin/env python
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0. If a copy of the MPL was not distributed with this
+# file, You can obtain one at http://mozilla.org/MPL/2.0/.
+
+# Reads a heap snapshot written by MMgc (avmshell -gcsnapshot F, or
+# GC::WriteHeapSnapshot), computes the dominator tree of the object graph,
+# and reports which types and which objects retain the most memory.
+#
+# The format is described at GCHeapSnapshotWriter in MMgc/GC.h.  Every root
+# record is a child of a synthetic root; an object's retained size is the sum
+# of the shallow sizes of the objects it dominates, including itself.
+
+import sys
+from getopt import getopt
+from os.path import basename
+
+globs = {'top': 20, 'verbose': False}
+
+def usage(c):
+    print("usage: %s [options] snapshot" % basename(sys.argv[0]))
+    print(" -n --top N      number of rows in each table (default 20)")
+    print(" -v --verbose    print progress while reading and analyzing")
+    exit(c)
+
+class Reader:
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.pos = 0
+
+    def byte(self):
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def number(self):
+        n = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            n |= (b & 0x7f) << shift
+            shift += 7
+            if b < 0x80:
+                return n
+
+    def delta(self):
+        n = self.number()
+        return ~(n >> 1) if n & 1 else n >> 1
+
+class Snapshot:
+    # Node 0 is the synthetic root; nodes 1..len(roots) are the root records.
+    ROOT_KINDS = ['gc', 'root', 'stack']
+
+    def __init__(self, data):
+        r = Reader(data)
+        if bytes(r.data[0:8]) != b'MMGCSNP1':
+            raise ValueError('not a heap snapshot')
+        r.pos = 8
+        self.types = {0: '(unknown)'}
+        self.names = ['(all roots)']
+        self.addrs = [0]
+        self.sizes = [0]
+        self.typeof = [0]
+        self.flags = [0]
+        self.succ = [[]]
+        byaddr = {}
+        pending = []            # (source node, target address/8)
+        source = None
+        lastnode = 0
+        while True:
+            tag = chr(r.byte())
+            if tag == 'T':
+                index = r.number()
+                length = r.number()
+                self.types[index] = bytes(r.data[r.pos:r.pos+length]).decode('latin-1')
+                r.pos += length
+            elif tag == 'R':
+                kind = r.number()
+                addr = r.number()
+                source = self.add('%s %#x' % (self.ROOT_KINDS[kind] if kind < 3 else 'root?', addr), addr, 0, 0, 0)
+                self.succ[0].append(source)
+                sourceaddr = 0
+            elif tag == 'N':
+                lastnode += r.delta()
+                size = r.number()
+                type = r.number()
+                flags = r.byte()
+                source = self.add(None, lastnode << 3, size, type, flags)
+                byaddr[lastnode] = source
+                sourceaddr = lastnode
+            elif tag == 'E':
+                pending.append((source, sourceaddr + r.delta()))
+            elif tag == 'Z':
+                self.nnodes = r.number()
+                self.nedges = r.number()
+                break
+            else:
+                raise ValueError('bad record %r at offset %d' % (tag, r.pos-1))
+        for (s, a) in pending:
+            t = byaddr.get(a)
+            if t is not None:
+                self.succ[s].append(t)
+        if globs['verbose']:
+            print('%d nodes, %d edges, %d types' % (self.nnodes, self.nedges, len(self.types)))
+
+    def add(self, name, addr, size, type, flags):
+        self.names.append(name)
+        self.addrs.append(addr)
+        self.sizes.append(size)
+        self.typeof.append(type)
+        self.flags.append(flags)
+        self.succ.append([])
+        return len(self.names) - 1
+
+    def typename(self, n):
+        return self.types.get(self.typeof[n], '(type %d)' % self.typeof[n])
+
+    def label(self, n):
+        if self.names[n] is not None:
+            return self.names[n]
+        return '%s @%#x' % (self.typename(n), self.addrs[n])
+
+    def dominators(self):
+        # Cooper, Harvey and Kennedy, "A Simple, Fast Dominance Algorithm":
+        # iterate over the reverse postorder until the immediate dominators settle.
+        n = len(self.succ)
+        order = []
+        visited = [False] * n
+        visited[0] = True
+        stack = [(0, 0)]
+        while stack:
+            (v, i) = stack.pop()
+            if i < len(self.succ[v]):
+                stack.append((v, i+1))
+                w = self.succ[v][i]
+                if not visited[w]:
+                    visited[w] = True
+                    stack.append((w, 0))
+            else:
+                order.append(v)
+        order.reverse()
+        rpo = [-1] * n
+        for (i, v) in enumerate(order):
+            rpo[v] = i
+        preds = [[] for v in range(n)]
+        for v in order:
+            for w in self.succ[v]:
+                preds[w].append(v)
+        idom = [-1] * n
+        idom[0] = 0
+        changed = True
+        passes = 0
+        while changed:
+            changed = False
+            passes += 1
+            for v in order[1:]:
+                new = -1
+                for p in preds[v]:
+                    if idom[p] == -1:
+                        continue
+                    if new == -1:
+                        new = p
+                        continue
+                    a = p
+                    b = new
+                    while a != b:
+                        while rpo[a] > rpo[b]:
+                            a = idom[a]
+                        while rpo[b] > rpo[a]:
+                            b = idom[b]
+                    new = a
+                if idom[v] != new:
+                    idom[v] = new
+                    changed = True
+        if globs['verbose']:
+            print('dominators settled after %d passes; %d of %d nodes reachable' % (passes, len(order), n))
+        retained = list(self.sizes)
+        for v in reversed(order[1:]):
+            retained[idom[v]] += retained[v]
+        self.order = order
+        self.idom = idom
+        self.retained = retained
+
+def table(title, rows, top):
+    print('')
+    print(title)
+    for row in rows[:top]:
+        print('%12d %12d %12d  %s' % row)
+
+def outermost(s):
+    # The objects not dominated by another object of the same type: a type's
+    # retained size is the sum of their retained sizes.
+    children = [[] for v in s.succ]
+    for v in s.order[1:]:
+        children[s.idom[v]].append(v)
+    result = set()
+    onpath = {}
+    stack = [(0, True)]
+    while stack:
+        (v, enter) = stack.pop()
+        t = s.typename(v) if s.names[v] is None else None
+        if not enter:
+            onpath[t] -= 1
+            continue
+        if t is not None and onpath.get(t, 0) == 0:
+            result.add(v)
+        onpath[t] = onpath.get(t, 0) + 1
+        stack.append((v, False))
+        for w in children[v]:
+            stack.append((w, True))
+    return result
+
+def report(s, top):
+    reachable = set(s.order)
+    outer = outermost(s)
+    bytype = {}
+    for v in range(1, len(s.succ)):
+        if s.names[v] is not None:
+            continue
+        t = s.typename(v)
+        (count, shallow, retained) = bytype.get(t, (0, 0, 0))
+        if v in outer:
+            retained += s.retained[v]
+        bytype[t] = (count + 1, shallow + s.sizes[v], retained)
+    print('%d objects, %d bytes, %d types' % (sum(c for (c, sh, r) in bytype.values()),
+                                              sum(sh for (c, sh, r) in bytype.values()), len(bytype)))
+    print('%d objects not reachable from any root' % (len(s.succ) - len(reachable)))
+    rows = [(c, sh, r, t) for (t, (c, sh, r)) in bytype.items()]
+    print('\n%12s %12s %12s  %s' % ('count', 'shallow', 'retained', 'type'))
+    table('Types by count:', sorted(rows, key=lambda x: -x[0]), top)
+    table('Types by shallow size:', sorted(rows, key=lambda x: -x[1]), top)
+    table('Types by retained size:', sorted(rows, key=lambda x: -x[2]), top)
+    objs = [(1, s.sizes[v], s.retained[v], s.label(v)) for v in s.order[1:]]
+    table('Dominators by retained size:', sorted(objs, key=lambda x: -x[2]), top)
+
+if __name__ == '__main__':
+    try:
+        (opts, args) = getopt(sys.argv[1:], 'n:vh', ['top=', 'verbose', 'help'])
+    except:
+        usage(2)
+    for (o, v) in opts:
+        if o in ('-n', '--top'):
+            globs['top'] = int(v)
+        elif o in ('-v', '--verbose'):
+            globs['verbose'] = True
+        elif o in ('-h', '--help'):
+            usage(0)
+    if len(args) != 1:
+        usage(2)
+    f = open(args[0], 'rb')
+    s = Snapshot(f.read())
+    f.close()
+    s.dominators()
+    report(s, globs['top'])